@@ -0,0 +1,224 @@
+#include "BatchExport.h"
+
+#include "control/jobs/ImageExport.h"
+#include "control/jobs/ProgressListener.h"
+#include "pdf/base/XojPdfExport.h"
+#include "pdf/base/XojPdfExportFactory.h"
+#include "xojfile/LoadHandler.h"
+
+#include <StringUtils.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+/**
+ * The PDF export reports the progress after each page, the time between two reports is the time of a page
+ */
+class PageTimeListener : public ProgressListener
+{
+public:
+	virtual void setMaximumState(int max)
+	{
+		// The export falls back to rendering, the pages are exported again
+		this->pageTimes.clear();
+		this->start = g_get_monotonic_time();
+	}
+
+	virtual void setCurrentState(int state)
+	{
+		gint64 now = g_get_monotonic_time();
+		this->pageTimes.push_back((now - this->start) / (double) G_TIME_SPAN_SECOND);
+		this->start = now;
+	}
+
+	virtual ~PageTimeListener() { };
+
+public:
+	vector<double> pageTimes;
+
+private:
+	gint64 start = 0;
+};
+
+BatchExport::BatchExport()
+{
+	XOJ_INIT_TYPE(BatchExport);
+}
+
+BatchExport::~BatchExport()
+{
+	XOJ_CHECK_TYPE(BatchExport);
+
+	XOJ_RELEASE_TYPE(BatchExport);
+}
+
+void BatchExport::setThreadCount(int threadCount)
+{
+	XOJ_CHECK_TYPE(BatchExport);
+
+	this->threadCount = threadCount;
+}
+
+int BatchExport::exportList(const char* listFile)
+{
+	XOJ_CHECK_TYPE(BatchExport);
+
+	std::ifstream file;
+	bool useStdin = strcmp(listFile, "-") == 0;
+	if (!useStdin)
+	{
+		file.open(listFile);
+		if (!file)
+		{
+			g_warning("Could not open the list of documents to export \"%s\"", listFile);
+			return -1;
+		}
+	}
+	std::istream& in = useStdin ? std::cin : file;
+
+	gint64 start = g_get_monotonic_time();
+	int result = 0;
+
+	string line;
+	int lineNr = 0;
+	while (std::getline(in, line))
+	{
+		lineNr++;
+
+		if (!line.empty() && line[line.size() - 1] == '\r')
+		{
+			line.erase(line.size() - 1);
+		}
+		if (line.empty() || line[0] == '#')
+		{
+			continue;
+		}
+
+		size_t tab = line.find('\t');
+		if (tab == string::npos || tab == 0 || tab == line.size() - 1)
+		{
+			g_warning("Line %i of the export list has no input and output filename separated by a tab", lineNr);
+			this->failed++;
+			result = -1;
+			continue;
+		}
+
+		int error = exportDocument(line.substr(0, tab).c_str(), line.substr(tab + 1).c_str());
+		if (error != 0)
+		{
+			result = error;
+		}
+	}
+
+	double time = (g_get_monotonic_time() - start) / (double) G_TIME_SPAN_SECOND;
+	printf("%i documents exported, %i failed, %i pages in %.3f s, %.1f pages/s\n",
+		   this->exported, this->failed, this->pages, time, time > 0 ? this->pages / time : 0);
+	fflush(stdout);
+
+	return result;
+}
+
+int BatchExport::exportDocument(const char* input, const char* output)
+{
+	XOJ_CHECK_TYPE(BatchExport);
+
+	gint64 start = g_get_monotonic_time();
+
+	// The document belongs to the loader, it is freed after each document
+	LoadHandler loader;
+	Document* doc = loader.loadDocument(input);
+	if (doc == NULL)
+	{
+		g_warning("Could not load \"%s\": %s", input, loader.getLastError().c_str());
+		this->failed++;
+		return -2;
+	}
+
+	gint64 loaded = g_get_monotonic_time();
+
+	GFile* file = g_file_new_for_commandline_arg(output);
+	char* cpath = g_file_get_path(file);
+	string path = cpath;
+	g_free(cpath);
+	g_object_unref(file);
+
+	vector<double> pageTimes;
+	string error;
+
+	if (StringUtils::endsWith(path, ".pdf"))
+	{
+		PageTimeListener listener;
+		XojPdfExport* pdfe = XojPdfExportFactory::createExport(doc, &listener);
+		if (!pdfe->createPdf(path))
+		{
+			error = pdfe->getLastError();
+		}
+		delete pdfe;
+
+		pageTimes = listener.pageTimes;
+	}
+	else
+	{
+		ExportGraphicsFormat format = StringUtils::endsWith(path, ".svg") ? EXPORT_GRAPHICS_SVG : EXPORT_GRAPHICS_PNG;
+
+		PageRangeVector exportRange;
+		exportRange.push_back(new PageRangeEntry(0, doc->getPageCount() - 1));
+		DummyProgressListener progress;
+
+		ImageExport imgExport(doc, path, format, false, exportRange);
+		imgExport.setThreadCount(this->threadCount);
+		imgExport.exportGraphics(&progress);
+
+		for (PageRangeEntry* e : exportRange)
+		{
+			delete e;
+		}
+		exportRange.clear();
+
+		error = imgExport.getLastErrorMsg();
+		pageTimes = imgExport.getPageTimes();
+	}
+
+	if (!error.empty())
+	{
+		g_warning("Could not export \"%s\" to \"%s\": %s", input, output, error.c_str());
+		this->failed++;
+		return -3;
+	}
+
+	gint64 end = g_get_monotonic_time();
+	printTimes(input, output, (loaded - start) / (double) G_TIME_SPAN_SECOND,
+			   (end - loaded) / (double) G_TIME_SPAN_SECOND, pageTimes);
+
+	return 0;
+}
+
+void BatchExport::printTimes(const char* input, const char* output, double loadTime, double exportTime,
+							 const vector<double>& pageTimes)
+{
+	XOJ_CHECK_TYPE(BatchExport);
+
+	int count = 0;
+	for (double t : pageTimes)
+	{
+		if (t >= 0)
+		{
+			count++;
+		}
+	}
+
+	this->exported++;
+	this->pages += count;
+
+	printf("%s -> %s: %i pages, load %.3f s, export %.3f s\n", input, output, count, loadTime, exportTime);
+	for (size_t i = 0; i < pageTimes.size(); i++)
+	{
+		if (pageTimes[i] >= 0)
+		{
+			printf("  page %i: %.3f s\n", (int) i + 1, pageTimes[i]);
+		}
+	}
+	fflush(stdout);
+}
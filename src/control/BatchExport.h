@@ -0,0 +1,62 @@
+/*
+ * Xournal++
+ *
+ * Exports many documents in one process, from the commandline
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <XournalType.h>
+
+/**
+ * Exports a list of documents without starting the GUI. The format is chosen by the extension
+ * of the output file: .pdf, .svg or else PNG.
+ *
+ * The time to load and to export each document, and the time of each page, is printed to stdout.
+ */
+class BatchExport
+{
+public:
+	BatchExport();
+	virtual ~BatchExport();
+
+public:
+	/**
+	 * Number of threads rendering the pages of an image export, 0 to use all processors
+	 */
+	void setThreadCount(int threadCount);
+
+	/**
+	 * Exports the documents of a list file, one line per document with the input and
+	 * the output filename separated by a tab. Empty lines and lines starting with # are ignored.
+	 *
+	 * @param listFile The list file, "-" to read the list from stdin
+	 * @return 0 if all documents were exported, else the error of the last failed document
+	 */
+	int exportList(const char* listFile);
+
+	/**
+	 * Exports one document
+	 *
+	 * @return 0 if the document was exported, -2 if it could not be loaded, -3 if it could not be exported
+	 */
+	int exportDocument(const char* input, const char* output);
+
+private:
+	void printTimes(const char* input, const char* output, double loadTime, double exportTime,
+					const vector<double>& pageTimes);
+
+private:
+	XOJ_TYPE_ATTRIB;
+
+	int threadCount = 0;
+
+	int exported = 0;
+	int failed = 0;
+	int pages = 0;
+};
@@ -25,6 +25,7 @@
 #include "gui/toolbarMenubar/model/ToolbarData.h"
 #include "gui/toolbarMenubar/model/ToolbarModel.h"
 #include "jobs/AutosaveJob.h"
+#include "xojfile/AutosaveHandler.h"
 #include "jobs/BlockingJob.h"
 #include "jobs/CustomExportJob.h"
 #include "jobs/PdfExportJob.h"
@@ -105,13 +106,15 @@ Control::Control(GladeSearchpath* gladeSearchPath)
 
 	this->scrollHandler = new ScrollHandler(this);
 
-	this->scheduler = new XournalScheduler();
+	this->scheduler = new XournalScheduler(this->settings->getSchedulerThreadCount());
 
 	this->doc = new Document(this);
 
 	// for crashhandling
 	setEmergencyDocument(this->doc);
 
+	this->autosaveHandler = new AutosaveHandler(this);
+
 	this->zoom = new ZoomControl();
 	this->zoom->setZoomStep(this->settings->getZoomStep() / 100.0);
 	this->zoom->setZoomStepScroll(this->settings->getZoomStepScroll() / 100.0);
@@ -147,6 +150,9 @@ Control::~Control()
 
 	this->scheduler->stop();
 
+	delete this->autosaveHandler;
+	this->autosaveHandler = nullptr;
+
 	for (XojPage* page: this->changedPages)
 	{
 		page->unreference();
@@ -272,6 +278,13 @@ void Control::setLastAutosaveFile(Path newAutosaveFile)
 	this->lastAutosaveFilename = newAutosaveFile;
 }
 
+AutosaveHandler* Control::getAutosaveHandler()
+{
+	XOJ_CHECK_TYPE(Control);
+
+	return this->autosaveHandler;
+}
+
 void Control::deleteLastAutosaveFile(Path newAutosaveFile)
 {
 	XOJ_CHECK_TYPE(Control);
@@ -288,26 +301,35 @@ bool Control::checkChangedDocument(Control* control)
 {
 	XOJ_CHECK_TYPE_OBJ(control, Control);
 
-	if (!control->doc->tryLock())
+	// If the document is locked this is called again later
+	control->fireChangedPages();
+
+	// Call again
+	return true;
+}
+
+bool Control::fireChangedPages()
+{
+	XOJ_CHECK_TYPE(Control);
+
+	if (!this->doc->tryLock())
 	{
-		// call again later
-		return true;
+		return false;
 	}
-	for (XojPage* page: control->changedPages)
+	for (XojPage* page: this->changedPages)
 	{
-		int p = control->doc->indexOf(page);
+		int p = this->doc->indexOf(page);
 		if (p != -1)
 		{
-			control->firePageChanged(p);
+			firePageChanged(p);
 		}
 
 		page->unreference();
 	}
-	control->changedPages.clear();
+	this->changedPages.clear();
 
-	control->doc->unlock();
+	this->doc->unlock();
 
-	// Call again
 	return true;
 }
 
@@ -398,11 +420,19 @@ bool Control::autosaveCallback(Control* control)
 		// do nothing, nothing changed
 		return true;
 	}
-	else
+
+	// Deliver the pending page changes, the autosave only serializes the changed pages
+	if (!control->fireChangedPages())
 	{
-		g_message("Info: autosave document...");
+		// try again with the next interval
+		return true;
 	}
 
+	g_message("Info: autosave document...");
+
+	// Later changes are autosaved the next time, their pages are marked as changed until then
+	control->undoRedo->documentAutosaved();
+
 	AutosaveJob* job = new AutosaveJob(control);
 	control->scheduler->addJob(job, JOB_PRIORITY_NONE);
 	job->unref();
@@ -1832,11 +1862,11 @@ size_t Control::getCurrentPageNo()
 	return 0;
 }
 
-bool Control::searchTextOnPage(string text, int p, int* occures, double* top)
+vector<SearchHit> Control::searchText(string text)
 {
 	XOJ_CHECK_TYPE(Control);
 
-	return getWindow()->getXournal()->searchTextOnPage(text, p, occures, top);
+	return getWindow()->getXournal()->searchText(text);
 }
 
 PageRef Control::getCurrentPage()
@@ -2882,6 +2912,7 @@ void Control::quit(bool allowCancel)
 
 	audioController->stopRecording();
 	settings->save();
+	settings->flush();
 
 	this->scheduler->removeAllJobs();
 	this->scheduler->unlock();
@@ -15,6 +15,7 @@
 #include "ClipboardHandler.h"
 #include "RecentManager.h"
 #include "ScrollHandler.h"
+#include "SearchIndex.h"
 #include "ToolHandler.h"
 #include "AudioController.h"
 
@@ -39,6 +40,7 @@ class FullscreenHandler;
 class Sidebar;
 class XojPageView;
 class SaveHandler;
+class AutosaveHandler;
 class GladeSearchpath;
 class MetadataManager;
 class XournalppCursor;
@@ -179,7 +181,12 @@ public:
 
 	bool isFullscreen();
 
-	bool searchTextOnPage(string text, int p, int* occures, double* top);
+	/**
+	 * Searches the whole document and shows the results, an empty text removes the results
+	 *
+	 * @return All hits, sorted by page
+	 */
+	vector<SearchHit> searchText(string text);
 
 	/**
 	 * Fire page selected, but first check if the page Number is valid
@@ -228,6 +235,7 @@ public:
 	void renameLastAutosaveFile();
 	void setLastAutosaveFile(Path newAutosaveFile);
 	void deleteLastAutosaveFile(Path newAutosaveFile);
+	AutosaveHandler* getAutosaveHandler();
 	void setClipboardHandlerSelection(EditSelection* selection);
 
 	MetadataManager* getMetadataManager();
@@ -303,6 +311,12 @@ protected:
 	static bool checkChangedDocument(Control* control);
 	static bool autosaveCallback(Control* control);
 
+	/**
+	 * Fires the page changes collected from the undo handler
+	 * @return false if the document is locked, the changes are fired later
+	 */
+	bool fireChangedPages();
+
 	void fontChanged();
 	/**
 	 * Load metadata later, md will be deleted
@@ -377,6 +391,11 @@ private:
 	int autosaveTimeout = 0;
 	Path lastAutosaveFilename;
 
+	/**
+	 * Serializes the document for autosave, caches the unchanged pages
+	 */
+	AutosaveHandler* autosaveHandler = NULL;
+
 	XournalScheduler* scheduler;
 
 	/**
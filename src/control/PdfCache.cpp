@@ -1,141 +1,264 @@
 #include "PdfCache.h"
 
-#include <stdio.h>
+#include <cmath>
+#include <iterator>
 
-class PdfCacheEntry
+PdfCache::PdfCache(size_t maxBytes)
+ : maxBytes(maxBytes)
 {
-public:
-	PdfCacheEntry(XojPdfPageSPtr popplerPage, cairo_surface_t* img)
-	{
-		XOJ_INIT_TYPE(PdfCacheEntry);
-
-		this->popplerPage = popplerPage;
-		this->rendered = img;
-	}
+	XOJ_INIT_TYPE(PdfCache);
 
-	~PdfCacheEntry()
-	{
-		XOJ_CHECK_TYPE(PdfCacheEntry);
+	g_mutex_init(&this->mutex);
+	g_cond_init(&this->renderFinished);
+}
 
-		this->popplerPage = NULL;
-		cairo_surface_destroy(this->rendered);
-		this->rendered = NULL;
+PdfCache::~PdfCache()
+{
+	XOJ_CHECK_TYPE(PdfCache);
 
-		XOJ_RELEASE_TYPE(PdfCacheEntry);
-	}
+	clearCacheUnlocked();
 
-	XOJ_TYPE_ATTRIB;
+	g_cond_clear(&this->renderFinished);
+	g_mutex_clear(&this->mutex);
 
-	XojPdfPageSPtr popplerPage;
-	cairo_surface_t* rendered;
-};
+	XOJ_RELEASE_TYPE(PdfCache);
+}
 
-PdfCache::PdfCache(int size)
+size_t PdfCache::CacheKeyHash::operator()(const CacheKey& key) const
 {
-	XOJ_INIT_TYPE(PdfCache);
-
-	this->size = size;
+	return std::hash<int>()(key.pageId) * 31 + std::hash<int>()(key.bucket);
+}
 
-	g_mutex_init(&this->renderMutex);
+int PdfCache::zoomBucket(double zoom)
+{
+	return (int) std::floor(std::log2(zoom) * BUCKETS_PER_OCTAVE + 0.5);
 }
 
-PdfCache::~PdfCache()
+void PdfCache::clearCache()
 {
 	XOJ_CHECK_TYPE(PdfCache);
 
-	clearCache();
-	this->size = 0;
-
-	XOJ_RELEASE_TYPE(PdfCache);
+	g_mutex_lock(&this->mutex);
+	clearCacheUnlocked();
+	this->generation++;
+	g_mutex_unlock(&this->mutex);
 }
 
-void PdfCache::setZoom(double zoom)
+void PdfCache::clearCacheUnlocked()
 {
 	XOJ_CHECK_TYPE(PdfCache);
 
-	if (this->zoom == zoom)
+	for (CacheEntry& e : this->data)
 	{
-		return;
+		cairo_surface_destroy(e.rendered);
 	}
-	this->zoom = zoom;
-
-	clearCache();
+	this->data.clear();
+	this->index.clear();
+	this->bytes = 0;
 }
 
-void PdfCache::clearCache()
+PdfCache::EntryList::iterator PdfCache::findUnlocked(const CacheKey& key)
 {
 	XOJ_CHECK_TYPE(PdfCache);
 
-	for (PdfCacheEntry* e : this->data)
+	auto it = this->index.find(key);
+	if (it == this->index.end())
 	{
-		delete e;
+		return this->data.end();
 	}
-	this->data.clear();
+	return it->second;
 }
 
-cairo_surface_t* PdfCache::lookup(XojPdfPageSPtr popplerPage)
+PdfCache::EntryList::iterator PdfCache::findNearestUnlocked(const CacheKey& key)
 {
 	XOJ_CHECK_TYPE(PdfCache);
 
-	for (PdfCacheEntry* e : this->data)
+	// Prefer the higher resolution, downscaling looks better than upscaling
+	for (int distance = 1; distance <= MAX_BUCKET_DISTANCE; distance++)
 	{
-		XOJ_CHECK_TYPE_OBJ(e, PdfCacheEntry);
-		if (e->popplerPage->getPageId() == popplerPage->getPageId())
+		for (int bucket : { key.bucket + distance, key.bucket - distance })
 		{
-			return e->rendered;
+			EntryList::iterator it = findUnlocked({ key.pageId, bucket });
+			if (it != this->data.end())
+			{
+				return it;
+			}
 		}
 	}
 
-	return NULL;
+	return this->data.end();
 }
 
-void PdfCache::cache(XojPdfPageSPtr popplerPage, cairo_surface_t* img)
+void PdfCache::storeUnlocked(const CacheKey& key, cairo_surface_t* img, double zoom)
 {
 	XOJ_CHECK_TYPE(PdfCache);
 
-	PdfCacheEntry* ne = new PdfCacheEntry(popplerPage, img);
-	this->data.push_front(ne);
-	
-	while (this->data.size() > this->size)
+	EntryList::iterator it = findUnlocked(key);
+	if (it != this->data.end())
+	{
+		this->bytes -= cairo_image_surface_get_stride(it->rendered) * cairo_image_surface_get_height(it->rendered);
+		cairo_surface_destroy(it->rendered);
+		this->index.erase(key);
+		this->data.erase(it);
+	}
+
+	this->data.push_front({ key, img, zoom });
+	this->index[key] = this->data.begin();
+	this->bytes += cairo_image_surface_get_stride(img) * cairo_image_surface_get_height(img);
+
+	// The first entry is the one just rendered, never remove it
+	while (this->bytes > this->maxBytes && this->data.size() > 1)
 	{
-		delete this->data.back();
+		CacheEntry& last = this->data.back();
+		this->bytes -= cairo_image_surface_get_stride(last.rendered) * cairo_image_surface_get_height(last.rendered);
+		cairo_surface_destroy(last.rendered);
+		this->index.erase(last.key);
 		this->data.pop_back();
 	}
 }
 
-void PdfCache::render(cairo_t* cr, XojPdfPageSPtr popplerPage, double zoom)
+cairo_surface_t* PdfCache::acquire(XojPdfPageSPtr popplerPage, double zoom, double* renderedZoom)
 {
 	XOJ_CHECK_TYPE(PdfCache);
 
-	g_mutex_lock(&this->renderMutex);
+	CacheKey key = { popplerPage->getPageId(), zoomBucket(zoom) };
 
-	this->setZoom(zoom);
+	g_mutex_lock(&this->mutex);
 
-	cairo_surface_t* img = lookup(popplerPage);
-	if (img == NULL)
+	while (true)
 	{
-		img = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
-										 popplerPage->getWidth() * this->zoom, popplerPage->getHeight() * this->zoom);
-		cairo_t* cr2 = cairo_create(img);
-
-		cairo_scale(cr2, this->zoom, this->zoom);
-		popplerPage->render(cr2, false);
-		cairo_destroy(cr2);
-		cache(popplerPage, img);
+		EntryList::iterator it = findUnlocked(key);
+		if (it != this->data.end())
+		{
+			this->data.splice(this->data.begin(), this->data, it);
+
+			cairo_surface_t* img = cairo_surface_reference(it->rendered);
+			*renderedZoom = it->zoom;
+			g_mutex_unlock(&this->mutex);
+			return img;
+		}
+
+		// The same poppler page is not rendered by two threads at the same time
+		if (this->rendering.count(key.pageId) == 0)
+		{
+			break;
+		}
+		g_cond_wait(&this->renderFinished, &this->mutex);
+	}
+
+	this->rendering.insert(key.pageId);
+	int generation = this->generation;
+	g_mutex_unlock(&this->mutex);
+
+	cairo_surface_t* img = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+													  popplerPage->getWidth() * zoom, popplerPage->getHeight() * zoom);
+	cairo_t* cr2 = cairo_create(img);
+	cairo_scale(cr2, zoom, zoom);
+	// Takes the lock of the PDF document, renders of other pages of the document wait for this one
+	popplerPage->render(cr2, false);
+	cairo_destroy(cr2);
+
+	g_mutex_lock(&this->mutex);
+	if (generation == this->generation)
+	{
+		storeUnlocked(key, cairo_surface_reference(img), zoom);
 	}
+	this->rendering.erase(key.pageId);
+	g_cond_broadcast(&this->renderFinished);
+	g_mutex_unlock(&this->mutex);
 
+	*renderedZoom = zoom;
+	return img;
+}
+
+cairo_surface_t* PdfCache::acquireLowResolution(XojPdfPageSPtr popplerPage, double zoom, double* renderedZoom)
+{
+	XOJ_CHECK_TYPE(PdfCache);
+
+	CacheKey key = { popplerPage->getPageId(), zoomBucket(zoom) };
+
+	g_mutex_lock(&this->mutex);
+
+	cairo_surface_t* img = NULL;
+	EntryList::iterator it = findNearestUnlocked(key);
+	if (it != this->data.end())
+	{
+		img = cairo_surface_reference(it->rendered);
+		*renderedZoom = it->zoom;
+	}
+
+	g_mutex_unlock(&this->mutex);
+
+	return img;
+}
+
+void PdfCache::paint(cairo_t* cr, cairo_surface_t* img, double scale)
+{
 	cairo_matrix_t mOriginal;
 	cairo_matrix_t mScaled;
 	cairo_get_matrix(cr, &mOriginal);
 	cairo_get_matrix(cr, &mScaled);
-	mScaled.xx = 1;
-	mScaled.yy = 1;
+	mScaled.xx = scale;
+	mScaled.yy = scale;
 	mScaled.xy = 0;
 	mScaled.yx = 0;
 	cairo_set_matrix(cr, &mScaled);
 	cairo_set_source_surface(cr, img, 0, 0);
+	if (scale != 1)
+	{
+		cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_GOOD);
+	}
 	cairo_paint(cr);
 	cairo_set_matrix(cr, &mOriginal);
+}
+
+void PdfCache::render(cairo_t* cr, XojPdfPageSPtr popplerPage, double zoom, bool lowResolution)
+{
+	XOJ_CHECK_TYPE(PdfCache);
+
+	double renderedZoom = zoom;
+	cairo_surface_t* img = NULL;
+
+	if (lowResolution && !isCached(popplerPage, zoom))
+	{
+		img = acquireLowResolution(popplerPage, zoom, &renderedZoom);
+	}
+
+	if (img == NULL)
+	{
+		img = acquire(popplerPage, zoom, &renderedZoom);
+	}
+
+	paint(cr, img, zoom / renderedZoom);
+	cairo_surface_destroy(img);
+}
+
+void PdfCache::prefetch(XojPdfPageSPtr popplerPage, double zoom)
+{
+	XOJ_CHECK_TYPE(PdfCache);
+
+	double renderedZoom = 0;
+	cairo_surface_destroy(acquire(popplerPage, zoom, &renderedZoom));
+}
+
+bool PdfCache::isCached(XojPdfPageSPtr popplerPage, double zoom)
+{
+	XOJ_CHECK_TYPE(PdfCache);
+
+	g_mutex_lock(&this->mutex);
+	bool cached = findUnlocked({ popplerPage->getPageId(), zoomBucket(zoom) }) != this->data.end();
+	g_mutex_unlock(&this->mutex);
+
+	return cached;
+}
+
+bool PdfCache::hasLowResolution(XojPdfPageSPtr popplerPage, double zoom)
+{
+	XOJ_CHECK_TYPE(PdfCache);
+
+	g_mutex_lock(&this->mutex);
+	bool found = findNearestUnlocked({ popplerPage->getPageId(), zoomBucket(zoom) }) != this->data.end();
+	g_mutex_unlock(&this->mutex);
 
-	g_mutex_unlock(&this->renderMutex);
+	return found;
 }
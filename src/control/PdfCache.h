@@ -16,14 +16,31 @@
 
 #include <cairo/cairo.h>
 #include <list>
-using std::list;
+#include <unordered_map>
+#include <unordered_set>
 
-class PdfCacheEntry;
+/**
+ * Memory budget for one cached PDF page, the setting "pdfPageCacheSize" is a count of pages
+ */
+#define PDF_CACHE_BYTES_PER_PAGE (16 * 1024 * 1024)
 
+/**
+ * Caches rendered PDF pages keyed by (page, zoom bucket). A zoom bucket covers about 9%
+ * of zoom, so small zoom changes reuse the existing render scaled instead of rendering again.
+ * Renders of different zoom levels are kept in the cache at the same time, the least recently
+ * used renders are dropped if the cache exceeds its byte budget.
+ *
+ * The cache is used from multiple scheduler threads. poppler renders one page of a document at a time
+ * (the page holds the lock of its document while rendering), the cache lookups of other threads are not
+ * blocked by a running render. A page is never rendered by two threads at the same time.
+ */
 class PdfCache
 {
 public:
-	PdfCache(int size);
+	/**
+	 * @param maxBytes The memory budget for all rendered pages
+	 */
+	PdfCache(size_t maxBytes);
 	virtual ~PdfCache();
 
 private:
@@ -31,21 +48,123 @@ private:
 	void operator=(const PdfCache& cache);
 
 public:
-	void render(cairo_t* cr, XojPdfPageSPtr popplerPage, double zoom);
+	/**
+	 * Paints the page, rendered for this zoom. Renders the page if it is not cached yet.
+	 *
+	 * @param lowResolution Paint a render of another zoom scaled instead, if there is one
+	 */
+	void render(cairo_t* cr, XojPdfPageSPtr popplerPage, double zoom, bool lowResolution = false);
 
-private:
-	void setZoom(double zoom);
+	/**
+	 * Renders the page into the cache, if it is not cached yet
+	 */
+	void prefetch(XojPdfPageSPtr popplerPage, double zoom);
+
+	/**
+	 * @return true if the page is rendered for this zoom
+	 */
+	bool isCached(XojPdfPageSPtr popplerPage, double zoom);
+
+	/**
+	 * @return true if the page is rendered for another zoom, which can be painted while rendering
+	 */
+	bool hasLowResolution(XojPdfPageSPtr popplerPage, double zoom);
+
+	/**
+	 * Drops all renders, e.g. because another PDF is loaded. The page IDs are only unique in one PDF.
+	 * Renders which are running meanwhile are not stored.
+	 */
 	void clearCache();
-	cairo_surface_t* lookup(XojPdfPageSPtr popplerPage);
-	void cache(XojPdfPageSPtr popplerPage, cairo_surface_t* img);
+
+private:
+	struct CacheKey
+	{
+		int pageId;
+		int bucket;
+
+		bool operator==(const CacheKey& other) const
+		{
+			return pageId == other.pageId && bucket == other.bucket;
+		}
+	};
+
+	struct CacheKeyHash
+	{
+		size_t operator()(const CacheKey& key) const;
+	};
+
+	struct CacheEntry
+	{
+		CacheKey key;
+		cairo_surface_t* rendered;
+
+		/**
+		 * The zoom the page was rendered with, inside the bucket
+		 */
+		double zoom;
+	};
+
+	typedef std::list<CacheEntry> EntryList;
+
+private:
+	static int zoomBucket(double zoom);
+
+	/**
+	 * @return A new reference to the render, the page is rendered if needed
+	 */
+	cairo_surface_t* acquire(XojPdfPageSPtr popplerPage, double zoom, double* renderedZoom);
+
+	/**
+	 * @return A new reference to the cached render nearest to the zoom, or NULL
+	 */
+	cairo_surface_t* acquireLowResolution(XojPdfPageSPtr popplerPage, double zoom, double* renderedZoom);
+
+	EntryList::iterator findUnlocked(const CacheKey& key);
+	EntryList::iterator findNearestUnlocked(const CacheKey& key);
+	void storeUnlocked(const CacheKey& key, cairo_surface_t* img, double zoom);
+	void clearCacheUnlocked();
+
+	static void paint(cairo_t* cr, cairo_surface_t* img, double scale);
 
 private:
 	XOJ_TYPE_ATTRIB;
 
-	GMutex renderMutex;
+	/**
+	 * Protects the entries and the pages being rendered, not held while rendering
+	 */
+	GMutex mutex;
+
+	/**
+	 * Signaled each time a page has been rendered
+	 */
+	GCond renderFinished;
+
+	/**
+	 * Most recently used entries first
+	 */
+	EntryList data;
+	std::unordered_map<CacheKey, EntryList::iterator, CacheKeyHash> index;
+
+	/**
+	 * The page IDs currently rendered by a thread
+	 */
+	std::unordered_set<int> rendering;
+
+	/**
+	 * Incremented by clearCache, a render started before is not stored
+	 */
+	int generation = 0;
+
+	size_t bytes = 0;
+	size_t maxBytes;
 
-	list<PdfCacheEntry*> data;
-	list<PdfCacheEntry*>::size_type size = 0;
+	/**
+	 * Zoom buckets per doubling of the zoom
+	 */
+	static const int BUCKETS_PER_OCTAVE = 8;
 
-	double zoom = -1;
+	/**
+	 * Largest distance of a low resolution render, in buckets (a factor of 8)
+	 */
+	static const int MAX_BUCKET_DISTANCE = 3 * BUCKETS_PER_OCTAVE;
 };
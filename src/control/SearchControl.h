@@ -1,7 +1,7 @@
 /*
  * Xournal++
  *
- * Handles text search on a PDF page and in Xournal Texts
+ * The search results of a page, painted over the page
  *
  * @author Xournal++ Team
  * https://github.com/xournalpp/xournalpp
@@ -11,26 +11,25 @@
 
 #pragma once
 
-#include "model/PageRef.h"
 #include "util/GtkColorWrapper.h"
 #include "pdf/base/XojPdfPage.h"
 
 class SearchControl
 {
 public:
-	SearchControl(PageRef page, XojPdfPageSPtr pdf);
+	SearchControl();
 	virtual ~SearchControl();
 
-	bool search(string text, int* occures, double* top);
+	/**
+	 * Sets the results of the page, found by SearchIndex
+	 */
+	void setResults(vector<XojPdfRectangle> results);
+	bool hasResults();
+
 	void paint(cairo_t* cr, GdkRectangle* rect, double zoom, GtkColorWrapper color);
-private:
-	void freeSearchResults();
 
 private:
 	XOJ_TYPE_ATTRIB;
 
-	PageRef page;
-	XojPdfPageSPtr pdf;
-
 	vector<XojPdfRectangle> results;
 };
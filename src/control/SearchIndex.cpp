@@ -0,0 +1,747 @@
+#include "SearchIndex.h"
+
+#include "model/Document.h"
+#include "model/Layer.h"
+#include "model/Text.h"
+#include "view/TextView.h"
+
+#include <Util.h>
+
+#include <glib/gstdio.h>
+
+#include <algorithm>
+#include <fstream>
+#include <unordered_set>
+
+using std::vector;
+using std::u32string;
+
+SearchHit::SearchHit(size_t page, XojPdfRectangle rect)
+ : page(page),
+   rect(rect)
+{
+}
+
+SearchIndex::SearchIndex()
+{
+	XOJ_INIT_TYPE(SearchIndex);
+
+	g_mutex_init(&this->mutex);
+}
+
+SearchIndex::~SearchIndex()
+{
+	XOJ_CHECK_TYPE(SearchIndex);
+
+	g_mutex_clear(&this->mutex);
+
+	XOJ_RELEASE_TYPE(SearchIndex);
+}
+
+void SearchIndex::setDocument(Document* doc)
+{
+	XOJ_CHECK_TYPE(SearchIndex);
+
+	string path = cacheFile(doc->getPdfFilename());
+
+	g_mutex_lock(&this->mutex);
+
+	this->generation++;
+	this->pdfPages.clear();
+	for (size_t i = 0; i < doc->getPdfPageCount(); i++)
+	{
+		this->pdfPages.push_back(doc->getPdfPage(i));
+	}
+	this->pdfEntries.assign(this->pdfPages.size(), nullptr);
+	this->nextPdfPage = 0;
+	this->indexedPdfPages = 0;
+	this->textEntries.clear();
+	this->pageTexts.clear();
+	this->lastTextChangeId = 0;
+	this->words.clear();
+	this->cachePath = path;
+	this->cacheChecked = false;
+
+	g_mutex_unlock(&this->mutex);
+}
+
+int SearchIndex::getGeneration()
+{
+	XOJ_CHECK_TYPE(SearchIndex);
+
+	g_mutex_lock(&this->mutex);
+	int generation = this->generation;
+	g_mutex_unlock(&this->mutex);
+
+	return generation;
+}
+
+bool SearchIndex::isComplete()
+{
+	XOJ_CHECK_TYPE(SearchIndex);
+
+	g_mutex_lock(&this->mutex);
+	bool complete = this->indexedPdfPages == this->pdfEntries.size();
+	g_mutex_unlock(&this->mutex);
+
+	return complete;
+}
+
+bool SearchIndex::indexNextPages(int generation, int pageCount)
+{
+	XOJ_CHECK_TYPE(SearchIndex);
+
+	g_mutex_lock(&this->mutex);
+	if (generation != this->generation)
+	{
+		g_mutex_unlock(&this->mutex);
+		return false;
+	}
+	bool checkCache = !this->cacheChecked;
+	this->cacheChecked = true;
+	string path = this->cachePath;
+	size_t count = this->pdfPages.size();
+	g_mutex_unlock(&this->mutex);
+
+	if (checkCache && !path.empty())
+	{
+		vector<EntryPtr> cached = loadCache(path, count);
+		if (!cached.empty())
+		{
+			g_mutex_lock(&this->mutex);
+			if (generation == this->generation)
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					if (!this->pdfEntries[i])
+					{
+						this->pdfEntries[i] = cached[i];
+						addWordsUnlocked(cached[i].get());
+					}
+				}
+				this->nextPdfPage = count;
+				this->indexedPdfPages = count;
+			}
+			g_mutex_unlock(&this->mutex);
+			return false;
+		}
+	}
+
+	for (int i = 0; i < pageCount; i++)
+	{
+		g_mutex_lock(&this->mutex);
+		if (generation != this->generation || this->nextPdfPage >= this->pdfPages.size())
+		{
+			g_mutex_unlock(&this->mutex);
+			return false;
+		}
+		size_t index = this->nextPdfPage++;
+		XojPdfPageSPtr page = this->pdfPages[index];
+		g_mutex_unlock(&this->mutex);
+
+		// Extracting the text takes the time, the index is not locked meanwhile. The page takes the lock
+		// of its PDF document, so the text is not extracted while another page of the document renders
+		vector<XojPdfRectangle> charRects;
+		string text = page->getText(charRects);
+		EntryPtr entry = createEntry(text, &charRects);
+		entry->pdfPage = index;
+
+		g_mutex_lock(&this->mutex);
+		bool current = generation == this->generation;
+		if (current)
+		{
+			this->pdfEntries[index] = entry;
+			addWordsUnlocked(entry.get());
+			this->indexedPdfPages++;
+		}
+		bool complete = current && this->indexedPdfPages == this->pdfEntries.size();
+		g_mutex_unlock(&this->mutex);
+
+		if (!current)
+		{
+			return false;
+		}
+		if (complete)
+		{
+			storeCache();
+			return false;
+		}
+	}
+
+	g_mutex_lock(&this->mutex);
+	bool more = generation == this->generation && this->nextPdfPage < this->pdfPages.size();
+	g_mutex_unlock(&this->mutex);
+
+	return more;
+}
+
+SearchIndex::EntryPtr SearchIndex::createEntry(const string& text, const vector<XojPdfRectangle>* charRects)
+{
+	EntryPtr entry = std::make_shared<Entry>();
+	u32string& normalized = entry->text;
+
+	bool inWord = false;
+	size_t charIndex = 0;
+	for (const char* c = text.c_str(); *c; c = g_utf8_next_char(c), charIndex++)
+	{
+		gunichar ch = g_utf8_get_char(c);
+		int offset = c - text.c_str();
+
+		if (g_unichar_isspace(ch))
+		{
+			inWord = false;
+			if (!normalized.empty() && normalized.back() != ' ')
+			{
+				normalized.push_back(' ');
+				entry->byteOffsets.push_back(offset);
+			}
+			continue;
+		}
+
+		normalized.push_back(g_unichar_tolower(ch));
+		entry->byteOffsets.push_back(offset);
+
+		if (!g_unichar_isalnum(ch))
+		{
+			inWord = false;
+			continue;
+		}
+
+		XojPdfRectangle rect;
+		if (charRects && charIndex < charRects->size())
+		{
+			rect = (*charRects)[charIndex];
+		}
+
+		if (!inWord)
+		{
+			entry->words.push_back({ (int) normalized.size() - 1, 0, (float) rect.x1, (float) rect.y1,
+									 (float) rect.x2, (float) rect.y2 });
+			inWord = true;
+		}
+
+		Word& w = entry->words.back();
+		w.length++;
+		w.x1 = std::min(w.x1, (float) rect.x1);
+		w.y1 = std::min(w.y1, (float) rect.y1);
+		w.x2 = std::max(w.x2, (float) rect.x2);
+		w.y2 = std::max(w.y2, (float) rect.y2);
+	}
+	entry->byteOffsets.push_back(text.size());
+
+	return entry;
+}
+
+u32string SearchIndex::normalize(const string& text)
+{
+	return createEntry(text, NULL)->text;
+}
+
+u32string SearchIndex::longestWord(const u32string& text)
+{
+	size_t bestStart = 0;
+	size_t bestLength = 0;
+
+	size_t start = 0;
+	for (size_t i = 0; i <= text.size(); i++)
+	{
+		if (i < text.size() && g_unichar_isalnum(text[i]))
+		{
+			continue;
+		}
+
+		if (i - start > bestLength)
+		{
+			bestStart = start;
+			bestLength = i - start;
+		}
+		start = i + 1;
+	}
+
+	return text.substr(bestStart, bestLength);
+}
+
+void SearchIndex::addWordsUnlocked(Entry* entry)
+{
+	XOJ_CHECK_TYPE(SearchIndex);
+
+	for (const Word& w : entry->words)
+	{
+		vector<Entry*>& list = this->words[entry->text.substr(w.start, w.length)];
+
+		// The entries are added one after the other, so a duplicate can only be the last one
+		if (list.empty() || list.back() != entry)
+		{
+			list.push_back(entry);
+		}
+	}
+}
+
+void SearchIndex::removeWordsUnlocked(Entry* entry)
+{
+	XOJ_CHECK_TYPE(SearchIndex);
+
+	for (const Word& w : entry->words)
+	{
+		auto it = this->words.find(entry->text.substr(w.start, w.length));
+		if (it == this->words.end())
+		{
+			continue;
+		}
+
+		vector<Entry*>& list = it->second;
+		list.erase(std::remove(list.begin(), list.end(), entry), list.end());
+		if (list.empty())
+		{
+			this->words.erase(it);
+		}
+	}
+}
+
+void SearchIndex::updateTexts(Document* doc, std::unordered_map<XojPage*, size_t>& pageIndex)
+{
+	XOJ_CHECK_TYPE(SearchIndex);
+
+	g_mutex_lock(&this->mutex);
+
+	// Read first, a Text changed while checking is checked again with the next search
+	int textChangeId = Text::getLastChangeId();
+	bool changed = textChangeId != this->lastTextChangeId;
+	this->lastTextChangeId = textChangeId;
+
+	// Only the changed pages are scanned for their Texts
+	for (size_t i = 0; i < doc->getPageCount(); i++)
+	{
+		PageRef page = doc->getPage(i);
+		XojPage* p = page;
+		pageIndex[p] = i;
+
+		int changeId = page->getChangeId();
+		auto it = this->pageTexts.find(p);
+		if (it != this->pageTexts.end() && it->second.changeId == changeId)
+		{
+			continue;
+		}
+
+		PageTexts& texts = this->pageTexts[p];
+		texts.changeId = changeId;
+		texts.texts.clear();
+		for (Layer* l : *page->getLayers())
+		{
+			bool visible = page->isLayerVisible(l);
+			for (Element* e : *l->getElements())
+			{
+				if (e->getType() == ELEMENT_TEXT)
+				{
+					texts.texts.push_back({ (Text*) e, visible });
+				}
+			}
+		}
+		changed = true;
+	}
+
+	// Deleted pages
+	if (this->pageTexts.size() != pageIndex.size())
+	{
+		for (auto it = this->pageTexts.begin(); it != this->pageTexts.end();)
+		{
+			if (pageIndex.count(it->first))
+			{
+				++it;
+				continue;
+			}
+			it = this->pageTexts.erase(it);
+		}
+		changed = true;
+	}
+
+	if (!changed)
+	{
+		g_mutex_unlock(&this->mutex);
+		return;
+	}
+
+	// Only the Texts whose text changed are indexed again
+	std::unordered_set<Text*> found;
+	for (auto& page : this->pageTexts)
+	{
+		for (PageText& t : page.second.texts)
+		{
+			found.insert(t.text);
+
+			EntryPtr& entry = this->textEntries[t.text];
+			if (!entry || entry->textChangeId != t.text->getChangeId())
+			{
+				if (entry)
+				{
+					removeWordsUnlocked(entry.get());
+				}
+
+				entry = createEntry(t.text->getText(), NULL);
+				entry->element = t.text;
+				entry->textChangeId = t.text->getChangeId();
+				addWordsUnlocked(entry.get());
+			}
+
+			// The Text may have been moved to another page
+			entry->page = page.first;
+			entry->visible = t.visible;
+		}
+	}
+
+	// Deleted Texts
+	for (auto it = this->textEntries.begin(); it != this->textEntries.end();)
+	{
+		if (found.count(it->first))
+		{
+			++it;
+			continue;
+		}
+
+		removeWordsUnlocked(it->second.get());
+		it = this->textEntries.erase(it);
+	}
+
+	g_mutex_unlock(&this->mutex);
+}
+
+void SearchIndex::addPdfRects(const Entry& entry, int start, int length, size_t page, vector<SearchHit>& hits)
+{
+	int end = start + length;
+
+	// The first word ending after the start
+	auto it = std::lower_bound(entry.words.begin(), entry.words.end(), start, [](const Word& w, int pos)
+	{
+		return w.start + w.length <= pos;
+	});
+
+	bool hasRect = false;
+	XojPdfRectangle line;
+
+	for (; it != entry.words.end() && it->start < end; ++it)
+	{
+		const Word& w = *it;
+
+		// Only the matched part of the word, assuming the characters have about the same width
+		double charWidth = (w.x2 - w.x1) / w.length;
+		double x1 = w.x1 + charWidth * (std::max(start, w.start) - w.start);
+		double x2 = w.x1 + charWidth * (std::min(end, w.start + w.length) - w.start);
+
+		if (hasRect && w.y1 < line.y2 && w.y2 > line.y1)
+		{
+			line.x1 = std::min(line.x1, x1);
+			line.x2 = std::max(line.x2, x2);
+			line.y1 = std::min(line.y1, (double) w.y1);
+			line.y2 = std::max(line.y2, (double) w.y2);
+			continue;
+		}
+
+		if (hasRect)
+		{
+			hits.push_back(SearchHit(page, line));
+		}
+		line = XojPdfRectangle(x1, w.y1, x2, w.y2);
+		hasRect = true;
+	}
+
+	if (hasRect)
+	{
+		hits.push_back(SearchHit(page, line));
+	}
+}
+
+vector<SearchHit> SearchIndex::search(Document* doc, string text)
+{
+	XOJ_CHECK_TYPE(SearchIndex);
+
+	vector<SearchHit> hits;
+
+	u32string query = normalize(text);
+	if (query.empty())
+	{
+		return hits;
+	}
+	u32string anchor = longestWord(query);
+
+	doc->lock();
+
+	std::unordered_map<XojPage*, size_t> pageIndex;
+	updateTexts(doc, pageIndex);
+
+	g_mutex_lock(&this->mutex);
+
+	// Only entries containing the longest word can contain the whole text
+	std::unordered_set<Entry*> candidates;
+	for (auto& w : this->words)
+	{
+		if (anchor.empty() || w.first.find(anchor) != u32string::npos)
+		{
+			candidates.insert(w.second.begin(), w.second.end());
+		}
+	}
+
+	vector<XojPdfPageSPtr> notIndexed(doc->getPageCount());
+
+	for (size_t i = 0; i < doc->getPageCount(); i++)
+	{
+		size_t pdfPage = doc->getPage(i)->getPdfPageNr();
+		if (pdfPage >= this->pdfEntries.size())
+		{
+			continue;
+		}
+
+		Entry* entry = this->pdfEntries[pdfPage].get();
+		if (entry == NULL)
+		{
+			notIndexed[i] = this->pdfPages[pdfPage];
+			continue;
+		}
+
+		if (candidates.count(entry) == 0)
+		{
+			continue;
+		}
+
+		for (size_t pos = entry->text.find(query); pos != u32string::npos; pos = entry->text.find(query, pos + 1))
+		{
+			addPdfRects(*entry, pos, query.size(), i, hits);
+		}
+	}
+
+	// Texts: the matches as byte ranges, the rectangles need Pango, which is not done with the lock
+	vector<std::pair<Entry*, vector<std::pair<int, int>>>> textMatches;
+	for (Entry* entry : candidates)
+	{
+		if (entry->element == NULL || !entry->visible)
+		{
+			continue;
+		}
+
+		vector<std::pair<int, int>> ranges;
+		for (size_t pos = entry->text.find(query); pos != u32string::npos; pos = entry->text.find(query, pos + 1))
+		{
+			ranges.push_back(std::make_pair(entry->byteOffsets[pos], entry->byteOffsets[pos + query.size()]));
+		}
+
+		if (!ranges.empty())
+		{
+			textMatches.push_back(std::make_pair(entry, ranges));
+		}
+	}
+
+	g_mutex_unlock(&this->mutex);
+
+	// The Text entries are only changed by updateTexts, on this thread
+	for (auto& match : textMatches)
+	{
+		size_t page = pageIndex[match.first->page];
+		for (XojPdfRectangle& rect : TextView::getTextRectangles(match.first->element, match.second))
+		{
+			hits.push_back(SearchHit(page, rect));
+		}
+	}
+
+	doc->unlock();
+
+	// Until the index is complete
+	for (size_t i = 0; i < notIndexed.size(); i++)
+	{
+		if (notIndexed[i])
+		{
+			for (XojPdfRectangle& rect : notIndexed[i]->findText(text))
+			{
+				hits.push_back(SearchHit(i, rect));
+			}
+		}
+	}
+
+	std::stable_sort(hits.begin(), hits.end(), [](const SearchHit& a, const SearchHit& b)
+	{
+		return a.page < b.page;
+	});
+
+	return hits;
+}
+
+string SearchIndex::cacheFile(Path pdfFile)
+{
+	GStatBuf attrib;
+	if (pdfFile.isEmpty() || g_stat(pdfFile.c_str(), &attrib) != 0)
+	{
+		return "";
+	}
+
+	// A changed PDF file gets a new cache file, the old one is removed as least recently used
+	string key = pdfFile.str() + "\n" + std::to_string(attrib.st_size) + "\n" + std::to_string(attrib.st_mtime);
+	gchar* hash = g_compute_checksum_for_string(G_CHECKSUM_SHA1, key.c_str(), -1);
+
+	Path path = Util::getConfigSubfolder("searchindex");
+	path /= string(hash) + ".index";
+	g_free(hash);
+
+	return path.str();
+}
+
+/**
+ * Cache file layout, in host byte order:
+ * header line, page count, then for each page: UTF-8 length, UTF-8 normalized text, word count, words
+ */
+static const char CACHE_HEADER[] = "XOJ-SEARCHINDEX/1.0\n";
+
+vector<SearchIndex::EntryPtr> SearchIndex::loadCache(const string& path, size_t pageCount)
+{
+	vector<EntryPtr> entries;
+
+	std::ifstream in(path.c_str(), std::ios::binary | std::ios::ate);
+	if (!in)
+	{
+		return entries;
+	}
+
+	// The lengths read from the file are checked against the bytes left, a damaged file is not used
+	guint64 remaining = in.tellg();
+	in.seekg(0);
+
+	char header[sizeof(CACHE_HEADER) - 1];
+	guint32 count = 0;
+	in.read(header, sizeof(header));
+	in.read((char*) &count, sizeof(count));
+	if (!in || string(header, sizeof(header)) != CACHE_HEADER || count != pageCount)
+	{
+		return entries;
+	}
+	remaining -= sizeof(header) + sizeof(count);
+
+	for (guint32 i = 0; i < count; i++)
+	{
+		EntryPtr entry = std::make_shared<Entry>();
+		entry->pdfPage = i;
+
+		guint32 length = 0;
+		in.read((char*) &length, sizeof(length));
+		if (!in || length > remaining - sizeof(length))
+		{
+			g_warning("Search index cache file \"%s\" is damaged", path.c_str());
+			return vector<EntryPtr>();
+		}
+		remaining -= sizeof(length);
+
+		string utf8(length, '\0');
+		in.read(&utf8[0], utf8.size());
+		remaining -= length;
+
+		guint32 wordCount = 0;
+		in.read((char*) &wordCount, sizeof(wordCount));
+		if (!in || remaining < sizeof(wordCount) || wordCount > (remaining - sizeof(wordCount)) / sizeof(Word) ||
+			!g_utf8_validate(utf8.c_str(), utf8.size(), NULL))
+		{
+			g_warning("Search index cache file \"%s\" is damaged", path.c_str());
+			return vector<EntryPtr>();
+		}
+		remaining -= sizeof(wordCount) + (guint64) wordCount * sizeof(Word);
+
+		entry->words.resize(wordCount);
+		in.read((char*) entry->words.data(), entry->words.size() * sizeof(Word));
+
+		glong chars = 0;
+		gunichar* ucs4 = g_utf8_to_ucs4_fast(utf8.c_str(), utf8.size(), &chars);
+		entry->text.assign((const char32_t*) ucs4, chars);
+		g_free(ucs4);
+
+		for (const Word& w : entry->words)
+		{
+			if (!in || w.start < 0 || w.length <= 0 || w.start > chars - w.length)
+			{
+				g_warning("Search index cache file \"%s\" is damaged", path.c_str());
+				return vector<EntryPtr>();
+			}
+		}
+
+		entries.push_back(entry);
+	}
+
+	// Mark as recently used
+	g_utime(path.c_str(), NULL);
+
+	return entries;
+}
+
+void SearchIndex::storeCache()
+{
+	XOJ_CHECK_TYPE(SearchIndex);
+
+	// The entries are never changed once indexed, so they can be written without the lock
+	g_mutex_lock(&this->mutex);
+	vector<EntryPtr> entries = this->pdfEntries;
+	string path = this->cachePath;
+	g_mutex_unlock(&this->mutex);
+
+	if (path.empty() || std::find(entries.begin(), entries.end(), nullptr) != entries.end())
+	{
+		return;
+	}
+
+	string tmpPath = path + ".tmp";
+	std::ofstream out(tmpPath.c_str(), std::ios::binary);
+
+	guint32 count = entries.size();
+	out.write(CACHE_HEADER, sizeof(CACHE_HEADER) - 1);
+	out.write((const char*) &count, sizeof(count));
+
+	for (EntryPtr& entry : entries)
+	{
+		glong length = 0;
+		gchar* utf8 = g_ucs4_to_utf8((const gunichar*) entry->text.data(), entry->text.size(), NULL, &length, NULL);
+		guint32 utf8Length = utf8 ? length : 0;
+		out.write((const char*) &utf8Length, sizeof(utf8Length));
+		out.write(utf8 ? utf8 : "", utf8Length);
+		g_free(utf8);
+
+		guint32 wordCount = entry->words.size();
+		out.write((const char*) &wordCount, sizeof(wordCount));
+		out.write((const char*) entry->words.data(), entry->words.size() * sizeof(Word));
+	}
+
+	out.close();
+	if (!out || g_rename(tmpPath.c_str(), path.c_str()) != 0)
+	{
+		g_warning("Could not write search index cache file \"%s\"", path.c_str());
+		g_unlink(tmpPath.c_str());
+		return;
+	}
+
+	pruneCache(Path(path).getParentPath().str());
+}
+
+void SearchIndex::pruneCache(const string& folder)
+{
+	GDir* dir = g_dir_open(folder.c_str(), 0, NULL);
+	if (dir == NULL)
+	{
+		return;
+	}
+
+	vector<std::pair<gint64, string>> files;
+	const gchar* name;
+	while ((name = g_dir_read_name(dir)) != NULL)
+	{
+		string path = folder + G_DIR_SEPARATOR_S + name;
+		GStatBuf attrib;
+		if (g_str_has_suffix(name, ".index") && g_stat(path.c_str(), &attrib) == 0)
+		{
+			files.push_back(std::make_pair((gint64) attrib.st_mtime, path));
+		}
+	}
+	g_dir_close(dir);
+
+	if (files.size() <= (size_t) CACHE_FILES)
+	{
+		return;
+	}
+
+	std::sort(files.begin(), files.end());
+	for (size_t i = 0; i < files.size() - CACHE_FILES; i++)
+	{
+		g_unlink(files[i].second.c_str());
+	}
+}
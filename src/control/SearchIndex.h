@@ -0,0 +1,265 @@
+/*
+ * Xournal++
+ *
+ * Full-text index of the PDF pages and Texts of a document
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include "pdf/base/XojPdfPage.h"
+
+#include <Path.h>
+#include <XournalType.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Document;
+class Text;
+class XojPage;
+
+/**
+ * A hit of a search, page is the index of the page in the document
+ */
+class SearchHit
+{
+public:
+	SearchHit(size_t page, XojPdfRectangle rect);
+
+public:
+	size_t page;
+	XojPdfRectangle rect;
+};
+
+/**
+ * Inverted index of all words of the PDF pages and of the Text elements, for searching the whole
+ * document at once.
+ *
+ * The text of the PDF pages is extracted by low priority SearchIndexJob%s and cached on disk,
+ * keyed by the PDF file, so opening the document again does not extract the text again. PDF pages
+ * not indexed yet are searched directly with the PDF page.
+ *
+ * Texts are indexed on the UI thread with each search. Only the pages changed since the last search
+ * (PageHandler::getChangeId) are scanned for Texts again, and only Texts whose text changed
+ * (Text::getChangeId) are indexed again. A search without changes does not look at the elements.
+ *
+ * The search is case insensitive and finds the text anywhere, also inside of words; whitespace
+ * matches any whitespace. The index is used to find the PDF pages and Texts containing the
+ * longest word of the searched text, only those are searched for the whole text.
+ */
+class SearchIndex
+{
+public:
+	SearchIndex();
+	virtual ~SearchIndex();
+
+private:
+	SearchIndex(const SearchIndex& index);
+	void operator=(const SearchIndex& index);
+
+public:
+	/**
+	 * Drops the index and starts indexing the PDF of the document. The document has to be locked.
+	 * Jobs of the previous document do not change the index anymore.
+	 */
+	void setDocument(Document* doc);
+
+	/**
+	 * Indexes the next PDF pages, called by SearchIndexJob
+	 *
+	 * @param generation The value of getGeneration() when the job was created
+	 * @param pageCount Count of pages to index
+	 * @return true if there are more pages to index
+	 */
+	bool indexNextPages(int generation, int pageCount);
+
+	/**
+	 * Changes each time setDocument() is called
+	 */
+	int getGeneration();
+
+	/**
+	 * @return true if all PDF pages are indexed
+	 */
+	bool isComplete();
+
+	/**
+	 * Searches the whole document, has to be called from the UI thread
+	 *
+	 * @return All hits, sorted by page
+	 */
+	std::vector<SearchHit> search(Document* doc, string text);
+
+private:
+	/**
+	 * A word of an indexed text, as range in the normalized text
+	 */
+	struct Word
+	{
+		int start;
+		int length;
+
+		/**
+		 * The bounding box of the word, only for PDF pages
+		 */
+		float x1;
+		float y1;
+		float x2;
+		float y2;
+	};
+
+	/**
+	 * An indexed PDF page or Text
+	 */
+	struct Entry
+	{
+		/**
+		 * Lower case text, whitespace collapsed to a single space
+		 */
+		std::u32string text;
+
+		std::vector<Word> words;
+
+		/**
+		 * The PDF page index, or -1 for a Text
+		 */
+		int pdfPage = -1;
+
+		/**
+		 * For Texts: the Text, the change id of the indexed text, its page and if its layer is visible
+		 */
+		Text* element = NULL;
+		int textChangeId = 0;
+		XojPage* page = NULL;
+		bool visible = false;
+
+		/**
+		 * For Texts: the byte offset in the original text of each character of text, and of its end
+		 */
+		std::vector<int> byteOffsets;
+	};
+
+	typedef std::shared_ptr<Entry> EntryPtr;
+
+private:
+	/**
+	 * Builds an entry from a text, with the bounding boxes of its characters (PDF) or without (Text)
+	 */
+	static EntryPtr createEntry(const string& text, const std::vector<XojPdfRectangle>* charRects);
+
+	/**
+	 * Lower case, whitespace collapsed
+	 */
+	static std::u32string normalize(const string& text);
+
+	/**
+	 * The longest word of the normalized text
+	 */
+	static std::u32string longestWord(const std::u32string& text);
+
+	/**
+	 * Rectangles of the range of the PDF entry, one per line
+	 */
+	static void addPdfRects(const Entry& entry, int start, int length, size_t page, std::vector<SearchHit>& hits);
+
+	void addWordsUnlocked(Entry* entry);
+	void removeWordsUnlocked(Entry* entry);
+
+	/**
+	 * Reindexes the changed Texts and removes the deleted ones, the document has to be locked
+	 *
+	 * @param pageIndex Returns the index of each page in the document
+	 */
+	void updateTexts(Document* doc, std::unordered_map<XojPage*, size_t>& pageIndex);
+
+	/**
+	 * Path of the index in the disk cache, empty if the PDF is not a file
+	 */
+	static string cacheFile(Path pdfFile);
+
+	/**
+	 * @return The PDF pages of the cache file, empty if there is no valid cache file
+	 */
+	static std::vector<EntryPtr> loadCache(const string& path, size_t pageCount);
+	void storeCache();
+
+	/**
+	 * Only the most recently used cache files are kept
+	 */
+	static void pruneCache(const string& folder);
+
+private:
+	XOJ_TYPE_ATTRIB;
+
+	/**
+	 * Protects all members, the index is read on the UI thread and written by the jobs
+	 */
+	GMutex mutex;
+
+	int generation = 0;
+
+	std::vector<XojPdfPageSPtr> pdfPages;
+
+	/**
+	 * Indexed PDF pages, NULL if not indexed yet
+	 */
+	std::vector<EntryPtr> pdfEntries;
+
+	/**
+	 * The next PDF page to index
+	 */
+	size_t nextPdfPage = 0;
+
+	size_t indexedPdfPages = 0;
+
+	std::unordered_map<Text*, EntryPtr> textEntries;
+
+	/**
+	 * A Text of a page, and if its layer is visible
+	 */
+	struct PageText
+	{
+		Text* text;
+		bool visible;
+	};
+
+	/**
+	 * The Texts of each page, as found when the page had the change id
+	 */
+	struct PageTexts
+	{
+		int changeId = 0;
+		std::vector<PageText> texts;
+	};
+
+	std::unordered_map<XojPage*, PageTexts> pageTexts;
+
+	/**
+	 * Text::getLastChangeId() when the Texts were checked the last time
+	 */
+	int lastTextChangeId = 0;
+
+	/**
+	 * All entries containing a word, the key is the lower case word
+	 */
+	std::unordered_map<std::u32string, std::vector<Entry*>> words;
+
+	string cachePath;
+
+	/**
+	 * The disk cache is read by the first job of a document
+	 */
+	bool cacheChecked = false;
+
+	/**
+	 * Count of index files kept in the disk cache
+	 */
+	static const int CACHE_FILES = 20;
+};
@@ -0,0 +1,218 @@
+#include "ThumbnailCache.h"
+
+#include "model/Document.h"
+#include "model/Layer.h"
+
+#include <serializing/BinObjectEncoding.h>
+#include <serializing/ObjectOutputStream.h>
+#include <Util.h>
+
+#include <glib/gstdio.h>
+
+#include <algorithm>
+
+ThumbnailCache::ThumbnailCache()
+{
+	XOJ_INIT_TYPE(ThumbnailCache);
+
+	g_mutex_init(&this->mutex);
+	this->folder = Util::getCacheSubfolder("thumbnails").str();
+}
+
+ThumbnailCache::~ThumbnailCache()
+{
+	XOJ_CHECK_TYPE(ThumbnailCache);
+
+	g_mutex_clear(&this->mutex);
+
+	XOJ_RELEASE_TYPE(ThumbnailCache);
+}
+
+string ThumbnailCache::pageKey(Document* doc, PageRef page, int width, int height)
+{
+	XOJ_CHECK_TYPE(ThumbnailCache);
+
+	XojPage* p = page;
+	int changeId = page->getChangeId();
+	string hash;
+
+	g_mutex_lock(&this->mutex);
+	auto it = this->contentHashes.find(p);
+	if (it != this->contentHashes.end() && it->second.first == changeId)
+	{
+		hash = it->second.second;
+	}
+	g_mutex_unlock(&this->mutex);
+
+	if (hash.empty())
+	{
+		hash = contentHash(doc, page);
+
+		g_mutex_lock(&this->mutex);
+		if (this->contentHashes.size() >= MAX_CONTENT_HASHES)
+		{
+			this->contentHashes.clear();
+		}
+		this->contentHashes[p] = std::make_pair(changeId, hash);
+		g_mutex_unlock(&this->mutex);
+	}
+
+	return hash + "-" + std::to_string(width) + "x" + std::to_string(height);
+}
+
+string ThumbnailCache::contentHash(Document* doc, PageRef page)
+{
+	// Everything DocumentView draws, in the binary clipboard format
+	ObjectOutputStream out(new BinObjectEncoding());
+
+	out.writeDouble(page->getWidth());
+	out.writeDouble(page->getHeight());
+
+	PageType type = page->getBackgroundType();
+	out.writeInt((int) type.format);
+	out.writeString(type.config);
+	out.writeInt(page->getBackgroundColor());
+
+	if (type.isPdfPage())
+	{
+		Path pdf = doc->getPdfFilename();
+		out.writeString(pdf.str());
+		out.writeSizeT(page->getPdfPageNr());
+
+		GStatBuf attrib;
+		if (!pdf.isEmpty() && g_stat(pdf.c_str(), &attrib) == 0)
+		{
+			out.writeSizeT(attrib.st_size);
+			out.writeSizeT(attrib.st_mtime);
+		}
+	}
+	else if (type.isImagePage())
+	{
+		// Attached images are named relative to the document
+		out.writeString(doc->getFilename().str());
+		out.writeString(page->getBackgroundImage().getFilename());
+	}
+
+	out.writeInt(page->isLayerVisible(0));
+
+	int layerId = 1;
+	for (Layer* layer : *page->getLayers())
+	{
+		bool visible = page->isLayerVisible(layerId++);
+		out.writeInt(visible);
+		if (!visible)
+		{
+			continue;
+		}
+
+		for (Element* e : *layer->getElements())
+		{
+			e->serialize(out);
+		}
+	}
+
+	GString* data = out.getStr();
+	gchar* hash = g_compute_checksum_for_data(G_CHECKSUM_SHA1, (const guchar*) data->str, data->len);
+	g_string_free(data, true);
+
+	string key = hash;
+	g_free(hash);
+
+	return key;
+}
+
+string ThumbnailCache::fileOf(const string& key)
+{
+	XOJ_CHECK_TYPE(ThumbnailCache);
+
+	return this->folder + G_DIR_SEPARATOR_S + key + ".png";
+}
+
+cairo_surface_t* ThumbnailCache::load(const string& key)
+{
+	XOJ_CHECK_TYPE(ThumbnailCache);
+
+	string path = fileOf(key);
+	if (!g_file_test(path.c_str(), G_FILE_TEST_EXISTS))
+	{
+		return NULL;
+	}
+
+	cairo_surface_t* surface = cairo_image_surface_create_from_png(path.c_str());
+	if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
+	{
+		g_warning("Could not read thumbnail \"%s\"", path.c_str());
+		cairo_surface_destroy(surface);
+		g_unlink(path.c_str());
+		return NULL;
+	}
+
+	// Mark as recently used
+	g_utime(path.c_str(), NULL);
+
+	return surface;
+}
+
+void ThumbnailCache::store(const string& key, cairo_surface_t* surface)
+{
+	XOJ_CHECK_TYPE(ThumbnailCache);
+
+	string path = fileOf(key);
+
+	// The thread id keeps two jobs storing the same page from writing the same temporary file
+	string tmpPath = path + "." + std::to_string((gsize) g_thread_self()) + ".tmp";
+
+	if (cairo_surface_write_to_png(surface, tmpPath.c_str()) != CAIRO_STATUS_SUCCESS ||
+		g_rename(tmpPath.c_str(), path.c_str()) != 0)
+	{
+		g_warning("Could not write thumbnail \"%s\"", path.c_str());
+		g_unlink(tmpPath.c_str());
+		return;
+	}
+
+	g_mutex_lock(&this->mutex);
+	bool doPrune = ++this->storedSincePrune >= PRUNE_INTERVAL;
+	if (doPrune)
+	{
+		this->storedSincePrune = 0;
+	}
+	g_mutex_unlock(&this->mutex);
+
+	if (doPrune)
+	{
+		prune();
+	}
+}
+
+void ThumbnailCache::prune()
+{
+	XOJ_CHECK_TYPE(ThumbnailCache);
+
+	GDir* dir = g_dir_open(this->folder.c_str(), 0, NULL);
+	if (dir == NULL)
+	{
+		return;
+	}
+
+	vector<std::pair<gint64, std::pair<string, gint64>>> files;
+	gint64 total = 0;
+	const gchar* name;
+	while ((name = g_dir_read_name(dir)) != NULL)
+	{
+		string path = this->folder + G_DIR_SEPARATOR_S + name;
+		GStatBuf attrib;
+		if (g_str_has_suffix(name, ".png") && g_stat(path.c_str(), &attrib) == 0)
+		{
+			files.push_back(std::make_pair((gint64) attrib.st_mtime, std::make_pair(path, (gint64) attrib.st_size)));
+			total += attrib.st_size;
+		}
+	}
+	g_dir_close(dir);
+
+	std::sort(files.begin(), files.end());
+	for (size_t i = 0; i < files.size() && total > CACHE_BYTES; i++)
+	{
+		g_unlink(files[i].second.first.c_str());
+		total -= files[i].second.second;
+	}
+}
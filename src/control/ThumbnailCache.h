@@ -0,0 +1,100 @@
+/*
+ * Xournal++
+ *
+ * Disk cache of the rendered page previews of the sidebar
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include "model/PageRef.h"
+
+#include <XournalType.h>
+
+#include <gtk/gtk.h>
+
+#include <unordered_map>
+
+class Document;
+
+/**
+ * Rendered previews stored as PNG files in ~/.cache/xournalpp/thumbnails, keyed by a hash of everything
+ * drawn on the page. A page which was not changed since it was rendered the last time, also in
+ * an earlier session, is loaded from the disk instead of being rendered again.
+ *
+ * The hash of a page is computed once per change of the page (see PageHandler::getChangeId),
+ * not on each lookup.
+ *
+ * The files are used by the preview jobs, so all methods can be called from any thread.
+ */
+class ThumbnailCache
+{
+public:
+	ThumbnailCache();
+	virtual ~ThumbnailCache();
+
+private:
+	ThumbnailCache(const ThumbnailCache& cache);
+	void operator=(const ThumbnailCache& cache);
+
+public:
+	/**
+	 * The key of the preview of a page, the document has to be locked
+	 *
+	 * @param width The width of the preview in pixel
+	 * @param height The height of the preview in pixel
+	 */
+	string pageKey(Document* doc, PageRef page, int width, int height);
+
+	/**
+	 * @return The cached preview, a new reference, or NULL if there is none
+	 */
+	cairo_surface_t* load(const string& key);
+
+	void store(const string& key, cairo_surface_t* surface);
+
+private:
+	/**
+	 * Hash of everything drawn on the page, the document has to be locked
+	 */
+	static string contentHash(Document* doc, PageRef page);
+
+	string fileOf(const string& key);
+
+	/**
+	 * Removes the least recently used files, until the cache fits in CACHE_BYTES
+	 */
+	void prune();
+
+private:
+	XOJ_TYPE_ATTRIB;
+
+	string folder;
+
+	/**
+	 * Protects storedSincePrune and contentHashes, the files themselves are replaced atomically
+	 */
+	GMutex mutex;
+
+	/**
+	 * The last content hash of each page, with the change id of the page it was computed for
+	 */
+	std::unordered_map<XojPage*, std::pair<int, string>> contentHashes;
+
+	/**
+	 * The folder is checked after each PRUNE_INTERVAL stored files, not on each file
+	 */
+	int storedSincePrune = 0;
+
+	/**
+	 * The hashes of deleted pages are not removed, they are all dropped if there are more
+	 */
+	static const size_t MAX_CONTENT_HASHES = 10000;
+
+	static const int PRUNE_INTERVAL = 50;
+	static const gint64 CACHE_BYTES = 64 * 1024 * 1024;
+};
@@ -1,5 +1,6 @@
 #include "XournalMain.h"
 
+#include "BatchExport.h"
 #include "Control.h"
 
 #include "control/jobs/ImageExport.h"
@@ -210,7 +211,7 @@ void XournalMain::checkForEmergencySave(Control* control) {
 	gtk_widget_destroy(dialog);
 }
 
-int XournalMain::exportImg(const char* input, const char* output)
+int XournalMain::exportImg(const char* input, const char* output, int threadCount)
 {
 	XOJ_CHECK_TYPE(XournalMain);
 
@@ -242,6 +243,7 @@ int XournalMain::exportImg(const char* input, const char* output)
 	DummyProgressListener progress;
 
 	ImageExport imgExport(doc, path, format, false, exportRange);
+	imgExport.setThreadCount(threadCount);
 	imgExport.exportGraphics(&progress);
 
 	for (PageRangeEntry* e : exportRange)
@@ -309,15 +311,22 @@ int XournalMain::run(int argc, char* argv[])
 	gchar** optFilename = NULL;
 	gchar* pdfFilename = NULL;
 	gchar* imgFilename = NULL;
+	gchar* batchFilename = NULL;
+	int exportThreads = 0;
 	int openAtPageNumber = -1;
 
 	string create_pdf = _("PDF output filename");
 	string create_img = _("Image output filename (.png / .svg)");
+	string export_batch = _("Export a list of documents, one line per document with the input and the output filename "
+	                        "separated by a tab, - to read the list from stdin");
+	string export_threads = _("Threads rendering the pages of an image export (default: all processors)");
 	string page_jump = _("Jump to Page (first Page: 1)");
 	string audio_folder = _("Absolute path for the audio files playback");
 	GOptionEntry options[] = {
 		{ "create-pdf",      'p', 0, G_OPTION_ARG_FILENAME,       &pdfFilename,      create_pdf.c_str(), NULL },
 		{ "create-img",      'i', 0, G_OPTION_ARG_FILENAME,       &imgFilename,      create_img.c_str(), NULL },
+		{ "export-batch",    'b', 0, G_OPTION_ARG_FILENAME,       &batchFilename,    export_batch.c_str(), "LIST" },
+		{ "export-threads",  0,   0, G_OPTION_ARG_INT,            &exportThreads,    export_threads.c_str(), "N" },
 		{ "page",            'n', 0, G_OPTION_ARG_INT,            &openAtPageNumber, page_jump.c_str(), "N" },
 		{G_OPTION_REMAINING,   0, 0, G_OPTION_ARG_FILENAME_ARRAY, &optFilename,      "<input>", NULL },
 		{NULL}
@@ -343,7 +352,13 @@ int XournalMain::run(int argc, char* argv[])
 	}
 	if (imgFilename && optFilename && *optFilename)
 	{
-		return exportImg(*optFilename, imgFilename);
+		return exportImg(*optFilename, imgFilename, exportThreads);
+	}
+	if (batchFilename)
+	{
+		BatchExport batch;
+		batch.setThreadCount(exportThreads);
+		return batch.exportList(batchFilename);
 	}
 
 	// Checks for input method compatibility
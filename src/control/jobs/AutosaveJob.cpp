@@ -1,7 +1,7 @@
 #include "AutosaveJob.h"
 
 #include "control/Control.h"
-#include "control/xojfile/SaveHandler.h"
+#include "control/xojfile/AutosaveHandler.h"
 
 #include <i18n.h>
 #include <Path.h>
@@ -31,17 +31,18 @@ void AutosaveJob::run()
 {
 	XOJ_CHECK_TYPE(AutosaveJob);
 
-	SaveHandler handler;
-
-	control->getUndoRedoHandler()->documentAutosaved();
+	AutosaveHandler* handler = control->getAutosaveHandler();
 
 	Document* doc = control->getDocument();
 
+	// Only the pages changed since the last autosave are copied while the document is locked
 	doc->lock();
-	handler.prepareSave(doc);
+	handler->takeSnapshot(doc);
 	Path filename = doc->getFilename();
 	doc->unlock();
 
+	handler->prepareAutosave();
+
 	if (filename.isEmpty())
 	{
 		filename = Util::getAutosaveFilename();
@@ -59,9 +60,9 @@ void AutosaveJob::run()
 
 	g_message("%s", FS(_F("Autosaving to {1}") % filename.str()).c_str());
 
-	handler.saveTo(filename);
+	handler->saveAutosaveTo(filename);
 
-	this->error = handler.getErrorMessage();
+	this->error = handler->getErrorMessage();
 	if (!this->error.empty())
 	{
 		callAfterRun();
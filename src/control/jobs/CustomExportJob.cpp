@@ -148,15 +148,19 @@ void CustomExportJob::run()
 
 	if (exportTypeXoj)
 	{
-		SaveJob::updatePreview(control);
 		Document* doc = this->control->getDocument();
 
-		XojExportHandler h;
 		doc->lock();
-		h.prepareSave(doc);
-		h.saveTo(filename, this->control);
+		Document* snapshot = doc->createSnapshot();
 		doc->unlock();
 
+		SaveJob::updatePreview(snapshot);
+
+		XojExportHandler h;
+		h.prepareSave(snapshot);
+		h.saveTo(filename, this->control);
+		delete snapshot;
+
 		if (!h.getErrorMessage().empty())
 		{
 			this->lastError = FS(_F("Save file error: {1}") % h.getErrorMessage());
@@ -166,11 +170,14 @@ void CustomExportJob::run()
 	}
 	else if (format == EXPORT_GRAPHICS_PDF)
 	{
-		// don't lock the page here for the whole flow, else we get a dead lock...
-		// the ui is blocked, so there should be no changes...
+		// Export a snapshot, so the document is only locked while copying the pages
 		Document* doc = control->getDocument();
 
-		XojPdfExport* pdfe = XojPdfExportFactory::createExport(doc, control);
+		doc->lock();
+		Document* snapshot = doc->createSnapshot();
+		doc->unlock();
+
+		XojPdfExport* pdfe = XojPdfExportFactory::createExport(snapshot, control);
 
 		pdfe->setNoBackgroundExport(filters[this->chosenFilterName]->withoutBackground);
 		
@@ -180,6 +187,7 @@ void CustomExportJob::run()
 		}
 
 		delete pdfe;
+		delete snapshot;
 	}
 	else
 	{
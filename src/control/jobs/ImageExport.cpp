@@ -7,6 +7,10 @@
 #include <cairo-svg.h>
 #include <i18n.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 
 ImageExport::ImageExport(Document* doc, Path filename, ExportGraphicsFormat format, bool hideBackground, PageRangeVector& exportRange)
  : doc(doc),
@@ -35,6 +39,16 @@ void ImageExport::setPngDpi(int dpi)
 	this->pngDpi = dpi;
 }
 
+/**
+ * Number of threads rendering pages, 0 to use all processors
+ */
+void ImageExport::setThreadCount(int threadCount)
+{
+	XOJ_CHECK_TYPE(ImageExport);
+
+	this->threadCount = threadCount;
+}
+
 /**
  * @return the last error message to show to the user
  */
@@ -45,50 +59,67 @@ string ImageExport::getLastErrorMsg()
 	return lastError;
 }
 
+void ImageExport::setLastError(const string& error)
+{
+	XOJ_CHECK_TYPE(ImageExport);
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->lastError = error;
+}
+
+vector<double> ImageExport::getPageTimes()
+{
+	XOJ_CHECK_TYPE(ImageExport);
+
+	return this->pageTimes;
+}
+
 /**
  * Create surface
  */
-void ImageExport::createSurface(double width, double height, int id)
+cairo_surface_t* ImageExport::createSurface(double width, double height, int id)
 {
 	XOJ_CHECK_TYPE(ImageExport);
 
 	if (format == EXPORT_GRAPHICS_PNG)
 	{
-		this->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
-												   width * this->pngDpi / 72.0,
-												   height * this->pngDpi / 72.0);
-		this->cr = cairo_create(this->surface);
-		double factor = this->pngDpi / 72.0;
-		cairo_scale(this->cr, factor, factor);
+		return cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+										  width * this->pngDpi / 72.0,
+										  height * this->pngDpi / 72.0);
 	}
 	else if (format == EXPORT_GRAPHICS_SVG)
 	{
 		string filepath = getFilenameWithNumber(id);
-		this->surface = cairo_svg_surface_create(filepath.c_str(), width, height);
-		cairo_svg_surface_restrict_to_version(this->surface, CAIRO_SVG_VERSION_1_2);
-		this->cr = cairo_create(this->surface);
+		cairo_surface_t* surface = cairo_svg_surface_create(filepath.c_str(), width, height);
+		cairo_svg_surface_restrict_to_version(surface, CAIRO_SVG_VERSION_1_2);
+		return surface;
 	}
 	else
 	{
 		g_error("Unsupported graphics format: %i", format);
+		return NULL;
 	}
 }
 
 /**
  * Free / store the surface
  */
-bool ImageExport::freeSurface(int id)
+bool ImageExport::freeSurface(cairo_surface_t* surface, int id)
 {
 	XOJ_CHECK_TYPE(ImageExport);
 
-	cairo_destroy(this->cr);
-
 	cairo_status_t status = CAIRO_STATUS_SUCCESS;
 	if (format == EXPORT_GRAPHICS_PNG)
 	{
 		string filepath = getFilenameWithNumber(id);
 		status = cairo_surface_write_to_png(surface, filepath.c_str());
 	}
+	else
+	{
+		// Writes the SVG file
+		cairo_surface_finish(surface);
+		status = cairo_surface_status(surface);
+	}
 	cairo_surface_destroy(surface);
 
 	// we ignore this problem
@@ -127,43 +158,58 @@ string ImageExport::getFilenameWithNumber(int no)
 /**
  * Export a single PNG page
  */
-void ImageExport::exportImagePage(int pageId, int id, double zoom, ExportGraphicsFormat format, DocumentView& view)
+void ImageExport::exportImagePage(int pageId, int id, double zoom, DocumentView& view)
 {
 	XOJ_CHECK_TYPE(ImageExport);
 
 	doc->lock();
 	PageRef page = doc->getPage(pageId);
+	XojPdfPageSPtr popplerPage;
+	if (page->getBackgroundType().isPdfPage())
+	{
+		popplerPage = doc->getPdfPage(page->getPdfPageNr());
+	}
 	doc->unlock();
 
-	createSurface(page->getWidth(), page->getHeight(), id);
+	cairo_surface_t* surface = createSurface(page->getWidth(), page->getHeight(), id);
 
-	cairo_status_t state = cairo_surface_status(this->surface);
+	cairo_status_t state = cairo_surface_status(surface);
 	if (state != CAIRO_STATUS_SUCCESS)
 	{
-		this->lastError = _("Error save image #1");
+		cairo_surface_destroy(surface);
+		setLastError(_("Error save image #1"));
 		return;
 	}
 
-	if (page->getBackgroundType().isPdfPage())
+	cairo_t* cr = cairo_create(surface);
+	if (format == EXPORT_GRAPHICS_PNG)
 	{
-		int pgNo = page->getPdfPageNr();
-		XojPdfPageSPtr popplerPage = doc->getPdfPage(pgNo);
+		cairo_scale(cr, zoom, zoom);
+	}
 
+	if (page->getBackgroundType().isPdfPage())
+	{
+		// All threads share the PopplerDocument, the render takes its lock (see PopplerGlibDocument::getLock),
+		// so the PDF backgrounds are rendered one after the other while the layers are drawn in parallel
 		PdfView::drawPage(NULL, popplerPage, cr, zoom, page->getWidth(), page->getHeight());
 	}
 
-	view.drawPage(page, this->cr, true, hideBackground);
+	view.drawPage(page, cr, true, hideBackground);
+	cairo_destroy(cr);
 
-	if (!freeSurface(id))
+	if (!freeSurface(surface, id))
 	{
 		// could not create this file...
-		this->lastError = _("Error save image #2");
+		setLastError(_("Error save image #2"));
 		return;
 	}
 }
 
 /**
  * Create one Graphics file per page
+ *
+ * The pages are rendered by a pool of threads, each thread renders and writes one page after the other.
+ * Only the PDF background render is serialized, by the lock of the PDF document.
  */
 void ImageExport::exportGraphics(ProgressListener* stateListener)
 {
@@ -175,41 +221,79 @@ void ImageExport::exportGraphics(ProgressListener* stateListener)
 
 	bool onePage = ((this->exportRange.size() == 1) && (this->exportRange[0]->getFirst() == this->exportRange[0]->getLast()));
 
-	char selectedPages[count];
-	int selectedCount = 0;
-	for (int i = 0; i < count; i++)
-	{
-		selectedPages[i] = 0;
-	}
+	vector<bool> selectedPages(count, false);
 	for (PageRangeEntry* e : this->exportRange)
 	{
 		for (int x = e->getFirst(); x <= e->getLast(); x++)
 		{
-			selectedPages[x] = 1;
-			selectedCount++;
+			selectedPages[x] = true;
+		}
+	}
+
+	vector<int> pages;
+	gint64 maxSurfaceBytes = 1;
+	for (int i = 0; i < count; i++)
+	{
+		if (!selectedPages[i])
+		{
+			continue;
+		}
+		pages.push_back(i);
+
+		if (format == EXPORT_GRAPHICS_PNG)
+		{
+			doc->lock();
+			PageRef page = doc->getPage(i);
+			doc->unlock();
+
+			double factor = this->pngDpi / 72.0;
+			gint64 bytes = (gint64) (page->getWidth() * factor) * (gint64) (page->getHeight() * factor) * 4;
+			maxSurfaceBytes = std::max(maxSurfaceBytes, bytes);
 		}
 	}
 
-	stateListener->setMaximumState(selectedCount);
+	this->pageTimes.assign(count, -1);
+
+	stateListener->setMaximumState(pages.size());
+
+	size_t threads = this->threadCount > 0 ? this->threadCount : g_get_num_processors();
+	threads = std::min(threads, (size_t) std::max((gint64) 1, MAX_SURFACE_BYTES / maxSurfaceBytes));
+	threads = std::max((size_t) 1, std::min(threads, pages.size()));
 
-	DocumentView view;
 	double zoom = this->pngDpi / 72.0;
+	std::atomic<size_t> nextPage(0);
 	int current = 0;
 
-	for (int i = 0; i < count; i++)
+	auto exportPages = [&]()
 	{
-		int id = i + 1;
-		if (onePage)
+		DocumentView view;
+
+		for (size_t i = nextPage++; i < pages.size(); i = nextPage++)
 		{
-			id = -1;
+			int id = pages[i] + 1;
+			if (onePage)
+			{
+				id = -1;
+			}
+
+			gint64 start = g_get_monotonic_time();
+			exportImagePage(pages[i], id, zoom, view);
+
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->pageTimes[pages[i]] = (g_get_monotonic_time() - start) / (double) G_TIME_SPAN_SECOND;
+			stateListener->setCurrentState(++current);
 		}
+	};
 
-		if (selectedPages[i])
-		{
-			stateListener->setCurrentState(current++);
+	vector<std::thread> workers;
+	for (size_t i = 1; i < threads; i++)
+	{
+		workers.emplace_back(exportPages);
+	}
+	exportPages();
 
-			exportImagePage(i, id, zoom, format, view);
-		}
+	for (std::thread& t : workers)
+	{
+		t.join();
 	}
 }
-
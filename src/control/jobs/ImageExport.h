@@ -19,6 +19,8 @@
 
 #include <gtk/gtk.h>
 
+#include <mutex>
+
 class Document;
 class ProgressListener;
 
@@ -46,21 +48,32 @@ public:
 	 */
 	string getLastErrorMsg();
 
+	/**
+	 * Number of threads rendering pages, 0 to use all processors
+	 */
+	void setThreadCount(int threadCount);
+
 	/**
 	 * Create one Graphics file per page
 	 */
 	void exportGraphics(ProgressListener* stateListener);
 
+	/**
+	 * @return The time to export each page of the document of the last export in seconds,
+	 * -1 for pages which were not exported
+	 */
+	vector<double> getPageTimes();
+
 private:
 	/**
 	 * Create surface
 	 */
-	void createSurface(double width, double height, int id);
+	cairo_surface_t* createSurface(double width, double height, int id);
 
 	/**
 	 * Free / store the surface
 	 */
-	bool freeSurface(int id);
+	bool freeSurface(cairo_surface_t* surface, int id);
 
 	/**
 	 * Get a filename with a number, e.g. .../export-1.png, if the no is -1, return .../export.png
@@ -70,7 +83,9 @@ private:
 	/**
 	 * Export a single Image page
 	 */
-	void exportImagePage(int pageId, int id, double zoom, ExportGraphicsFormat format, DocumentView& view);
+	void exportImagePage(int pageId, int id, double zoom, DocumentView& view);
+
+	void setLastError(const string& error);
 
 public:
 	XOJ_TYPE_ATTRIB;
@@ -106,17 +121,27 @@ public:
 	int pngDpi = 300;
 
 	/**
-	 * Export surface
+	 * Number of threads rendering pages, 0 to use all processors
+	 */
+	int threadCount = 0;
+
+	/**
+	 * Each thread holds the surface of one page, the threads are limited to keep the surfaces within this size
 	 */
-	cairo_surface_t* surface = NULL;
+	static const gint64 MAX_SURFACE_BYTES = 512 * 1024 * 1024;
 
 	/**
-	 * Cairo context
+	 * Protects lastError, pageTimes and the progress, which are set by all rendering threads
 	 */
-	cairo_t* cr = NULL;
+	std::mutex mutex;
 
 	/**
 	 * The last error message to show to the user
 	 */
 	string lastError;
+
+	/**
+	 * The time to export each page in seconds
+	 */
+	vector<double> pageTimes;
 };
@@ -15,7 +15,7 @@
 
 enum JobType
 {
-	JOB_TYPE_BLOCKING, JOB_TYPE_PREVIEW, JOB_TYPE_RENDER, JOB_TYPE_AUTOSAVE
+	JOB_TYPE_BLOCKING, JOB_TYPE_PREVIEW, JOB_TYPE_RENDER, JOB_TYPE_AUTOSAVE, JOB_TYPE_SEARCH_INDEX
 };
 
 class Job
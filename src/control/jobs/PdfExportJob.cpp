@@ -46,10 +46,13 @@ void PdfExportJob::run()
 
 	Document* doc = control->getDocument();
 
+	// The PDF is created from a snapshot, so the document is only locked while copying the pages
 	doc->lock();
-	XojPdfExport* pdfe = XojPdfExportFactory::createExport(doc, control);
+	Document* snapshot = doc->createSnapshot();
 	doc->unlock();
 
+	XojPdfExport* pdfe = XojPdfExportFactory::createExport(snapshot, control);
+
 	if (!pdfe->createPdf(this->filename))
 	{
 		if (control->getWindow())
@@ -63,5 +66,6 @@ void PdfExportJob::run()
 	}
 
 	delete pdfe;
+	delete snapshot;
 }
 
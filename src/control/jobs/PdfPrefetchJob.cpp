@@ -0,0 +1,43 @@
+#include "PdfPrefetchJob.h"
+
+#include "control/PdfCache.h"
+
+PdfPrefetchJob::PdfPrefetchJob(PdfCache* cache, XojPdfPageSPtr popplerPage, double zoom)
+ : cache(cache),
+   popplerPage(popplerPage),
+   zoom(zoom)
+{
+	XOJ_INIT_TYPE(PdfPrefetchJob);
+}
+
+PdfPrefetchJob::~PdfPrefetchJob()
+{
+	XOJ_CHECK_TYPE(PdfPrefetchJob);
+
+	this->cache = NULL;
+	this->popplerPage = NULL;
+
+	XOJ_RELEASE_TYPE(PdfPrefetchJob);
+}
+
+void* PdfPrefetchJob::getSource()
+{
+	XOJ_CHECK_TYPE(PdfPrefetchJob);
+
+	return this->cache;
+}
+
+JobType PdfPrefetchJob::getType()
+{
+	XOJ_CHECK_TYPE(PdfPrefetchJob);
+
+	// Handled like rendering, so it is paused while zooming
+	return JOB_TYPE_RENDER;
+}
+
+void PdfPrefetchJob::run()
+{
+	XOJ_CHECK_TYPE(PdfPrefetchJob);
+
+	this->cache->prefetch(this->popplerPage, this->zoom);
+}
@@ -0,0 +1,46 @@
+/*
+ * Xournal++
+ *
+ * A job which renders a PDF page into the PDF cache, before the page is visible
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include "Job.h"
+
+#include "pdf/base/XojPdfPage.h"
+
+#include <XournalType.h>
+
+class PdfCache;
+
+class PdfPrefetchJob : public Job
+{
+public:
+	PdfPrefetchJob(PdfCache* cache, XojPdfPageSPtr popplerPage, double zoom);
+
+protected:
+	virtual ~PdfPrefetchJob();
+
+public:
+	virtual JobType getType();
+
+	/**
+	 * The source is the cache, so all jobs of the cache can be removed before it is deleted
+	 */
+	void* getSource();
+
+	void run();
+
+private:
+	XOJ_TYPE_ATTRIB;
+
+	PdfCache* cache;
+	XojPdfPageSPtr popplerPage;
+	double zoom;
+};
@@ -1,6 +1,7 @@
 #include "PreviewJob.h"
 
 #include "control/Control.h"
+#include "control/ThumbnailCache.h"
 #include "gui/Shadow.h"
 #include "gui/sidebar/previews/base/SidebarPreviewBaseEntry.h"
 #include "gui/sidebar/previews/base/SidebarPreviewBase.h"
@@ -40,9 +41,8 @@ JobType PreviewJob::getType()
 
 void PreviewJob::initGraphics()
 {
-	GtkAllocation alloc;
-	gtk_widget_get_allocation(this->sidebarPreview->widget, &alloc);
-	crBuffer = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, alloc.width, alloc.height);
+	crBuffer = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, this->sidebarPreview->getWidgetWidth(),
+										  this->sidebarPreview->getWidgetHeight());
 	zoom = this->sidebarPreview->sidebar->getZoom();
 	cr2 = cairo_create(crBuffer);
 }
@@ -68,7 +68,11 @@ void PreviewJob::finishPaint()
 	ref();
 
 	Util::execInUiThread([=]() {
-		gtk_widget_queue_draw(this->sidebarPreview->widget);
+		// The widget is destroyed if the entry was scrolled out of view meanwhile
+		if (this->sidebarPreview->widget)
+		{
+			gtk_widget_queue_draw(this->sidebarPreview->widget);
+		}
 
 		// After the UI job is also done, it can be unreferenced
 		unref();
@@ -119,13 +123,34 @@ void PreviewJob::run()
 {
 	XOJ_CHECK_TYPE(PreviewJob);
 
+	Document* doc = this->sidebarPreview->sidebar->getControl()->getDocument();
+	PreviewRenderType type = this->sidebarPreview->getRenderType();
+
+	// Only complete pages are stored, the layer previews are cheap
+	ThumbnailCache* thumbnails = NULL;
+	string key;
+	if (RENDER_TYPE_PAGE_PREVIEW == type)
+	{
+		thumbnails = this->sidebarPreview->sidebar->getThumbnailCache();
+
+		doc->lock();
+		key = thumbnails->pageKey(doc, this->sidebarPreview->page, this->sidebarPreview->getWidgetWidth(),
+								  this->sidebarPreview->getWidgetHeight());
+		doc->unlock();
+
+		crBuffer = thumbnails->load(key);
+		if (crBuffer)
+		{
+			finishPaint();
+			return;
+		}
+	}
+
 	initGraphics();
 	drawBorder();
 
-	Document* doc = this->sidebarPreview->sidebar->getControl()->getDocument();
 	doc->lock();
 
-	PreviewRenderType type = this->sidebarPreview->getRenderType();
 	int layer = -100; // all layer
 
 	if (RENDER_TYPE_PAGE_LAYER == type)
@@ -140,7 +165,20 @@ void PreviewJob::run()
 
 	drawPage(layer);
 
+	if (thumbnails)
+	{
+		// The page may have been changed since the cache was checked, else the hash is not computed again
+		key = thumbnails->pageKey(doc, this->sidebarPreview->page, this->sidebarPreview->getWidgetWidth(),
+								  this->sidebarPreview->getWidgetHeight());
+	}
+
 	doc->unlock();
 
+	if (thumbnails)
+	{
+		cairo_surface_flush(crBuffer);
+		thumbnails->store(key, crBuffer);
+	}
+
 	finishPaint();
 }
@@ -14,6 +14,10 @@
 class ProgressListener
 {
 public:
+	/**
+	 * Starts the progress. It is started again if the work is done again, e.g. by the rendering
+	 * PDF export if the background PDF could not be copied.
+	 */
 	virtual void setMaximumState(int max) = 0;
 	virtual void setCurrentState(int state) = 0;
 
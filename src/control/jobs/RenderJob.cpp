@@ -4,15 +4,15 @@
 #include "control/ToolHandler.h"
 #include "gui/PageView.h"
 #include "gui/XournalView.h"
+#include "gui/widgets/XournalWidget.h"
 #include "model/Document.h"
 #include "view/DocumentView.h"
 #include "view/PdfView.h"
 
-#include <Rectangle.h>
 #include <Util.h>
 #include <config-features.h>
 
-#include <list>
+#include <algorithm>
 
 RenderJob::RenderJob(XojPageView* view)
  : view(view)
@@ -36,162 +36,142 @@ void* RenderJob::getSource()
 	return this->view;
 }
 
-void RenderJob::rerenderRectangle(Rectangle* rect)
+void RenderJob::renderTile(PageTileCache* tileCache, double zoom, TileIndex tile, bool lowResolution)
 {
 	XOJ_CHECK_TYPE(RenderJob);
 
-	double zoom = view->xournal->getZoom();
 	Document* doc = view->xournal->getDocument();
 
 	doc->lock();
 	double pageWidth = view->page->getWidth();
 	double pageHeight = view->page->getHeight();
+	bool pdfBackground = view->page->isLayerVisible(0) && view->page->getBackgroundType().isPdfPage();
+	int pgNo = view->page->getPdfPageNr();
 	doc->unlock();
 
-	int x = rect->x * zoom;
-	int y = rect->y * zoom;
-	int width = rect->width * zoom;
-	int height = rect->height * zoom;
+	int x = tile.x * PAGE_TILE_SIZE;
+	int y = tile.y * PAGE_TILE_SIZE;
 
-	cairo_surface_t* rectBuffer = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
-	cairo_t* crRect = cairo_create(rectBuffer);
-	cairo_translate(crRect, -x, -y);
-	cairo_scale(crRect, zoom, zoom);
+	cairo_surface_t* tileBuffer = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, PAGE_TILE_SIZE, PAGE_TILE_SIZE);
+	cairo_t* crTile = cairo_create(tileBuffer);
+	cairo_translate(crTile, -x, -y);
+	cairo_scale(crTile, zoom, zoom);
 
 	DocumentView v;
 	Control* control = view->getXournal()->getControl();
 	v.setMarkAudioStroke(control->getToolHandler()->getToolType() == TOOL_PLAY_OBJECT);
-	v.limitArea(rect->x, rect->y, rect->width, rect->height);
+	v.limitArea(x / zoom, y / zoom, PAGE_TILE_SIZE / zoom, PAGE_TILE_SIZE / zoom);
 
-	bool backgroundVisible = view->page->isLayerVisible(0);
-	if (backgroundVisible && view->page->getBackgroundType().isPdfPage())
+	if (pdfBackground)
 	{
-		int pgNo = view->page->getPdfPageNr();
 		XojPdfPageSPtr popplerPage = doc->getPdfPage(pgNo);
 		PdfCache* cache = view->xournal->getCache();
-		PdfView::drawPage(cache, popplerPage, crRect, zoom, pageWidth, pageHeight);
+		PdfView::drawPage(cache, popplerPage, crTile, zoom, pageWidth, pageHeight, false, lowResolution);
 	}
 
 	doc->lock();
-	v.drawPage(view->page, crRect, false);
+	v.drawPage(view->page, crTile, false);
 	doc->unlock();
 
-	cairo_destroy(crRect);
+	cairo_destroy(crTile);
 
-	g_mutex_lock(&view->drawingMutex);
-
-	cairo_t * crPageBuffer = cairo_create(view->crBuffer);
-
-	cairo_set_operator(crPageBuffer, CAIRO_OPERATOR_SOURCE);
-	cairo_set_source_surface(crPageBuffer, rectBuffer, x, y);
-	cairo_rectangle(crPageBuffer, x, y, width, height);
-	cairo_fill(crPageBuffer);
-
-	cairo_destroy(crPageBuffer);
-
-	cairo_surface_destroy(rectBuffer);
-
-	g_mutex_unlock(&view->drawingMutex);
+	tileCache->store(this->view, zoom, tile.x, tile.y, tileBuffer);
 }
 
 void RenderJob::run()
 {
 	XOJ_CHECK_TYPE(RenderJob);
 
-	double zoom = this->view->xournal->getZoom();
-
-	g_mutex_lock(&this->view->repaintRectMutex);
+	// The tiles are rendered in device pixels
+	double zoom = this->view->xournal->getZoom() * this->view->xournal->getDpiScaleFactor();
+	PageTileCache* tileCache = this->view->xournal->getTileCache();
 
-	bool rerenderComplete = this->view->rerenderComplete;
-	std::vector<Rectangle*> rerenderRects = this->view->rerenderRects;
-	this->view->rerenderRects.clear();
-
-	this->view->rerenderComplete = false;
-
-	g_mutex_unlock(&this->view->repaintRectMutex);
-
-	int dpiScaleFactor = this->view->xournal->getDpiScaleFactor();
-
-	if (rerenderComplete || dpiScaleFactor > 1)
+	// Only tiles which were painted and are outdated are rendered
+	std::vector<TileIndex> tiles = tileCache->takeDirtyTiles(this->view, zoom);
+	if (tiles.empty())
 	{
-		Document* doc = this->view->xournal->getDocument();
-
-		int dispWidth = this->view->getDisplayWidth();
-		int dispHeight = this->view->getDisplayHeight();
-
-		dispWidth *= dpiScaleFactor;
-		dispHeight *= dpiScaleFactor;
-		zoom *= dpiScaleFactor;
-
-		cairo_surface_t* crBuffer = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, dispWidth, dispHeight);
-		cairo_t* cr2 = cairo_create(crBuffer);
-		cairo_scale(cr2, zoom, zoom);
-
-		XojPdfPageSPtr popplerPage;
-
-		doc->lock();
+		return;
+	}
 
-		if (this->view->page->getBackgroundType().isPdfPage())
+	// Rendering the PDF background is slow, show the tiles with a scaled render of
+	// another zoom first, and replace them when the background is rendered sharp
+	if (hasLowResolutionBackground(zoom))
+	{
+		for (TileIndex tile : tiles)
 		{
-			int pgNo = this->view->page->getPdfPageNr();
-			popplerPage = doc->getPdfPage(pgNo);
+			renderTile(tileCache, zoom, tile, true);
 		}
+		repaintTiles(tiles);
+	}
 
-		Control* control = view->getXournal()->getControl();
-		DocumentView view;
-		view.setMarkAudioStroke(control->getToolHandler()->getToolType() == TOOL_PLAY_OBJECT);
-		int width = this->view->page->getWidth();
-		int height = this->view->page->getHeight();
+	for (TileIndex tile : tiles)
+	{
+		renderTile(tileCache, zoom, tile, false);
+	}
 
-		bool backgroundVisible = this->view->page->isLayerVisible(0);
-		if (backgroundVisible)
-		{
-			PdfView::drawPage(this->view->xournal->getCache(), popplerPage, cr2, zoom, width, height);
-		}
-		view.drawPage(this->view->page, cr2, false);
+	// Schedule a repaint of the rendered tiles
+	repaintTiles(tiles);
+}
 
-		cairo_destroy(cr2);
+bool RenderJob::hasLowResolutionBackground(double zoom)
+{
+	XOJ_CHECK_TYPE(RenderJob);
 
-		g_mutex_lock(&this->view->drawingMutex);
+	Document* doc = view->xournal->getDocument();
 
-		if (this->view->crBuffer)
-		{
-			cairo_surface_destroy(this->view->crBuffer);
-		}
-		this->view->crBuffer = crBuffer;
+	doc->lock();
+	bool pdfBackground = view->page->isLayerVisible(0) && view->page->getBackgroundType().isPdfPage();
+	int pgNo = view->page->getPdfPageNr();
+	doc->unlock();
 
-		g_mutex_unlock(&this->view->drawingMutex);
-		doc->unlock();
-	}
-	else
+	if (!pdfBackground)
 	{
-		for (Rectangle* rect : rerenderRects)
-		{
-			rerenderRectangle(rect);
-		}
+		return false;
 	}
 
-	// Schedule a repaint of the widget
-	repaintWidget(this->view->getXournal()->getWidget());
-
-	// delete all rectangles
-	for (Rectangle* rect : rerenderRects)
+	XojPdfPageSPtr popplerPage = doc->getPdfPage(pgNo);
+	if (!popplerPage)
 	{
-		delete rect;
+		return false;
 	}
-	rerenderRects.clear();
+
+	PdfCache* cache = view->xournal->getCache();
+	return !cache->isCached(popplerPage, zoom) && cache->hasLowResolution(popplerPage, zoom);
 }
 
 /**
- * Repaint the widget in UI Thread
+ * Repaint the area of the tiles in UI Thread
  */
-void RenderJob::repaintWidget(GtkWidget* widget)
+void RenderJob::repaintTiles(const std::vector<TileIndex>& tiles)
 {
+	XOJ_CHECK_TYPE(RenderJob);
+
+	int x1 = G_MAXINT;
+	int y1 = G_MAXINT;
+	int x2 = 0;
+	int y2 = 0;
+	for (TileIndex tile : tiles)
+	{
+		x1 = std::min(x1, tile.x);
+		y1 = std::min(y1, tile.y);
+		x2 = std::max(x2, tile.x + 1);
+		y2 = std::max(y2, tile.y + 1);
+	}
+
+	// The tiles are in device pixels, the widget in logical pixels
+	int scale = this->view->getXournal()->getDpiScaleFactor();
+	int x = this->view->getX();
+	int y = this->view->getY();
+	x1 = x + x1 * PAGE_TILE_SIZE / scale;
+	y1 = y + y1 * PAGE_TILE_SIZE / scale;
+	x2 = x + x2 * PAGE_TILE_SIZE / scale;
+	y2 = y + y2 * PAGE_TILE_SIZE / scale;
+
 	// "this" is not needed, "widget" is in
 	// the closure, therefore no sync needed
-	// Because of this the argument "widget" is needed
+	GtkWidget* widget = this->view->getXournal()->getWidget();
 	Util::execInUiThread([=]() {
-		gtk_widget_queue_draw(widget);
+		gtk_xournal_repaint_area(widget, x1, y1, x2, y2);
 	});
 }
 
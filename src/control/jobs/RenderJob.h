@@ -13,11 +13,12 @@
 
 #include "Job.h"
 
+#include "gui/PageTileCache.h"
+
 #include <XournalType.h>
 
 #include <gtk/gtk.h>
 
-class Rectangle;
 class XojPageView;
 
 class RenderJob : public Job
@@ -37,11 +38,21 @@ public:
 
 private:
 	/**
-	 * Repaint the widget in UI Thread
+	 * Repaint the area of the tiles in UI Thread
+	 */
+	void repaintTiles(const std::vector<TileIndex>& tiles);
+
+	/**
+	 * Renders one tile of the page and stores it in the tile cache
+	 *
+	 * @param lowResolution Use a cached PDF background of another zoom, see PdfCache::render
 	 */
-	void repaintWidget(GtkWidget* widget);
+	void renderTile(PageTileCache* tileCache, double zoom, TileIndex tile, bool lowResolution);
 
-	void rerenderRectangle(Rectangle* rect);
+	/**
+	 * @return true if the PDF background is not rendered for this zoom yet, but for another zoom
+	 */
+	bool hasLowResolutionBackground(double zoom);
 
 private:
 	XOJ_TYPE_ATTRIB;
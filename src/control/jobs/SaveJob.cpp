@@ -46,14 +46,10 @@ void SaveJob::afterRun()
 	}
 }
 
-void SaveJob::updatePreview(Control* control)
+void SaveJob::updatePreview(Document* doc)
 {
 	const int previewSize = 128;
 
-	Document* doc = control->getDocument();
-
-	doc->lock();
-
 	if (doc->getPageCount() > 0)
 	{
 		PageRef page = doc->getPage(0);
@@ -99,26 +95,31 @@ void SaveJob::updatePreview(Control* control)
 	{
 		doc->setPreview(NULL);
 	}
-
-	doc->unlock();
 }
 
 bool SaveJob::save()
 {
 	XOJ_CHECK_TYPE(SaveJob);
 
-	updatePreview(control);
 	Document* doc = this->control->getDocument();
 
-	SaveHandler h;
-
+	// Only copying the pages needs the lock, the snapshot is rendered and written without it
 	doc->lock();
-	h.prepareSave(doc);
+	Document* snapshot = doc->createSnapshot();
 	Path filename = doc->getFilename();
 	filename.clearExtensions();
 	filename += ".xopp";
 	doc->unlock();
 
+	updatePreview(snapshot);
+
+	doc->lock();
+	doc->setPreview(snapshot->getPreview());
+	doc->unlock();
+
+	SaveHandler h;
+	h.prepareSave(snapshot);
+
 	if (doc->shouldCreateBackupOnSave())
 	{
 		Path backup = filename;
@@ -132,9 +133,10 @@ bool SaveJob::save()
 		doc->setCreateBackupOnSave(false);
 	}
 
-	doc->lock();
-
 	h.saveTo(filename, this->control);
+	delete snapshot;
+
+	doc->lock();
 	doc->setFilename(filename);
 	doc->unlock();
 
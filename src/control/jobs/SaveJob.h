@@ -28,7 +28,11 @@ public:
 
 	bool save();
 
-	static void updatePreview(Control* control);
+	/**
+	 * Renders the preview of the first page into doc. Call this with a snapshot
+	 * of the document, else the document has to be locked.
+	 */
+	static void updatePreview(Document* doc);
 
 protected:
 	virtual void afterRun();
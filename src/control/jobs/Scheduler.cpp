@@ -1,7 +1,9 @@
 #include "Scheduler.h"
 #include <config-debug.h>
 
+#include <algorithm>
 #include <inttypes.h>
+#include <thread>
 
 #ifdef DEBUG_SHEDULER
 #define SDEBUG g_message
@@ -9,7 +11,7 @@
 #define SDEBUG(msg, ...)
 #endif
 
-Scheduler::Scheduler()
+Scheduler::Scheduler(int threadCount)
 {
 	XOJ_INIT_TYPE(Scheduler);
 
@@ -17,22 +19,31 @@ Scheduler::Scheduler()
 
 	// Thread
 	g_cond_init(&this->jobQueueCond);
+	g_cond_init(&this->jobFinishedCond);
 
 	g_mutex_init(&this->jobQueueMutex);
-	g_mutex_init(&this->jobRunningMutex);
-	g_mutex_init(&this->schedulerMutex);
 	g_mutex_init(&this->blockRenderMutex);
 
+	if (threadCount <= 0)
+	{
+		threadCount = std::thread::hardware_concurrency();
+	}
+	threadCount = std::max(threadCount, 1);
+
 	// Queue
 	GQueue init = G_QUEUE_INIT;
-	this->queueUrgent = init;
-	this->queueHigh = init;
-	this->queueLow = init;
-	this->queueNone = init;
-	this->jobQueue[JOB_PRIORITY_URGENT] = &this->queueUrgent;
-	this->jobQueue[JOB_PRIORITY_HIGH] = &this->queueHigh;
-	this->jobQueue[JOB_PRIORITY_LOW] = &this->queueLow;
-	this->jobQueue[JOB_PRIORITY_NONE] = &this->queueNone;
+	for (int i = 0; i < threadCount; i++)
+	{
+		SchedulerWorker* worker = new SchedulerWorker();
+		worker->scheduler = this;
+		worker->thread = NULL;
+		worker->index = i;
+		for (int priority = JOB_PRIORITY_URGENT; priority < JOB_N_PRIORITIES; priority++)
+		{
+			worker->jobQueue[priority] = init;
+		}
+		this->workers.push_back(worker);
+	}
 }
 
 Scheduler::~Scheduler()
@@ -41,20 +52,26 @@ Scheduler::~Scheduler()
 
 	SDEBUG("Destroy scheduler");
 
+	stop();
+
 	if (this->jobRenderThreadTimerId)
 	{
 		g_source_remove(this->jobRenderThreadTimerId);
 		this->jobRenderThreadTimerId = 0;
 	}
 
-	stop();
-
 	Job * job = NULL;
-	while ((job = getNextJobUnlocked()) != NULL)
+	while ((job = getNextJobUnlocked(NULL)) != NULL)
 	{
 		job->unref();
 	}
 
+	for (SchedulerWorker* worker : this->workers)
+	{
+		delete worker;
+	}
+	this->workers.clear();
+
 	if (this->blockRenderZoomTime)
 	{
 		g_free(this->blockRenderZoomTime);
@@ -66,9 +83,13 @@ Scheduler::~Scheduler()
 void Scheduler::start()
 {
 	SDEBUG("Starting scheduler");
-	g_return_if_fail(this->thread == NULL);
+	g_return_if_fail(this->workers.front()->thread == NULL);
 
-	this->thread = g_thread_new(name.c_str(), (GThreadFunc) jobThreadCallback, this);
+	for (SchedulerWorker* worker : this->workers)
+	{
+		string threadName = name + "-" + std::to_string(worker->index);
+		worker->thread = g_thread_new(threadName.c_str(), (GThreadFunc) jobThreadCallback, worker);
+	}
 }
 
 void Scheduler::stop()
@@ -79,15 +100,29 @@ void Scheduler::stop()
 	{
 		return;
 	}
+
+	g_mutex_lock(&this->jobQueueMutex);
 	this->threadRunning = false;
 	g_cond_broadcast(&this->jobQueueCond);
+	g_mutex_unlock(&this->jobQueueMutex);
 
-	if (this->thread)
+	for (SchedulerWorker* worker : this->workers)
 	{
-		g_thread_join(this->thread);
+		if (worker->thread)
+		{
+			g_thread_join(worker->thread);
+			worker->thread = NULL;
+		}
 	}
 }
 
+int Scheduler::getThreadCount()
+{
+	XOJ_CHECK_TYPE(Scheduler);
+
+	return this->workers.size();
+}
+
 void Scheduler::addJob(Job* job, JobPriority priority)
 {
 	XOJ_CHECK_TYPE(Scheduler);
@@ -96,7 +131,12 @@ void Scheduler::addJob(Job* job, JobPriority priority)
 	g_mutex_lock(&this->jobQueueMutex);
 
 	job->ref();
-	g_queue_push_tail(this->jobQueue[priority], job);
+
+	// Distribute the jobs round robin, idle workers steal the jobs from the others anyway
+	SchedulerWorker* worker = this->workers[this->nextWorker];
+	this->nextWorker = (this->nextWorker + 1) % this->workers.size();
+
+	g_queue_push_tail(&worker->jobQueue[priority], job);
 	g_cond_broadcast(&this->jobQueueCond);
 
 	SDEBUG("add job: %" PRId64, (uint64_t) job);
@@ -104,34 +144,69 @@ void Scheduler::addJob(Job* job, JobPriority priority)
 	g_mutex_unlock(&this->jobQueueMutex);
 }
 
-Job* Scheduler::getNextJobUnlocked(bool onlyNotRender, bool* hasRenderJobs)
+bool Scheduler::isSerialJob(Job* job)
 {
-	XOJ_CHECK_TYPE(Scheduler);
+	JobType type = job->getType();
+	return type == JOB_TYPE_BLOCKING || type == JOB_TYPE_AUTOSAVE;
+}
 
-	Job* job = NULL;
+Job* Scheduler::takeJobUnlocked(GQueue* queue, bool fromTail, bool onlyNotRender, bool* hasRenderJobs)
+{
+	XOJ_CHECK_TYPE(Scheduler);
 
-	for (int i = JOB_PRIORITY_URGENT; i < JOB_N_PRIORITIES; i++)
+	for (GList* l = fromTail ? queue->tail : queue->head; l != NULL; l = fromTail ? l->prev : l->next)
 	{
-		if (onlyNotRender)
+		Job* job = (Job*) l->data;
+
+		if (onlyNotRender && job->getType() == JOB_TYPE_RENDER)
 		{
-			for (GList* l = this->jobQueue[i]->head; l != NULL; l = l->next)
+			if (hasRenderJobs)
 			{
-				job = (Job*) l->data;
-
-				if (job->getType() != JOB_TYPE_RENDER)
-				{
-					g_queue_delete_link(this->jobQueue[i], l);
-					return job;
-				}
-				else if (hasRenderJobs)
-				{
-					*hasRenderJobs = true;
-				}
+				*hasRenderJobs = true;
 			}
+			continue;
+		}
+
+		if (this->serialJobRunning && isSerialJob(job))
+		{
+			// Will be picked up as soon as the running serial job is finished
+			continue;
 		}
-		else
+
+		if (isSourceRunningUnlocked(job->getSource()))
+		{
+			// Two jobs of the same source (e.g. rerendering the same page) never run in parallel
+			continue;
+		}
+
+		g_queue_delete_link(queue, l);
+		return job;
+	}
+
+	return NULL;
+}
+
+/**
+ * Returns the next job with the highest priority. The own queue of the worker is preferred,
+ * if it is empty a job with the same priority is stolen from another worker.
+ *
+ * If worker is NULL all queues are searched from the head (used to clean up)
+ */
+Job* Scheduler::getNextJobUnlocked(SchedulerWorker* worker, bool onlyNotRender, bool* hasRenderJobs)
+{
+	XOJ_CHECK_TYPE(Scheduler);
+
+	int count = this->workers.size();
+	int ownIndex = worker ? worker->index : 0;
+
+	for (int priority = JOB_PRIORITY_URGENT; priority < JOB_N_PRIORITIES; priority++)
+	{
+		for (int i = 0; i < count; i++)
 		{
-			job = (Job*) g_queue_pop_head(this->jobQueue[i]);
+			SchedulerWorker* w = this->workers[(ownIndex + i) % count];
+			bool steal = worker != NULL && w != worker;
+
+			Job* job = takeJobUnlocked(&w->jobQueue[priority], steal, onlyNotRender, hasRenderJobs);
 			if (job)
 			{
 				return job;
@@ -142,6 +217,36 @@ Job* Scheduler::getNextJobUnlocked(bool onlyNotRender, bool* hasRenderJobs)
 	return NULL;
 }
 
+bool Scheduler::isSourceRunningUnlocked(void* source)
+{
+	XOJ_CHECK_TYPE(Scheduler);
+
+	if (source == NULL)
+	{
+		return false;
+	}
+
+	for (Job* job : this->runningJobs)
+	{
+		if (job->getSource() == source)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void Scheduler::waitForRunningJobsUnlocked(void* source)
+{
+	XOJ_CHECK_TYPE(Scheduler);
+
+	while (source == NULL ? !this->runningJobs.empty() : isSourceRunningUnlocked(source))
+	{
+		g_cond_wait(&this->jobFinishedCond, &this->jobQueueMutex);
+	}
+}
+
 /**
  * Locks the complete scheduler
  */
@@ -149,7 +254,18 @@ void Scheduler::lock()
 {
 	XOJ_CHECK_TYPE(Scheduler);
 
-	g_mutex_lock(&this->schedulerMutex);
+	g_mutex_lock(&this->jobQueueMutex);
+
+	// Wait for another lock holder
+	while (this->schedulerLocked)
+	{
+		g_cond_wait(&this->jobFinishedCond, &this->jobQueueMutex);
+	}
+
+	this->schedulerLocked = true;
+	waitForRunningJobsUnlocked();
+
+	g_mutex_unlock(&this->jobQueueMutex);
 }
 
 /**
@@ -159,7 +275,13 @@ void Scheduler::unlock()
 {
 	XOJ_CHECK_TYPE(Scheduler);
 
-	g_mutex_unlock(&this->schedulerMutex);
+	g_mutex_lock(&this->jobQueueMutex);
+
+	this->schedulerLocked = false;
+	g_cond_broadcast(&this->jobFinishedCond);
+	g_cond_broadcast(&this->jobQueueCond);
+
+	g_mutex_unlock(&this->jobQueueMutex);
 }
 
 #define ZOOM_WAIT_US_TIMEOUT 300000 // 0.3s
@@ -189,15 +311,16 @@ void Scheduler::unblockRerenderZoom()
 
 	g_free(this->blockRenderZoomTime);
 	this->blockRenderZoomTime = NULL;
+	g_mutex_unlock(&this->blockRenderMutex);
+
+	g_mutex_lock(&this->jobQueueMutex);
 	if (this->jobRenderThreadTimerId)
 	{
 		g_source_remove(this->jobRenderThreadTimerId);
 		this->jobRenderThreadTimerId = 0;
 	}
-
-	g_mutex_unlock(&this->blockRenderMutex);
-
 	g_cond_broadcast(&this->jobQueueCond);
+	g_mutex_unlock(&this->jobQueueMutex);
 }
 
 /**
@@ -226,27 +349,26 @@ bool Scheduler::jobRenderThreadTimer(Scheduler* scheduler)
 {
 	XOJ_CHECK_TYPE_OBJ(scheduler, Scheduler);
 
-	scheduler->jobRenderThreadTimerId = 0;
-
 	g_mutex_lock(&scheduler->blockRenderMutex);
 	g_free(scheduler->blockRenderZoomTime);
 	scheduler->blockRenderZoomTime = NULL;
 	g_mutex_unlock(&scheduler->blockRenderMutex);
 
+	g_mutex_lock(&scheduler->jobQueueMutex);
+	scheduler->jobRenderThreadTimerId = 0;
 	g_cond_broadcast(&scheduler->jobQueueCond);
+	g_mutex_unlock(&scheduler->jobQueueMutex);
 
 	return false;
 }
 
-gpointer Scheduler::jobThreadCallback(Scheduler* scheduler)
+gpointer Scheduler::jobThreadCallback(SchedulerWorker* worker)
 {
+	Scheduler* scheduler = worker->scheduler;
 	XOJ_CHECK_TYPE_OBJ(scheduler, Scheduler);
 
 	while (scheduler->threadRunning)
 	{
-		// lock the whole scheduler
-		g_mutex_lock(&scheduler->schedulerMutex);
-
 		g_mutex_lock(&scheduler->blockRenderMutex);
 		bool onlyNoneRenderJobs = false;
 		glong diff = 1000;
@@ -269,8 +391,19 @@ gpointer Scheduler::jobThreadCallback(Scheduler* scheduler)
 		g_mutex_unlock(&scheduler->blockRenderMutex);
 
 		g_mutex_lock(&scheduler->jobQueueMutex);
+
+		if (!scheduler->threadRunning)
+		{
+			g_mutex_unlock(&scheduler->jobQueueMutex);
+			break;
+		}
+
 		bool hasOnlyRenderJobs = false;
-		Job* job = scheduler->getNextJobUnlocked(onlyNoneRenderJobs, &hasOnlyRenderJobs);
+		Job* job = NULL;
+		if (!scheduler->schedulerLocked)
+		{
+			job = scheduler->getNextJobUnlocked(worker, onlyNoneRenderJobs, &hasOnlyRenderJobs);
+		}
 		if (job != NULL)
 		{
 			hasOnlyRenderJobs = false;
@@ -280,15 +413,9 @@ gpointer Scheduler::jobThreadCallback(Scheduler* scheduler)
 
 		if (job == NULL)
 		{
-			// unlock the whole scheduler
-			g_mutex_unlock(&scheduler->schedulerMutex);
-
-			if (hasOnlyRenderJobs)
+			// One timer wakes up all workers, it is only added by the first worker which waits for it
+			if (hasOnlyRenderJobs && scheduler->jobRenderThreadTimerId == 0)
 			{
-				if (scheduler->jobRenderThreadTimerId)
-				{
-					g_source_remove(scheduler->jobRenderThreadTimerId);
-				}
 				scheduler->jobRenderThreadTimerId = g_timeout_add(diff, (GSourceFunc) jobRenderThreadTimer, scheduler);
 			}
 
@@ -300,17 +427,32 @@ gpointer Scheduler::jobThreadCallback(Scheduler* scheduler)
 
 		SDEBUG("do job: %" PRId64, (uint64_t) job);
 
-		g_mutex_unlock(&scheduler->jobQueueMutex);
+		bool serial = isSerialJob(job);
+		if (serial)
+		{
+			scheduler->serialJobRunning = true;
+		}
+		scheduler->runningJobs.push_back(job);
 
-		g_mutex_lock(&scheduler->jobRunningMutex);
+		g_mutex_unlock(&scheduler->jobQueueMutex);
 
 		job->execute();
 
-		job->unref();
-		g_mutex_unlock(&scheduler->jobRunningMutex);
+		g_mutex_lock(&scheduler->jobQueueMutex);
 
-		// unlock the whole scheduler
-		g_mutex_unlock(&scheduler->schedulerMutex);
+		scheduler->runningJobs.erase(std::find(scheduler->runningJobs.begin(), scheduler->runningJobs.end(), job));
+		if (serial)
+		{
+			scheduler->serialJobRunning = false;
+		}
+
+		// Other workers may wait for the next serial job or a job of the same source
+		g_cond_broadcast(&scheduler->jobQueueCond);
+		g_cond_broadcast(&scheduler->jobFinishedCond);
+
+		g_mutex_unlock(&scheduler->jobQueueMutex);
+
+		job->unref();
 
 		SDEBUG("next");
 	}
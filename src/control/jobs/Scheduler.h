@@ -16,6 +16,8 @@
 #include "Job.h"
 #include <XournalType.h>
 
+#include <vector>
+
 /**
  * @file Scheduler.h
  * @brief A file containing the defintion of the Scheduler
@@ -57,10 +59,46 @@ enum JobPriority
 };
 
 
+class Scheduler;
+
+/**
+ * A worker thread of the Scheduler
+ *
+ * Each worker owns one queue per priority. It takes jobs from the head of its own
+ * queues, and if they are empty it steals from the tail of the other workers queues.
+ */
+struct SchedulerWorker
+{
+	Scheduler* scheduler;
+	GThread* thread;
+	int index;
+
+	GQueue jobQueue[JOB_N_PRIORITIES];
+};
+
+/**
+ * Runs the jobs on a pool of worker threads.
+ *
+ * Which jobs run in parallel:
+ * - Two jobs with the same source (e.g. two renders of one page view, two previews of one sidebar
+ *   entry, two PDF prefetches of one cache) never run at the same time
+ * - Blocking jobs (save, export, load...) and autosave jobs are serial, only one of them runs at a time.
+ *   They run in parallel to the render, preview, prefetch and search index jobs
+ * - All other jobs of different sources run in parallel
+ *
+ * The jobs read the document with the document lock (the save job from a snapshot). All calls into
+ * poppler, also for the PDFs of LaTeX elements, take the lock of their PDF document
+ * (PopplerGlibDocument::getLock), so PDF pages are rendered one at a time per document, while the
+ * rest of the page is drawn in parallel. The caches shared between the jobs (PdfCache, PageTileCache,
+ * ThumbnailCache) have their own mutex.
+ */
 class Scheduler
 {
 public:
-	Scheduler();
+	/**
+	 * @param threadCount The count of worker threads, 0 to use one thread per CPU core
+	 */
+	Scheduler(int threadCount = 0);
 	virtual ~Scheduler();
 
 public:
@@ -78,7 +116,8 @@ public:
 	void stop();
 
 	/**
-	 * Locks the complete scheduler
+	 * Locks the complete scheduler, waits until all running jobs are finished
+	 * and prevents new jobs from being started
 	 */
 	void lock();
 
@@ -87,6 +126,11 @@ public:
 	 */
 	void unlock();
 
+	/**
+	 * @return The count of worker threads
+	 */
+	int getThreadCount();
+
 	/**
 	 * Don't render the next X ms so the scrolling performance is better
 	 */
@@ -98,36 +142,73 @@ public:
 	void unblockRerenderZoom();
 
 private:
-	static gpointer jobThreadCallback(Scheduler* scheduler);
-	Job* getNextJobUnlocked(bool onlyNotRender = false, bool* hasRenderJobs = NULL);
+	static gpointer jobThreadCallback(SchedulerWorker* worker);
+	Job* getNextJobUnlocked(SchedulerWorker* worker, bool onlyNotRender = false, bool* hasRenderJobs = NULL);
+	Job* takeJobUnlocked(GQueue* queue, bool fromTail, bool onlyNotRender, bool* hasRenderJobs);
+
+	/**
+	 * Jobs which may not run in parallel to each other, e.g. because they write files
+	 */
+	static bool isSerialJob(Job* job);
+
+	/**
+	 * @return true if a job with this source is currently executed, the jobQueueMutex has to be locked
+	 */
+	bool isSourceRunningUnlocked(void* source);
 
 	static bool jobRenderThreadTimer(Scheduler* scheduler);
 
+protected:
+	/**
+	 * Waits until no running job has the given source, or until no job is running at all
+	 * if source is NULL. The jobQueueMutex has to be locked by the caller.
+	 */
+	void waitForRunningJobsUnlocked(void* source = NULL);
+
 protected:
 	XOJ_TYPE_ATTRIB;
 
 	bool threadRunning = true;
 
+	/**
+	 * Wakes up the workers when rendering is not blocked anymore, protected by the jobQueueMutex
+	 */
 	int jobRenderThreadTimerId = 0;
 
-	GThread* thread = NULL;
-
+	/**
+	 * Protects the queues of all workers and the list of running jobs
+	 */
 	GCond jobQueueCond;
 	GMutex jobQueueMutex;
 
-	GMutex schedulerMutex;
+	/**
+	 * Signaled each time a job has finished
+	 */
+	GCond jobFinishedCond;
+
+	/**
+	 * No new jobs are started while the scheduler is locked
+	 */
+	bool schedulerLocked = false;
 
 	/**
+	 * The jobs currently executed by the workers.
+	 *
 	 * This is need to be sure there is no job running if we delete a page, else we may access delete memory...
 	 */
-	GMutex jobRunningMutex;
+	std::vector<Job*> runningJobs;
 
-	GQueue queueUrgent;
-	GQueue queueHigh;
-	GQueue queueLow;
-	GQueue queueNone;
+	/**
+	 * A serial job (e.g. save) is currently running
+	 */
+	bool serialJobRunning = false;
+
+	std::vector<SchedulerWorker*> workers;
 
-	GQueue* jobQueue[JOB_N_PRIORITIES];
+	/**
+	 * The worker which gets the next added job
+	 */
+	int nextWorker = 0;
 
 	GTimeVal* blockRenderZoomTime = NULL;
 	GMutex blockRenderMutex;
@@ -0,0 +1,50 @@
+#include "SearchIndexJob.h"
+
+#include "XournalScheduler.h"
+
+#include "control/SearchIndex.h"
+
+SearchIndexJob::SearchIndexJob(SearchIndex* index, XournalScheduler* scheduler, int generation)
+ : index(index),
+   scheduler(scheduler),
+   generation(generation)
+{
+	XOJ_INIT_TYPE(SearchIndexJob);
+}
+
+SearchIndexJob::~SearchIndexJob()
+{
+	XOJ_CHECK_TYPE(SearchIndexJob);
+
+	this->index = NULL;
+	this->scheduler = NULL;
+
+	XOJ_RELEASE_TYPE(SearchIndexJob);
+}
+
+void* SearchIndexJob::getSource()
+{
+	XOJ_CHECK_TYPE(SearchIndexJob);
+
+	return this->index;
+}
+
+JobType SearchIndexJob::getType()
+{
+	XOJ_CHECK_TYPE(SearchIndexJob);
+
+	return JOB_TYPE_SEARCH_INDEX;
+}
+
+void SearchIndexJob::run()
+{
+	XOJ_CHECK_TYPE(SearchIndexJob);
+
+	if (this->index->indexNextPages(this->generation, PAGES_PER_JOB))
+	{
+		// Not addSearchIndex(), the document may have changed meanwhile
+		SearchIndexJob* job = new SearchIndexJob(this->index, this->scheduler, this->generation);
+		this->scheduler->addJob(job, JOB_PRIORITY_NONE);
+		job->unref();
+	}
+}
@@ -0,0 +1,55 @@
+/*
+ * Xournal++
+ *
+ * A job which indexes some PDF pages for the search
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include "Job.h"
+
+#include <XournalType.h>
+
+class SearchIndex;
+class XournalScheduler;
+
+/**
+ * Indexes a few pages and adds a new job for the next pages, so the indexing does not keep
+ * a worker thread busy for long
+ */
+class SearchIndexJob : public Job
+{
+public:
+	/**
+	 * @param generation The generation of the index the job was created for
+	 */
+	SearchIndexJob(SearchIndex* index, XournalScheduler* scheduler, int generation);
+
+protected:
+	virtual ~SearchIndexJob();
+
+public:
+	virtual JobType getType();
+
+	/**
+	 * The source is the index, so all jobs of the index can be removed before it is deleted
+	 */
+	void* getSource();
+
+	void run();
+
+private:
+	XOJ_TYPE_ATTRIB;
+
+	SearchIndex* index;
+	XournalScheduler* scheduler;
+
+	int generation;
+
+	static const int PAGES_PER_JOB = 8;
+};
@@ -1,10 +1,14 @@
 #include "XournalScheduler.h"
 
+#include "PdfPrefetchJob.h"
 #include "PreviewJob.h"
 #include "RenderJob.h"
+#include "SearchIndexJob.h"
 
-XournalScheduler::XournalScheduler()
- : Scheduler()
+#include "control/SearchIndex.h"
+
+XournalScheduler::XournalScheduler(int threadCount)
+ : Scheduler(threadCount)
 {
 	XOJ_INIT_TYPE(XournalScheduler);
 
@@ -36,19 +40,26 @@ void XournalScheduler::removeAllJobs()
 
 	g_mutex_lock(&this->jobQueueMutex);
 
-	for (int priority = JOB_PRIORITY_URGENT; priority < JOB_N_PRIORITIES; priority++)
+	for (SchedulerWorker* worker : this->workers)
 	{
-		int length = g_queue_get_length(this->jobQueue[priority]);
-		for (int i = 0; i < length; i++)
+		for (int priority = JOB_PRIORITY_URGENT; priority < JOB_N_PRIORITIES; priority++)
 		{
-			Job* job = (Job*) g_queue_peek_nth(this->jobQueue[priority], i);
-
-			JobType type = job->getType();
-			if (type == JOB_TYPE_PREVIEW || type == JOB_TYPE_RENDER)
+			GQueue* queue = &worker->jobQueue[priority];
+			GList* l = queue->head;
+			while (l != NULL)
 			{
-				job->deleteJob();
-				g_queue_remove(this->jobQueue[priority], job);
-				job->unref();
+				GList* next = l->next;
+				Job* job = (Job*) l->data;
+
+				JobType type = job->getType();
+				if (type == JOB_TYPE_PREVIEW || type == JOB_TYPE_RENDER)
+				{
+					job->deleteJob();
+					g_queue_delete_link(queue, l);
+					job->unref();
+				}
+
+				l = next;
 			}
 		}
 	}
@@ -61,61 +72,78 @@ void XournalScheduler::finishTask()
 {
 	XOJ_CHECK_TYPE(XournalScheduler);
 
-	g_mutex_lock(&this->jobRunningMutex);
-	g_mutex_unlock(&this->jobRunningMutex);
+	g_mutex_lock(&this->jobQueueMutex);
+	waitForRunningJobsUnlocked();
+	g_mutex_unlock(&this->jobQueueMutex);
 }
 
-void XournalScheduler::removeSource(void* source, JobType type, JobPriority priority)
+GList* XournalScheduler::findSourceUnlocked(void* source, JobType type, JobPriority priority, GQueue** queue)
 {
 	XOJ_CHECK_TYPE(XournalScheduler);
 
-	g_mutex_lock(&this->jobQueueMutex);
-
-	int length = g_queue_get_length(this->jobQueue[priority]);
-	for (int i = 0; i < length; i++)
+	for (SchedulerWorker* worker : this->workers)
 	{
-		Job* job = (Job*) g_queue_peek_nth(this->jobQueue[priority], i);
-
-		if (job->getType() == type)
+		for (GList* l = worker->jobQueue[priority].head; l != NULL; l = l->next)
 		{
-			if (job->getSource() == source)
+			Job* job = (Job*) l->data;
+
+			if (job->getType() == type && job->getSource() == source)
 			{
-				job->deleteJob();
-				g_queue_remove(this->jobQueue[priority], job);
-				job->unref();
-				break;
+				*queue = &worker->jobQueue[priority];
+				return l;
 			}
 		}
 	}
 
-	// wait until the last job is done
+	return NULL;
+}
+
+void XournalScheduler::removeSource(void* source, JobType type, JobPriority priority)
+{
+	XOJ_CHECK_TYPE(XournalScheduler);
+
+	g_mutex_lock(&this->jobQueueMutex);
+
+	GQueue* queue = NULL;
+	GList* l = findSourceUnlocked(source, type, priority, &queue);
+	if (l != NULL)
+	{
+		Job* job = (Job*) l->data;
+		job->deleteJob();
+		g_queue_delete_link(queue, l);
+		job->unref();
+	}
+
+	// wait until the running jobs of this source are done
 	// we can be sure we don't access "source"
-	finishTask();
+	waitForRunningJobsUnlocked(source);
 
 	g_mutex_unlock(&this->jobQueueMutex);
 }
 
+void XournalScheduler::removeAllSourceJobsUnlocked(void* source, JobType type, JobPriority priority)
+{
+	XOJ_CHECK_TYPE(XournalScheduler);
+
+	GQueue* queue = NULL;
+	GList* l = NULL;
+	while ((l = findSourceUnlocked(source, type, priority, &queue)) != NULL)
+	{
+		Job* job = (Job*) l->data;
+		job->deleteJob();
+		g_queue_delete_link(queue, l);
+		job->unref();
+	}
+}
+
 bool XournalScheduler::existsSource(void* source, JobType type, JobPriority priority)
 {
 	XOJ_CHECK_TYPE(XournalScheduler);
 
-	bool exists = false;
 	g_mutex_lock(&this->jobQueueMutex);
 
-	int length = g_queue_get_length(this->jobQueue[priority]);
-	for (int i = 0; i < length; i++)
-	{
-		Job* job = (Job*) g_queue_peek_nth(this->jobQueue[priority], i);
-
-		if (job->getType() == type)
-		{
-			if (job->getSource() == source)
-			{
-				exists = true;
-				break;
-			}
-		}
-	}
+	GQueue* queue = NULL;
+	bool exists = findSourceUnlocked(source, type, priority, &queue) != NULL;
 
 	g_mutex_unlock(&this->jobQueueMutex);
 
@@ -149,3 +177,57 @@ void XournalScheduler::addRerenderPage(XojPageView* view)
 	addJob(job, JOB_PRIORITY_URGENT);
 	job->unref();
 }
+
+void XournalScheduler::addPrefetchPdf(PdfCache* cache, vector<XojPdfPageSPtr> pages, double zoom)
+{
+	XOJ_CHECK_TYPE(XournalScheduler);
+
+	g_mutex_lock(&this->jobQueueMutex);
+	removeAllSourceJobsUnlocked(cache, JOB_TYPE_RENDER, JOB_PRIORITY_LOW);
+	g_mutex_unlock(&this->jobQueueMutex);
+
+	for (XojPdfPageSPtr& page : pages)
+	{
+		PdfPrefetchJob* job = new PdfPrefetchJob(cache, page, zoom);
+		addJob(job, JOB_PRIORITY_LOW);
+		job->unref();
+	}
+}
+
+void XournalScheduler::removePdfCache(PdfCache* cache)
+{
+	XOJ_CHECK_TYPE(XournalScheduler);
+
+	g_mutex_lock(&this->jobQueueMutex);
+
+	removeAllSourceJobsUnlocked(cache, JOB_TYPE_RENDER, JOB_PRIORITY_LOW);
+
+	// wait until the running jobs of this cache are done
+	waitForRunningJobsUnlocked(cache);
+
+	g_mutex_unlock(&this->jobQueueMutex);
+}
+
+void XournalScheduler::addSearchIndex(SearchIndex* index)
+{
+	XOJ_CHECK_TYPE(XournalScheduler);
+
+	SearchIndexJob* job = new SearchIndexJob(index, this, index->getGeneration());
+	addJob(job, JOB_PRIORITY_NONE);
+	job->unref();
+}
+
+void XournalScheduler::removeSearchIndex(SearchIndex* index)
+{
+	XOJ_CHECK_TYPE(XournalScheduler);
+
+	g_mutex_lock(&this->jobQueueMutex);
+
+	removeAllSourceJobsUnlocked(index, JOB_TYPE_SEARCH_INDEX, JOB_PRIORITY_NONE);
+	waitForRunningJobsUnlocked(index);
+
+	// The running job may have added the job for the next pages
+	removeAllSourceJobsUnlocked(index, JOB_TYPE_SEARCH_INDEX, JOB_PRIORITY_NONE);
+
+	g_mutex_unlock(&this->jobQueueMutex);
+}
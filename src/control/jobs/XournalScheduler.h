@@ -16,13 +16,20 @@
 #include "control/jobs/Scheduler.h"
 #include "gui/sidebar/previews/page/SidebarPreviewPageEntry.h"
 #include "gui/PageView.h"
+#include "pdf/base/XojPdfPage.h"
 
 #include <XournalType.h>
 
+class PdfCache;
+class SearchIndex;
+
 class XournalScheduler : public Scheduler
 {
 public:
-	XournalScheduler();
+	/**
+	 * @param threadCount The count of worker threads, 0 to use one thread per CPU core
+	 */
+	XournalScheduler(int threadCount = 0);
 	virtual ~XournalScheduler();
 
 public:
@@ -40,6 +47,27 @@ public:
 	void addRepaintSidebar(SidebarPreviewBaseEntry* preview);
 	void addRerenderPage(XojPageView* view);
 
+	/**
+	 * Renders the PDF pages into the cache with low priority. Prefetch jobs of the cache
+	 * which are not started yet are replaced, as they are outdated after scrolling.
+	 */
+	void addPrefetchPdf(PdfCache* cache, vector<XojPdfPageSPtr> pages, double zoom);
+
+	/**
+	 * Removes all prefetch jobs of the cache and waits until the running ones are done
+	 */
+	void removePdfCache(PdfCache* cache);
+
+	/**
+	 * Indexes the PDF pages of the search index with the lowest priority, a few pages per job
+	 */
+	void addSearchIndex(SearchIndex* index);
+
+	/**
+	 * Removes all jobs of the search index and waits until the running one is done
+	 */
+	void removeSearchIndex(SearchIndex* index);
+
 	/**
 	 * Blocks until all currently running Job%s have been executed
 	 */
@@ -51,8 +79,21 @@ private:
 	 */
 	void removeSource(void* source, JobType type, JobPriority priority);
 
+	/**
+	 * Removes all queued jobs of the source, the jobQueueMutex has to be locked
+	 */
+	void removeAllSourceJobsUnlocked(void* source, JobType type, JobPriority priority);
+
 	bool existsSource(void* source, JobType type, JobPriority priority);
 
+	/**
+	 * Searches the queues of all workers for a job, the jobQueueMutex has to be locked
+	 *
+	 * @param queue Returns the queue containing the job
+	 * @return The link of the job, or NULL if there is no such job
+	 */
+	GList* findSourceUnlocked(void* source, JobType type, JobPriority priority, GQueue** queue);
+
 private:
 	XOJ_TYPE_ATTRIB;
 };
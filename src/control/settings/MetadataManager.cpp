@@ -8,12 +8,26 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
 #include <fstream>
 #include <sstream>
 #include <algorithm> // std::sort
 
 using namespace std;
 
+/**
+ * Log file layout: header line, then one record per line:
+ * time, page, zoom, length of the path in bytes, ':', path
+ */
+static const char LOG_HEADER[] = "XOJ-METADATA-LOG/1.0";
+
 MetadataEntry::MetadataEntry()
  : valid(false),
    zoom(1),
@@ -24,18 +38,33 @@ MetadataEntry::MetadataEntry()
 
 
 MetadataManager::MetadataManager()
- : metadata(NULL)
 {
 	XOJ_INIT_TYPE(MetadataManager);
 
 	g_mutex_init(&this->mutex);
+	g_cond_init(&this->writeCond);
+
+	this->logFile = Util::getConfigFile("metadata/metadata.log").str();
+	load();
+
+	this->writer = g_thread_new("MetadataWriter", (GThreadFunc) writerThread, this);
 }
 
 MetadataManager::~MetadataManager()
 {
 	XOJ_CHECK_TYPE(MetadataManager);
 
-	documentChanged();
+	// The writer writes the pending entries before it stops
+	g_mutex_lock(&this->mutex);
+	this->stop = true;
+	g_cond_signal(&this->writeCond);
+	g_mutex_unlock(&this->mutex);
+
+	g_thread_join(this->writer);
+	this->writer = NULL;
+
+	g_cond_clear(&this->writeCond);
+	g_mutex_clear(&this->mutex);
 
 	XOJ_RELEASE_TYPE(MetadataManager);
 }
@@ -67,63 +96,224 @@ void MetadataManager::documentChanged()
 	XOJ_CHECK_TYPE(MetadataManager);
 
 	g_mutex_lock(&this->mutex);
-	MetadataEntry* m = metadata;
-	metadata = NULL;
+	if (!this->pending.empty())
+	{
+		this->flush = true;
+		g_cond_signal(&this->writeCond);
+	}
 	g_mutex_unlock(&this->mutex);
+}
+
+void MetadataManager::load()
+{
+	XOJ_CHECK_TYPE(MetadataManager);
+
+	int lock = lockLog();
+
+	if (!readLog())
+	{
+		migrateMetadataFiles();
+	}
+
+	unlockLog(lock);
+}
+
+int MetadataManager::lockLog()
+{
+	XOJ_CHECK_TYPE(MetadataManager);
+
+	// Not the log itself, it is replaced by the compaction
+	string lockFile = this->logFile + ".lock";
+
+	int fd = g_open(lockFile.c_str(), O_RDWR | O_CREAT, 0600);
+	if (fd == -1)
+	{
+		g_warning("Could not open the metadata lock file \"%s\"", lockFile.c_str());
+		return -1;
+	}
+
+#ifdef _WIN32
+	OVERLAPPED overlapped = { 0 };
+	bool locked = LockFileEx((HANDLE) _get_osfhandle(fd), LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped);
+#else
+	bool locked = flock(fd, LOCK_EX) == 0;
+#endif
+
+	if (!locked)
+	{
+		g_warning("Could not lock the metadata lock file \"%s\"", lockFile.c_str());
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+void MetadataManager::unlockLog(int fd)
+{
+	XOJ_CHECK_TYPE(MetadataManager);
 
-	if (m == NULL)
+	if (fd == -1)
 	{
 		return;
 	}
 
-	storeMetadata(m);
-	delete m;
+#ifdef _WIN32
+	OVERLAPPED overlapped = { 0 };
+	UnlockFileEx((HANDLE) _get_osfhandle(fd), 0, 1, 0, &overlapped);
+#else
+	flock(fd, LOCK_UN);
+#endif
+
+	close(fd);
+}
+
+bool MetadataManager::readLog()
+{
+	XOJ_CHECK_TYPE(MetadataManager);
+
+	bool complete = true;
+	if (!readLogFile(this->entries, this->logRecords, complete))
+	{
+		return false;
+	}
+
+	if (!complete)
+	{
+		// Records appended after a torn record could not be read, so the log is written again
+		g_warning("Metadata log \"%s\" was not written completely", this->logFile.c_str());
+
+		vector<MetadataEntry> all;
+		for (auto& e : this->entries)
+		{
+			all.push_back(e.second);
+		}
+		if (writeLog(all))
+		{
+			this->logRecords = all.size();
+		}
+	}
+
+	return true;
 }
 
-bool sortMetadata(MetadataEntry& a, MetadataEntry& b)
+bool MetadataManager::readLogFile(std::unordered_map<string, MetadataEntry>& entries, size_t& records, bool& complete)
 {
-	return a.time > b.time;
+	XOJ_CHECK_TYPE(MetadataManager);
+
+	ifstream in(this->logFile.c_str(), ios::binary);
+	if (!in)
+	{
+		return false;
+	}
+	in.imbue(locale::classic());
+
+	string line;
+	if (!getline(in, line) || line != LOG_HEADER)
+	{
+		g_warning("Invalid metadata log \"%s\", it is written again", this->logFile.c_str());
+		return false;
+	}
+
+	// The end of the last complete record
+	streamoff end = in.tellg();
+
+	while (true)
+	{
+		MetadataEntry entry;
+		size_t length = 0;
+		char separator = 0;
+
+		in >> entry.time >> entry.page >> entry.zoom >> length;
+		if (!in.get(separator) || separator != ':')
+		{
+			// End of the log, or a record torn by a crash
+			break;
+		}
+
+		entry.path.resize(length);
+		in.read(&entry.path[0], length);
+		if (!in.get(separator) || separator != '\n')
+		{
+			break;
+		}
+
+		entry.valid = true;
+		auto it = entries.find(entry.path);
+		if (it == entries.end() || it->second.time <= entry.time)
+		{
+			entries[entry.path] = entry;
+		}
+		records++;
+		end = in.tellg();
+	}
+
+	GStatBuf attrib;
+	complete = g_stat(this->logFile.c_str(), &attrib) != 0 || attrib.st_size == end;
+
+	return true;
 }
 
-/**
- * Load the metadata list (sorted)
- */
-vector<MetadataEntry> MetadataManager::loadList()
+void MetadataManager::migrateMetadataFiles()
 {
 	XOJ_CHECK_TYPE(MetadataManager);
 
 	Path folder = Util::getConfigSubfolder("metadata");
 
-	vector<MetadataEntry> data;
-
 	GError* error = NULL;
 	GDir* home = g_dir_open(folder.c_str(), 0, &error);
 	if (error != NULL)
 	{
 		XojMsgBox::showErrorToUser(NULL, error->message);
 		g_error_free(error);
-		return data;
+		return;
 	}
 
+	vector<string> files;
 	const gchar* file;
 	while ((file = g_dir_read_name(home)) != NULL)
 	{
+		if (!g_str_has_suffix(file, ".metadata"))
+		{
+			continue;
+		}
+
 		string path = folder.str();
 		path += "/";
 		path += file;
 
 		MetadataEntry entry = loadMetadataFile(path, file);
+		if (!entry.valid)
+		{
+			continue;
+		}
+		files.push_back(path);
 
-		if (entry.valid)
+		auto it = this->entries.find(entry.path);
+		if (it == this->entries.end() || it->second.time < entry.time)
 		{
-			data.push_back(entry);
+			this->entries[entry.path] = entry;
 		}
 	}
 	g_dir_close(home);
 
-	std::sort(data.begin(), data.end(), sortMetadata);
+	vector<MetadataEntry> all;
+	for (auto& e : this->entries)
+	{
+		all.push_back(e.second);
+	}
+
+	// The old files are only deleted if the log exists, else they are migrated next time
+	if (!writeLog(all))
+	{
+		return;
+	}
+	this->logRecords = all.size();
 
-	return data;
+	for (string& path : files)
+	{
+		deleteMetadataFile(path);
+	}
 }
 
 /**
@@ -134,7 +324,6 @@ MetadataEntry MetadataManager::loadMetadataFile(string path, string file)
 	XOJ_CHECK_TYPE(MetadataManager);
 
 	MetadataEntry entry;
-	entry.metadataFile = path;
 
 	string line;
 	ifstream infile(path.c_str());
@@ -208,56 +397,206 @@ MetadataEntry MetadataManager::getForFile(string file)
 {
 	XOJ_CHECK_TYPE(MetadataManager);
 
-	vector<MetadataEntry> files = loadList();
-
 	MetadataEntry entry;
-	for (MetadataEntry e : files)
+
+	g_mutex_lock(&this->mutex);
+	auto it = this->entries.find(file);
+	if (it != this->entries.end())
+	{
+		entry = it->second;
+	}
+	g_mutex_unlock(&this->mutex);
+
+	return entry;
+}
+
+void MetadataManager::writeRecord(ostream& out, const MetadataEntry& entry)
+{
+	// The stream has to use the C locale, the application uses the locale of the user
+	out << entry.time << " " << entry.page << " " << entry.zoom << " " << entry.path.size() << ":" << entry.path << "\n";
+}
+
+bool MetadataManager::writeLog(const vector<MetadataEntry>& entries)
+{
+	XOJ_CHECK_TYPE(MetadataManager);
+
+	string tmpFile = this->logFile + ".tmp";
+
+	ofstream out(tmpFile.c_str(), ios::binary | ios::trunc);
+	out.imbue(locale::classic());
+	out << LOG_HEADER << "\n";
+	for (const MetadataEntry& e : entries)
+	{
+		writeRecord(out, e);
+	}
+	out.close();
+
+	if (!out || g_rename(tmpFile.c_str(), this->logFile.c_str()) != 0)
+	{
+		g_warning("Could not write metadata log \"%s\"", this->logFile.c_str());
+		g_unlink(tmpFile.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+void MetadataManager::writePendingLocked()
+{
+	XOJ_CHECK_TYPE(MetadataManager);
+
+	vector<MetadataEntry> batch;
+	for (auto& e : this->pending)
+	{
+		batch.push_back(e.second);
+	}
+	this->pending.clear();
+
+	// Compact if most records are outdated
+	bool compact = this->logRecords + batch.size() > 2 * this->entries.size() + 100;
+
+	std::unordered_map<string, MetadataEntry> current;
+	if (compact)
+	{
+		current = this->entries;
+	}
+
+	// The disk is accessed without the lock, the UI thread is not blocked
+	g_mutex_unlock(&this->mutex);
+
+	int lock = lockLog();
+
+	bool written = false;
+	vector<MetadataEntry> all;
+	if (compact)
 	{
-		if (e.path == file)
+		// Other instances may have appended records since the log was read, they are kept
+		size_t records = 0;
+		bool complete = true;
+		std::unordered_map<string, MetadataEntry> logged;
+		readLogFile(logged, records, complete);
+
+		for (auto& e : logged)
 		{
-			entry = e;
-			break;
+			auto it = current.find(e.first);
+			if (it == current.end() || it->second.time < e.second.time)
+			{
+				current[e.first] = e.second;
+			}
+		}
+
+		for (auto& e : current)
+		{
+			all.push_back(e.second);
+		}
+
+		// Forget the documents which were not opened for the longest time
+		if (all.size() > MAX_ENTRIES)
+		{
+			std::sort(all.begin(), all.end(), [](const MetadataEntry& a, const MetadataEntry& b)
+			{
+				return a.time > b.time;
+			});
+			all.resize(MAX_ENTRIES);
+		}
+
+		written = writeLog(all);
+	}
+	else
+	{
+		ofstream out(this->logFile.c_str(), ios::binary | ios::app);
+		out.imbue(locale::classic());
+		if (out.tellp() == 0)
+		{
+			out << LOG_HEADER << "\n";
+		}
+		for (const MetadataEntry& e : batch)
+		{
+			writeRecord(out, e);
+		}
+		out.close();
+
+		written = (bool) out;
+		if (!written)
+		{
+			g_warning("Could not write metadata log \"%s\"", this->logFile.c_str());
 		}
 	}
 
-	for (int i = 20; i < (int)files.size(); i++)
+	unlockLog(lock);
+
+	g_mutex_lock(&this->mutex);
+
+	if (compact && written)
 	{
-		string path = files[i].metadataFile;
-		deleteMetadataFile(path);
+		// The entries of the other instances are taken over, the forgotten documents are removed,
+		// except if they were stored again meanwhile
+		std::unordered_map<string, MetadataEntry> kept;
+		for (MetadataEntry& e : all)
+		{
+			kept[e.path] = e;
+		}
+
+		for (auto it = this->entries.begin(); it != this->entries.end();)
+		{
+			if (kept.find(it->first) == kept.end() && this->pending.find(it->first) == this->pending.end())
+			{
+				it = this->entries.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+
+		for (auto& e : kept)
+		{
+			auto it = this->entries.find(e.first);
+			if (it == this->entries.end() || it->second.time < e.second.time)
+			{
+				this->entries[e.first] = e.second;
+			}
+		}
 	}
 
-	return entry;
+	if (written)
+	{
+		this->logRecords = compact ? all.size() : this->logRecords + batch.size();
+	}
 }
 
-/**
- * Store metadata to file
- */
-void MetadataManager::storeMetadata(MetadataEntry* m)
+gpointer MetadataManager::writerThread(MetadataManager* manager)
 {
-	vector<MetadataEntry> files = loadList();
-	for (MetadataEntry e : files)
+	g_mutex_lock(&manager->mutex);
+
+	while (true)
 	{
-		if (e.path == m->path)
+		while (manager->pending.empty() && !manager->stop)
+		{
+			g_cond_wait(&manager->writeCond, &manager->mutex);
+		}
+
+		// Wait for more changes, to write them at once
+		gint64 endTime = g_get_monotonic_time() + WRITE_DELAY_US;
+		while (!manager->stop && !manager->flush && g_cond_wait_until(&manager->writeCond, &manager->mutex, endTime))
+		{
+		}
+		manager->flush = false;
+
+		if (!manager->pending.empty())
+		{
+			manager->writePendingLocked();
+		}
+
+		if (manager->stop && manager->pending.empty())
 		{
-			// This is an old entry with the same path
-			deleteMetadataFile(e.metadataFile);
+			break;
 		}
 	}
 
-	Path folder = Util::getConfigSubfolder("metadata");
-	string path = folder.str();
-	path += "/";
-	gint64 time = g_get_real_time();
-	path += std::to_string(time);
-	path += ".metadata";
-
-	ofstream out;
-	out.open(path.c_str());
-	out << "XOJ-METADATA/1.0\n";
-	out << m->path << "\n";
-	out << "page=" << m->page << "\n";
-	out << "zoom=" << m->zoom << "\n";
-	out.close();
+	g_mutex_unlock(&manager->mutex);
+
+	return NULL;
 }
 
 /**
@@ -272,17 +611,18 @@ void MetadataManager::storeMetadata(string file, int page, double zoom)
 		return;
 	}
 
+	MetadataEntry entry;
+	entry.valid = true;
+	entry.path = file;
+	entry.zoom = zoom;
+	entry.page = page;
+	entry.time = g_get_real_time();
+
 	g_mutex_lock(&this->mutex);
-	if (metadata == NULL)
-	{
-		metadata = new MetadataEntry();
-	}
 
-	metadata->metadataFile = "";
-	metadata->valid = true;
-	metadata->path = file;
-	metadata->zoom = zoom;
-	metadata->page = page;
-	metadata->time = g_get_real_time();
+	this->entries[file] = entry;
+	this->pending[file] = entry;
+	g_cond_signal(&this->writeCond);
+
 	g_mutex_unlock(&this->mutex);
 }
@@ -13,13 +13,15 @@
 
 #include <XournalType.h>
 
+#include <ostream>
+#include <unordered_map>
+
 class MetadataEntry
 {
 public:
 	MetadataEntry();
 
 public:
-	string metadataFile;
 	bool valid;
 	string path;
 	double zoom;
@@ -27,6 +29,20 @@ public:
 	gint64 time;
 };
 
+/**
+ * The metadata of all documents is kept in memory, indexed by the path of the document, and
+ * stored in a single append-only log file. Changes are appended to the log by a writer thread,
+ * batched, so storing the metadata on each zoom change does not touch the disk on the UI thread.
+ *
+ * The log is compacted, written again with only the current entries, when most of its records
+ * are outdated. A record torn by a crash is only the last record of the log, and is ignored.
+ *
+ * Several instances of the application append to the same log. The log is only written while
+ * the lock file next to it is locked, and it is read again before it is compacted, so the records
+ * of the other instances are merged and not dropped.
+ *
+ * The .metadata files of older versions, one per document, are migrated to the log once.
+ */
 class MetadataManager
 {
 public:
@@ -50,6 +66,38 @@ public:
 	void documentChanged();
 
 private:
+	/**
+	 * Reads the log, or migrates the old metadata files if there is no log yet
+	 */
+	void load();
+
+	/**
+	 * @return false if there is no log file
+	 */
+	bool readLog();
+
+	/**
+	 * Reads the records of the log into entries, a record replaces an older record of the same document
+	 *
+	 * @param records Incremented for each record read
+	 * @param complete Set to false if the log ends with a torn record
+	 * @return false if there is no valid log file
+	 */
+	bool readLogFile(std::unordered_map<string, MetadataEntry>& entries, size_t& records, bool& complete);
+
+	/**
+	 * Locks the log against the other instances, blocks until it is unlocked by them
+	 *
+	 * @return The lock file, to pass to unlockLog(), -1 if it could not be locked
+	 */
+	int lockLog();
+	void unlockLog(int fd);
+
+	/**
+	 * Reads the .metadata files, one per document, of older versions into the log and deletes them
+	 */
+	void migrateMetadataFiles();
+
 	/**
 	 * Delete an old metadata file
 	 */
@@ -60,21 +108,66 @@ private:
 	 */
 	MetadataEntry loadMetadataFile(string path, string file);
 
+	static gpointer writerThread(MetadataManager* manager);
+
 	/**
-	 * Store metadata to file
+	 * Writes the pending entries, called by the writer thread with the mutex held
 	 */
-	void storeMetadata(MetadataEntry* m);
+	void writePendingLocked();
+
+	static void writeRecord(std::ostream& out, const MetadataEntry& entry);
 
-private:
 	/**
-	 * Load the metadata list (sorted)
+	 * Writes a new log with the entries
 	 */
-	vector<MetadataEntry> loadList();
-
+	bool writeLog(const vector<MetadataEntry>& entries);
 
 private:
 	XOJ_TYPE_ATTRIB;
 
+	/**
+	 * Protects all members
+	 */
 	GMutex mutex;
-	MetadataEntry* metadata;
+
+	/**
+	 * Wakes up the writer thread
+	 */
+	GCond writeCond;
+
+	GThread* writer = NULL;
+
+	/**
+	 * The entries of all documents, indexed by path
+	 */
+	std::unordered_map<string, MetadataEntry> entries;
+
+	/**
+	 * Entries changed since the last write, indexed by path
+	 */
+	std::unordered_map<string, MetadataEntry> pending;
+
+	/**
+	 * Records in the log, including records replaced by a newer record of the same document
+	 */
+	size_t logRecords = 0;
+
+	string logFile;
+
+	/**
+	 * Write the pending entries now, not after WRITE_DELAY_US
+	 */
+	bool flush = false;
+
+	bool stop = false;
+
+	/**
+	 * A zoom gesture changes the metadata many times per second, only the last change is written
+	 */
+	static const gint64 WRITE_DELAY_US = 2 * G_TIME_SPAN_SECOND;
+
+	/**
+	 * The count of most recently used documents kept at compaction
+	 */
+	static const size_t MAX_ENTRIES = 1000;
 };
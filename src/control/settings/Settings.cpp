@@ -1,9 +1,11 @@
 #include "Settings.h"
 
 #include "ButtonConfig.h"
+#include "SettingsWriter.h"
 #include "model/FormatDefinitions.h"
 
 #include <config.h>
+#include <config-debug.h>
 #include <i18n.h>
 #include <Util.h>
 #include <util/DeviceListHelper.h>
@@ -23,6 +25,7 @@ Settings::Settings(Path filename)
  : filename(filename)
 {
 	XOJ_INIT_TYPE(Settings);
+	this->writer = new SettingsWriter(filename);
 	loadDefault();
 }
 
@@ -30,6 +33,10 @@ Settings::~Settings()
 {
 	XOJ_CHECK_TYPE(Settings);
 
+	flush();
+	delete this->writer;
+	this->writer = NULL;
+
 	for (int i = 0; i < BUTTON_COUNT; i++)
 	{
 		delete this->buttonConfig[i];
@@ -128,6 +135,10 @@ void Settings::loadDefault()
 
 	this->pdfPageCacheSize = 10;
 
+	this->schedulerThreadCount = 0;
+
+	this->undoMemoryLimit = 256;
+
 	this->selectionBorderColor = 0xff0000; // red
 	this->selectionMarkerColor = 0x729FCF; // light blue
 
@@ -483,6 +494,14 @@ void Settings::parseItem(xmlDocPtr doc, xmlNodePtr cur)
 	{
 		this->pdfPageCacheSize = g_ascii_strtoll((const char*) value, NULL, 10);
 	}
+	else if (xmlStrcmp(name, (const xmlChar*) "schedulerThreadCount") == 0)
+	{
+		this->schedulerThreadCount = g_ascii_strtoll((const char*) value, NULL, 10);
+	}
+	else if (xmlStrcmp(name, (const xmlChar*) "undoMemoryLimit") == 0)
+	{
+		this->undoMemoryLimit = g_ascii_strtoll((const char*) value, NULL, 10);
+	}
 	else if (xmlStrcmp(name, (const xmlChar*) "selectionBorderColor") == 0)
 	{
 		this->selectionBorderColor = g_ascii_strtoll((const char*) value, NULL, 10);
@@ -632,6 +651,7 @@ void Settings::loadDeviceClasses()
 		inputDeviceClasses.insert(std::pair<string, std::pair<int, GdkInputSource>>(
 		        device.first, std::pair<int, GdkInputSource>(deviceClass, (GdkInputSource) deviceSource)));
 	}
+	this->deviceClassesVersion++;
 }
 
 void Settings::loadButtonConfig()
@@ -893,16 +913,64 @@ void Settings::save()
 		return;
 	}
 
+	if (this->saveRequests++ == 0)
+	{
+		this->firstSaveRequest = g_get_monotonic_time();
+	}
+
+	if (this->saveTimeoutId == 0)
+	{
+		this->saveTimeoutId = g_timeout_add(SAVE_DELAY_MS, (GSourceFunc) saveTimeout, this);
+	}
+}
+
+gboolean Settings::saveTimeout(Settings* settings)
+{
+	XOJ_CHECK_TYPE_OBJ(settings, Settings);
+
+	settings->saveTimeoutId = 0;
+
+	xmlDocPtr doc = settings->createDocument();
+	if (doc)
+	{
+		settings->writer->write(doc);
+	}
+
+	return false;
+}
+
+void Settings::flush()
+{
+	XOJ_CHECK_TYPE(Settings);
+
+	if (this->saveTimeoutId)
+	{
+		g_source_remove(this->saveTimeoutId);
+		saveTimeout(this);
+	}
+
+	this->writer->flush();
+
+#ifdef DEBUG_SETTINGS_SAVE
+	double minutes = MAX(1.0, (g_get_monotonic_time() - this->firstSaveRequest) / (60.0 * G_USEC_PER_SEC));
+	int writes = this->writer->getWriteCount();
+	g_message("Settings: %i save requests (%.1f / min), %i files written (%.1f / min)",
+			  this->saveRequests, this->saveRequests / minutes, writes, writes / minutes);
+#endif
+}
+
+xmlDocPtr Settings::createDocument()
+{
+	XOJ_CHECK_TYPE(Settings);
+
 	xmlDocPtr doc;
 	xmlNodePtr root;
 	xmlNodePtr xmlNode;
 
-	xmlIndentTreeOutput = TRUE;
-
 	doc = xmlNewDoc((const xmlChar*) "1.0");
 	if (doc == NULL)
 	{
-		return;
+		return NULL;
 	}
 
 	saveButtonConfig();
@@ -1011,6 +1079,12 @@ void Settings::save()
 	WRITE_INT_PROP(pdfPageCacheSize);
 	WRITE_COMMENT("The count of rendered PDF pages which will be cached.");
 
+	WRITE_INT_PROP(schedulerThreadCount);
+	WRITE_COMMENT("The count of threads for background rendering, 0 for one thread per CPU core. Applied on restart.");
+
+	WRITE_INT_PROP(undoMemoryLimit);
+	WRITE_COMMENT("The memory in MiB for the undo history, older actions are moved to a temporary file. 0 for no limit.");
+
 	WRITE_COMMENT("Config for new pages");
 	WRITE_STRING_PROP(pageTemplate);
 
@@ -1052,8 +1126,7 @@ void Settings::save()
 		saveData(root, p.first, p.second);
 	}
 
-	xmlSaveFormatFileEnc(filename.c_str(), doc, "UTF-8", 1);
-	xmlFreeDoc(doc);
+	return doc;
 }
 
 void Settings::saveData(xmlNodePtr root, string name, SElement& elem)
@@ -2199,6 +2272,44 @@ void Settings::setPdfPageCacheSize(int size)
 	save();
 }
 
+int Settings::getSchedulerThreadCount()
+{
+	XOJ_CHECK_TYPE(Settings);
+
+	return this->schedulerThreadCount;
+}
+
+void Settings::setSchedulerThreadCount(int count)
+{
+	XOJ_CHECK_TYPE(Settings);
+
+	if (this->schedulerThreadCount == count)
+	{
+		return;
+	}
+	this->schedulerThreadCount = count;
+	save();
+}
+
+int Settings::getUndoMemoryLimit()
+{
+	XOJ_CHECK_TYPE(Settings);
+
+	return this->undoMemoryLimit;
+}
+
+void Settings::setUndoMemoryLimit(int limit)
+{
+	XOJ_CHECK_TYPE(Settings);
+
+	if (this->undoMemoryLimit == limit)
+	{
+		return;
+	}
+	this->undoMemoryLimit = limit;
+	save();
+}
+
 int Settings::getBorderColor()
 {
 	XOJ_CHECK_TYPE(Settings);
@@ -2518,6 +2629,7 @@ void Settings::setDeviceClassForDevice(const string& deviceName, GdkInputSource
 		inputDeviceClasses.insert(std::pair<string, std::pair<int, GdkInputSource>>(
 		        deviceName, std::pair<int, GdkInputSource>(deviceClass, deviceSource)));
 	}
+	this->deviceClassesVersion++;
 }
 
 std::vector<InputDevice> Settings::getKnownInputDevices()
@@ -2530,6 +2642,13 @@ std::vector<InputDevice> Settings::getKnownInputDevices()
 	return inputDevices;
 }
 
+unsigned int Settings::getDeviceClassesVersion()
+{
+	XOJ_CHECK_TYPE(Settings);
+
+	return this->deviceClassesVersion;
+}
+
 int Settings::getDeviceClassForDevice(GdkDevice* device)
 {
 	return this->getDeviceClassForDevice(gdk_device_get_name(device), gdk_device_get_source(device));
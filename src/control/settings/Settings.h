@@ -125,6 +125,8 @@ private:
 	__RefSElement* element;
 };
 
+class SettingsWriter;
+
 class Settings
 {
 public:
@@ -135,10 +137,26 @@ public:
 	bool load();
 	void parseData(xmlNodePtr cur, SElement& elem);
 
+	/**
+	 * Saves the settings after SAVE_DELAY_MS, together with all changes until then.
+	 * The file is written in the background.
+	 */
 	void save();
 
+	/**
+	 * Saves pending changes and waits until the file is written, called on exit
+	 */
+	void flush();
+
 private:
 	void loadDefault();
+
+	/**
+	 * The settings as XML document, a snapshot for the writer
+	 */
+	xmlDocPtr createDocument();
+
+	static gboolean saveTimeout(Settings* settings);
 	void parseItem(xmlDocPtr doc, xmlNodePtr cur);
 
 	xmlNodePtr savePropertyDouble(const gchar* key, double value,
@@ -339,6 +357,12 @@ public:
 	int getPdfPageCacheSize();
 	void setPdfPageCacheSize(int size);
 
+	int getSchedulerThreadCount();
+	void setSchedulerThreadCount(int count);
+
+	int getUndoMemoryLimit();
+	void setUndoMemoryLimit(int limit);
+
 	string getPageTemplate();
 	void setPageTemplate(string pageTemplate);
 
@@ -380,6 +404,11 @@ public:
 	int getDeviceClassForDevice(const string& deviceName, GdkInputSource deviceSource);
 	std::vector<InputDevice> getKnownInputDevices();
 
+	/**
+	 * Changes if the class of a device was changed, to invalidate cached device classes
+	 */
+	unsigned int getDeviceClassesVersion();
+
 	/**
 	 * Get name, e.g. "cm"
 	 */
@@ -482,6 +511,28 @@ private:
 	 */
 	Path filename;
 
+	SettingsWriter* writer = NULL;
+
+	/**
+	 * The pending save, 0 if none
+	 */
+	guint saveTimeoutId = 0;
+
+	/**
+	 * Calls of save(), each of them wrote the file before it was delayed
+	 */
+	int saveRequests = 0;
+
+	/**
+	 * Time of the first call of save(), in microseconds
+	 */
+	gint64 firstSaveRequest = 0;
+
+	/**
+	 * Changes within this time are written at once
+	 */
+	static const guint SAVE_DELAY_MS = 500;
+
 private:
 	/**
 	 * The settings tree
@@ -731,6 +782,17 @@ private:
 	 */
 	int pdfPageCacheSize;
 
+	/**
+	 * The count of threads used for background jobs (rendering etc.), 0 for one thread per CPU core
+	 */
+	int schedulerThreadCount;
+
+	/**
+	 * The memory in MiB the undo history may use, older actions are moved to a temporary file
+	 * if it is exceeded. 0 for no limit
+	 */
+	int undoMemoryLimit;
+
 	/**
 	 * The color to draw borders on selected elements
 	 * (Page, insert image selection etc.)
@@ -835,6 +897,11 @@ private:
 
 	std::map<string, std::pair<int, GdkInputSource>> inputDeviceClasses = {};
 
+	/**
+	 * Incremented on each change of inputDeviceClasses
+	 */
+	unsigned int deviceClassesVersion = 0;
+
 	/**
 	 * "Transaction" running, do not save until the end is reached
 	 */
@@ -0,0 +1,129 @@
+#include "SettingsWriter.h"
+
+#include <glib/gstdio.h>
+
+SettingsWriter::SettingsWriter(Path filename)
+ : filename(filename)
+{
+	XOJ_INIT_TYPE(SettingsWriter);
+
+	g_mutex_init(&this->mutex);
+	g_cond_init(&this->cond);
+}
+
+SettingsWriter::~SettingsWriter()
+{
+	XOJ_CHECK_TYPE(SettingsWriter);
+
+	// The pending document is written before the thread stops
+	g_mutex_lock(&this->mutex);
+	this->stop = true;
+	g_cond_broadcast(&this->cond);
+	g_mutex_unlock(&this->mutex);
+
+	if (this->thread)
+	{
+		g_thread_join(this->thread);
+		this->thread = NULL;
+	}
+
+	g_cond_clear(&this->cond);
+	g_mutex_clear(&this->mutex);
+
+	XOJ_RELEASE_TYPE(SettingsWriter);
+}
+
+void SettingsWriter::write(xmlDocPtr doc)
+{
+	XOJ_CHECK_TYPE(SettingsWriter);
+
+	g_mutex_lock(&this->mutex);
+
+	if (this->pending)
+	{
+		xmlFreeDoc(this->pending);
+	}
+	this->pending = doc;
+
+	if (this->thread == NULL)
+	{
+		this->thread = g_thread_new("SettingsWriter", (GThreadFunc) writerThread, this);
+	}
+
+	g_cond_broadcast(&this->cond);
+	g_mutex_unlock(&this->mutex);
+}
+
+void SettingsWriter::flush()
+{
+	XOJ_CHECK_TYPE(SettingsWriter);
+
+	g_mutex_lock(&this->mutex);
+	while (this->pending || this->writing)
+	{
+		g_cond_wait(&this->cond, &this->mutex);
+	}
+	g_mutex_unlock(&this->mutex);
+}
+
+int SettingsWriter::getWriteCount()
+{
+	XOJ_CHECK_TYPE(SettingsWriter);
+
+	g_mutex_lock(&this->mutex);
+	int count = this->writeCount;
+	g_mutex_unlock(&this->mutex);
+
+	return count;
+}
+
+void SettingsWriter::writeDocument(xmlDocPtr doc)
+{
+	XOJ_CHECK_TYPE(SettingsWriter);
+
+	// libxml2 globals are per thread
+	xmlIndentTreeOutput = TRUE;
+
+	string tmpFile = this->filename.str() + ".tmp";
+	if (xmlSaveFormatFileEnc(tmpFile.c_str(), doc, "UTF-8", 1) < 0 ||
+		g_rename(tmpFile.c_str(), this->filename.c_str()) != 0)
+	{
+		g_warning("Could not write settings file \"%s\"", this->filename.c_str());
+		g_unlink(tmpFile.c_str());
+	}
+}
+
+gpointer SettingsWriter::writerThread(SettingsWriter* writer)
+{
+	g_mutex_lock(&writer->mutex);
+
+	while (true)
+	{
+		while (writer->pending == NULL && !writer->stop)
+		{
+			g_cond_wait(&writer->cond, &writer->mutex);
+		}
+
+		if (writer->pending == NULL)
+		{
+			break;
+		}
+
+		xmlDocPtr doc = writer->pending;
+		writer->pending = NULL;
+		writer->writing = true;
+		g_mutex_unlock(&writer->mutex);
+
+		writer->writeDocument(doc);
+		xmlFreeDoc(doc);
+
+		g_mutex_lock(&writer->mutex);
+		writer->writing = false;
+		writer->writeCount++;
+		g_cond_broadcast(&writer->cond);
+	}
+
+	g_mutex_unlock(&writer->mutex);
+
+	return NULL;
+}
@@ -0,0 +1,85 @@
+/*
+ * Xournal++
+ *
+ * Writes the settings file in the background
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <Path.h>
+#include <XournalType.h>
+
+#include <libxml/xmlreader.h>
+
+/**
+ * Writes settings documents on its own thread, atomically: to a temporary file, which is then
+ * renamed to the settings file. If a new document is passed while the previous one is not written
+ * yet, only the new one is written.
+ */
+class SettingsWriter
+{
+public:
+	SettingsWriter(Path filename);
+	virtual ~SettingsWriter();
+
+private:
+	SettingsWriter(const SettingsWriter& writer);
+	void operator=(const SettingsWriter& writer);
+
+public:
+	/**
+	 * Writes the document in the background, takes the ownership of the document
+	 */
+	void write(xmlDocPtr doc);
+
+	/**
+	 * Waits until all documents are written
+	 */
+	void flush();
+
+	/**
+	 * @return The count of files written
+	 */
+	int getWriteCount();
+
+private:
+	static gpointer writerThread(SettingsWriter* writer);
+
+	void writeDocument(xmlDocPtr doc);
+
+private:
+	XOJ_TYPE_ATTRIB;
+
+	Path filename;
+
+	GMutex mutex;
+
+	/**
+	 * Signaled if there is a document to write, or a document is written
+	 */
+	GCond cond;
+
+	/**
+	 * Started with the first write
+	 */
+	GThread* thread = NULL;
+
+	/**
+	 * The document to write next
+	 */
+	xmlDocPtr pending = NULL;
+
+	/**
+	 * A document is written at the moment
+	 */
+	bool writing = false;
+
+	bool stop = false;
+
+	int writeCount = 0;
+};
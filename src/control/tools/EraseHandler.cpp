@@ -65,7 +65,7 @@ void EraseHandler::erase(double x, double y)
 
 	Layer* l = page->getSelectedLayer();
 
-	vector<Element*> tmp(*l->getElements());
+	vector<Element*> tmp = l->getElementsInArea(eraserRect.x, eraserRect.y, eraserRect.width, eraserRect.height);
 	for (Element* e : tmp)
 	{
 		if (e->getType() == ELEMENT_STROKE && e->intersectsArea(&eraserRect))
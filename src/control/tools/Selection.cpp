@@ -60,7 +60,7 @@ bool RectSelection::finalize(PageRef page)
 	this->page = page;
 
 	Layer* l = page->getSelectedLayer();
-	for (Element* e : *l->getElements())
+	for (Element* e : l->getElementsInArea(this->x1, this->y1, this->x2 - this->x1, this->y2 - this->y1))
 	{
 		if (e->isInSelection(this))
 		{
@@ -89,6 +89,22 @@ bool RectSelection::contains(double x, double y)
 	return true;
 }
 
+ShapeContainment RectSelection::containsArea(double x, double y, double width, double height)
+{
+	XOJ_CHECK_TYPE(RectSelection);
+
+	if (x > this->x2 || x + width < this->x1 || y > this->y2 || y + height < this->y1)
+	{
+		return SHAPE_OUTSIDE;
+	}
+	if (x >= this->x1 && x + width <= this->x2 && y >= this->y1 && y + height <= this->y2)
+	{
+		return SHAPE_INSIDE;
+	}
+
+	return SHAPE_PARTIAL;
+}
+
 void RectSelection::currentPos(double x, double y)
 {
 	XOJ_CHECK_TYPE(RectSelection);
@@ -140,37 +156,15 @@ void RectSelection::paint(cairo_t* cr, GdkRectangle* rect, double zoom)
 
 //////////////////////////////////////////////////////////
 
-class RegionPoint
-{
-public:
-	RegionPoint(double x, double y)
-	{
-		this->x = x;
-		this->y = y;
-	}
-
-	double x;
-	double y;
-};
-
 RegionSelect::RegionSelect(double x, double y, Redrawable* view) : Selection(view)
 {
 	XOJ_INIT_TYPE(RegionSelect);
 
-	this->points = NULL;
 	currentPos(x, y);
 }
 
 RegionSelect::~RegionSelect()
 {
-	XOJ_CHECK_TYPE(RegionSelect);
-
-	for (GList* l = this->points; l != NULL; l = l->next)
-	{
-		delete (RegionPoint*) l->data;
-	}
-	g_list_free(this->points);
-
 	XOJ_RELEASE_TYPE(RegionSelect);
 }
 
@@ -178,8 +172,10 @@ void RegionSelect::paint(cairo_t* cr, GdkRectangle* rect, double zoom)
 {
 	XOJ_CHECK_TYPE(RegionSelect);
 
+	const vector<Point>& points = this->polygon.getPoints();
+
 	// at least three points needed
-	if (this->points && this->points->next && this->points->next->next)
+	if (points.size() >= 3)
 	{
 		GtkColorWrapper selectionColor = view->getSelectionColor();
 
@@ -187,16 +183,12 @@ void RegionSelect::paint(cairo_t* cr, GdkRectangle* rect, double zoom)
 		cairo_set_line_width(cr, 1 / zoom);
 		selectionColor.apply(cr);
 
-		RegionPoint* r0 = (RegionPoint*) this->points->data;
-		cairo_move_to(cr, r0->x, r0->y);
-
-		for (GList* l = this->points->next; l != NULL; l = l->next)
+		cairo_move_to(cr, points[0].x, points[0].y);
+		for (size_t i = 1; i < points.size(); i++)
 		{
-			RegionPoint* r = (RegionPoint*) l->data;
-			cairo_line_to(cr, r->x, r->y);
+			cairo_line_to(cr, points[i].x, points[i].y);
 		}
-
-		cairo_line_to(cr, r0->x, r0->y);
+		cairo_close_path(cr);
 
 		cairo_stroke_preserve(cr);
 		selectionColor.applyWithAlpha(cr, 0.3);
@@ -208,40 +200,12 @@ void RegionSelect::currentPos(double x, double y)
 {
 	XOJ_CHECK_TYPE(RegionSelect);
 
-	this->points = g_list_append(this->points, new RegionPoint(x, y));
+	this->polygon.addPoint(x, y);
 
 	// at least three points needed
-	if (this->points && this->points->next && this->points->next->next)
+	if (this->polygon.getPoints().size() >= 3)
 	{
-
-		RegionPoint* r0 = (RegionPoint*) this->points->data;
-		double ax = r0->x;
-		double bx = r0->x;
-		double ay = r0->y;
-		double by = r0->y;
-
-		for (GList* l = this->points; l != NULL; l = l->next)
-		{
-			RegionPoint* r = (RegionPoint*) l->data;
-			if (ax > r->x)
-			{
-				ax = r->x;
-			}
-			if (bx < r->x)
-			{
-				bx = r->x;
-			}
-			if (ay > r->y)
-			{
-				ay = r->y;
-			}
-			if (by < r->y)
-			{
-				by = r->y;
-			}
-		}
-
-		view->repaintArea(ax, ay, bx, by);
+		view->repaintArea(this->polygon.getX1(), this->polygon.getY1(), this->polygon.getX2(), this->polygon.getY2());
 	}
 }
 
@@ -249,94 +213,14 @@ bool RegionSelect::contains(double x, double y)
 {
 	XOJ_CHECK_TYPE(RegionSelect);
 
-	if (x < this->x1Box || x > this->x2Box)
-	{
-		return false;
-	}
-	if (y < this->y1Box || y > this->y2Box)
-	{
-		return false;
-	}
-	if (this->points == NULL || this->points->next == NULL)
-	{
-		return false;
-	}
-
-	int hits = 0;
-
-	RegionPoint* last = (RegionPoint*) g_list_last(this->points)->data;
-
-	double lastx = last->x;
-	double lasty = last->y;
-	double curx, cury;
-
-	// Walk the edges of the polygon
-	for (GList* l = this->points; l != NULL; lastx = curx, lasty = cury, l = l->next)
-	{
-		RegionPoint* last = (RegionPoint*) l->data;
-		curx = last->x;
-		cury = last->y;
-
-		if (cury == lasty)
-		{
-			continue;
-		}
-
-		int leftx;
-		if (curx < lastx)
-		{
-			if (x >= lastx)
-			{
-				continue;
-			}
-			leftx = curx;
-		}
-		else
-		{
-			if (x >= curx)
-			{
-				continue;
-			}
-			leftx = lastx;
-		}
-
-		double test1, test2;
-		if (cury < lasty)
-		{
-			if (y < cury || y >= lasty)
-			{
-				continue;
-			}
-			if (x < leftx)
-			{
-				hits++;
-				continue;
-			}
-			test1 = x - curx;
-			test2 = y - cury;
-		}
-		else
-		{
-			if (y < lasty || y >= cury)
-			{
-				continue;
-			}
-			if (x < leftx)
-			{
-				hits++;
-				continue;
-			}
-			test1 = x - lastx;
-			test2 = y - lasty;
-		}
+	return this->polygon.contains(x, y);
+}
 
-		if (test1 < (test2 / (lasty - cury) * (lastx - curx)))
-		{
-			hits++;
-		}
-	}
+ShapeContainment RegionSelect::containsArea(double x, double y, double width, double height)
+{
+	XOJ_CHECK_TYPE(RegionSelect);
 
-	return (hits & 1) != 0;
+	return this->polygon.containsArea(x, y, width, height);
 }
 
 bool RegionSelect::finalize(PageRef page)
@@ -345,36 +229,15 @@ bool RegionSelect::finalize(PageRef page)
 
 	this->page = page;
 
-	this->x1Box = 0;
-	this->x2Box = 0;
-	this->y1Box = 0;
-	this->y2Box = 0;
-
-	for (GList* l = this->points; l != NULL; l = l->next)
-	{
-		RegionPoint* p = (RegionPoint*) l->data;
-
-		if (p->x < this->x1Box)
-		{
-			this->x1Box = p->x;
-		}
-		else if (p->x > this->x2Box)
-		{
-			this->x2Box = p->x;
-		}
-
-		if (p->y < this->y1Box)
-		{
-			this->y1Box = p->y;
-		}
-		else if (p->y > this->y2Box)
-		{
-			this->y2Box = p->y;
-		}
-	}
+	this->x1Box = this->polygon.getX1();
+	this->x2Box = this->polygon.getX2();
+	this->y1Box = this->polygon.getY1();
+	this->y2Box = this->polygon.getY2();
 
 	Layer* l = page->getSelectedLayer();
-	for (Element* e : *l->getElements())
+	double boxWidth = this->x2Box - this->x1Box;
+	double boxHeight = this->y2Box - this->y1Box;
+	for (Element* e : l->getElementsInArea(this->x1Box, this->y1Box, boxWidth, boxHeight))
 	{
 		if (e->isInSelection(this))
 		{
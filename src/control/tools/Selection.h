@@ -14,6 +14,7 @@
 #include "gui/Redrawable.h"
 #include "model/Element.h"
 #include "model/PageRef.h"
+#include "model/PolygonShape.h"
 
 #include <Util.h>
 #include <XournalType.h>
@@ -56,6 +57,7 @@ public:
 	virtual void paint(cairo_t* cr, GdkRectangle* rect, double zoom);
 	virtual void currentPos(double x, double y);
 	virtual bool contains(double x, double y);
+	virtual ShapeContainment containsArea(double x, double y, double width, double height);
 
 private:
 	XOJ_TYPE_ATTRIB;
@@ -85,9 +87,10 @@ public:
 	virtual void paint(cairo_t* cr, GdkRectangle* rect, double zoom);
 	virtual void currentPos(double x, double y);
 	virtual bool contains(double x, double y);
+	virtual ShapeContainment containsArea(double x, double y, double width, double height);
 
 private:
 	XOJ_TYPE_ATTRIB;
 
-	GList* points;
+	PolygonShape polygon;
 };
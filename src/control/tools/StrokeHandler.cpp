@@ -21,8 +21,7 @@ guint32 StrokeHandler::lastStrokeTime;  // persist for next stroke
 
 StrokeHandler::StrokeHandler(XournalView* xournal, XojPageView* redrawable, PageRef page)
  : InputHandler(xournal, redrawable, page)
- , surfMask(nullptr)
- , crMask(nullptr)
+ , liveView(nullptr)
  , reco(nullptr)
 {
 	XOJ_INIT_TYPE(StrokeHandler);
@@ -48,17 +47,7 @@ void StrokeHandler::draw(cairo_t* cr)
 		return;
 	}
 
-	view.applyColor(cr, stroke);
-
-	if (stroke->getToolType() == STROKE_TOOL_HIGHLIGHTER) {
-		cairo_set_operator(cr, CAIRO_OPERATOR_MULTIPLY);
-	}
-	else
-	{
-		cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
-	}
-
-	cairo_mask_surface(cr, surfMask, 0, 0);
+	liveView->paint(cr);
 }
 
 
@@ -99,45 +88,8 @@ bool StrokeHandler::onMotionNotifyEvent(const PositionInputData& pos)
 
 	stroke->addPoint(currentPoint);
 
-	if ((stroke->getFill() != -1 || stroke->getLineStyle().hasDashes()) &&
-	    !(stroke->getFill() != -1 && stroke->getToolType() == STROKE_TOOL_HIGHLIGHTER))
-	{
-		// Clear surface
-
-		// for debugging purposes
-		// cairo_set_source_rgba(crMask, 1, 0, 0, 1);
-		cairo_set_source_rgba(crMask, 0, 0, 0, 0);
-		cairo_rectangle(
-		        crMask, 0, 0, cairo_image_surface_get_width(surfMask), cairo_image_surface_get_height(surfMask));
-		cairo_fill(crMask);
-
-		view.drawStroke(crMask, stroke, 0, 1, true, true);
-	}
-	else
-	{
-		if (pointCount > 0)
-		{
-			Point prevPoint(stroke->getPoint(pointCount - 1));
-
-			Stroke lastSegment;
-
-			lastSegment.addPoint(prevPoint);
-			lastSegment.addPoint(currentPoint);
-			lastSegment.setWidth(stroke->getWidth());
-
-			cairo_set_operator(crMask, CAIRO_OPERATOR_OVER);
-			cairo_set_source_rgba(crMask, 1, 1, 1, 1);
-
-			view.drawStroke(crMask, &lastSegment, 0, 1, false);
-		}
-	}
-
-	const double w = stroke->getWidth();
-
-	this->redrawable->repaintRect(stroke->getX() - w,
-	                              stroke->getY() - w,
-	                              stroke->getElementWidth() + 2 * w,
-	                              stroke->getElementHeight() + 2 * w);
+	Range range = liveView->drawLastSegment();
+	this->redrawable->repaintRange(range);
 
 	return true;
 }
@@ -245,7 +197,7 @@ void StrokeHandler::onButtonReleaseEvent(const PositionInputData& pos)
 		// If the stroke has fill values, it needs to be re-rendered
 		// else the fill will not be visible.
 
-		view.drawStroke(crMask, stroke, 0, 1, true, true);
+		liveView->drawStroke(view);
 	}
 
 	layer->addElement(stroke);
@@ -311,19 +263,6 @@ void StrokeHandler::onButtonPressEvent(const PositionInputData& pos)
 	double width = page->getWidth() * zoom * dpiScaleFactor;
 	double height = page->getHeight() * zoom * dpiScaleFactor;
 
-	surfMask = cairo_image_surface_create(CAIRO_FORMAT_A8, width, height);
-
-	crMask = cairo_create(surfMask);
-
-	// for debugging purposes
-	// cairo_set_source_rgba(crMask, 0, 0, 0, 1);
-	cairo_set_source_rgba(crMask, 0, 0, 0, 0);
-	cairo_rectangle(crMask, 0, 0, width, height);
-
-	cairo_fill(crMask);
-
-	cairo_scale(crMask, zoom * dpiScaleFactor, zoom * dpiScaleFactor);
-
 	if (!stroke)
 	{
 		this->buttonDownPoint.x = pos.x / zoom;
@@ -332,6 +271,8 @@ void StrokeHandler::onButtonPressEvent(const PositionInputData& pos)
 		createStroke(Point(this->buttonDownPoint.x, this->buttonDownPoint.y));
 	}
 
+	liveView = new LiveStrokeView(stroke, width, height, zoom * dpiScaleFactor);
+
 	this->startStrokeTime = pos.timestamp;
 }
 
@@ -339,13 +280,8 @@ void StrokeHandler::destroySurface()
 {
 	XOJ_CHECK_TYPE(StrokeHandler);
 
-	if (surfMask || crMask)
-	{
-		cairo_destroy(crMask);
-		cairo_surface_destroy(surfMask);
-		surfMask = nullptr;
-		crMask = nullptr;
-	}
+	delete liveView;
+	liveView = nullptr;
 }
 
 void StrokeHandler::resetShapeRecognizer()
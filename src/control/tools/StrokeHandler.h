@@ -14,17 +14,19 @@
 #include "InputHandler.h"
 
 #include "view/DocumentView.h"
+#include "view/LiveStrokeView.h"
 
 class ShapeRecognizer;
 
 /**
  * @brief The stroke handler draws a stroke on a XojPageView
  * 
- * The stroke is drawn using a cairo_surface_t* as a mask:
+ * The stroke is drawn using cairo_surface_t* masks, see LiveStrokeView:
  * As the pointer moves on the canvas single segments are
  * drawn opaquely on the initially transparent masking
  * surface. The surface is used to mask the stroke
- * when drawing it to the XojPageView
+ * when drawing it to the XojPageView. Only the area of
+ * the new segment is repainted.
  */
 class StrokeHandler : public InputHandler
 {
@@ -54,14 +56,9 @@ private:
 	XOJ_TYPE_ATTRIB;
 
 	/**
-	 * The masking surface
+	 * The masking surfaces
 	 */
-	cairo_surface_t* surfMask;
-
-	/**
-	 * And the corresponding cairo_t*
-	 */
-	cairo_t* crMask;
+	LiveStrokeView* liveView;
 
 	DocumentView view;
 
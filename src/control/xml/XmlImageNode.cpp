@@ -1,5 +1,7 @@
 #include "XmlImageNode.h"
 
+#include <algorithm>
+
 XmlImageNode::XmlImageNode(const char* tag) : XmlNode(tag)
 {
 	XOJ_INIT_TYPE(XmlImageNode);
@@ -32,6 +34,13 @@ void XmlImageNode::setImage(cairo_surface_t* img)
 	this->img = cairo_surface_reference(img);
 }
 
+void XmlImageNode::setImageData(std::shared_ptr<const string> png)
+{
+	XOJ_CHECK_TYPE(XmlImageNode);
+
+	this->png = std::move(png);
+}
+
 cairo_status_t XmlImageNode::pngWriteFunction(XmlImageNode* image, unsigned char* data, unsigned int length)
 {
 	for (unsigned int i = 0; i < length; i++, image->pos++)
@@ -59,7 +68,19 @@ void XmlImageNode::writeOut(OutputStream* out)
 
 	out->write(">");
 
-	if (this->img == NULL)
+	if (this->png)
+	{
+		// Encoded in blocks, a multiple of 3 bytes so there is no padding in between
+		const gsize BLOCK_SIZE = 3 * 1024;
+		for (gsize start = 0; start < this->png->length(); start += BLOCK_SIZE)
+		{
+			gsize length = std::min(BLOCK_SIZE, this->png->length() - start);
+			gchar* base64_str = g_base64_encode((const guchar*) this->png->data() + start, length);
+			out->write(base64_str);
+			g_free(base64_str);
+		}
+	}
+	else if (this->img == NULL)
 	{
 		g_error("XmlImageNode::writeOut(); this->img == NULL");
 	}
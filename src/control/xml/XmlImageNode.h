@@ -13,6 +13,8 @@
 
 #include "XmlNode.h"
 
+#include <memory>
+
 class XmlImageNode : public XmlNode
 {
 public:
@@ -22,6 +24,11 @@ public:
 public:
 	void setImage(cairo_surface_t* img);
 
+	/**
+	 * Writes the already PNG encoded image, instead of encoding an image
+	 */
+	void setImageData(std::shared_ptr<const string> png);
+
 	static cairo_status_t pngWriteFunction(XmlImageNode* image, unsigned char* data, unsigned int length);
 
 	virtual void writeOut(OutputStream* out);
@@ -30,6 +37,7 @@ private:
 	XOJ_TYPE_ATTRIB;
 
 	cairo_surface_t* img;
+	std::shared_ptr<const string> png;
 
 	OutputStream* out;
 	int pos;
@@ -132,6 +132,36 @@ void XmlNode::writeOut(OutputStream* out, ProgressListener* listener)
 	}
 }
 
+void XmlNode::writeOpenTag(OutputStream* out)
+{
+	XOJ_CHECK_TYPE(XmlNode);
+
+	out->write("<");
+	out->write(tag);
+	writeAttributes(out);
+	out->write(">\n");
+}
+
+void XmlNode::writeChildrenOut(OutputStream* out)
+{
+	XOJ_CHECK_TYPE(XmlNode);
+
+	for (GList* l = this->children; l != NULL; l = l->next)
+	{
+		XmlNode* node = (XmlNode*) l->data;
+		node->writeOut(out);
+	}
+}
+
+void XmlNode::writeCloseTag(OutputStream* out)
+{
+	XOJ_CHECK_TYPE(XmlNode);
+
+	out->write("</");
+	out->write(tag);
+	out->write(">\n");
+}
+
 void XmlNode::addChild(XmlNode* node)
 {
 	XOJ_CHECK_TYPE(XmlNode);
@@ -139,6 +169,13 @@ void XmlNode::addChild(XmlNode* node)
 	this->children = g_list_append(this->children, node);
 }
 
+GList* XmlNode::getChildren()
+{
+	XOJ_CHECK_TYPE(XmlNode);
+
+	return this->children;
+}
+
 void XmlNode::putAttrib(XMLAttribute* a)
 {
 	XOJ_CHECK_TYPE(XmlNode);
@@ -47,8 +47,20 @@ public:
 		writeOut(out, NULL);
 	}
 
+	/**
+	 * Write the parts of the node separately, used to write a document from cached pieces
+	 */
+	void writeOpenTag(OutputStream* out);
+	void writeChildrenOut(OutputStream* out);
+	void writeCloseTag(OutputStream* out);
+
 	void addChild(XmlNode* node);
 
+	/**
+	 * The child nodes, owned by this node
+	 */
+	GList* getChildren();
+
 protected:
 	void putAttrib(XMLAttribute* a);
 	void writeAttributes(OutputStream* out);
@@ -0,0 +1,209 @@
+#include "AutosaveHandler.h"
+
+#include "control/Control.h"
+#include "control/xml/XmlNode.h"
+
+#include <i18n.h>
+
+#include <glib/gstdio.h>
+
+#include <cstdio>
+
+AutosaveHandler::AutosaveHandler(Control* control)
+ : control(control)
+{
+	XOJ_INIT_TYPE(AutosaveHandler);
+
+	registerListener(control);
+}
+
+AutosaveHandler::~AutosaveHandler()
+{
+	XOJ_CHECK_TYPE(AutosaveHandler);
+
+	unregisterListener();
+
+	this->order.clear();
+	this->pages.clear();
+
+	delete this->snapshot;
+	this->snapshot = NULL;
+
+	XOJ_RELEASE_TYPE(AutosaveHandler);
+}
+
+void AutosaveHandler::takeSnapshot(Document* doc)
+{
+	XOJ_CHECK_TYPE(AutosaveHandler);
+
+	delete this->snapshot;
+	this->snapshot = doc->createSnapshot(false);
+	this->order.clear();
+
+	bool copyAll = g_atomic_int_compare_and_exchange(&this->copyAllPages, 1, 0);
+	if (++this->generation % COMPACTION_INTERVAL == 0)
+	{
+		copyAll = true;
+	}
+
+	bool firstPdfPageVisited = false;
+	for (size_t i = 0; i < doc->getPageCount(); i++)
+	{
+		PageRef p = doc->getPage(i);
+		bool pdfPage = p->getBackgroundType().isPdfPage();
+		bool firstPdfPage = pdfPage && !firstPdfPageVisited;
+		firstPdfPageVisited = firstPdfPageVisited || pdfPage;
+
+		int changeId = p->getChangeId();
+
+		PageEntry& entry = this->pages[(XojPage*) p];
+		bool copy = copyAll || entry.data.empty() || !entry.cacheable || firstPdfPage || entry.changeId != changeId;
+
+		entry.page = p;
+		entry.generation = this->generation;
+		entry.id = i;
+
+		if (copy)
+		{
+			entry.changeId = changeId;
+			entry.copy = p->clone();
+			entry.cacheable = !p->getBackgroundType().isImagePage() && !firstPdfPage;
+
+			// Only the copied pages are part of the snapshot, e.g. for clearing the save state of background images
+			this->snapshot->addPage(entry.copy);
+		}
+
+		this->order.push_back(&entry);
+	}
+
+	// Remove the pages which are not part of the document anymore
+	for (auto it = this->pages.begin(); it != this->pages.end();)
+	{
+		if (it->second.generation != this->generation)
+		{
+			it = this->pages.erase(it);
+		}
+		else
+		{
+			it++;
+		}
+	}
+}
+
+void AutosaveHandler::prepareAutosave()
+{
+	XOJ_CHECK_TYPE(AutosaveHandler);
+
+	this->errorMessage = "";
+	this->serializedPageCount = 0;
+
+	prepareRoot(this->snapshot);
+
+	GzMemoryOutputStream headerOut;
+	headerOut.write("<?xml version=\"1.0\" standalone=\"no\"?>\n");
+	this->root->writeOpenTag(&headerOut);
+	this->root->writeChildrenOut(&headerOut);
+	headerOut.close();
+	this->header = headerOut.getData();
+
+	for (PageEntry* entry : this->order)
+	{
+		if (!entry->copy.isValid())
+		{
+			continue;
+		}
+
+		// Visit the page into an own root, so only the <page> node is written
+		XmlNode pageRoot("xournal");
+		visitPage(&pageRoot, entry->copy, this->snapshot, entry->id);
+
+		GzMemoryOutputStream out;
+		pageRoot.writeChildrenOut(&out);
+		out.close();
+		entry->data = out.getData();
+		entry->copy = NULL;
+
+		this->serializedPageCount++;
+	}
+
+	if (this->footer.empty())
+	{
+		GzMemoryOutputStream footerOut;
+		this->root->writeCloseTag(&footerOut);
+		footerOut.close();
+		this->footer = footerOut.getData();
+	}
+}
+
+void AutosaveHandler::saveAutosaveTo(Path filename)
+{
+	XOJ_CHECK_TYPE(AutosaveHandler);
+
+	FILE* fp = g_fopen(filename.c_str(), "wb");
+	if (fp == NULL)
+	{
+		this->errorMessage = FS(_F("Error opening file: \"{1}\"") % filename.str());
+		return;
+	}
+
+	bool ok = fwrite(this->header.data(), 1, this->header.size(), fp) == this->header.size();
+	for (PageEntry* entry : this->order)
+	{
+		if (!ok)
+		{
+			break;
+		}
+		ok = fwrite(entry->data.data(), 1, entry->data.size(), fp) == entry->data.size();
+	}
+	ok = ok && fwrite(this->footer.data(), 1, this->footer.size(), fp) == this->footer.size();
+
+	if (fclose(fp) != 0 || !ok)
+	{
+		this->errorMessage = FS(_F("Error writing file: \"{1}\"") % filename.str());
+		return;
+	}
+
+	writeBackgroundImages(filename);
+}
+
+int AutosaveHandler::getSerializedPageCount()
+{
+	XOJ_CHECK_TYPE(AutosaveHandler);
+
+	return this->serializedPageCount;
+}
+
+void AutosaveHandler::markPageChanged(size_t page)
+{
+	XOJ_CHECK_TYPE(AutosaveHandler);
+
+	PageRef p = this->control->getDocument()->getPage(page);
+	if (p.isValid())
+	{
+		p->contentChanged();
+	}
+}
+
+void AutosaveHandler::documentChanged(DocumentChangeType type)
+{
+	XOJ_CHECK_TYPE(AutosaveHandler);
+
+	if (type == DOCUMENT_CHANGE_CLEARED || type == DOCUMENT_CHANGE_COMPLETE)
+	{
+		g_atomic_int_set(&this->copyAllPages, 1);
+	}
+}
+
+void AutosaveHandler::pageSizeChanged(size_t page)
+{
+	XOJ_CHECK_TYPE(AutosaveHandler);
+
+	markPageChanged(page);
+}
+
+void AutosaveHandler::pageChanged(size_t page)
+{
+	XOJ_CHECK_TYPE(AutosaveHandler);
+
+	markPageChanged(page);
+}
@@ -0,0 +1,140 @@
+/*
+ * Xournal++
+ *
+ * Saves a document for autosave, reusing the unchanged pages of the last autosave
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include "SaveHandler.h"
+
+#include "model/DocumentListener.h"
+
+#include <XournalType.h>
+
+#include <unordered_map>
+
+class Control;
+
+/**
+ * Keeps every page as separately compressed gzip member. The autosave file is
+ * written as concatenation of these members, which is a regular gzipped .xopp file.
+ *
+ * Only the changed pages are copied into a snapshot (while the document is locked)
+ * and then serialized and compressed again (without lock). A page is changed if its
+ * change id differs, or if it was reported through the DocumentListener interface.
+ * Every COMPACTION_INTERVAL autosaves all pages are rebuilt, in case a change was
+ * not reported.
+ */
+class AutosaveHandler : public SaveHandler, public DocumentListener
+{
+public:
+	AutosaveHandler(Control* control);
+	virtual ~AutosaveHandler();
+
+public:
+	/**
+	 * Copies the changed pages, the document has to be locked
+	 */
+	void takeSnapshot(Document* doc);
+
+	/**
+	 * Serializes the header and the changed pages of the snapshot, the document does not need to be locked
+	 */
+	void prepareAutosave();
+
+	/**
+	 * Writes the prepared document, the document does not need to be locked
+	 */
+	void saveAutosaveTo(Path filename);
+
+	/**
+	 * The number of pages serialized by the last prepareAutosave()
+	 */
+	int getSerializedPageCount();
+
+	// DocumentListener interface
+public:
+	void documentChanged(DocumentChangeType type);
+	void pageSizeChanged(size_t page);
+	void pageChanged(size_t page);
+
+private:
+	void markPageChanged(size_t page);
+
+private:
+	XOJ_TYPE_ATTRIB;
+
+	struct PageEntry
+	{
+		/**
+		 * Keeps the page alive, so the key is not reused by another page
+		 */
+		PageRef page;
+
+		/**
+		 * The change id of the page when it was copied
+		 */
+		int changeId = 0;
+
+		/**
+		 * The copy to serialize, only set if the page changed
+		 */
+		PageRef copy;
+
+		/**
+		 * The page number when it was copied
+		 */
+		int id = 0;
+
+		/**
+		 * The compressed <page> node
+		 */
+		string data;
+
+		/**
+		 * The XML of image background pages and of the first PDF page depends on the
+		 * other pages, they are serialized with every autosave
+		 */
+		bool cacheable = false;
+
+		/**
+		 * Number of the autosave which used this entry
+		 */
+		int generation = 0;
+	};
+
+	Control* control = NULL;
+
+	/**
+	 * Document properties and the changed pages
+	 */
+	Document* snapshot = NULL;
+
+	/**
+	 * All pages are copied with the next snapshot, set from the main thread
+	 */
+	int copyAllPages = 0;
+
+	std::unordered_map<XojPage*, PageEntry> pages;
+
+	/**
+	 * The prepared document, in order
+	 */
+	string header;
+	vector<PageEntry*> order;
+	string footer;
+
+	int generation = 0;
+	int serializedPageCount = 0;
+
+	/**
+	 * All pages are serialized again every COMPACTION_INTERVAL autosaves
+	 */
+	static const int COMPACTION_INTERVAL = 10;
+};
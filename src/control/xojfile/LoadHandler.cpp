@@ -9,10 +9,15 @@
 #include <config.h>
 #include <GzUtil.h>
 #include <i18n.h>
+#include <StringUtils.h>
 
 #include <glib/gstdio.h>
 #include <gtk/gtk.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include <stdlib.h>
 
 #define error2(var, ...)																	\
@@ -52,6 +57,7 @@ LoadHandler::LoadHandler()
 	XOJ_INIT_TYPE(LoadHandler);
 
 	this->error = NULL;
+	g_mutex_init(&this->zipMutex);
 
 	initAttributes();
 }
@@ -63,6 +69,7 @@ LoadHandler::~LoadHandler()
 	{
 		g_hash_table_unref(this->audioFiles);
 	}
+	g_mutex_clear(&this->zipMutex);
 }
 
 void LoadHandler::initAttributes()
@@ -130,6 +137,13 @@ void LoadHandler::setPdfReplacement(string filename, bool attachToDocument)
 	this->pdfReplacementAttach = attachToDocument;
 }
 
+void LoadHandler::setThreadCount(int threadCount)
+{
+	XOJ_CHECK_TYPE(LoadHandler);
+
+	this->threadCount = threadCount;
+}
+
 bool LoadHandler::openFile(string filename)
 {
 	XOJ_CHECK_TYPE(LoadHandler);
@@ -240,49 +254,169 @@ zip_int64_t LoadHandler::readContentFile(char* buffer, zip_uint64_t len)
 	}
 }
 
-bool LoadHandler::parseXml()
+bool LoadHandler::readContent(string& content)
+{
+	XOJ_CHECK_TYPE(LoadHandler);
+
+	if (!this->isGzFile)
+	{
+		zip_stat_t contentStat;
+		if (zip_stat(this->zipFp, "content.xml", 0, &contentStat) == 0 && (contentStat.valid & ZIP_STAT_SIZE))
+		{
+			content.reserve(contentStat.size);
+		}
+	}
+
+	char buffer[64 * 1024];
+	zip_int64_t len = 0;
+	while ((len = readContentFile(buffer, sizeof(buffer))) >= 0)
+	{
+		content.append(buffer, len);
+	}
+
+	return !content.empty();
+}
+
+/**
+ * Finds the <page> elements in the document content, so they can be parsed independently.
+ *
+ * @return false if the content is not structured as expected, it has to be parsed sequentially then
+ */
+bool LoadHandler::findPageSegments(const string& content, vector<PageSegment>& segments)
+{
+	// Comments and CDATA sections may contain anything, Xournal++ does not write them
+	if (content.find("<!--") != string::npos || content.find("<![CDATA[") != string::npos)
+	{
+		return false;
+	}
+
+	// The first element has to be the root element
+	gsize rootStart = content.find('<');
+	while (rootStart != string::npos && content[rootStart + 1] == '?')
+	{
+		rootStart = content.find('<', rootStart + 1);
+	}
+
+	gsize pos = content.find("<page");
+	while (pos != string::npos)
+	{
+		char next = content[pos + 5];
+		if (!g_ascii_isspace(next) && next != '>' && next != '/')
+		{
+			pos = content.find("<page", pos + 5);
+			continue;
+		}
+
+		if (pos <= rootStart)
+		{
+			return false;
+		}
+
+		gsize tagEnd = content.find('>', pos);
+		if (tagEnd == string::npos)
+		{
+			return false;
+		}
+
+		gsize end = tagEnd + 1;
+		if (content[tagEnd - 1] != '/')
+		{
+			gsize close = content.find("</page", tagEnd);
+			gsize nested = content.find("<page", tagEnd);
+			if (close == string::npos || nested < close)
+			{
+				return false;
+			}
+
+			gsize closeEnd = content.find('>', close);
+			if (closeEnd == string::npos)
+			{
+				return false;
+			}
+			end = closeEnd + 1;
+		}
+
+		segments.push_back({ pos, end });
+		pos = content.find("<page", end);
+	}
+
+	return true;
+}
+
+/**
+ * Parses the content with the GMarkup parser
+ *
+ * @param parserError Set if the content is not valid, false if the content is only incomplete
+ */
+bool LoadHandler::parseBuffer(const char* data, gsize length, bool& parserError)
 {
 	XOJ_CHECK_TYPE(LoadHandler);
 
 	const GMarkupParser parser = { LoadHandler::parserStartElement, LoadHandler::parserEndElement, LoadHandler::parserText, NULL, NULL };
+	GMarkupParseContext* context = g_markup_parse_context_new(&parser, (GMarkupParseFlags) 0, this, NULL);
+
+	gboolean valid = g_markup_parse_context_parse(context, data, length, &this->error);
+	parserError = !valid || this->error != NULL;
+
+	if (!parserError)
+	{
+		valid = g_markup_parse_context_end_parse(context, &this->error);
+	}
+
+	g_markup_parse_context_free(context);
+
+	return valid && !parserError;
+}
+
+bool LoadHandler::parseXml()
+{
+	XOJ_CHECK_TYPE(LoadHandler);
+
 	this->error = NULL;
-	gboolean valid = true;
 
 	this->pos = PARSER_POS_NOT_STARTED;
 	this->creator = "Unknown";
 	this->fileVersion = 1;
 
-	GMarkupParseContext* context = g_markup_parse_context_new(&parser, (GMarkupParseFlags) 0, this, NULL);
+	string content;
+	readContent(content);
 
-	zip_int64_t len = 0;
-	do
+	bool parserError = false;
+	bool valid = false;
+
+	vector<PageSegment> segments;
+	if (this->threadCount != 1 && findPageSegments(content, segments) && segments.size() > 1)
 	{
-		char buffer[1024];
-		len = readContentFile(buffer, sizeof(buffer));
-		if (len > 0)
+		// Everything except the pages is parsed first, the pages need the file version and the audio attachments
+		string skeleton;
+		gsize last = 0;
+		for (const PageSegment& segment : segments)
 		{
-			valid = g_markup_parse_context_parse(context, buffer, len, &error);
+			skeleton.append(content, last, segment.start - last);
+			last = segment.end;
 		}
+		skeleton.append(content, last, string::npos);
 
-		if (error)
+		valid = parseBuffer(skeleton.data(), skeleton.size(), parserError);
+		if (valid)
 		{
-			g_warning("LoadHandler::parseXml: %s\n", error->message);
-			valid = false;
-			break;
+			valid = parsePagesParallel(content, segments);
+			parserError = !valid;
 		}
 	}
-	while (len >= 0 && valid && !error);
-
-	if (valid)
+	else
 	{
-		valid = g_markup_parse_context_end_parse(context, &error);
+		valid = parseBuffer(content.data(), content.size(), parserError);
 	}
-	else
+
+	if (parserError)
 	{
 		if (error != NULL && error->message != NULL)
 		{
+			g_warning("LoadHandler::parseXml: %s\n", error->message);
 			this->lastError = FS(_F("XML Parser error: {1}") % error->message);
 			g_error_free(error);
+			error = NULL;
 		}
 		else
 		{
@@ -291,8 +425,6 @@ bool LoadHandler::parseXml()
 		g_warning("LoadHandler::parseXml: %s\n", this->lastError.c_str());
 	}
 
-	g_markup_parse_context_free(context);
-
 	if (this->pos != PASER_POS_FINISHED && this->lastError == "")
 	{
 		lastError = _("Document is not complete (maybe the end is cut off?)");
@@ -304,6 +436,144 @@ bool LoadHandler::parseXml()
 	return valid;
 }
 
+/**
+ * Parses the pages with page workers, each worker is a LoadHandler parsing one page after the other.
+ * The parsed pages are added to the document in their order afterwards.
+ */
+bool LoadHandler::parsePagesParallel(const string& content, const vector<PageSegment>& segments)
+{
+	XOJ_CHECK_TYPE(LoadHandler);
+
+	size_t threads = this->threadCount > 0 ? this->threadCount : g_get_num_processors();
+	threads = std::max((size_t) 1, std::min(threads, segments.size()));
+
+	vector<ParsedPage> parsedPages(segments.size());
+	std::atomic<size_t> nextPage(0);
+
+	auto parsePages = [&]()
+	{
+		LoadHandler worker;
+		worker.initPageWorker(this);
+
+		for (size_t i = nextPage++; i < segments.size(); i = nextPage++)
+		{
+			const PageSegment& segment = segments[i];
+			worker.parsePageSegment(content.data() + segment.start, segment.end - segment.start, parsedPages[i]);
+		}
+	};
+
+	vector<std::thread> workers;
+	for (size_t i = 1; i < threads; i++)
+	{
+		workers.emplace_back(parsePages);
+	}
+	parsePages();
+
+	for (std::thread& t : workers)
+	{
+		t.join();
+	}
+
+	for (ParsedPage& parsedPage : parsedPages)
+	{
+		addParsedPage(parsedPage);
+	}
+
+	return this->error == NULL;
+}
+
+void LoadHandler::initPageWorker(LoadHandler* parent)
+{
+	XOJ_CHECK_TYPE(LoadHandler);
+
+	this->parent = parent;
+
+	this->filename = parent->filename;
+	this->xournalFilename = parent->xournalFilename;
+	this->isGzFile = parent->isGzFile;
+	this->zipFp = parent->zipFp;
+	this->fileVersion = parent->fileVersion;
+	this->removePdfBackgroundFlag = parent->removePdfBackgroundFlag;
+	this->pdfReplacementFilename = parent->pdfReplacementFilename;
+
+	// Only read by the workers
+	g_hash_table_unref(this->audioFiles);
+	this->audioFiles = g_hash_table_ref(parent->audioFiles);
+}
+
+void LoadHandler::parsePageSegment(const char* data, gsize length, ParsedPage& result)
+{
+	XOJ_CHECK_TYPE(LoadHandler);
+
+	this->parsedPage = &result;
+	this->pos = PARSER_POS_STARTED;
+	this->page = NULL;
+	this->layer = NULL;
+	this->stroke = NULL;
+	this->text = NULL;
+	this->image = NULL;
+	this->teximage = NULL;
+	this->pressureBuffer.clear();
+	this->loadedFilename = "";
+	this->loadedTimeStamp = 0;
+
+	bool parserError = false;
+	parseBuffer(data, length, parserError);
+
+	result.error = this->error;
+	this->error = NULL;
+	this->parsedPage = NULL;
+	this->page = NULL;
+}
+
+/**
+ * Adds a page parsed by a page worker to the document, and does what the worker left to the loading thread
+ */
+void LoadHandler::addParsedPage(ParsedPage& result)
+{
+	XOJ_CHECK_TYPE(LoadHandler);
+
+	if (result.error)
+	{
+		if (this->error == NULL)
+		{
+			this->error = result.error;
+		}
+		else
+		{
+			g_error_free(result.error);
+		}
+		result.error = NULL;
+	}
+
+	if (!result.page.isValid())
+	{
+		return;
+	}
+
+	for (std::pair<Text*, string>& text : result.texts)
+	{
+		text.first->setText(text.second);
+	}
+
+	if (result.cloneBackgroundOf >= 0)
+	{
+		PageRef p = doc.getPage((size_t) result.cloneBackgroundOf);
+		if (p.isValid())
+		{
+			result.page->setBackgroundImage(p->getBackgroundImage());
+		}
+	}
+
+	if (result.pdfBackground && !this->pdfFilenameParsed)
+	{
+		loadPdfBackground(result.pdfDomain.c_str(),
+		                  result.pdfFilenameAvailable ? result.pdfFilename.c_str() : NULL);
+	}
+
+	this->doc.addPage(result.page);
+}
+
 void LoadHandler::parseStart()
 {
 	XOJ_CHECK_TYPE(LoadHandler);
@@ -369,7 +639,14 @@ void LoadHandler::parseContents()
 
 		this->page = new XojPage(width, height);
 
-		this->doc.addPage(this->page);
+		if (this->parsedPage)
+		{
+			this->parsedPage->page = this->page;
+		}
+		else
+		{
+			this->doc.addPage(this->page);
+		}
 	}
 	else if (strcmp(elementName, "audio") == 0)
 	{
@@ -433,17 +710,24 @@ void LoadHandler::parseBgPixmap()
 			fileToLoad = filename;
 		}
 
-		GError* error = nullptr;
-		BackgroundImage img;
-		img.loadFile(fileToLoad, &error);
-
-		if (error)
+		// Only read the file, the image is decoded when it's painted the first time
+		GError* fileError = nullptr;
+		gchar* data = nullptr;
+		gsize dataLength = 0;
+		if (!g_file_get_contents(fileToLoad.c_str(), &data, &dataLength, &fileError))
 		{
-			error("%s", FC(_F("Could not read image: {1}. Error message: {2}") % fileToLoad % error->message));
-			g_error_free(error);
+			g_warning("%s", FC(_F("Could not read image: {1}. Error message: {2}") % fileToLoad % fileError->message));
+			g_error_free(fileError);
 		}
+		else
+		{
+			GBytes* bytes = g_bytes_new_take(data, dataLength);
+			BackgroundImage img;
+			img.loadData(bytes, fileToLoad);
+			g_bytes_unref(bytes);
 
-		this->page->setBackgroundImage(img);
+			this->page->setBackgroundImage(img);
+		}
 	}
 	else if (!strcmp(domain, "attach"))
 	{
@@ -457,22 +741,18 @@ void LoadHandler::parseBgPixmap()
 		}
 
 		GBytes* attachment = g_bytes_new_take(data, dataLength);
-		GInputStream* inputStream = g_memory_input_stream_new_from_bytes(attachment);
 
-		GError* error = nullptr;
 		BackgroundImage img;
-		img.loadFile(inputStream, filename, &error);
-
-		g_input_stream_close(inputStream, nullptr, nullptr);
-
-		if (error)
-		{
-			error("%s", FC(_F("Could not read image: {1}. Error message: {2}") % filename % error->message));
-			g_error_free(error);
-		}
+		img.loadData(attachment, filename);
+		g_bytes_unref(attachment);
 
 		this->page->setBackgroundImage(img);
 	}
+	else if (!strcmp(domain, "clone") && this->parsedPage)
+	{
+		// The page is not known to the worker, the parent resolves the clone
+		this->parsedPage->cloneBackgroundOf = (long) stoull(filename);
+	}
 	else if (!strcmp(domain, "clone"))
 	{
 		PageRef p = doc.getPage(stoull(filename));
@@ -495,113 +775,144 @@ void LoadHandler::parseBgPdf()
 	XOJ_CHECK_TYPE(LoadHandler);
 
 	int pageno = LoadHandlerHelper::getAttribInt("pageno", this);
-	bool attachToDocument = false;
-	string pdfFilename;
 
 	this->page->setBackgroundPdfPageNr(pageno - 1);
 
-	if (!this->pdfFilenameParsed)
+	if (this->parsedPage)
 	{
+		// The PDF is loaded by the parent, once for the whole document
+		this->parsedPage->pdfBackground = true;
+		if (this->pdfReplacementFilename == "")
+		{
+			const char* domain = LoadHandlerHelper::getAttrib("domain", true, this);
+			const char* sFilename = LoadHandlerHelper::getAttrib("filename", true, this);
+
+			this->parsedPage->pdfDomain = domain ? domain : "";
+			this->parsedPage->pdfFilenameAvailable = sFilename != NULL;
+			this->parsedPage->pdfFilename = sFilename ? sFilename : "";
+		}
+		return;
+	}
 
+	if (!this->pdfFilenameParsed)
+	{
+		const char* domain = NULL;
+		const char* sFilename = NULL;
 		if (this->pdfReplacementFilename == "")
 		{
-			const char* domain = LoadHandlerHelper::getAttrib("domain", false, this);
-			const char* sFilename = LoadHandlerHelper::getAttrib("filename", false, this);
+			domain = LoadHandlerHelper::getAttrib("domain", false, this);
+			sFilename = LoadHandlerHelper::getAttrib("filename", false, this);
+		}
 
-			if (sFilename == NULL)
-			{
-				error("PDF Filename missing!");
-				return;
-			}
+		loadPdfBackground(domain, sFilename);
+	}
+}
 
-			pdfFilename = sFilename;
+/**
+ * Loads the PDF of the first page with a PDF background
+ */
+void LoadHandler::loadPdfBackground(const char* domain, const char* sFilename)
+{
+	XOJ_CHECK_TYPE(LoadHandler);
 
-			if (!strcmp("absolute", domain))   // Absolute OR relative path
-			{
-				if (!g_file_test(sFilename, G_FILE_TEST_EXISTS))
-				{
-					char* dirname = g_path_get_dirname(xournalFilename.c_str());
-					char* file = g_path_get_basename(sFilename);
+	bool attachToDocument = false;
+	string pdfFilename;
+
+	if (this->pdfReplacementFilename == "")
+	{
+		if (sFilename == NULL)
+		{
+			error("PDF Filename missing!");
+			return;
+		}
 
-					char* tmpFilename = g_build_path(G_DIR_SEPARATOR_S, dirname, file, NULL);
+		pdfFilename = sFilename;
 
-					if (g_file_test(tmpFilename, G_FILE_TEST_EXISTS))
-					{
-						pdfFilename = tmpFilename;
-					}
+		if (!strcmp("absolute", domain))   // Absolute OR relative path
+		{
+			if (!g_file_test(sFilename, G_FILE_TEST_EXISTS))
+			{
+				char* dirname = g_path_get_dirname(xournalFilename.c_str());
+				char* file = g_path_get_basename(sFilename);
 
-					g_free(tmpFilename);
-					g_free(dirname);
-					g_free(file);
+				char* tmpFilename = g_build_path(G_DIR_SEPARATOR_S, dirname, file, NULL);
+
+				if (g_file_test(tmpFilename, G_FILE_TEST_EXISTS))
+				{
+					pdfFilename = tmpFilename;
 				}
+
+				g_free(tmpFilename);
+				g_free(dirname);
+				g_free(file);
 			}
-			else if (!strcmp("attach", domain))
+		}
+		else if (!strcmp("attach", domain))
+		{
+			// Handle old format separately
+			if (this->isGzFile)
 			{
-				// Handle old format separately
-				if (this->isGzFile)
-				{
-					char* tmpFilename = g_strdup_printf("%s.%s", xournalFilename.c_str(), sFilename);
+				char* tmpFilename = g_strdup_printf("%s.%s", xournalFilename.c_str(), sFilename);
 
-					if (g_file_test(tmpFilename, G_FILE_TEST_EXISTS))
-					{
-						pdfFilename = tmpFilename;
-					}
+				if (g_file_test(tmpFilename, G_FILE_TEST_EXISTS))
+				{
+					pdfFilename = tmpFilename;
+				}
 
-					g_free(tmpFilename);
-				} else
+				g_free(tmpFilename);
+			} else
+			{
+				gpointer data = nullptr;
+				gsize dataLength;
+				bool success = readZipAttachment(pdfFilename, data, dataLength);
+				if (!success)
 				{
-					gpointer data = nullptr;
-					gsize dataLength;
-					bool success = readZipAttachment(pdfFilename, data, dataLength);
-					if (!success)
-					{
-						return;
-					}
-
-					doc.readPdf(pdfFilename, false, attachToDocument, data, dataLength);
-
-					if (!doc.getLastErrorMsg().empty())
-					{
-						error("%s", FC(_F("Error reading PDF: {1}") % doc.getLastErrorMsg()));
-					}
-
-					this->pdfFilenameParsed = true;
 					return;
 				}
-			}
-			else
-			{
-				error("%s", FC(_F("Unknown domain type: {1}") % domain));
+
+				doc.readPdf(pdfFilename, false, attachToDocument, data, dataLength);
+
+				if (!doc.getLastErrorMsg().empty())
+				{
+					error("%s", FC(_F("Error reading PDF: {1}") % doc.getLastErrorMsg()));
+				}
+
+				this->pdfFilenameParsed = true;
 				return;
 			}
-
 		}
 		else
 		{
-			pdfFilename = this->pdfReplacementFilename;
-			attachToDocument = this->pdfReplacementAttach;
+			error("%s", FC(_F("Unknown domain type: {1}") % domain));
+			return;
 		}
 
-		this->pdfFilenameParsed = true;
+	}
+	else
+	{
+		pdfFilename = this->pdfReplacementFilename;
+		attachToDocument = this->pdfReplacementAttach;
+	}
+
+	this->pdfFilenameParsed = true;
 
-		if (g_file_test(pdfFilename.c_str(), G_FILE_TEST_EXISTS))
+	if (g_file_test(pdfFilename.c_str(), G_FILE_TEST_EXISTS))
+	{
+		doc.readPdf(pdfFilename, false, attachToDocument);
+		if (!doc.getLastErrorMsg().empty())
 		{
-			doc.readPdf(pdfFilename, false, attachToDocument);
-			if (!doc.getLastErrorMsg().empty())
-			{
-				error("%s", FC(_F("Error reading PDF: {1}") % doc.getLastErrorMsg()));
-			}
+			error("%s", FC(_F("Error reading PDF: {1}") % doc.getLastErrorMsg()));
+		}
+	}
+	else
+	{
+		if (attachToDocument)
+		{
+			this->attachedPdfMissing = true;
 		}
 		else
 		{
-			if (attachToDocument)
-			{
-				this->attachedPdfMissing = true;
-			}
-			else
-			{
-				this->pdfMissing = pdfFilename;
-			}
+			this->pdfMissing = pdfFilename;
 		}
 	}
 }
@@ -657,7 +968,7 @@ void LoadHandler::parseStroke()
 	const char* width = LoadHandlerHelper::getAttrib("width", false, this);
 
 	char* endPtr = NULL;
-	stroke->setWidth(g_ascii_strtod(width, &endPtr));
+	stroke->setWidth(StringUtils::parseDouble(width, &endPtr));
 	if (endPtr == width)
 	{
 		error("%s", FC(_F("Error reading width of a stroke: {1}") % width));
@@ -675,7 +986,7 @@ void LoadHandler::parseStroke()
 	while (*pressure != 0)
 	{
 		char* tmpptr = NULL;
-		double val = g_ascii_strtod(pressure, &tmpptr);
+		double val = StringUtils::parseDouble(pressure, &tmpptr);
 		if (tmpptr == pressure)
 		{
 			break;
@@ -1131,7 +1442,7 @@ void LoadHandler::parserText(GMarkupParseContext* context, const gchar* text,
 
 		while (textLen > 0)
 		{
-			double tmp = g_ascii_strtod(text, (char**) (&ptr));
+			double tmp = StringUtils::parseDouble(text, (char**) (&ptr));
 			if (ptr == text)
 			{
 				break;
@@ -1177,9 +1488,16 @@ void LoadHandler::parserText(GMarkupParseContext* context, const gchar* text,
 	}
 	else if (handler->pos == PARSER_POS_IN_TEXT)
 	{
-		gchar* txt = g_strndup(text, textLen);
-		handler->text->setText(txt);
-		g_free(txt);
+		if (handler->parsedPage)
+		{
+			handler->parsedPage->texts.emplace_back(handler->text, string(text, textLen));
+		}
+		else
+		{
+			gchar* txt = g_strndup(text, textLen);
+			handler->text->setText(txt);
+			g_free(txt);
+		}
 	}
 	else if (handler->pos == PARSER_POS_IN_IMAGE)
 	{
@@ -1279,6 +1597,16 @@ Document* LoadHandler::loadDocument(string filename)
 }
 
 bool LoadHandler::readZipAttachment(string filename, gpointer& data, gsize& length)
+{
+	GMutex* zipMutex = this->parent ? &this->parent->zipMutex : &this->zipMutex;
+	g_mutex_lock(zipMutex);
+	bool success = readZipAttachmentUnlocked(filename, data, length);
+	g_mutex_unlock(zipMutex);
+
+	return success;
+}
+
+bool LoadHandler::readZipAttachmentUnlocked(string filename, gpointer& data, gsize& length)
 {
 	zip_stat_t attachmentFileStat;
 	int statStatus = zip_stat(this->zipFp, filename.c_str(), 0, &attachmentFileStat);
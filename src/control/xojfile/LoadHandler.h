@@ -54,6 +54,49 @@ public:
 	void removePdfBackground();
 	void setPdfReplacement(string filename, bool attachToDocument);
 
+	/**
+	 * Number of threads parsing the pages of a document, 0 uses one thread per CPU core
+	 * and 1 parses the whole document on the calling thread
+	 */
+	void setThreadCount(int threadCount);
+
+private:
+	/**
+	 * A <page> element, parsed by a page worker
+	 */
+	struct ParsedPage
+	{
+		PageRef page;
+		GError* error = NULL;
+
+		/**
+		 * The PDF is loaded by the parent, the filename of the first PDF background is used
+		 */
+		bool pdfBackground = false;
+		bool pdfFilenameAvailable = false;
+		string pdfDomain;
+		string pdfFilename;
+
+		/**
+		 * Index of the page whose background image is used, -1 for none
+		 */
+		long cloneBackgroundOf = -1;
+
+		/**
+		 * Texts are measured with Pango, which is done on the loading thread
+		 */
+		vector<std::pair<Text*, string>> texts;
+	};
+
+	/**
+	 * Byte range of a <page> element in the document content
+	 */
+	struct PageSegment
+	{
+		gsize start;
+		gsize end;
+	};
+
 private:
 	void parseStart();
 	void parseContents();
@@ -73,7 +116,15 @@ private:
 	zip_int64_t readContentFile(char* buffer, zip_uint64_t len);
 	bool closeFile();
 	bool openFile(string filename);
+	bool readContent(string& content);
 	bool parseXml();
+	bool parseBuffer(const char* data, gsize length, bool& parserError);
+
+	static bool findPageSegments(const string& content, vector<PageSegment>& segments);
+	bool parsePagesParallel(const string& content, const vector<PageSegment>& segments);
+	void initPageWorker(LoadHandler* parent);
+	void parsePageSegment(const char* data, gsize length, ParsedPage& result);
+	void addParsedPage(ParsedPage& result);
 
 	static void parserText(GMarkupParseContext* context, const gchar* text, gsize text_len, gpointer userdata,
 	                       GError** error);
@@ -90,6 +141,7 @@ private:
 	void parseBgSolid();
 	void parseBgPixmap();
 	void parseBgPdf();
+	void loadPdfBackground(const char* domain, const char* sFilename);
 	void parseAttachment();
 
 	void readImage(const gchar* base64string, gsize base64stringLen);
@@ -98,6 +150,7 @@ private:
 private:
 	string parseBase64(const gchar* base64, gsize lenght);
 	bool readZipAttachment(string filename, gpointer& data, gsize& length);
+	bool readZipAttachmentUnlocked(string filename, gpointer& data, gsize& length);
 	string getTempFileForPath(string filename);
 
 private:
@@ -122,6 +175,11 @@ private:
 	int minimalFileVersion;
 
 	zip_t* zipFp;
+
+	/**
+	 * The zip file is shared with the page workers, libzip is not thread safe
+	 */
+	GMutex zipMutex;
 	zip_file_t* zipContentFile;
 	gzFile gzFp;
 	bool isGzFile = false;
@@ -148,6 +206,18 @@ private:
 	int loadedTimeStamp;
 	string loadedFilename;
 
+	int threadCount = 0;
+
+	/**
+	 * Set in a page worker, the handler which loads the document
+	 */
+	LoadHandler* parent = NULL;
+
+	/**
+	 * The page currently parsed by a page worker
+	 */
+	ParsedPage* parsedPage = NULL;
+
 	DocumentHandler dHanlder;
 	Document doc;
 
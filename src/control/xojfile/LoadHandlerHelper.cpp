@@ -4,6 +4,7 @@
 
 #include <config.h>
 #include <i18n.h>
+#include <StringUtils.h>
 
 #define error(...) if (loadHandler->error == NULL) { loadHandler->error = g_error_new(G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT, __VA_ARGS__); }
 
@@ -134,7 +135,7 @@ double LoadHandlerHelper::getAttribDouble(const char* name, LoadHandler* loadHan
 	}
 
 	char* ptr = NULL;
-	double val = g_ascii_strtod(attrib, &ptr);
+	double val = StringUtils::parseDouble(attrib, &ptr);
 	if (ptr == attrib)
 	{
 		error("%s", FC(_F("Attribute \"{1}\" could not be parsed as double, the value is \"{2}\"") % name % attrib));
@@ -19,6 +19,20 @@
 #include <config.h>
 #include <i18n.h>
 
+#include <glib/gstdio.h>
+
+#ifndef WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 SaveHandler::SaveHandler()
 {
 	XOJ_INIT_TYPE(SaveHandler);
@@ -33,7 +47,17 @@ SaveHandler::~SaveHandler()
 {
 	XOJ_CHECK_TYPE(SaveHandler);
 
+	clearSaveData();
+
+	XOJ_RELEASE_TYPE(SaveHandler);
+}
+
+void SaveHandler::clearSaveData()
+{
+	XOJ_CHECK_TYPE(SaveHandler);
+
 	delete this->root;
+	this->root = NULL;
 
 	for (GList* l = this->backgroundImages; l != NULL; l = l->next)
 	{
@@ -41,27 +65,14 @@ SaveHandler::~SaveHandler()
 	}
 	g_list_free(this->backgroundImages);
 	this->backgroundImages = NULL;
-
-	XOJ_RELEASE_TYPE(SaveHandler);
 }
 
-void SaveHandler::prepareSave(Document* doc)
+void SaveHandler::prepareRoot(Document* doc)
 {
 	XOJ_CHECK_TYPE(SaveHandler);
 
-	if (this->root)
-	{
-		// cleanup old data
-		delete this->root;
-		this->root = NULL;
-
-		for (GList* l = this->backgroundImages; l != NULL; l = l->next)
-		{
-			delete (BackgroundImage*) l->data;
-		}
-		g_list_free(this->backgroundImages);
-		this->backgroundImages = NULL;
-	}
+	// cleanup old data
+	clearSaveData();
 
 	this->firstPdfPageVisited = false;
 	this->attachBgId = 1;
@@ -83,6 +94,13 @@ void SaveHandler::prepareSave(Document* doc)
 		PageRef p = doc->getPage(i);
 		p->getBackgroundImage().clearSaveState();
 	}
+}
+
+void SaveHandler::prepareSave(Document* doc)
+{
+	XOJ_CHECK_TYPE(SaveHandler);
+
+	prepareRoot(doc);
 
 	for (size_t i = 0; i < doc->getPageCount(); i++)
 	{
@@ -227,7 +245,7 @@ void SaveHandler::visitLayer(XmlNode* page, Layer* l)
 			XmlImageNode* image = new XmlImageNode("image");
 			layer->addChild(image);
 
-			image->setImage(i->getImage());
+			image->setImageData(i->getData());
 
 			image->setAttrib("left", i->getX());
 			image->setAttrib("top", i->getY());
@@ -369,22 +387,209 @@ void SaveHandler::writeSolidBackground(XmlNode* background, PageRef p)
 
 void SaveHandler::saveTo(Path filename, ProgressListener* listener)
 {
-	GzOutputStream out(filename);
+	XOJ_CHECK_TYPE(SaveHandler);
+
+	// The target of a link is replaced, not the link
+	string target = resolveLink(filename.str());
+
+	// In the same folder, so the file is replaced by a rename and never left half written. The name is
+	// unique, an existing file is never overwritten.
+	gchar* dir = g_path_get_dirname(target.c_str());
+	gchar* base = g_path_get_basename(target.c_str());
+	gchar* tmpTemplate = g_strdup_printf("%s%s.%s.XXXXXX", dir, G_DIR_SEPARATOR_S, base);
+	g_free(dir);
+	g_free(base);
 
-	if (!out.getLastError().empty())
+	int fd = g_mkstemp(tmpTemplate);
+	string tmpFilename = tmpTemplate;
+	g_free(tmpTemplate);
+
+	FILE* fp = fd == -1 ? NULL : fdopen(fd, "wb");
+	if (fp == NULL)
+	{
+		if (fd != -1)
+		{
+			close(fd);
+			g_unlink(tmpFilename.c_str());
+		}
+		this->errorMessage = FS(_F("Error opening file: \"{1}\"") % filename.str());
+		return;
+	}
+
+	bool ok = writeCompressed(fp, listener);
+#ifndef WIN32
+	// The data has to be on the disk before the rename, else a crash may leave an empty file
+	ok = ok && fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+#endif
+	ok = fclose(fp) == 0 && ok;
+
+	GStatBuf attrib;
+	if (ok && g_stat(target.c_str(), &attrib) == 0)
+	{
+		// Keep the permissions of the replaced file
+		g_chmod(tmpFilename.c_str(), attrib.st_mode & 0777);
+	}
+#ifndef WIN32
+	else if (ok)
 	{
-		this->errorMessage = out.getLastError();
+		// A new file, g_mkstemp only allows the user to read it
+		mode_t mask = umask(0);
+		umask(mask);
+		g_chmod(tmpFilename.c_str(), 0666 & ~mask);
+	}
+#endif
+
+	if (!ok || g_rename(tmpFilename.c_str(), target.c_str()) != 0)
+	{
+		g_unlink(tmpFilename.c_str());
+		if (this->errorMessage.empty())
+		{
+			this->errorMessage = FS(_F("Error writing file: \"{1}\"") % filename.str());
+		}
 		return;
 	}
 
-	saveTo(&out, filename, listener);
+	writeBackgroundImages(filename);
+}
 
-	out.close();
+string SaveHandler::resolveLink(const string& filename)
+{
+	string path = filename;
 
-	if (this->errorMessage.empty())
+	// Limited like the kernel does, a loop of links is not followed forever
+	for (int i = 0; i < 40; i++)
 	{
-		this->errorMessage = out.getLastError();
+		gchar* link = g_file_read_link(path.c_str(), NULL);
+		if (link == NULL)
+		{
+			break;
+		}
+
+		if (g_path_is_absolute(link))
+		{
+			path = link;
+		}
+		else
+		{
+			// Relative to the folder of the link
+			gchar* dir = g_path_get_dirname(path.c_str());
+			gchar* target = g_build_filename(dir, link, NULL);
+			path = target;
+			g_free(target);
+			g_free(dir);
+		}
+		g_free(link);
 	}
+
+	return path;
+}
+
+/**
+ * Every child of the root node is compressed as a block by the workers, in order. The calling thread
+ * writes the blocks as soon as they are complete, and compresses blocks itself while it waits.
+ */
+bool SaveHandler::writeCompressed(FILE* fp, ProgressListener* listener)
+{
+	XOJ_CHECK_TYPE(SaveHandler);
+
+	vector<XmlNode*> nodes;
+	for (GList* l = this->root->getChildren(); l != NULL; l = l->next)
+	{
+		nodes.push_back((XmlNode*) l->data);
+	}
+
+	size_t threads = this->threadCount > 0 ? this->threadCount : g_get_num_processors();
+	threads = std::max((size_t) 1, std::min(threads, nodes.size()));
+
+	vector<string> blocks(nodes.size());
+	vector<bool> compressed(nodes.size(), false);
+	std::atomic<size_t> nextBlock(0);
+	std::mutex blockMutex;
+	std::condition_variable blockCompressed;
+
+	auto compressBlock = [&](size_t i)
+	{
+		GzMemoryOutputStream out;
+		nodes[i]->writeOut(&out);
+		out.close();
+
+		std::lock_guard<std::mutex> lock(blockMutex);
+		blocks[i].swap(out.getData());
+		compressed[i] = true;
+		blockCompressed.notify_all();
+	};
+
+	auto compressBlocks = [&]()
+	{
+		for (size_t i = nextBlock++; i < nodes.size(); i = nextBlock++)
+		{
+			compressBlock(i);
+		}
+	};
+
+	vector<std::thread> workers;
+	for (size_t i = 1; i < threads; i++)
+	{
+		workers.emplace_back(compressBlocks);
+	}
+
+	GzMemoryOutputStream header;
+	header.write("<?xml version=\"1.0\" standalone=\"no\"?>\n");
+	this->root->writeOpenTag(&header);
+	header.close();
+
+	bool ok = fwrite(header.getData().data(), 1, header.getData().size(), fp) == header.getData().size();
+
+	if (listener)
+	{
+		listener->setMaximumState(nodes.size());
+	}
+
+	for (size_t i = 0; i < nodes.size(); i++)
+	{
+		string data;
+		while (true)
+		{
+			std::unique_lock<std::mutex> lock(blockMutex);
+			if (compressed[i])
+			{
+				data.swap(blocks[i]);
+				break;
+			}
+			lock.unlock();
+
+			size_t next = nextBlock++;
+			if (next < nodes.size())
+			{
+				compressBlock(next);
+				continue;
+			}
+
+			lock.lock();
+			blockCompressed.wait(lock, [&]() { return (bool) compressed[i]; });
+		}
+
+		// After a write error the blocks are still collected, so the workers can finish
+		ok = ok && fwrite(data.data(), 1, data.size(), fp) == data.size();
+
+		if (listener)
+		{
+			listener->setCurrentState(i + 1);
+		}
+	}
+
+	for (std::thread& t : workers)
+	{
+		t.join();
+	}
+
+	GzMemoryOutputStream footer;
+	this->root->writeCloseTag(&footer);
+	footer.close();
+
+	ok = ok && fwrite(footer.getData().data(), 1, footer.getData().size(), fp) == footer.getData().size();
+
+	return ok;
 }
 
 void SaveHandler::saveTo(OutputStream* out, Path filename, ProgressListener* listener)
@@ -396,6 +601,13 @@ void SaveHandler::saveTo(OutputStream* out, Path filename, ProgressListener* lis
 	out->write("<?xml version=\"1.0\" standalone=\"no\"?>\n");
 	root->writeOut(out, listener);
 
+	writeBackgroundImages(filename);
+}
+
+void SaveHandler::writeBackgroundImages(Path filename)
+{
+	XOJ_CHECK_TYPE(SaveHandler);
+
 	for (GList* l = this->backgroundImages; l != NULL; l = l->next)
 	{
 		BackgroundImage* img = (BackgroundImage*) l->data;
@@ -414,6 +626,13 @@ void SaveHandler::saveTo(OutputStream* out, Path filename, ProgressListener* lis
 
 }
 
+void SaveHandler::setThreadCount(int threadCount)
+{
+	XOJ_CHECK_TYPE(SaveHandler);
+
+	this->threadCount = threadCount;
+}
+
 string SaveHandler::getErrorMessage()
 {
 	XOJ_CHECK_TYPE(SaveHandler);
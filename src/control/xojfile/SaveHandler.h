@@ -19,6 +19,8 @@
 #include <XournalType.h>
 #include <control/xml/XmlAudioNode.h>
 
+#include <cstdio>
+
 class XmlNode;
 class XmlPointNode;
 class ProgressListener;
@@ -31,13 +33,48 @@ public:
 
 public:
 	void prepareSave(Document* doc);
+
+	/**
+	 * Writes the document compressed to a temporary file next to filename, which then replaces filename.
+	 * If filename is a symbolic link, the file it points to is replaced and the link is kept.
+	 * The nodes of the document are compressed in parallel, each into its own gzip member, the
+	 * concatenated members are read as one gzip stream.
+	 */
 	void saveTo(Path filename, ProgressListener* listener = NULL);
 	void saveTo(OutputStream* out, Path filename, ProgressListener* listener = NULL);
 	string getErrorMessage();
 
+	/**
+	 * The count of threads compressing the document, 0 for one thread per CPU
+	 */
+	void setThreadCount(int threadCount);
+
 protected:
 	static string getColorStr(int c, unsigned char alpha = 0xff);
 
+	/**
+	 * Creates the root node with the header, without pages
+	 */
+	void prepareRoot(Document* doc);
+	void clearSaveData();
+
+	/**
+	 * @return The file a symbolic link points to, over all links, or the file itself if it is no link
+	 */
+	static string resolveLink(const string& filename);
+
+	/**
+	 * Writes the attached background images next to filename
+	 */
+	void writeBackgroundImages(Path filename);
+
+	/**
+	 * Writes the compressed blocks of the document in order, while they are compressed
+	 *
+	 * @return false if the file could not be written
+	 */
+	bool writeCompressed(FILE* fp, ProgressListener* listener);
+
 	virtual void visitPage(XmlNode* root, PageRef p, Document* doc, int id);
 	virtual void visitLayer(XmlNode* page, Layer* l);
 	virtual void visitStroke(XmlPointNode* stroke, Stroke* s);
@@ -61,4 +98,6 @@ protected:
 	string errorMessage;
 
 	GList* backgroundImages;
+
+	int threadCount = 0;
 };
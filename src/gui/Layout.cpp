@@ -5,6 +5,9 @@
 #include "control/Control.h"
 #include "widgets/XournalWidget.h"
 #include "gui/scroll/ScrollHandling.h"
+
+#include <algorithm>
+#include <cmath>
 	
 /**
  * Padding outside the pages, including shadow
@@ -79,52 +82,88 @@ void Layout::updateVisibility()
 	XOJ_CHECK_TYPE(Layout);
 
 	Rectangle visRect = getVisibleRect();
-	
-	// step through every possible page position and update using p->setIsVisible()
-	// Using initial grid aprox speeds things up by a factor of 5.  See previous git check-in for specifics.
-	int x1 = 0;
-	int y1 = 0;	
- 	
-	for (int onRow = 0; onRow < this->rows; onRow++)
+
+	if (this->visibleViewsValid)
+	{
+		for (XojPageView* pageView : this->visibleViews)
+		{
+			pageView->setIsVisible(false);
+		}
+	}
+	else
 	{
-		int y2 = this->sizeRow[onRow];
-		for (int onCol = 0; onCol < this->columns; onCol++)
+		// The first update after a new layout has to step through all pages
+		for (size_t i = 0; i < this->view->viewPagesLen; i++)
 		{
-			int x2 = this->sizeCol[onCol];		
-			int pageIndex = this->mapper.map(onCol, onRow);
-			if (pageIndex >= 0)	// a page exists at this grid location
+			this->view->viewPages[i]->setIsVisible(false);
+		}
+		this->visibleViewsValid = true;
+	}
+
+	this->visibleViews = getViewsInArea(visRect);
+	for (XojPageView* pageView : this->visibleViews)
+	{
+		pageView->setIsVisible(true);
+	}
+}
+
+bool Layout::getGridRange(const Rectangle& area, int& firstRow, int& lastRow, int& firstCol, int& lastCol)
+{
+	XOJ_CHECK_TYPE(Layout);
+
+	if (this->sizeRow.empty() || this->sizeCol.empty())
+	{
+		return false;
+	}
+
+	// sizeRow / sizeCol are the accumulated end positions of the rows / columns, which are
+	// sorted, the rows and columns containing the start and the end of the area are searched
+	firstRow = std::lower_bound(this->sizeRow.begin(), this->sizeRow.end(), (int) area.y) - this->sizeRow.begin();
+	lastRow = std::lower_bound(this->sizeRow.begin(), this->sizeRow.end(), (int) std::ceil(area.y + area.height)) - this->sizeRow.begin();
+	firstCol = std::lower_bound(this->sizeCol.begin(), this->sizeCol.end(), (int) area.x) - this->sizeCol.begin();
+	lastCol = std::lower_bound(this->sizeCol.begin(), this->sizeCol.end(), (int) std::ceil(area.x + area.width)) - this->sizeCol.begin();
+
+	lastRow = std::min(lastRow, (int) this->sizeRow.size() - 1);
+	lastCol = std::min(lastCol, (int) this->sizeCol.size() - 1);
+
+	return firstRow <= lastRow && firstCol <= lastCol;
+}
+
+std::vector<XojPageView*> Layout::getViewsInArea(const Rectangle& area)
+{
+	XOJ_CHECK_TYPE(Layout);
+
+	std::vector<XojPageView*> views;
+
+	int firstRow = 0;
+	int lastRow = 0;
+	int firstCol = 0;
+	int lastCol = 0;
+	if (!getGridRange(area, firstRow, lastRow, firstCol, lastCol))
+	{
+		return views;
+	}
+
+	for (int r = firstRow; r <= lastRow; r++)
+	{
+		for (int c = firstCol; c <= lastCol; c++)
+		{
+			int pageIndex = this->mapper.map(c, r);
+			if (pageIndex < 0 || pageIndex >= (int) this->view->viewPagesLen)
 			{
+				continue;
+			}
 
-				XojPageView* pageView = this->view->viewPages[pageIndex];
-				
-				
-				//check if grid location is visible as an aprox for page visiblity:
-				if(		!(visRect.x >x2  || visRect.x+visRect.width < x1) // visrect not outside current row/col 
-					&& 	!(visRect.y >y2  || visRect.y+visRect.height < y1))
-				{
-					// now use exact check of page itself:
-					Rectangle pageRect = pageView->getRect();
-					if(		!(visRect.x >pageRect.x+pageRect.width  || visRect.x+visRect.width < pageRect.x) // visrect not outside current page dimensions 
-						&& 	!(visRect.y >pageRect.y+pageRect.height  || visRect.y+visRect.height < pageRect.y))
-					{
-						pageView->setIsVisible(true);
-					}	
-					else 
-					{
-						pageView->setIsVisible(false);
-					}
-				}
-				else
-				{
-					pageView->setIsVisible(false);
-							
-				}
+			// Pages smaller than their row or column may still be outside of the area
+			XojPageView* pageView = this->view->viewPages[pageIndex];
+			if (area.intersects(pageView->getRect()))
+			{
+				views.push_back(pageView);
 			}
-			x1 = x2;
 		}
-		y1 = y2;
 	}
-	
+
+	return views;
 }
 
 Rectangle Layout::getVisibleRect()
@@ -185,6 +224,10 @@ void Layout::layoutPages()
 	this->rows = this->mapper.getRows();
 	this->columns = this->mapper.getColumns();
 	
+	// The views may have changed
+	this->visibleViewsValid = false;
+	this->visibleViews.clear();
+
 	this->lastGetViewAtRow = this->rows/2;		//reset to middle
 	this->lastGetViewAtCol = this->columns/2;
 	
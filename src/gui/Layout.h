@@ -101,6 +101,12 @@ public:
 	 */	
 	int getIndexAtGridMap(int row, int col);
 
+	/**
+	 * The views which intersect the area (in layout coordinates). The rows and columns are found by
+	 * binary search, so the cost only depends on the count of pages in the area
+	 */
+	std::vector<XojPageView*> getViewsInArea(const Rectangle& area);
+
 protected:
 	static void horizontalScrollChanged(GtkAdjustment* adjustment, Layout* layout);
 	static void verticalScrollChanged(GtkAdjustment* adjustment, Layout* layout);
@@ -109,6 +115,13 @@ private:
 	void checkScroll(GtkAdjustment* adjustment, double& lastScroll);
 	void setLayoutSize(int width, int height);
 
+	/**
+	 * The rows and columns which intersect the area
+	 *
+	 * @return false if the area is outside of all rows or columns
+	 */
+	bool getGridRange(const Rectangle& area, int& firstRow, int& lastRow, int& firstCol, int& lastCol);
+
 private:
 	XOJ_TYPE_ATTRIB;
 
@@ -148,4 +161,11 @@ private:
 	 */
 	int lastGetViewAtRow = 0;
 	int lastGetViewAtCol = 0;
+
+	/**
+	 * The views set visible by the last updateVisibility(), only these have to be set invisible
+	 * on scrolling. Not valid after the pages are laid out again, the views may be deleted
+	 */
+	std::vector<XojPageView*> visibleViews;
+	bool visibleViewsValid = false;
 };
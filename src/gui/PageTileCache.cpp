@@ -0,0 +1,323 @@
+#include "PageTileCache.h"
+
+#include <iterator>
+
+PageTileCache::PageTileCache(size_t maxBytes)
+ : maxBytes(maxBytes)
+{
+	XOJ_INIT_TYPE(PageTileCache);
+
+	this->maxTiles = 2 * maxBytes / (PAGE_TILE_SIZE * PAGE_TILE_SIZE * 4) + 1;
+
+	g_mutex_init(&this->mutex);
+}
+
+PageTileCache::~PageTileCache()
+{
+	XOJ_CHECK_TYPE(PageTileCache);
+
+	for (Tile& t : this->tiles)
+	{
+		if (t.surface)
+		{
+			cairo_surface_destroy(t.surface);
+		}
+	}
+	this->tiles.clear();
+	this->index.clear();
+
+	XOJ_RELEASE_TYPE(PageTileCache);
+}
+
+size_t PageTileCache::TileKeyHash::operator()(const TileKey& key) const
+{
+	size_t h = std::hash<void*>()(key.view);
+	h = h * 31 + std::hash<double>()(key.zoom);
+	h = h * 31 + key.x;
+	h = h * 31 + key.y;
+	return h;
+}
+
+size_t PageTileCache::surfaceBytes(cairo_surface_t* surface)
+{
+	if (surface == NULL)
+	{
+		return 0;
+	}
+
+	return cairo_image_surface_get_stride(surface) * cairo_image_surface_get_height(surface);
+}
+
+PageTileCache::TileList::iterator PageTileCache::find(const TileKey& key)
+{
+	XOJ_CHECK_TYPE(PageTileCache);
+
+	auto it = this->index.find(key);
+	if (it == this->index.end())
+	{
+		return this->tiles.end();
+	}
+	return it->second;
+}
+
+void PageTileCache::touch(TileList::iterator it)
+{
+	XOJ_CHECK_TYPE(PageTileCache);
+
+	this->tiles.splice(this->tiles.begin(), this->tiles, it);
+}
+
+void PageTileCache::removeUnlocked(TileList::iterator it)
+{
+	XOJ_CHECK_TYPE(PageTileCache);
+
+	if (it->surface)
+	{
+		this->bytes -= surfaceBytes(it->surface);
+		cairo_surface_destroy(it->surface);
+	}
+
+	this->index.erase(it->key);
+	this->tiles.erase(it);
+}
+
+void PageTileCache::evictUnlocked()
+{
+	XOJ_CHECK_TYPE(PageTileCache);
+
+	// The first entry is the one just used, never remove it
+	while ((this->bytes > this->maxBytes || this->tiles.size() > this->maxTiles) && this->tiles.size() > 1)
+	{
+		removeUnlocked(std::prev(this->tiles.end()));
+	}
+}
+
+cairo_surface_t* PageTileCache::lookup(XojPageView* view, double zoom, int x, int y, bool* dirty)
+{
+	XOJ_CHECK_TYPE(PageTileCache);
+
+	g_mutex_lock(&this->mutex);
+
+	TileKey key = { view, zoom, x, y };
+	TileList::iterator it = find(key);
+	if (it == this->tiles.end())
+	{
+		this->tiles.push_front({ key, NULL, true });
+		this->index[key] = this->tiles.begin();
+		evictUnlocked();
+
+		g_mutex_unlock(&this->mutex);
+
+		*dirty = true;
+		return NULL;
+	}
+
+	touch(it);
+
+	*dirty = it->dirty;
+	cairo_surface_t* surface = it->surface;
+	if (surface)
+	{
+		cairo_surface_reference(surface);
+	}
+
+	g_mutex_unlock(&this->mutex);
+
+	return surface;
+}
+
+cairo_surface_t* PageTileCache::peek(XojPageView* view, double zoom, int x, int y)
+{
+	XOJ_CHECK_TYPE(PageTileCache);
+
+	g_mutex_lock(&this->mutex);
+
+	cairo_surface_t* surface = NULL;
+	TileList::iterator it = find({ view, zoom, x, y });
+	if (it != this->tiles.end() && it->surface)
+	{
+		surface = cairo_surface_reference(it->surface);
+	}
+
+	g_mutex_unlock(&this->mutex);
+
+	return surface;
+}
+
+void PageTileCache::store(XojPageView* view, double zoom, int x, int y, cairo_surface_t* surface)
+{
+	XOJ_CHECK_TYPE(PageTileCache);
+
+	g_mutex_lock(&this->mutex);
+
+	TileKey key = { view, zoom, x, y };
+	TileList::iterator it = find(key);
+	if (it == this->tiles.end())
+	{
+		this->tiles.push_front({ key, NULL, false });
+		it = this->tiles.begin();
+		this->index[key] = it;
+	}
+	else
+	{
+		touch(it);
+	}
+
+	if (it->surface)
+	{
+		this->bytes -= surfaceBytes(it->surface);
+		cairo_surface_destroy(it->surface);
+	}
+
+	it->surface = surface;
+	this->bytes += surfaceBytes(surface);
+
+	evictUnlocked();
+
+	g_mutex_unlock(&this->mutex);
+}
+
+std::vector<TileIndex> PageTileCache::takeDirtyTiles(XojPageView* view, double zoom)
+{
+	XOJ_CHECK_TYPE(PageTileCache);
+
+	std::vector<TileIndex> dirtyTiles;
+
+	g_mutex_lock(&this->mutex);
+
+	for (Tile& t : this->tiles)
+	{
+		if (t.dirty && t.key.view == view && t.key.zoom == zoom)
+		{
+			t.dirty = false;
+			dirtyTiles.push_back({ t.key.x, t.key.y });
+		}
+	}
+
+	g_mutex_unlock(&this->mutex);
+
+	return dirtyTiles;
+}
+
+void PageTileCache::invalidate(XojPageView* view, double x, double y, double width, double height)
+{
+	XOJ_CHECK_TYPE(PageTileCache);
+
+	g_mutex_lock(&this->mutex);
+
+	for (Tile& t : this->tiles)
+	{
+		if (t.key.view != view || t.dirty)
+		{
+			continue;
+		}
+
+		// Tile bounds in page coordinates
+		double tileSize = PAGE_TILE_SIZE / t.key.zoom;
+		double tx = t.key.x * tileSize;
+		double ty = t.key.y * tileSize;
+
+		if (tx < x + width && x < tx + tileSize && ty < y + height && y < ty + tileSize)
+		{
+			t.dirty = true;
+		}
+	}
+
+	g_mutex_unlock(&this->mutex);
+}
+
+void PageTileCache::invalidate(XojPageView* view)
+{
+	XOJ_CHECK_TYPE(PageTileCache);
+
+	g_mutex_lock(&this->mutex);
+
+	for (Tile& t : this->tiles)
+	{
+		if (t.key.view == view)
+		{
+			t.dirty = true;
+		}
+	}
+
+	g_mutex_unlock(&this->mutex);
+}
+
+void PageTileCache::forEachTile(XojPageView* view, double zoom, std::function<void(TileIndex, cairo_surface_t*)> fn)
+{
+	XOJ_CHECK_TYPE(PageTileCache);
+
+	g_mutex_lock(&this->mutex);
+
+	for (Tile& t : this->tiles)
+	{
+		if (t.surface && t.key.view == view && t.key.zoom == zoom)
+		{
+			fn({ t.key.x, t.key.y }, t.surface);
+		}
+	}
+
+	g_mutex_unlock(&this->mutex);
+}
+
+void PageTileCache::removeView(XojPageView* view)
+{
+	XOJ_CHECK_TYPE(PageTileCache);
+
+	g_mutex_lock(&this->mutex);
+
+	for (TileList::iterator it = this->tiles.begin(); it != this->tiles.end();)
+	{
+		TileList::iterator next = std::next(it);
+		if (it->key.view == view)
+		{
+			removeUnlocked(it);
+		}
+		it = next;
+	}
+
+	g_mutex_unlock(&this->mutex);
+}
+
+bool PageTileCache::hasTiles(XojPageView* view)
+{
+	XOJ_CHECK_TYPE(PageTileCache);
+
+	bool found = false;
+
+	g_mutex_lock(&this->mutex);
+
+	for (Tile& t : this->tiles)
+	{
+		if (t.surface && t.key.view == view)
+		{
+			found = true;
+			break;
+		}
+	}
+
+	g_mutex_unlock(&this->mutex);
+
+	return found;
+}
+
+size_t PageTileCache::getPixels(XojPageView* view)
+{
+	XOJ_CHECK_TYPE(PageTileCache);
+
+	size_t pixels = 0;
+
+	g_mutex_lock(&this->mutex);
+
+	for (Tile& t : this->tiles)
+	{
+		if (t.surface && t.key.view == view)
+		{
+			pixels += cairo_image_surface_get_width(t.surface) * cairo_image_surface_get_height(t.surface);
+		}
+	}
+
+	g_mutex_unlock(&this->mutex);
+
+	return pixels;
+}
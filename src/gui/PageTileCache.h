@@ -0,0 +1,172 @@
+/*
+ * Xournal++
+ *
+ * Caches rendered tiles of the page views
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <XournalType.h>
+
+#include <cairo/cairo.h>
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+class XojPageView;
+
+/**
+ * Size of a tile in device pixels
+ */
+#define PAGE_TILE_SIZE 256
+
+/**
+ * Position of a tile, in tile units from the top left corner of the page
+ */
+struct TileIndex
+{
+	int x;
+	int y;
+};
+
+/**
+ * Page views are not backed by one buffer for the whole page, but by fixed size tiles,
+ * keyed by (page view, zoom, tile x/y). Only the tiles which are painted are rendered,
+ * and the least recently used tiles are dropped if the cache exceeds its byte budget.
+ *
+ * The cache is used from the UI thread (painting) and the scheduler threads (rendering).
+ */
+class PageTileCache
+{
+public:
+	/**
+	 * @param maxBytes The memory budget for all rendered tiles
+	 */
+	PageTileCache(size_t maxBytes);
+	virtual ~PageTileCache();
+
+private:
+	PageTileCache(const PageTileCache& cache);
+	void operator=(const PageTileCache& cache);
+
+public:
+	/**
+	 * Returns the rendered tile, or NULL if it is not rendered yet. If there is no entry yet,
+	 * an empty dirty entry is added, so the tile is rendered by the next RenderJob.
+	 *
+	 * @param dirty Returns whether the tile needs to be (re)rendered
+	 * @return A new reference to the surface, which has to be destroyed by the caller
+	 */
+	cairo_surface_t* lookup(XojPageView* view, double zoom, int x, int y, bool* dirty);
+
+	/**
+	 * Returns the rendered tile without marking it for rendering, used to paint outdated
+	 * zoom levels while the current one is rendered
+	 *
+	 * @return A new reference to the surface, or NULL
+	 */
+	cairo_surface_t* peek(XojPageView* view, double zoom, int x, int y);
+
+	/**
+	 * Stores a rendered tile, the cache takes the ownership of the surface
+	 */
+	void store(XojPageView* view, double zoom, int x, int y, cairo_surface_t* surface);
+
+	/**
+	 * Returns the dirty tiles of the view on this zoom level and clears their dirty flag.
+	 * If they are invalidated again while rendering, they are returned by the next call.
+	 */
+	std::vector<TileIndex> takeDirtyTiles(XojPageView* view, double zoom);
+
+	/**
+	 * Marks all tiles of the view overlapping the area (in page coordinates) as dirty
+	 */
+	void invalidate(XojPageView* view, double x, double y, double width, double height);
+
+	/**
+	 * Marks all tiles of the view as dirty
+	 */
+	void invalidate(XojPageView* view);
+
+	/**
+	 * Calls the function for each rendered tile of the view on this zoom level,
+	 * with the cache locked
+	 */
+	void forEachTile(XojPageView* view, double zoom, std::function<void(TileIndex, cairo_surface_t*)> fn);
+
+	/**
+	 * Removes all tiles of the view
+	 */
+	void removeView(XojPageView* view);
+
+	/**
+	 * @return true if there is at least one rendered tile of this view
+	 */
+	bool hasTiles(XojPageView* view);
+
+	/**
+	 * @return The count of pixels rendered for this view
+	 */
+	size_t getPixels(XojPageView* view);
+
+private:
+	struct TileKey
+	{
+		XojPageView* view;
+		double zoom;
+		int x;
+		int y;
+
+		bool operator==(const TileKey& other) const
+		{
+			return view == other.view && zoom == other.zoom && x == other.x && y == other.y;
+		}
+	};
+
+	struct TileKeyHash
+	{
+		size_t operator()(const TileKey& key) const;
+	};
+
+	struct Tile
+	{
+		TileKey key;
+		cairo_surface_t* surface;
+		bool dirty;
+	};
+
+	typedef std::list<Tile> TileList;
+
+private:
+	TileList::iterator find(const TileKey& key);
+	void touch(TileList::iterator it);
+	void removeUnlocked(TileList::iterator it);
+	void evictUnlocked();
+
+	static size_t surfaceBytes(cairo_surface_t* surface);
+
+private:
+	XOJ_TYPE_ATTRIB;
+
+	GMutex mutex;
+
+	/**
+	 * Most recently used tiles first
+	 */
+	TileList tiles;
+	std::unordered_map<TileKey, TileList::iterator, TileKeyHash> index;
+
+	size_t bytes = 0;
+	size_t maxBytes;
+
+	/**
+	 * Limits also the entries without rendered surface
+	 */
+	size_t maxTiles;
+};
@@ -1,5 +1,6 @@
 #include "PageView.h"
 
+#include "PageTileCache.h"
 #include "RepaintHandler.h"
 #include "TextEditor.h"
 #include "XournalView.h"
@@ -61,8 +62,6 @@ XojPageView::XojPageView(XournalView* xournal, PageRef page)
 
 	g_mutex_init(&this->drawingMutex);
 
-	g_mutex_init(&this->repaintRectMutex);
-
 	// this does not have to be deleted afterwards:
 	// (we need it for undo commands)
 	this->oldtext = nullptr;
@@ -89,12 +88,6 @@ XojPageView::~XojPageView()
 	endText();
 	deleteViewBuffer();
 
-	for (Rectangle* rect: this->rerenderRects)
-	{
-		delete rect;
-	}
-	this->rerenderRects.clear();
-
 	delete this->search;
 	this->search = nullptr;
 
@@ -121,7 +114,7 @@ int XojPageView::getLastVisibleTime()
 {
 	XOJ_CHECK_TYPE(XojPageView);
 
-	if (this->crBuffer == nullptr)
+	if (!this->xournal->getTileCache()->hasTiles(this))
 	{
 		return -1;
 	}
@@ -133,13 +126,7 @@ void XojPageView::deleteViewBuffer()
 {
 	XOJ_CHECK_TYPE(XojPageView);
 
-	g_mutex_lock(&this->drawingMutex);
-	if (this->crBuffer)
-	{
-		cairo_surface_destroy(this->crBuffer);
-		this->crBuffer = nullptr;
-	}
-	g_mutex_unlock(&this->drawingMutex);
+	this->xournal->getTileCache()->removeView(this);
 }
 
 bool XojPageView::containsPoint(int x, int y, bool local)
@@ -161,32 +148,26 @@ bool XojPageView::containsPoint(int x, int y, bool local)
 	}
 }
 
-bool XojPageView::searchTextOnPage(string& text, int* occures, double* top)
+void XojPageView::setSearchResults(vector<XojPdfRectangle> results)
 {
 	XOJ_CHECK_TYPE(XojPageView);
 
 	if (this->search == nullptr)
 	{
-		if (text.empty()) return true;
-
-		int pNr = this->page->getPdfPageNr();
-		XojPdfPageSPtr pdf = nullptr;
-		if (pNr != -1)
+		if (results.empty())
 		{
-			Document* doc = xournal->getControl()->getDocument();
-
-			doc->lock();
-			pdf = doc->getPdfPage(pNr);
-			doc->unlock();
+			return;
 		}
-		this->search = new SearchControl(page, pdf);
+		this->search = new SearchControl();
+	}
+	else if (!this->search->hasResults() && results.empty())
+	{
+		return;
 	}
 
-	bool found = this->search->search(text, occures, top);
+	this->search->setResults(results);
 
 	repaintPage();
-
-	return found;
 }
 
 void XojPageView::endText()
@@ -266,11 +247,12 @@ void XojPageView::startText(double x, double y)
 		// Is there already a textfield?
 		Text* text = nullptr;
 
-		for (Element* e: *this->page->getSelectedLayer()->getElements())
+		GdkRectangle matchRect = {gint(x - 10), gint(y - 10), 20, 20};
+		Layer* layer = this->page->getSelectedLayer();
+		for (Element* e: layer->getElementsInArea(matchRect.x, matchRect.y, matchRect.width, matchRect.height))
 		{
 			if (e->getType() == ELEMENT_TEXT)
 			{
-				GdkRectangle matchRect = {gint(x - 10), gint(y - 10), 20, 20};
 				if (e->intersectsArea(&matchRect))
 				{
 					text = (Text*) e;
@@ -729,7 +711,7 @@ void XojPageView::rerenderPage()
 {
 	XOJ_CHECK_TYPE(XojPageView);
 
-	this->rerenderComplete = true;
+	this->xournal->getTileCache()->invalidate(this);
 	this->xournal->getControl()->getScheduler()->addRerenderPage(this);
 }
 
@@ -764,33 +746,8 @@ void XojPageView::addRerenderRect(double x, double y, double width, double heigh
 {
 	XOJ_CHECK_TYPE(XojPageView);
 
-	if (this->rerenderComplete)
-	{
-		return;
-	}
-
-	Rectangle* rect = new Rectangle(x, y, width, height);
-
-	g_mutex_lock(&this->repaintRectMutex);
-
-	for (Rectangle* r: this->rerenderRects)
-	{
-		// its faster to redraw only one rect than repaint twice the same area
-		// so loop through the rectangles to be redrawn, if new rectangle
-		// intersects any of them, replace it by the union with the new one
-		if (r->intersects(*rect))
-		{
-			r->add(*rect);
-
-			delete rect;
-
-			g_mutex_unlock(&this->repaintRectMutex);
-			return;
-		}
-	}
-
-	this->rerenderRects.push_back(rect);
-	g_mutex_unlock(&this->repaintRectMutex);
+	// Only the tiles overlapping the rectangle are rendered again
+	this->xournal->getTileCache()->invalidate(this, x, y, width, height);
 
 	this->xournal->getControl()->getScheduler()->addRerenderPage(this);
 }
@@ -804,8 +761,10 @@ void XojPageView::setSelected(bool selected)
 	if (selected)
 	{
 		this->xournal->requestFocus();
-		this->xournal->getRepaintHandler()->repaintPageBorder(this);
 	}
+
+	// Also on deselection, to remove the border
+	this->xournal->getRepaintHandler()->repaintPageBorder(this);
 }
 
 bool XojPageView::cut()
@@ -866,6 +825,8 @@ void XojPageView::drawLoadingPage(cairo_t* cr)
 	int dispWidth = getDisplayWidth();
 	int dispHeight = getDisplayHeight();
 
+	cairo_save(cr);
+
 	cairo_set_source_rgb(cr, 1, 1, 1);
 	cairo_rectangle(cr, 0, 0, dispWidth, dispHeight);
 	cairo_fill(cr);
@@ -881,7 +842,55 @@ void XojPageView::drawLoadingPage(cairo_t* cr)
 	        cr, (page->getWidth() - ex.width) / 2 - ex.x_bearing, (page->getHeight() - ex.height) / 2 - ex.y_bearing);
 	cairo_show_text(cr, txtLoading.c_str());
 
-	rerenderPage();
+	cairo_restore(cr);
+}
+
+void XojPageView::paintFallbackTile(cairo_t* cr, int x, int y, double tileZoom)
+{
+	XOJ_CHECK_TYPE(XojPageView);
+
+	cairo_save(cr);
+
+	cairo_rectangle(cr, x * PAGE_TILE_SIZE, y * PAGE_TILE_SIZE, PAGE_TILE_SIZE, PAGE_TILE_SIZE);
+	cairo_clip(cr);
+
+	cairo_set_source_rgb(cr, 1, 1, 1);
+	cairo_paint(cr);
+
+	if (this->fallbackZoom > 0)
+	{
+		PageTileCache* tileCache = this->xournal->getTileCache();
+		double scale = tileZoom / this->fallbackZoom;
+
+		// The area of this tile in tiles of the previous zoom level
+		int firstX = (int) std::floor(x / scale);
+		int firstY = (int) std::floor(y / scale);
+		int lastX = (int) std::ceil((x + 1) / scale) - 1;
+		int lastY = (int) std::ceil((y + 1) / scale) - 1;
+
+		cairo_scale(cr, scale, scale);
+
+		for (int ty = firstY; ty <= lastY; ty++)
+		{
+			for (int tx = firstX; tx <= lastX; tx++)
+			{
+				cairo_surface_t* tile = tileCache->peek(this, this->fallbackZoom, tx, ty);
+				if (tile == nullptr)
+				{
+					continue;
+				}
+
+				cairo_set_source_surface(cr, tile, tx * PAGE_TILE_SIZE, ty * PAGE_TILE_SIZE);
+				cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_FAST);
+				cairo_rectangle(cr, tx * PAGE_TILE_SIZE, ty * PAGE_TILE_SIZE, PAGE_TILE_SIZE, PAGE_TILE_SIZE);
+				cairo_fill(cr);
+
+				cairo_surface_destroy(tile);
+			}
+		}
+	}
+
+	cairo_restore(cr);
 }
 
 /**
@@ -891,66 +900,102 @@ void XojPageView::paintPageSync(cairo_t* cr, GdkRectangle* rect)
 {
 	XOJ_CHECK_TYPE(XojPageView);
 
-	if (this->crBuffer == nullptr)
-	{
-		drawLoadingPage(cr);
-		return;
-	}
-
 	double zoom = xournal->getZoom();
+	int dpiScaleFactor = xournal->getDpiScaleFactor();
 	int dispWidth = getDisplayWidth();
+	int dispHeight = getDisplayHeight();
+	PageTileCache* tileCache = xournal->getTileCache();
 
-	cairo_save(cr);
-
-	double width = cairo_image_surface_get_width(this->crBuffer);
+	// The tiles are rendered in device pixels
+	double tileZoom = zoom * dpiScaleFactor;
+	if (tileZoom != this->tileZoom)
+	{
+		this->fallbackZoom = this->tileZoom;
+		this->tileZoom = tileZoom;
+	}
 
-	bool rerender = true;
-	if (width / xournal->getDpiScaleFactor() == dispWidth)
+	bool loading = !tileCache->hasTiles(this);
+	if (loading)
 	{
-		rerender = false;
+		drawLoadingPage(cr);
 	}
 
-	if (width != dispWidth)
+	// Only the tiles within the drawn area are painted (and rendered if needed)
+	double x1, y1, x2, y2;
+	if (rect)
+	{
+		x1 = rect->x;
+		y1 = rect->y;
+		x2 = rect->x + rect->width;
+		y2 = rect->y + rect->height;
+	}
+	else
 	{
-		double scale = ((double) dispWidth) / ((double) width);
+		cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+	}
 
-		// Scale current image to fit the zoom level
-		cairo_scale(cr, scale, scale);
-		cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_FAST);
+	x1 = std::max(x1, 0.0) * dpiScaleFactor;
+	y1 = std::max(y1, 0.0) * dpiScaleFactor;
+	x2 = std::min(x2, (double) dispWidth) * dpiScaleFactor;
+	y2 = std::min(y2, (double) dispHeight) * dpiScaleFactor;
 
-		cairo_set_source_surface(cr, this->crBuffer, 0, 0);
+	int firstX = (int) x1 / PAGE_TILE_SIZE;
+	int firstY = (int) y1 / PAGE_TILE_SIZE;
+	int lastX = ((int) std::ceil(x2) - 1) / PAGE_TILE_SIZE;
+	int lastY = ((int) std::ceil(y2) - 1) / PAGE_TILE_SIZE;
 
-		if (rerender)
-		{
-			rerenderPage();
-		}
+	cairo_save(cr);
 
-		rect = nullptr;
-	}
-	else
+	cairo_scale(cr, 1.0 / dpiScaleFactor, 1.0 / dpiScaleFactor);
+
+	// The tiles on the right and bottom border are larger than the page
+	cairo_rectangle(cr, 0, 0, dispWidth * dpiScaleFactor, dispHeight * dpiScaleFactor);
+	cairo_clip(cr);
+
+	if (x2 <= x1 || y2 <= y1)
 	{
-		cairo_set_source_surface(cr, this->crBuffer, 0, 0);
+		// Nothing of the page is drawn
+		lastY = firstY - 1;
 	}
 
-	if (rect)
+	bool needsRender = false;
+	for (int y = firstY; y <= lastY; y++)
 	{
-		cairo_rectangle(cr, rect->x, rect->y, rect->width, rect->height);
-		cairo_fill(cr);
+		for (int x = firstX; x <= lastX; x++)
+		{
+			bool dirty = false;
+			cairo_surface_t* tile = tileCache->lookup(this, tileZoom, x, y, &dirty);
+			needsRender |= dirty;
+
+			if (tile)
+			{
+				cairo_set_source_surface(cr, tile, x * PAGE_TILE_SIZE, y * PAGE_TILE_SIZE);
+				cairo_rectangle(cr, x * PAGE_TILE_SIZE, y * PAGE_TILE_SIZE, PAGE_TILE_SIZE, PAGE_TILE_SIZE);
+				cairo_fill(cr);
+
+				cairo_surface_destroy(tile);
+			}
+			else if (!loading)
+			{
+				paintFallbackTile(cr, x, y, tileZoom);
+			}
+		}
+	}
 
 #ifdef DEBUG_SHOW_PAINT_BOUNDS
-		cairo_set_source_rgb(cr, 1.0, 0.5, 1.0);
-		cairo_set_line_width(cr, 1. / zoom);
-		cairo_rectangle(cr, rect->x, rect->y, rect->width, rect->height);
-		cairo_stroke(cr);
+	cairo_set_source_rgb(cr, 1.0, 0.5, 1.0);
+	cairo_set_line_width(cr, 1.);
+	cairo_rectangle(cr, x1, y1, x2 - x1, y2 - y1);
+	cairo_stroke(cr);
 #endif
-	}
-	else
-	{
-		cairo_paint(cr);
-	}
 
 	cairo_restore(cr);
 
+	if (needsRender)
+	{
+		this->xournal->getControl()->getScheduler()->addRerenderPage(this);
+	}
+
 	// don't paint this with scale, because it needs a 1:1 zoom
 	if (this->verticalSpace)
 	{
@@ -1018,11 +1063,7 @@ int XojPageView::getBufferPixels()
 {
 	XOJ_CHECK_TYPE(XojPageView);
 
-	if (crBuffer)
-	{
-		return cairo_image_surface_get_width(crBuffer) * cairo_image_surface_get_height(crBuffer);
-	}
-	return 0;
+	return this->xournal->getTileCache()->getPixels(this);
 }
 
 GtkColorWrapper XojPageView::getSelectionColor()
@@ -1207,15 +1248,17 @@ void XojPageView::elementChanged(Element* elem)
 
 	if (this->inputHandler && elem == this->inputHandler->getStroke())
 	{
-		g_mutex_lock(&this->drawingMutex);
-
-		cairo_t* cr = cairo_create(this->crBuffer);
-
-		this->inputHandler->draw(cr);
+		// Draw the finished stroke into the rendered tiles, until they are rendered again
+		double tileZoom = xournal->getZoom() * xournal->getDpiScaleFactor();
+		xournal->getTileCache()->forEachTile(this, tileZoom, [&](TileIndex index, cairo_surface_t* tile)
+		{
+			cairo_t* cr = cairo_create(tile);
+			cairo_translate(cr, -index.x * PAGE_TILE_SIZE, -index.y * PAGE_TILE_SIZE);
 
-		cairo_destroy(cr);
+			this->inputHandler->draw(cr);
 
-		g_mutex_unlock(&this->drawingMutex);
+			cairo_destroy(cr);
+		});
 	}
 	else
 	{
@@ -17,6 +17,7 @@
 #include "model/PageListener.h"
 #include "model/PageRef.h"
 #include "model/TexImage.h"
+#include "pdf/base/XojPdfPage.h"
 
 #include <Range.h>
 
@@ -56,7 +57,10 @@ public:
 
 	void endText();
 
-	bool searchTextOnPage(string& text, int* occures, double* top);
+	/**
+	 * Shows the search results of this page, an empty list removes the results
+	 */
+	void setSearchResults(vector<XojPdfRectangle> results);
 
 	bool onKeyPressEvent(GdkEventKey* event);
 	bool onKeyReleaseEvent(GdkEventKey* event);
@@ -178,6 +182,11 @@ private:
 	void addRerenderRect(double x, double y, double width, double height);
 
 	void drawLoadingPage(cairo_t* cr);
+
+	/**
+	 * Paints a tile which is not yet rendered, scaled from the tiles of the previous zoom level
+	 */
+	void paintFallbackTile(cairo_t* cr, int x, int y, double tileZoom);
 	
 	void setX(int x);
 	void setY(int y);
@@ -213,7 +222,12 @@ private:
 
 	bool selected = false;
 
-	cairo_surface_t* crBuffer = nullptr;
+	/**
+	 * The zoom level (including the DPI scale factor) of the last paint,
+	 * and the one before, which is used while the tiles are rerendered
+	 */
+	double tileZoom = -1;
+	double fallbackZoom = -1;
 
 	bool inEraser = false;
 
@@ -232,10 +246,6 @@ private:
 	 */
 	int lastVisibleTime = -1;
 
-	GMutex repaintRectMutex;
-	vector<Rectangle*> rerenderRects;
-	bool rerenderComplete = false;
-
 	GMutex drawingMutex;
 	
 	int dispX;	//position on display - set in Layout::layoutPages
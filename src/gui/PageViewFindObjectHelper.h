@@ -52,7 +52,7 @@ public:
 protected:
 	bool checkLayer(Layer* l)
 	{
-		for (Element* e : *l->getElements())
+		for (Element* e : l->getElementsInArea(matchRect.x, matchRect.y, matchRect.width, matchRect.height))
 		{
 			if (e->intersectsArea(&matchRect))
 			{
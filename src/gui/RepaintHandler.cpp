@@ -1,11 +1,13 @@
 #include "RepaintHandler.h"
 
 #include "PageView.h"
+#include "Shadow.h"
 #include "XournalView.h"
 
-#include "gui/scroll/ScrollHandling.h"
 #include "widgets/XournalWidget.h"
 
+#include <algorithm>
+
 RepaintHandler::RepaintHandler(XournalView* xournal)
  : xournal(xournal)
 {
@@ -25,41 +27,34 @@ void RepaintHandler::repaintPage(XojPageView* view)
 {
 	XOJ_CHECK_TYPE(RepaintHandler);
 
-	if (xournal->getScrollHandling()->fullRepaint())
-	{
-		gtk_widget_queue_draw(this->xournal->getWidget());
-	}
-	else
-	{
-		int x1 = view->getX();
-		int y1 = view->getY();
-		int x2 = x1 + view->getDisplayWidth();
-		int y2 = y1 + view->getDisplayHeight();
-
-		gtk_xournal_repaint_area(this->xournal->getWidget(), x1, y1, x2, y2);
-	}
+	int x1 = view->getX();
+	int y1 = view->getY();
+	int x2 = x1 + view->getDisplayWidth();
+	int y2 = y1 + view->getDisplayHeight();
+
+	gtk_xournal_repaint_area(this->xournal->getWidget(), x1, y1, x2, y2);
 }
 
 void RepaintHandler::repaintPageArea(XojPageView* view, int x1, int y1, int x2, int y2)
 {
 	XOJ_CHECK_TYPE(RepaintHandler);
 
-
-	if (xournal->getScrollHandling()->fullRepaint())
-	{
-		gtk_widget_queue_draw(this->xournal->getWidget());
-	}
-	else
-	{
-		int x = view->getX();
-		int y = view->getY();
-		gtk_xournal_repaint_area(this->xournal->getWidget(), x + x1, y + y1, x + x2, y + y2);
-	}
+	int x = view->getX();
+	int y = view->getY();
+	gtk_xournal_repaint_area(this->xournal->getWidget(), x + x1, y + y1, x + x2, y + y2);
 }
 
 void RepaintHandler::repaintPageBorder(XojPageView* view)
 {
 	XOJ_CHECK_TYPE(RepaintHandler);
 
-	gtk_widget_queue_draw(this->xournal->getWidget());
+	// The border of the selected page is drawn 2px outside of the shadow
+	int border = std::max(Shadow::getShadowTopLeftSize(), Shadow::getShadowBottomRightSize()) + 4;
+
+	int x1 = view->getX() - border;
+	int y1 = view->getY() - border;
+	int x2 = view->getX() + view->getDisplayWidth() + border;
+	int y2 = view->getY() + view->getDisplayHeight() + border;
+
+	gtk_xournal_repaint_area(this->xournal->getWidget(), x1, y1, x2, y2);
 }
@@ -37,13 +37,45 @@ SearchBar::~SearchBar()
 	XOJ_RELEASE_TYPE(SearchBar);
 }
 
-bool SearchBar::searchTextonCurrentPage(const char* text, int* occures, double* top)
+bool SearchBar::findOnPage(const vector<SearchHit>& hits, size_t page, int* occures, double* top)
 {
-	XOJ_CHECK_TYPE(SearchBar);
+	int count = 0;
+	double min = 0;
+
+	for (const SearchHit& hit : hits)
+	{
+		if (hit.page != page)
+		{
+			continue;
+		}
+
+		min = count == 0 ? hit.rect.y1 : MIN(min, hit.rect.y1);
+		count++;
+	}
+
+	if (occures)
+	{
+		*occures = count;
+	}
+	if (top)
+	{
+		*top = min;
+	}
 
-	int p = control->getCurrentPageNo();
+	return count > 0;
+}
+
+void SearchBar::showPageMessage(size_t page, int occures)
+{
+	XOJ_CHECK_TYPE(SearchBar);
 
-	return control->searchTextOnPage(text, p, occures, top);
+	GtkWidget* lbSearchState = control->getWindow()->get("lbSearchState");
+	gtk_label_set_text(GTK_LABEL(lbSearchState),
+		(occures == 1
+			? FC(_F("Text found once on page {1}") % (page + 1))
+			: FC(_F("Text found {1} times on page {2}") % occures % (page + 1))
+		)
+	);
 }
 
 void SearchBar::search(const char* text)
@@ -58,8 +90,16 @@ void SearchBar::search(const char* text)
 
 	if (*text != 0)
 	{
-		found = searchTextonCurrentPage(text, &occures, NULL);
-		if (found)
+		vector<SearchHit> hits = control->searchText(text);
+		found = findOnPage(hits, control->getCurrentPageNo(), &occures, NULL);
+		if (!found && !hits.empty())
+		{
+			// Not on this page, but the whole document is searched anyway
+			found = true;
+			findOnPage(hits, hits[0].page, &occures, NULL);
+			showPageMessage(hits[0].page, occures);
+		}
+		else if (found)
 		{
 			if (occures == 1)
 			{
@@ -79,7 +119,7 @@ void SearchBar::search(const char* text)
 	}
 	else
 	{
-		searchTextonCurrentPage("", NULL, NULL);
+		control->searchText("");
 		gtk_label_set_text(GTK_LABEL(lbSearchState), "");
 	}
 
@@ -137,20 +177,15 @@ void SearchBar::searchNext()
 
 	double top = 0;
 	int occures = 0;
+	vector<SearchHit> hits = control->searchText(text);
 
 	while (x != page)
 	{
 
-		bool found = control->searchTextOnPage(text, x, &occures, &top);
-		if (found)
+		if (findOnPage(hits, x, &occures, &top))
 		{
 			control->getScrollHandler()->scrollToPage(x, top);
-			gtk_label_set_text(GTK_LABEL(lbSearchState),
-				(occures == 1
-					? FC(_F("Text found once on page {1}") % (x + 1))
-					: FC(_F("Text found {1} times on page {2}") % occures % (x + 1))
-				)
-			);
+			showPageMessage(x, occures);
 			return;
 		}
 
@@ -193,20 +228,15 @@ void SearchBar::searchPrevious()
 
 	double top = 0;
 	int occures = 0;
+	vector<SearchHit> hits = control->searchText(text);
 
 	while (x != page)
 	{
 
-		bool found = control->searchTextOnPage(text, x, &occures, &top);
-		if (found)
+		if (findOnPage(hits, x, &occures, &top))
 		{
 			control->getScrollHandler()->scrollToPage(x, top);
-			gtk_label_set_text(GTK_LABEL(lbSearchState),
-				(occures == 1
-					? FC(_F("Text found once on page {1}") % (x + 1))
-					: FC(_F("Text found {1} times on page {2}") % occures % (x + 1))
-				)
-			);
+			showPageMessage(x, occures);
 			return;
 		}
 
@@ -250,9 +280,6 @@ void SearchBar::showSearchBar(bool show)
 	else
 	{
 		gtk_widget_hide(searchBar);
-		for (int i = control->getDocument()->getPageCount() - 1; i >= 0; i--)
-		{
-			control->searchTextOnPage("", i, NULL, NULL);
-		}
+		control->searchText("");
 	}
 }
@@ -11,6 +11,8 @@
 
 #pragma once
 
+#include "control/SearchIndex.h"
+
 #include <XournalType.h>
 
 #include <gtk/gtk.h>
@@ -36,7 +38,16 @@ private:
 	void searchPrevious();
 
 	void search(const char* text);
-	bool searchTextonCurrentPage(const char* text, int* occures, double* top);
+
+	/**
+	 * Counts the hits on the page
+	 *
+	 * @param top Returns the top of the highest hit
+	 * @return true if there are hits on the page
+	 */
+	static bool findOnPage(const vector<SearchHit>& hits, size_t page, int* occures, double* top);
+
+	void showPageMessage(size_t page, int occures);
 
 private:
 	XOJ_TYPE_ATTRIB;
@@ -1,6 +1,7 @@
 #include "XournalView.h"
 
 #include "Layout.h"
+#include "PageTileCache.h"
 #include "PageView.h"
 #include "RepaintHandler.h"
 #include "Shadow.h"
@@ -24,6 +25,16 @@
 #include <cmath>
 #include <tuple>
 
+/**
+ * Memory budget for the rendered page tiles
+ */
+#define PAGE_TILE_CACHE_BYTES (256 * 1024 * 1024)
+
+/**
+ * Count of pages in scroll direction whose PDF background is rendered in advance
+ */
+#define PDF_PREFETCH_PAGES 2
+
 XournalView::XournalView(GtkWidget* parent, Control* control, ScrollHandling* scrollHandling, ZoomGesture* zoomGesture)
  : scrollHandling(scrollHandling)
  , control(control)
@@ -31,7 +42,9 @@ XournalView::XournalView(GtkWidget* parent, Control* control, ScrollHandling* sc
 {
 	XOJ_INIT_TYPE(XournalView);
 
-	this->cache = new PdfCache(control->getSettings()->getPdfPageCacheSize());
+	this->cache = new PdfCache((size_t) control->getSettings()->getPdfPageCacheSize() * PDF_CACHE_BYTES_PER_PAGE);
+	this->tileCache = new PageTileCache(PAGE_TILE_CACHE_BYTES);
+	this->searchIndex = new SearchIndex();
 	registerListener(control);
 
 	InputContext* inputContext = nullptr;
@@ -79,8 +92,14 @@ XournalView::~XournalView()
 	this->viewPagesLen = 0;
 	this->viewPages = nullptr;
 
+	this->control->getScheduler()->removePdfCache(this->cache);
 	delete this->cache;
 	this->cache = nullptr;
+	delete this->tileCache;
+	this->tileCache = nullptr;
+	this->control->getScheduler()->removeSearchIndex(this->searchIndex);
+	delete this->searchIndex;
+	this->searchIndex = nullptr;
 	delete this->repaintHandler;
 	this->repaintHandler = nullptr;
 
@@ -434,17 +453,28 @@ void XournalView::requestFocus()
 	gtk_widget_grab_focus(this->widget);
 }
 
-bool XournalView::searchTextOnPage(string text, size_t p, int* occures, double* top)
+vector<SearchHit> XournalView::searchText(string text)
 {
 	XOJ_CHECK_TYPE(XournalView);
 
-	if (p == size_t_npos || p >= this->viewPagesLen)
+	vector<SearchHit> hits;
+	if (!text.empty())
 	{
-		return false;
+		hits = this->searchIndex->search(control->getDocument(), text);
+	}
+
+	size_t h = 0;
+	for (size_t i = 0; i < this->viewPagesLen; i++)
+	{
+		vector<XojPdfRectangle> results;
+		for (; h < hits.size() && hits[h].page == i; h++)
+		{
+			results.push_back(hits[h].rect);
+		}
+		this->viewPages[i]->setSearchResults(results);
 	}
-	XojPageView* v = this->viewPages[p];
 
-	return v->searchTextOnPage(text, occures, top);
+	return hits;
 }
 
 void XournalView::forceUpdatePagenumbers()
@@ -489,6 +519,8 @@ void XournalView::pageSelected(size_t page)
 		this->viewPages[this->lastSelectedPage]->setSelected(false);
 	}
 
+	prefetchPdfPages(page, this->currentPage);
+
 	this->currentPage = page;
 
 	size_t pdfPage = size_t_npos;
@@ -506,6 +538,50 @@ void XournalView::pageSelected(size_t page)
 	control->updateBackgroundSizeButton();
 }
 
+void XournalView::prefetchPdfPages(size_t page, size_t previousPage)
+{
+	XOJ_CHECK_TYPE(XournalView);
+
+	if (page == size_t_npos || previousPage == size_t_npos || page == previousPage)
+	{
+		return;
+	}
+
+	int direction = page > previousPage ? 1 : -1;
+	double zoom = getZoom() * getDpiScaleFactor();
+	vector<XojPdfPageSPtr> pages;
+
+	Document* doc = control->getDocument();
+	doc->lock();
+	for (int i = 1; i <= PDF_PREFETCH_PAGES; i++)
+	{
+		size_t p = page + direction * i;
+		if (p >= doc->getPageCount())
+		{
+			// Also catches the wrap around below page 0
+			break;
+		}
+
+		PageRef nextPage = doc->getPage(p);
+		if (!nextPage->getBackgroundType().isPdfPage())
+		{
+			continue;
+		}
+
+		XojPdfPageSPtr popplerPage = doc->getPdfPage(nextPage->getPdfPageNr());
+		if (popplerPage && !this->cache->isCached(popplerPage, zoom))
+		{
+			pages.push_back(popplerPage);
+		}
+	}
+	doc->unlock();
+
+	if (!pages.empty())
+	{
+		control->getScheduler()->addPrefetchPdf(this->cache, pages, zoom);
+	}
+}
+
 Control* XournalView::getControl()
 {
 	XOJ_CHECK_TYPE(XournalView);
@@ -801,6 +877,13 @@ PdfCache* XournalView::getCache()
 	return this->cache;
 }
 
+PageTileCache* XournalView::getTileCache()
+{
+	XOJ_CHECK_TYPE(XournalView);
+
+	return this->tileCache;
+}
+
 void XournalView::pageInserted(size_t page)
 {
 	XOJ_CHECK_TYPE(XournalView);
@@ -1007,6 +1090,12 @@ void XournalView::documentChanged(DocumentChangeType type)
 {
 	XOJ_CHECK_TYPE(XournalView);
 
+	// Another PDF may be loaded, the cached renders are keyed by the page number in the PDF
+	if (type == DOCUMENT_CHANGE_CLEARED || type == DOCUMENT_CHANGE_COMPLETE || type == DOCUMENT_CHANGE_PDF_BOOKMARKS)
+	{
+		this->cache->clearCache();
+	}
+
 	if (type != DOCUMENT_CHANGE_CLEARED && type != DOCUMENT_CHANGE_COMPLETE)
 	{
 		return;
@@ -1036,11 +1125,14 @@ void XournalView::documentChanged(DocumentChangeType type)
 		viewPages[i] = pageView;
 	}
 
+	this->searchIndex->setDocument(doc);
+
 	doc->unlock();
 
 	layoutPages();
 	scrollTo(0, 0);
 
+	scheduler->addSearchIndex(this->searchIndex);
 	scheduler->unlock();
 }
 
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include "control/SearchIndex.h"
 #include "control/zoom/ZoomListener.h"
 #include "control/zoom/ZoomGesture.h"
 #include "model/DocumentListener.h"
@@ -28,6 +29,7 @@ class EditSelection;
 class Layout;
 class PagePositionHandler;
 class XojPageView;
+class PageTileCache;
 class PdfCache;
 class Rectangle;
 class RepaintHandler;
@@ -68,7 +70,12 @@ public:
 
 	XojPageView* getViewFor(size_t pageNr);
 
-	bool searchTextOnPage(string text, size_t p, int* occures, double* top);
+	/**
+	 * Searches the whole document and shows the results on the pages, an empty text removes the results
+	 *
+	 * @return All hits, sorted by page
+	 */
+	vector<SearchHit> searchText(string text);
 
 	bool cut();
 	bool copy();
@@ -101,6 +108,7 @@ public:
 	int getDpiScaleFactor();
 	Document* getDocument();
 	PdfCache* getCache();
+	PageTileCache* getTileCache();
 	RepaintHandler* getRepaintHandler();
 	GtkWidget* getWidget();
 	XournalppCursor* getCursor();
@@ -154,6 +162,11 @@ private:
 
 	void addLoadPageToQue(PageRef page, int priority);
 
+	/**
+	 * Renders the PDF backgrounds of the next pages in scroll direction in background
+	 */
+	void prefetchPdfPages(size_t page, size_t previousPage);
+
 	Rectangle* getVisibleRect(size_t page);
 
 	static gboolean clearMemoryTimer(XournalView* widget);
@@ -183,6 +196,16 @@ private:
 
 	PdfCache* cache = NULL;
 
+	/**
+	 * Rendered tiles of all page views
+	 */
+	PageTileCache* tileCache = NULL;
+
+	/**
+	 * Full-text index of the document, built in the background
+	 */
+	SearchIndex* searchIndex = NULL;
+
 	/**
 	 * Handler for rerendering pages / repainting pages
 	 */
@@ -32,6 +32,12 @@ InputContext::~InputContext()
 {
 	XOJ_CHECK_TYPE(InputContext);
 
+	for (auto& device : this->devices)
+	{
+		g_object_weak_unref(G_OBJECT(device.first), (GWeakNotify) deviceFinalized, this);
+	}
+	this->devices.clear();
+
 	delete this->stylusHandler;
 	this->stylusHandler = nullptr;
 
@@ -85,78 +91,114 @@ bool InputContext::eventCallback(GtkWidget* widget, GdkEvent* event, InputContex
 	return self->handle(event);
 }
 
-bool InputContext::handle(GdkEvent* sourceEvent)
+InputDeviceClass InputContext::getDeviceClass(GdkDevice* device)
 {
 	XOJ_CHECK_TYPE(InputContext);
 
-	printDebug(sourceEvent);
+	if (device == nullptr)
+	{
+		return INPUT_DEVICE_IGNORE;
+	}
 
-	InputEvent* event = InputEvents::translateEvent(sourceEvent, this->getSettings());
+	Settings* settings = this->getSettings();
 
-	// Add the device to the list of known devices if it is currently unknown
-	GdkDevice* sourceDevice = gdk_event_get_source_device(sourceEvent);
-	if (GDK_SOURCE_KEYBOARD != gdk_device_get_source(sourceDevice) &&
-	    gdk_device_get_device_type(sourceDevice) != GDK_DEVICE_TYPE_MASTER &&
-	    this->knownDevices.find(string(event->deviceName)) == this->knownDevices.end())
+	auto it = this->devices.find(device);
+	if (it != this->devices.end() && it->second.version == settings->getDeviceClassesVersion())
 	{
-		this->knownDevices.insert(string(event->deviceName));
-		this->getSettings()->transactionStart();
-		this->getSettings()->setDeviceClassForDevice(gdk_event_get_source_device(sourceEvent), event->deviceClass);
-		this->getSettings()->transactionEnd();
+		return it->second.deviceClass;
 	}
 
+	if (it == this->devices.end())
+	{
+		g_object_weak_ref(G_OBJECT(device), (GWeakNotify) deviceFinalized, this);
+		it = this->devices.emplace(device, DeviceInfo()).first;
+
+		// Add the device to the list of known devices if it is currently unknown
+		const gchar* name = gdk_device_get_name(device);
+		if (GDK_SOURCE_KEYBOARD != gdk_device_get_source(device) &&
+		    gdk_device_get_device_type(device) != GDK_DEVICE_TYPE_MASTER &&
+		    this->knownDevices.find(name) == this->knownDevices.end())
+		{
+			this->knownDevices.insert(name);
+			settings->transactionStart();
+			settings->setDeviceClassForDevice(device, settings->getDeviceClassForDevice(device));
+			settings->transactionEnd();
+		}
+	}
+
+	it->second.deviceClass = InputEvents::translateDeviceType(device, settings);
+	it->second.version = settings->getDeviceClassesVersion();
+
+	return it->second.deviceClass;
+}
+
+void InputContext::deviceFinalized(InputContext* self, GObject* device)
+{
+	XOJ_CHECK_TYPE_OBJ(self, InputContext);
+
+	self->devices.erase((GdkDevice*) device);
+}
+
+bool InputContext::handle(GdkEvent* sourceEvent)
+{
+	XOJ_CHECK_TYPE(InputContext);
+
+	printDebug(sourceEvent);
+
+	// The event is kept on the stack, nothing is allocated for the pen input
+	GdkDevice* sourceDevice = gdk_event_get_source_device(sourceEvent);
+	InputEvent event = InputEvents::translateEvent(sourceEvent, getDeviceClass(sourceDevice));
+
 	// We do not handle scroll events manually but let GTK do it for us
-	if (event->type == SCROLL_EVENT)
+	if (event.type == SCROLL_EVENT)
 	{
 		// Hand over to standard GTK Scroll / Zoom handling
 		return false;
 	}
 
 	// Deactivate touchscreen when a pen event occurs
-	this->getView()->getHandRecognition()->event(event->deviceClass);
+	this->getView()->getHandRecognition()->event(event.deviceClass);
 
 	// Get the state of all modifiers
-	this->modifierState = event->state;
+	this->modifierState = event.state;
 
 	// separate events to appropriate handlers
 	// handle tablet stylus
-	if (event->deviceClass == INPUT_DEVICE_PEN || event->deviceClass == INPUT_DEVICE_ERASER)
+	if (event.deviceClass == INPUT_DEVICE_PEN || event.deviceClass == INPUT_DEVICE_ERASER)
 	{
-		return this->stylusHandler->handle(event);
+		return this->stylusHandler->handle(&event);
 	}
 
 	// handle mouse devices
-	if (event->deviceClass == INPUT_DEVICE_MOUSE)
+	if (event.deviceClass == INPUT_DEVICE_MOUSE)
 	{
-		return this->mouseHandler->handle(event);
+		return this->mouseHandler->handle(&event);
 	}
 
 	// handle touchscreens
-	if (event->deviceClass == INPUT_DEVICE_TOUCHSCREEN)
+	if (event.deviceClass == INPUT_DEVICE_TOUCHSCREEN)
 	{
 		// trigger touch drawing depending on the setting
 		if (this->touchWorkaroundEnabled)
 		{
-			return this->touchDrawingHandler->handle(event);
+			return this->touchDrawingHandler->handle(&event);
 		} else
 		{
-			return this->touchHandler->handle(event);
+			return this->touchHandler->handle(&event);
 		}
 	}
 
 	// handle keyboard
-	if (event->deviceClass == INPUT_DEVICE_KEYBOARD)
+	if (event.deviceClass == INPUT_DEVICE_KEYBOARD)
 	{
-		return this->keyboardHandler->handle(event);
+		return this->keyboardHandler->handle(&event);
 	}
 
-	if (event->deviceClass == INPUT_DEVICE_IGNORE)
+	if (event.deviceClass == INPUT_DEVICE_IGNORE)
 	{
 		return true;
 	}
 
-	delete event;
-
 	//We received an event we do not have a handler for
 	return false;
 }
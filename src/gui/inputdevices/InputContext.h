@@ -33,6 +33,7 @@
 #include <gtk/gtk.h>
 
 #include <set>
+#include <unordered_map>
 
 class InputContext
 {
@@ -56,6 +57,26 @@ private:
 
 	std::set<string> knownDevices;
 
+	/**
+	 * The class of a source device
+	 */
+	class DeviceInfo
+	{
+	public:
+		InputDeviceClass deviceClass = INPUT_DEVICE_IGNORE;
+
+		/**
+		 * Settings::getDeviceClassesVersion() when the class was looked up
+		 */
+		unsigned int version = 0;
+	};
+
+	/**
+	 * The classes of the devices seen, the lookup in the settings is by name so it is only
+	 * done if a device is new or the device classes were changed
+	 */
+	std::unordered_map<GdkDevice*, DeviceInfo> devices;
+
 public:
 	enum DeviceType {
 			MOUSE,
@@ -84,6 +105,16 @@ private:
 	 */
 	bool handle(GdkEvent* event);
 
+	/**
+	 * @return The class of the device, cached per device
+	 */
+	InputDeviceClass getDeviceClass(GdkDevice* device);
+
+	/**
+	 * A device was removed, the pointer can be reused by a new device
+	 */
+	static void deviceFinalized(InputContext* self, GObject* device);
+
 	/**
 	 * Print debug output
 	 */
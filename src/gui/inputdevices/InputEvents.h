@@ -43,6 +43,10 @@ enum InputDeviceClass
 	INPUT_DEVICE_IGNORE
 };
 
+/**
+ * An input event, passed by value. The GDK event is not owned and only valid while the
+ * event is handled, a stored copy of the event has no source event.
+ */
 class InputEvent
 {
 public:
@@ -51,7 +55,7 @@ public:
 	InputEventType type = UNKNOWN;
 
 	InputDeviceClass deviceClass = INPUT_DEVICE_IGNORE;
-	gchar* deviceName = nullptr;
+	const gchar* deviceName = nullptr;
 
 
 	gdouble absoluteX = 0;
@@ -66,9 +70,10 @@ public:
 	GdkEventSequence* sequence = nullptr;
 	guint32 timestamp = 0;
 
-	~InputEvent();
-
-	InputEvent* copy();
+	/**
+	 * A copy of the event which can be kept after the event was handled
+	 */
+	InputEvent copyWithoutSource() const;
 };
 
 class InputEvents
@@ -81,7 +86,10 @@ public:
 	static InputDeviceClass translateDeviceType(GdkDevice* device, Settings* settings);
 	static InputDeviceClass translateDeviceType(const string& name, GdkInputSource source, Settings* settings);
 
-	static InputEvent* translateEvent(GdkEvent* sourceEvent, Settings* settings);
+	/**
+	 * @param deviceClass The class of the source device of the event, see translateDeviceType
+	 */
+	static InputEvent translateEvent(GdkEvent* sourceEvent, InputDeviceClass deviceClass);
 };
 
 
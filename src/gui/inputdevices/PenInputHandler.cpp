@@ -38,27 +38,13 @@ void PenInputHandler::updateLastEvent(InputEvent* event)
 		return;
 	}
 
-	InputEvent* oldEvent = this->lastEvent;
-	this->lastEvent = event->copy();
-
-	//Update the refcount of the events for the GTK garbage collector
-	if (oldEvent != nullptr)
-	{
-		delete oldEvent;
-		oldEvent = nullptr;
-	}
+	this->lastEventData = event->copyWithoutSource();
+	this->lastEvent = &this->lastEventData;
 
 	if (getPageAtCurrentPosition(event))
 	{
-		InputEvent* oldHitEvent = this->lastHitEvent;
-		this->lastHitEvent = event->copy();
-
-		//Update the refcount of the events for the GTK garbage collector
-		if (oldHitEvent != nullptr)
-		{
-			delete oldHitEvent;
-			oldHitEvent = nullptr;
-		}
+		this->lastHitEventData = event->copyWithoutSource();
+		this->lastHitEvent = &this->lastHitEventData;
 	}
 }
 
@@ -378,7 +364,6 @@ bool PenInputHandler::actionEnd(InputEvent* event)
 	}
 
 	this->inputRunning = false;
-	delete this->lastHitEvent;
 	this->lastHitEvent = nullptr;
 
 	return false;
@@ -35,15 +35,21 @@ protected:
 	bool modifier3 = false;
 
 	/**
-	 * Reference to the last event
+	 * Reference to the last event, points to lastEventData or is nullptr
 	 */
 	InputEvent* lastEvent = nullptr;
 
 	/**
-	 * Reference to the last event actually hitting a page
+	 * Reference to the last event actually hitting a page, points to lastHitEventData or is nullptr
 	 */
 	InputEvent* lastHitEvent = nullptr;
 
+	/**
+	 * The copies of the last events, kept in place so a motion event does not allocate
+	 */
+	InputEvent lastEventData;
+	InputEvent lastHitEventData;
+
 	/**
 	 * Start position to reference scroll offset
 	 */
@@ -49,13 +49,6 @@ void ScrollHandlingGtk::translate(double& x, double& y)
 	// Nothing to do here - all done by GTK
 }
 
-bool ScrollHandlingGtk::fullRepaint()
-{
-	XOJ_CHECK_TYPE(ScrollHandlingGtk);
-
-	return false;
-}
-
 void ScrollHandlingGtk::scrollChanged()
 {
 	XOJ_CHECK_TYPE(ScrollHandlingGtk);
@@ -63,13 +63,6 @@ void ScrollHandlingXournalpp::translate(double& x, double& y)
 	y += v;
 }
 
-bool ScrollHandlingXournalpp::fullRepaint()
-{
-	XOJ_CHECK_TYPE(ScrollHandlingXournalpp);
-
-	return true;
-}
-
 void ScrollHandlingXournalpp::scrollChanged()
 {
 	XOJ_CHECK_TYPE(ScrollHandlingXournalpp);
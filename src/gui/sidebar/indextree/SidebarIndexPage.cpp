@@ -49,6 +49,7 @@ SidebarIndexPage::SidebarIndexPage(Control* control, SidebarToolbar* toolbar)
 	g_object_set(G_OBJECT(renderer), "style", PANGO_STYLE_ITALIC, NULL);
 
 	g_signal_connect(treeViewBookmarks, "cursor-changed", G_CALLBACK(treeBookmarkSelected), this);
+	g_signal_connect(treeViewBookmarks, "row-expanded", G_CALLBACK(treeRowExpanded), this);
 
 	gtk_widget_show(this->treeViewBookmarks);
 
@@ -197,6 +198,17 @@ bool SidebarIndexPage::treeBookmarkSelected(GtkWidget* treeview, SidebarIndexPag
 	return false;
 }
 
+void SidebarIndexPage::treeRowExpanded(GtkTreeView* treeView, GtkTreeIter* iter, GtkTreePath* path,
+									   SidebarIndexPage* sidebar)
+{
+	XOJ_CHECK_TYPE_OBJ(sidebar, SidebarIndexPage);
+
+	Document* doc = sidebar->control->getDocument();
+	doc->lock();
+	doc->expandContentsRow(iter);
+	doc->unlock();
+}
+
 bool SidebarIndexPage::searchTimeoutFunc(SidebarIndexPage* sidebar)
 {
 	XOJ_CHECK_TYPE_OBJ(sidebar, SidebarIndexPage);
@@ -443,9 +455,12 @@ void SidebarIndexPage::documentChanged(DocumentChangeType type)
 
 		doc->lock();
 		GtkTreeModel* model = doc->getContentsModel();
+		doc->unlock();
+
 		gtk_tree_view_set_model(GTK_TREE_VIEW(this->treeViewBookmarks), model);
+
+		// Not locked, expanding a row locks the document to add the bookmarks below it
 		int count = expandOpenLinks(model, NULL);
-		doc->unlock();
 
 		hasContents = (count != 0);
 	}
@@ -75,6 +75,11 @@ private:
 	 */
 	static bool treeBookmarkSelected(GtkWidget* treeview, SidebarIndexPage* sidebar);
 
+	/**
+	 * A row was expanded, the bookmarks below its children are added to the model
+	 */
+	static void treeRowExpanded(GtkTreeView* treeView, GtkTreeIter* iter, GtkTreePath* path, SidebarIndexPage* sidebar);
+
 	/**
 	 * If you select a Bookmark wich is currently not in the Xournal document, only in the PDF (page deleted or so)
 	 */
@@ -82,7 +82,12 @@ public:
 		{
 			int currentY = (height - p->getHeight()) / 2;
 
-			gtk_layout_move(layout, p->getWidget(), x, y + currentY);
+			// Entries of a virtualized sidebar are only placed when they get a widget
+			p->setPosition(x, y + currentY);
+			if (p->getWidget())
+			{
+				gtk_layout_move(layout, p->getWidget(), x, y + currentY);
+			}
 
 			x += p->getWidth();
 		}
@@ -2,6 +2,7 @@
 
 #include "control/Control.h"
 #include "control/PdfCache.h"
+#include "control/ThumbnailCache.h"
 #include "SidebarLayout.h"
 #include "SidebarPreviewBaseEntry.h"
 
@@ -13,7 +14,8 @@ SidebarPreviewBase::SidebarPreviewBase(Control* control, GladeGui* gui, SidebarT
 
 	this->layoutmanager = new SidebarLayout();
 
-	this->cache = new PdfCache(control->getSettings()->getPdfPageCacheSize());
+	this->cache = new PdfCache((size_t) control->getSettings()->getPdfPageCacheSize() * PDF_CACHE_BYTES_PER_PAGE);
+	this->thumbnails = new ThumbnailCache();
 
 	this->iconViewPreview = gtk_layout_new(NULL, NULL);
 	g_object_ref(this->iconViewPreview);
@@ -33,6 +35,14 @@ SidebarPreviewBase::SidebarPreviewBase(Control* control, GladeGui* gui, SidebarT
 
 	g_signal_connect(this->scrollPreview, "size-allocate", G_CALLBACK(sizeChanged), this);
 
+	GtkAdjustment* vadj = gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(this->scrollPreview));
+	g_signal_connect(vadj, "value-changed", G_CALLBACK(
+		+[](GtkAdjustment* adjustment, SidebarPreviewBase* self)
+		{
+			XOJ_CHECK_TYPE_OBJ(self, SidebarPreviewBase);
+			self->updateVisibleWidgets();
+		}), this);
+
 	gtk_widget_show_all(this->scrollPreview);
 
 	g_signal_connect(this->iconViewPreview, "draw", G_CALLBACK(Util::paintBackgroundWhite), NULL);
@@ -42,6 +52,9 @@ SidebarPreviewBase::~SidebarPreviewBase()
 {
 	XOJ_CHECK_TYPE(SidebarPreviewBase);
 
+	GtkAdjustment* vadj = gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(this->scrollPreview));
+	g_signal_handlers_disconnect_by_data(vadj, this);
+
 	gtk_widget_destroy(this->iconViewPreview);
 	this->iconViewPreview = NULL;
 
@@ -59,6 +72,10 @@ SidebarPreviewBase::~SidebarPreviewBase()
 	}
 	this->previews.clear();
 
+	// The preview jobs are done, the entries are deleted
+	delete this->thumbnails;
+	this->thumbnails = NULL;
+
 	XOJ_RELEASE_TYPE(SidebarPreviewBase);
 }
 
@@ -92,6 +109,11 @@ void SidebarPreviewBase::sizeChanged(GtkWidget* widget, GtkAllocation* allocatio
 		sidebar->layout();
 		lastWidth = allocation->width;
 	}
+	else
+	{
+		// The height may have changed
+		sidebar->updateVisibleWidgets();
+	}
 }
 
 double SidebarPreviewBase::getZoom()
@@ -108,11 +130,50 @@ PdfCache* SidebarPreviewBase::getCache()
 	return this->cache;
 }
 
+ThumbnailCache* SidebarPreviewBase::getThumbnailCache()
+{
+	XOJ_CHECK_TYPE(SidebarPreviewBase);
+
+	return this->thumbnails;
+}
+
 void SidebarPreviewBase::layout()
 {
 	XOJ_CHECK_TYPE(SidebarPreviewBase);
 
 	this->layoutmanager->layout(this);
+	updateVisibleWidgets();
+}
+
+void SidebarPreviewBase::updateVisibleWidgets()
+{
+	XOJ_CHECK_TYPE(SidebarPreviewBase);
+
+	if (!this->virtualized)
+	{
+		return;
+	}
+
+	// Half a screen above and below is kept, so scrolling does not show empty previews
+	GtkAdjustment* vadj = gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(this->scrollPreview));
+	double pageSize = gtk_adjustment_get_page_size(vadj);
+	double top = gtk_adjustment_get_value(vadj) - pageSize / 2;
+	double bottom = gtk_adjustment_get_value(vadj) + pageSize * 1.5;
+
+	for (SidebarPreviewBaseEntry* p : this->previews)
+	{
+		bool visible = p->getY() != -1 && p->getY() + p->getHeight() >= top && p->getY() <= bottom;
+
+		if (visible && !p->hasWidget())
+		{
+			p->createWidget();
+			gtk_layout_put(GTK_LAYOUT(this->iconViewPreview), p->getWidget(), p->getX(), p->getY());
+		}
+		else if (!visible && p->hasWidget())
+		{
+			p->destroyWidget();
+		}
+	}
 }
 
 bool SidebarPreviewBase::hasData()
@@ -133,6 +194,12 @@ void SidebarPreviewBase::documentChanged(DocumentChangeType type)
 {
 	XOJ_CHECK_TYPE(SidebarPreviewBase);
 
+	// Another PDF may be loaded, the cached renders are keyed by the page number in the PDF
+	if (type == DOCUMENT_CHANGE_CLEARED || type == DOCUMENT_CHANGE_COMPLETE || type == DOCUMENT_CHANGE_PDF_BOOKMARKS)
+	{
+		this->cache->clearCache();
+	}
+
 	if (type == DOCUMENT_CHANGE_COMPLETE || type == DOCUMENT_CHANGE_CLEARED)
 	{
 		updatePreviews();
@@ -167,12 +234,10 @@ bool SidebarPreviewBase::scrollToPreview(SidebarPreviewBase* sidebar)
 		// scroll to preview
 		GtkAdjustment* hadj = gtk_scrolled_window_get_hadjustment(GTK_SCROLLED_WINDOW(sidebar->scrollPreview));
 		GtkAdjustment* vadj = gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(sidebar->scrollPreview));
-		GtkWidget* widget = p->getWidget();
 
-		GtkAllocation allocation;
-		gtk_widget_get_allocation(widget, &allocation);
-		int x = allocation.x;
-		int y = allocation.y;
+		// The position is known from the layout, also if the entry has no widget
+		int x = p->getX();
+		int y = p->getY();
 
 		if (x == -1)
 		{
@@ -180,8 +245,8 @@ bool SidebarPreviewBase::scrollToPreview(SidebarPreviewBase* sidebar)
 			return false;
 		}
 
-		gtk_adjustment_clamp_page(vadj, y, y + allocation.height);
-		gtk_adjustment_clamp_page(hadj, x, x + allocation.width);
+		gtk_adjustment_clamp_page(vadj, y, y + p->getHeight());
+		gtk_adjustment_clamp_page(hadj, x, x + p->getWidth());
 	}
 	return false;
 }
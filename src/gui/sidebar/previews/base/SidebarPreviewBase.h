@@ -19,6 +19,7 @@
 
 class PdfCache;
 class SidebarLayout;
+class ThumbnailCache;
 class SidebarPreviewBaseEntry;
 class SidebarToolbar;
 
@@ -62,6 +63,11 @@ public:
 	 */
 	PdfCache* getCache();
 
+	/**
+	 * Gets the disk cache of the rendered previews
+	 */
+	ThumbnailCache* getThumbnailCache();
+
 public:
 	// DocumentListener interface (only the part handled by SidebarPreviewBase)
 	virtual void documentChanged(DocumentChangeType type);
@@ -79,6 +85,12 @@ protected:
 	 */
 	static void sizeChanged(GtkWidget* widget, GtkAllocation* allocation, SidebarPreviewBase* sidebar);
 
+	/**
+	 * Creates the widgets of the entries which got visible and destroys the widgets of the entries
+	 * which are not visible anymore, if virtualized
+	 */
+	void updateVisibleWidgets();
+
 private:
 	XOJ_TYPE_ATTRIB;
 
@@ -97,6 +109,11 @@ private:
 	 */
 	PdfCache* cache = NULL;
 
+	/**
+	 * Previews rendered before, also in earlier sessions
+	 */
+	ThumbnailCache* thumbnails = NULL;
+
 	/**
 	 * The layouting class for the prviews
 	 */
@@ -127,5 +144,11 @@ protected:
 	 */
 	bool enabled = false;
 
+	/**
+	 * Only the entries in and near the visible area have a widget, the entries are added to the
+	 * layout when they get visible
+	 */
+	bool virtualized = false;
+
 	friend class SidebarLayout;
 };
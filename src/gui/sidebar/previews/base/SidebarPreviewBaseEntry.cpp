@@ -13,13 +13,41 @@ SidebarPreviewBaseEntry::SidebarPreviewBaseEntry(SidebarPreviewBase* sidebar, Pa
 {
 	XOJ_INIT_TYPE(SidebarPreviewBaseEntry);
 
+	g_mutex_init(&this->drawingMutex);
+}
+
+SidebarPreviewBaseEntry::~SidebarPreviewBaseEntry()
+{
+	XOJ_CHECK_TYPE(SidebarPreviewBaseEntry);
+
+	destroyWidget();
+
+	this->sidebar->getControl()->getScheduler()->removeSidebar(this);
+	this->page = NULL;
+
+	if (this->crBuffer)
+	{
+		cairo_surface_destroy(this->crBuffer);
+		this->crBuffer = NULL;
+	}
+
+	XOJ_RELEASE_TYPE(SidebarPreviewBaseEntry);
+}
+
+void SidebarPreviewBaseEntry::createWidget()
+{
+	XOJ_CHECK_TYPE(SidebarPreviewBaseEntry);
+
+	if (this->widget)
+	{
+		return;
+	}
+
 	this->widget = gtk_button_new();	// re: issue 1072
-	
+
 	gtk_widget_show(this->widget);
 	g_object_ref(this->widget);
 
-	g_mutex_init(&this->drawingMutex);
-
 	updateSize();
 	gtk_widget_set_events(widget, GDK_EXPOSURE_MASK ); 
 
@@ -34,23 +62,65 @@ SidebarPreviewBaseEntry::SidebarPreviewBaseEntry(SidebarPreviewBase* sidebar, Pa
 		}), this);
 }
 
-SidebarPreviewBaseEntry::~SidebarPreviewBaseEntry()
+void SidebarPreviewBaseEntry::destroyWidget()
 {
 	XOJ_CHECK_TYPE(SidebarPreviewBaseEntry);
 
+	if (this->widget == NULL)
+	{
+		return;
+	}
+
+	// The preview job must not access the widget anymore
 	this->sidebar->getControl()->getScheduler()->removeSidebar(this);
-	this->page = NULL;
 
 	gtk_widget_destroy(this->widget);
+	g_object_unref(this->widget);
 	this->widget = NULL;
 
+	g_mutex_lock(&this->drawingMutex);
 	if (this->crBuffer)
 	{
 		cairo_surface_destroy(this->crBuffer);
 		this->crBuffer = NULL;
 	}
+	g_mutex_unlock(&this->drawingMutex);
+}
 
-	XOJ_RELEASE_TYPE(SidebarPreviewBaseEntry);
+bool SidebarPreviewBaseEntry::hasWidget()
+{
+	XOJ_CHECK_TYPE(SidebarPreviewBaseEntry);
+
+	return this->widget != NULL;
+}
+
+void SidebarPreviewBaseEntry::setPosition(int x, int y)
+{
+	XOJ_CHECK_TYPE(SidebarPreviewBaseEntry);
+
+	this->x = x;
+	this->y = y;
+}
+
+int SidebarPreviewBaseEntry::getX()
+{
+	XOJ_CHECK_TYPE(SidebarPreviewBaseEntry);
+
+	return this->x;
+}
+
+int SidebarPreviewBaseEntry::getY()
+{
+	XOJ_CHECK_TYPE(SidebarPreviewBaseEntry);
+
+	return this->y;
+}
+
+PageRef SidebarPreviewBaseEntry::getPage()
+{
+	XOJ_CHECK_TYPE(SidebarPreviewBaseEntry);
+
+	return this->page;
 }
 
 gboolean SidebarPreviewBaseEntry::drawCallback(GtkWidget* widget, cairo_t* cr, SidebarPreviewBaseEntry* preview)
@@ -71,13 +141,22 @@ void SidebarPreviewBaseEntry::setSelected(bool selected)
 	}
 	this->selected = selected;
 
-	gtk_widget_queue_draw(this->widget);
+	if (this->widget)
+	{
+		gtk_widget_queue_draw(this->widget);
+	}
 }
 
 void SidebarPreviewBaseEntry::repaint()
 {
 	XOJ_CHECK_TYPE(SidebarPreviewBaseEntry);
 
+	// Rendered when it gets visible
+	if (this->widget == NULL)
+	{
+		return;
+	}
+
 	sidebar->getControl()->getScheduler()->addRepaintSidebar(this);
 }
 
@@ -85,10 +164,7 @@ void SidebarPreviewBaseEntry::drawLoadingPage()
 {
 	XOJ_CHECK_TYPE(SidebarPreviewBaseEntry);
 
-	GtkAllocation alloc;
-	gtk_widget_get_allocation(widget, &alloc);
-
-	this->crBuffer = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, alloc.width, alloc.height);
+	this->crBuffer = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, getWidgetWidth(), getWidgetHeight());
 
 	double zoom = sidebar->getZoom();
 
@@ -170,7 +246,10 @@ void SidebarPreviewBaseEntry::updateSize()
 {
 	XOJ_CHECK_TYPE(SidebarPreviewBaseEntry);
 
-	gtk_widget_set_size_request(this->widget, getWidgetWidth(), getWidgetHeight());
+	if (this->widget)
+	{
+		gtk_widget_set_size_request(this->widget, getWidgetWidth(), getWidgetHeight());
+	}
 }
 
 int SidebarPreviewBaseEntry::getWidgetWidth()
@@ -40,10 +40,34 @@ public:
 	virtual ~SidebarPreviewBaseEntry();
 
 public:
+	/**
+	 * The widget, NULL while the entry has none
+	 */
 	virtual GtkWidget* getWidget();
 	virtual int getWidth();
 	virtual int getHeight();
 
+	/**
+	 * Creates the widget. In a virtualized sidebar only the visible entries have a widget.
+	 */
+	virtual void createWidget();
+
+	/**
+	 * Destroys the widget and the rendered preview, until the entry is visible again
+	 */
+	virtual void destroyWidget();
+
+	bool hasWidget();
+
+	/**
+	 * The position in the sidebar, set by the layout, -1 if not layouted yet
+	 */
+	void setPosition(int x, int y);
+	int getX();
+	int getY();
+
+	PageRef getPage();
+
 	virtual void setSelected(bool selected);
 
 	virtual void repaint();
@@ -93,7 +117,10 @@ protected:
 	/**
 	 * The Widget which is used for drawing
 	 */
-	GtkWidget* widget;
+	GtkWidget* widget = NULL;
+
+	int x = -1;
+	int y = -1;
 
 	/**
 	 * Buffer because of performance reasons
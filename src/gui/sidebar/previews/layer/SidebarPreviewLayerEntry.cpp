@@ -14,6 +14,9 @@ SidebarPreviewLayerEntry::SidebarPreviewLayerEntry(SidebarPreviewBase* sidebar,
 {
 	XOJ_INIT_TYPE(SidebarPreviewLayerEntry);
 
+	// The layer sidebar is not virtualized, there are only a few layers
+	createWidget();
+
 	GtkWidget* toolbar = gtk_box_new(GTK_ORIENTATION_HORIZONTAL,6);
 
 	string text;
@@ -8,6 +8,24 @@ SidebarPreviewPageEntry::SidebarPreviewPageEntry(SidebarPreviewPages* sidebar, P
  , sidebar(sidebar)
 {
 	XOJ_INIT_TYPE(SidebarPreviewPageEntry);
+}
+
+SidebarPreviewPageEntry::~SidebarPreviewPageEntry()
+{
+	XOJ_CHECK_TYPE(SidebarPreviewPageEntry);
+	XOJ_RELEASE_TYPE(SidebarPreviewPageEntry);
+}
+
+void SidebarPreviewPageEntry::createWidget()
+{
+	XOJ_CHECK_TYPE(SidebarPreviewPageEntry);
+
+	if (this->widget)
+	{
+		return;
+	}
+
+	SidebarPreviewBaseEntry::createWidget();
 
 	const auto clickCallback = G_CALLBACK(+[](GtkWidget* widget, GdkEvent* event, SidebarPreviewPageEntry* self) {
 		// Open context menu on right mouse click
@@ -26,12 +44,6 @@ SidebarPreviewPageEntry::SidebarPreviewPageEntry(SidebarPreviewPages* sidebar, P
 	g_signal_connect_after(this->widget, "button-press-event", clickCallback, this);
 }
 
-SidebarPreviewPageEntry::~SidebarPreviewPageEntry()
-{
-	XOJ_CHECK_TYPE(SidebarPreviewPageEntry);
-	XOJ_RELEASE_TYPE(SidebarPreviewPageEntry);
-}
-
 PreviewRenderType SidebarPreviewPageEntry::getRenderType()
 {
 	XOJ_CHECK_TYPE(SidebarPreviewPageEntry);
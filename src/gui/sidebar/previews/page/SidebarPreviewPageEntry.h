@@ -32,6 +32,11 @@ public:
 	 */
 	virtual PreviewRenderType getRenderType();
 
+	/**
+	 * @overwrite
+	 */
+	virtual void createWidget();
+
 protected:
 	SidebarPreviewPages* sidebar;
 	virtual void mouseButtonPressCallback();
@@ -10,12 +10,17 @@
 #include "i18n.h"
 #include "util/cpp14memory.h"
 
+#include <unordered_map>
+
 SidebarPreviewPages::SidebarPreviewPages(Control* control, GladeGui* gui, SidebarToolbar* toolbar)
  : SidebarPreviewBase(control, gui, toolbar)
  , contextMenu(gui->get("sidebarPreviewContextMenu"))
 {
 	XOJ_INIT_TYPE(SidebarPreviewPages);
 
+	// Documents may have thousands of pages, only the visible previews get a widget
+	this->virtualized = true;
+
 	// Connect the context menu actions
 	const std::map<std::string, SidebarActions> ctxMenuActions = {
 	        {"sidebarPreviewDuplicate", SIDEBAR_ACTION_COPY},
@@ -193,26 +198,48 @@ void SidebarPreviewPages::updatePreviews()
 	doc->lock();
 	size_t len = doc->getPageCount();
 
-	if (this->previews.size() == len)
+	// The entries of pages which are still in the document are kept, with their rendered preview
+	std::unordered_map<XojPage*, SidebarPreviewBaseEntry*> oldEntries;
+	for (SidebarPreviewBaseEntry* p : this->previews)
 	{
-		doc->unlock();
-		return;
+		oldEntries[(XojPage*) p->getPage()] = p;
 	}
 
-	for (SidebarPreviewBaseEntry* p : this->previews)
+	vector<SidebarPreviewBaseEntry*> entries;
+	entries.reserve(len);
+	bool changed = this->previews.size() != len;
+
+	for (size_t i = 0; i < len; i++)
+	{
+		PageRef page = doc->getPage(i);
+		auto it = oldEntries.find((XojPage*) page);
+
+		SidebarPreviewBaseEntry* p = NULL;
+		if (it != oldEntries.end())
+		{
+			p = it->second;
+			oldEntries.erase(it);
+		}
+		else
+		{
+			p = new SidebarPreviewPageEntry(this, page);
+		}
+
+		changed = changed || this->previews[i] != p;
+		entries.push_back(p);
+	}
+
+	for (auto& old : oldEntries)
 	{
-		delete p;
+		delete old.second;
 	}
-	this->previews.clear();
 
-	for (size_t i = 0; i < len; i++)
+	if (changed)
 	{
-		SidebarPreviewBaseEntry* p = new SidebarPreviewPageEntry(this, doc->getPage(i));
-		this->previews.push_back(p);
-		gtk_layout_put(GTK_LAYOUT(this->iconViewPreview), p->getWidget(), 0, 0);
+		this->previews = entries;
+		layout();
 	}
 
-	layout();
 	doc->unlock();
 }
 
@@ -275,8 +302,6 @@ void SidebarPreviewPages::pageInserted(size_t page)
 
 	this->previews.insert(this->previews.begin() + page, p);
 
-	gtk_layout_put(GTK_LAYOUT(this->iconViewPreview), p->getWidget(), 0, 0);
-
 	// Unselect page, to prevent double selection displaying
 	unselectPage();
 
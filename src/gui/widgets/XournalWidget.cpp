@@ -18,6 +18,8 @@
 #include <gdk/gdkkeysyms.h>
 #include <gui/inputdevices/InputContext.h>
 
+#include <vector>
+
 static void gtk_xournal_class_init(GtkXournalClass* klass);
 static void gtk_xournal_init(GtkXournal* xournal);
 static void gtk_xournal_get_preferred_width(GtkWidget* widget, gint* minimal_width, gint* natural_width);
@@ -270,10 +272,15 @@ void gtk_xournal_repaint_area(GtkWidget* widget, int x1, int y1, int x2, int y2)
 
 	GtkXournal* xournal = GTK_XOURNAL(widget);
 
-	x1 -= xournal->x;
-	x2 -= xournal->x;
-	y1 -= xournal->y;
-	y2 -= xournal->y;
+	// The position of the widget within the layout, if the widget is not scrolled by GTK
+	double offsetX = xournal->x;
+	double offsetY = xournal->y;
+	xournal->scrollHandling->translate(offsetX, offsetY);
+
+	x1 -= (int) offsetX;
+	x2 -= (int) offsetX;
+	y1 -= (int) offsetY;
+	y2 -= (int) offsetY;
 
 	if (x2 < 0 || y2 < 0)
 	{
@@ -298,12 +305,27 @@ static gboolean gtk_xournal_draw(GtkWidget* widget, cairo_t* cr)
 
 	GtkXournal* xournal = GTK_XOURNAL(widget);
 
-	ArrayIterator<XojPageView*> it = xournal->view->pageViewIterator();
-
 	double x1, x2, y1, y2;
 
 	cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
 
+	// GTK collects the queued areas, only the pages within them are painted
+	std::vector<Rectangle> damage;
+	cairo_rectangle_list_t* clip = cairo_copy_clip_rectangle_list(cr);
+	if (clip->status == CAIRO_STATUS_SUCCESS)
+	{
+		for (int i = 0; i < clip->num_rectangles; i++)
+		{
+			cairo_rectangle_t& r = clip->rectangles[i];
+			damage.push_back(Rectangle(r.x, r.y, r.width, r.height));
+		}
+	}
+	else
+	{
+		damage.push_back(Rectangle(x1, y1, x2 - x1, y2 - y1));
+	}
+	cairo_rectangle_list_destroy(clip);
+
 	// Draw background
 	Settings* settings = xournal->view->getControl()->getSettings();
 	Util::cairo_set_source_rgbi(cr, settings->getBackgroundColor());
@@ -312,28 +334,33 @@ static gboolean gtk_xournal_draw(GtkWidget* widget, cairo_t* cr)
 
 	xournal->scrollHandling->translate(cr, x1, x2, y1, y2);
 
-	Rectangle clippingRect(x1 - 10, y1 - 10, x2 - x1 + 20, y2 - y1 + 20);
-
-	while (it.hasNext())
+	for (Rectangle& area : damage)
 	{
-		XojPageView* pv = it.next();
+		xournal->scrollHandling->translate(area.x, area.y);
+
+		// The shadows are transparent, they must not be painted twice where they are in two areas
+		cairo_save(cr);
+		cairo_rectangle(cr, area.x, area.y, area.width, area.height);
+		cairo_clip(cr);
 
-		int px = pv->getX();
-		int py = pv->getY();
-		int pw = pv->getDisplayWidth();
-		int ph = pv->getDisplayHeight();
+		Rectangle clippingRect(area.x - 10, area.y - 10, area.width + 20, area.height + 20);
 
-		if (!clippingRect.intersects(pv->getRect()))
+		for (XojPageView* pv : xournal->layout->getViewsInArea(clippingRect))
 		{
-			continue;
-		}
+			int px = pv->getX();
+			int py = pv->getY();
+			int pw = pv->getDisplayWidth();
+			int ph = pv->getDisplayHeight();
 
-		gtk_xournal_draw_shadow(xournal, cr, px, py, pw, ph, pv->isSelected());
+			gtk_xournal_draw_shadow(xournal, cr, px, py, pw, ph, pv->isSelected());
 
-		cairo_save(cr);
-		cairo_translate(cr, px, py);
+			cairo_save(cr);
+			cairo_translate(cr, px, py);
+
+			pv->paintPage(cr, NULL);
+			cairo_restore(cr);
+		}
 
-		pv->paintPage(cr, NULL);
 		cairo_restore(cr);
 	}
 
@@ -8,6 +8,8 @@
  * Internal impl object, dont move this to an external header/source file due this is the best way to reduce code
  * bloat and increase encapsulation. This object is only used in this source scope and is a RAII Container for the
  * GdkPixbuf*
+ * Images loaded with loadData() are only decoded when the pixbuf is needed, so loading a document
+ * with a lot of background images does not decode them all at once.
  * No xournal memory leak tests necessary, because we use smart ptrs to ensure memory correctness
  */
 
@@ -23,19 +25,72 @@ struct BackgroundImage::Content
 	{
 	}
 
+	Content(GBytes* data, string filename)
+			: filename(std::move(filename)), data(g_bytes_ref(data))
+	{
+		g_mutex_init(&this->decodeMutex);
+	}
+
 	~Content()
 	{
-		g_object_unref(this->pixbuf);
-		this->pixbuf = nullptr;
+		if (this->pixbuf)
+		{
+			g_object_unref(this->pixbuf);
+			this->pixbuf = nullptr;
+		}
+		if (this->data)
+		{
+			g_bytes_unref(this->data);
+			this->data = nullptr;
+			g_mutex_clear(&this->decodeMutex);
+		}
 	};
 
 	Content(const Content&) = delete;
-	Content(Content&&) = default;
+	Content(Content&&) = delete;
 	Content& operator=(const Content&) = delete;
-	Content& operator=(Content&&) = default;
+	Content& operator=(Content&&) = delete;
+
+	GdkPixbuf* getPixbuf()
+	{
+		if (this->data == nullptr)
+		{
+			return this->pixbuf;
+		}
+
+		// The pixbuf may be requested by the render threads and the GUI thread at the same time
+		g_mutex_lock(&this->decodeMutex);
+		if (this->pixbuf == nullptr && !this->decodeFailed)
+		{
+			GInputStream* inputStream = g_memory_input_stream_new_from_bytes(this->data);
+			GError* error = nullptr;
+			this->pixbuf = gdk_pixbuf_new_from_stream(inputStream, nullptr, &error);
+			g_input_stream_close(inputStream, nullptr, nullptr);
+			g_object_unref(inputStream);
+
+			if (error)
+			{
+				g_warning("Could not read image: %s. Error message: %s", this->filename.c_str(), error->message);
+				g_error_free(error);
+				this->decodeFailed = true;
+			}
+		}
+		GdkPixbuf* pixbuf = this->pixbuf;
+		g_mutex_unlock(&this->decodeMutex);
+
+		return pixbuf;
+	}
 
 	string filename;
 	GdkPixbuf* pixbuf = nullptr;
+
+	/**
+	 * The encoded image, if it is decoded lazily
+	 */
+	GBytes* data = nullptr;
+	GMutex decodeMutex;
+	bool decodeFailed = false;
+
 	int pageId = -1;
 	bool attach = false;
 };
@@ -87,6 +142,12 @@ void BackgroundImage::loadFile(GInputStream* stream, string filename, GError** e
 	this->img = std::make_shared<Content>(stream, std::move(filename), error);
 }
 
+void BackgroundImage::loadData(GBytes* data, string filename)
+{
+	XOJ_CHECK_TYPE(BackgroundImage);
+	this->img = std::make_shared<Content>(data, std::move(filename));
+}
+
 int BackgroundImage::getCloneId()
 {
 	XOJ_CHECK_TYPE(BackgroundImage);
@@ -143,7 +204,7 @@ void BackgroundImage::setAttach(bool attach)
 GdkPixbuf* BackgroundImage::getPixbuf()
 {
 	XOJ_CHECK_TYPE(BackgroundImage);
-	return this->img ? this->img->pixbuf : nullptr;
+	return this->img ? this->img->getPixbuf() : nullptr;
 }
 
 bool BackgroundImage::isEmpty()
@@ -35,6 +35,13 @@ struct BackgroundImage
 	void loadFile(string filename, GError** error);
 	void loadFile(GInputStream* stream, string filename, GError** error);
 
+	/**
+	 * Uses the encoded image data, it is decoded on the first call of getPixbuf()
+	 *
+	 * @param data The image file contents, a new reference is taken
+	 */
+	void loadData(GBytes* data, string filename);
+
 	int getCloneId();
 	void setCloneId(int id);
 	void clearSaveState();
@@ -38,10 +38,17 @@ void Document::freeTreeContentModel()
 		g_object_unref(this->contentsModel);
 		this->contentsModel = NULL;
 	}
+
+	this->contentsRows.clear();
+	this->contentsModelBuilt = false;
 }
 
 bool Document::freeTreeContentEntry(GtkTreeModel* treeModel, GtkTreePath* path, GtkTreeIter* iter, Document* doc)
 {
+	XojPdfBookmarkIterator* children = NULL;
+	gtk_tree_model_get(treeModel, iter, DOCUMENT_LINKS_COLUMN_CHILDREN, &children, -1);
+	delete children;
+
 	XojLinkDest* link = NULL;
 	gtk_tree_model_get(treeModel, iter, DOCUMENT_LINKS_COLUMN_LINK, &link, -1);
 
@@ -112,6 +119,7 @@ void Document::clearDocument(bool destroy)
 	}
 
 	this->pages.clear();
+	this->pdfPageIndexValid = false;
 	freeTreeContentModel();
 
 	this->filename = "";
@@ -259,21 +267,39 @@ size_t Document::findPdfPage(size_t pdfPage)
 {
 	XOJ_CHECK_TYPE(Document);
 
-	for (size_t i = 0; i < getPageCount(); i++)
+	if (!this->pdfPageIndexValid || this->pdfPageIndexRevision != XojPage::getBackgroundRevision())
+	{
+		updatePdfPageIndex();
+	}
+
+	auto it = this->pdfPageIndex.find(pdfPage);
+	if (it == this->pdfPageIndex.end())
+	{
+		return size_t_npos;
+	}
+	return it->second;
+}
+
+void Document::updatePdfPageIndex()
+{
+	XOJ_CHECK_TYPE(Document);
+
+	this->pdfPageIndex.clear();
+	this->pdfPageIndexRevision = XojPage::getBackgroundRevision();
+	this->pdfPageIndexValid = true;
+
+	for (size_t i = 0; i < this->pages.size(); i++)
 	{
 		PageRef p = this->pages[i];
 		if (p->getBackgroundType().isPdfPage())
 		{
-			if (p->getPdfPageNr() == pdfPage)
-			{
-				return i;
-			}
+			// Only the first page with the PDF page is stored
+			this->pdfPageIndex.insert(std::make_pair(p->getPdfPageNr(), i));
 		}
 	}
-	return -1;
 }
 
-void Document::buildTreeContentsModel(GtkTreeIter* parent, XojPdfBookmarkIterator* iter)
+void Document::addContentsRows(GtkTreeIter* parent, XojPdfBookmarkIterator* iter, int depth)
 {
 	XOJ_CHECK_TYPE(Document);
 
@@ -297,17 +323,30 @@ void Document::buildTreeContentsModel(GtkTreeIter* parent, XojPdfBookmarkIterato
 		char* titleMarkup = g_markup_escape_text(action->getTitle().c_str(), -1);
 
 		gtk_tree_store_set(GTK_TREE_STORE(contentsModel), &treeIter, DOCUMENT_LINKS_COLUMN_NAME, titleMarkup,
-						   DOCUMENT_LINKS_COLUMN_LINK, link, DOCUMENT_LINKS_COLUMN_PAGE_NUMBER, "", -1);
+						   DOCUMENT_LINKS_COLUMN_LINK, link, -1);
 
 		g_free(titleMarkup);
+
+		size_t pdfPage = link->dest->getPdfPage();
+		if (pdfPage != size_t_npos)
+		{
+			this->contentsRows.insert(std::make_pair(pdfPage, treeIter));
+			setPageLabel(&treeIter, pdfPage);
+		}
+
 		g_object_unref(link);
 
 		XojPdfBookmarkIterator* child = iter->getChildIter();
-		if (child)
+		if (child && depth > 0)
 		{
-			buildTreeContentsModel(&treeIter, child);
+			addContentsRows(&treeIter, child, depth - 1);
 			delete child;
 		}
+		else if (child)
+		{
+			// Added when the parent row is expanded
+			gtk_tree_store_set(GTK_TREE_STORE(contentsModel), &treeIter, DOCUMENT_LINKS_COLUMN_CHILDREN, child, -1);
+		}
 
 		delete action;
 
@@ -320,6 +359,7 @@ void Document::buildContentsModel()
 	XOJ_CHECK_TYPE(Document);
 
 	freeTreeContentModel();
+	this->contentsModelBuilt = true;
 
 	XojPdfBookmarkIterator* iter = pdfDocument.getContentsIter();
 	if (iter == NULL)
@@ -328,8 +368,11 @@ void Document::buildContentsModel()
 		return;
 	}
 
-	this->contentsModel = (GtkTreeModel*) gtk_tree_store_new(4, G_TYPE_STRING, G_TYPE_OBJECT, G_TYPE_BOOLEAN, G_TYPE_STRING);
-	buildTreeContentsModel(NULL, iter);
+	this->contentsModel = (GtkTreeModel*) gtk_tree_store_new(5, G_TYPE_STRING, G_TYPE_OBJECT, G_TYPE_BOOLEAN,
+	                                                         G_TYPE_STRING, G_TYPE_POINTER);
+
+	// The second level is needed, so the rows of the first level show if they can be expanded
+	addContentsRows(NULL, iter, 1);
 	delete iter;
 }
 
@@ -337,40 +380,73 @@ GtkTreeModel* Document::getContentsModel()
 {
 	XOJ_CHECK_TYPE(Document);
 
+	if (!this->contentsModelBuilt && isPdfDocumentLoaded())
+	{
+		buildContentsModel();
+	}
+
 	return this->contentsModel;
 }
 
-bool Document::fillPageLabels(GtkTreeModel* treeModel, GtkTreePath* path, GtkTreeIter* iter, Document* doc)
+void Document::expandContentsRow(GtkTreeIter* iter)
 {
-	XojLinkDest* link = NULL;
-	gtk_tree_model_get(treeModel, iter, DOCUMENT_LINKS_COLUMN_LINK, &link, -1);
+	XOJ_CHECK_TYPE(Document);
 
-	if (link == NULL)
+	if (this->contentsModel == NULL)
 	{
-		return false;
+		return;
+	}
+
+	GtkTreeIter child = { 0 };
+	gboolean valid = gtk_tree_model_iter_children(this->contentsModel, &child, iter);
+	while (valid)
+	{
+		loadContentsChildren(&child);
+		valid = gtk_tree_model_iter_next(this->contentsModel, &child);
+	}
+}
+
+void Document::loadContentsChildren(GtkTreeIter* iter)
+{
+	XOJ_CHECK_TYPE(Document);
+
+	XojPdfBookmarkIterator* children = NULL;
+	gtk_tree_model_get(this->contentsModel, iter, DOCUMENT_LINKS_COLUMN_CHILDREN, &children, -1);
+	if (children == NULL)
+	{
+		// Already added
+		return;
 	}
 
-	int page = doc->findPdfPage(link->dest->getPdfPage());
+	gtk_tree_store_set(GTK_TREE_STORE(contentsModel), iter, DOCUMENT_LINKS_COLUMN_CHILDREN, NULL, -1);
+
+	addContentsRows(iter, children, 0);
+	delete children;
+}
+
+void Document::setPageLabel(GtkTreeIter* iter, size_t pdfPage)
+{
+	XOJ_CHECK_TYPE(Document);
+
+	size_t page = findPdfPage(pdfPage);
 
 	gchar* pageLabel = NULL;
-	if (page != -1)
+	if (page != size_t_npos)
 	{
-		pageLabel = g_strdup_printf("%i", page + 1);
+		pageLabel = g_strdup_printf("%i", (int) page + 1);
 	}
-	gtk_tree_store_set(GTK_TREE_STORE(treeModel), iter, DOCUMENT_LINKS_COLUMN_PAGE_NUMBER, pageLabel, -1);
+	gtk_tree_store_set(GTK_TREE_STORE(this->contentsModel), iter, DOCUMENT_LINKS_COLUMN_PAGE_NUMBER, pageLabel, -1);
 	g_free(pageLabel);
-
-	g_object_unref(link);
-	return false;
 }
 
 void Document::updateIndexPageNumbers()
 {
 	XOJ_CHECK_TYPE(Document);
 
-	if (this->contentsModel != NULL)
+	// Only the rows already added to the model, the others get their label when they are added
+	for (auto& row : this->contentsRows)
 	{
-		gtk_tree_model_foreach(this->contentsModel, (GtkTreeModelForeachFunc) fillPageLabels, this);
+		setPageLabel(&row.second, row.first);
 	}
 }
 
@@ -410,9 +486,13 @@ bool Document::readPdf(Path filename, bool initPages, bool attachToDocument, gpo
 
 	lastError = "";
 
+	// The bookmarks of the new PDF, they are loaded when they are used, after the pages are added
+	freeTreeContentModel();
+
 	if (initPages)
 	{
 		this->pages.clear();
+		this->pdfPageIndexValid = false;
 	}
 
 	if (initPages)
@@ -425,9 +505,17 @@ bool Document::readPdf(Path filename, bool initPages, bool attachToDocument, gpo
 			addPage(p);
 		}
 	}
-
-	buildContentsModel();
-	updateIndexPageNumbers();
+	else
+	{
+		// The existing pages show another PDF now, e.g. their cached previews are out of date
+		for (PageRef p : this->pages)
+		{
+			if (p->getBackgroundType().isPdfPage())
+			{
+				p->contentChanged();
+			}
+		}
+	}
 
 	unlock();
 
@@ -470,6 +558,7 @@ void Document::deletePage(size_t pNr)
 	vector<PageRef>::iterator it = this->pages.begin() + pNr;
 	this->pages.erase(it);
 
+	this->pdfPageIndexValid = false;
 	updateIndexPageNumbers();
 }
 
@@ -479,6 +568,7 @@ void Document::insertPage(PageRef p, size_t position)
 
 	this->pages.insert(this->pages.begin() + position, p);
 
+	this->pdfPageIndexValid = false;
 	updateIndexPageNumbers();
 }
 
@@ -488,6 +578,7 @@ void Document::addPage(PageRef p)
 
 	this->pages.push_back(p);
 
+	this->pdfPageIndexValid = false;
 	updateIndexPageNumbers();
 }
 
@@ -557,9 +648,6 @@ void Document::operator=(Document& doc)
 		addPage(p);
 	}
 
-	buildContentsModel();
-	updateIndexPageNumbers();
-
 	bool lastLock = tryLock();
 	unlock();
 	this->handler->fireDocumentChanged(DOCUMENT_CHANGE_COMPLETE);
@@ -569,6 +657,36 @@ void Document::operator=(Document& doc)
 	}
 }
 
+Document* Document::createSnapshot(bool copyPages)
+{
+	XOJ_CHECK_TYPE(Document);
+
+	Document* snapshot = new Document(this->handler);
+
+	snapshot->pdfDocument = this->pdfDocument;
+	snapshot->password = this->password;
+	snapshot->createBackupOnSave = this->createBackupOnSave;
+	snapshot->pdfFilename = this->pdfFilename;
+	snapshot->filename = this->filename;
+	snapshot->attachPdf = this->attachPdf;
+
+	if (this->preview)
+	{
+		snapshot->preview = cairo_surface_reference(this->preview);
+	}
+
+	if (copyPages)
+	{
+		snapshot->pages.reserve(this->pages.size());
+		for (PageRef& p : this->pages)
+		{
+			snapshot->pages.push_back(p->clone());
+		}
+	}
+
+	return snapshot;
+}
+
 void Document::setCreateBackupOnSave(bool backup)
 {
 	XOJ_CHECK_TYPE(Document);
@@ -24,6 +24,8 @@
 #include <Path.h>
 #include <XournalType.h>
 
+#include <unordered_map>
+
 class Document
 {
 public:
@@ -62,10 +64,25 @@ public:
 	string getLastErrorMsg();
 
 	bool isPdfDocumentLoaded();
+
+	/**
+	 * @return The index of the first page with the PDF page as background, size_t_npos if there is none
+	 */
 	size_t findPdfPage(size_t pdfPage);
 
 	void operator=(Document& doc);
 
+	/**
+	 * Creates a copy of the document for saving, exporting and rendering without holding the lock.
+	 * The copy shares the PDF document, the pages are copied if copyPages is set. The copied strokes and
+	 * images share their points and image data with the document, so copying a page copies no stroke
+	 * points; the points are copied when the stroke is changed. It does not fire any events and has to
+	 * be deleted by the caller.
+	 *
+	 * Has to be called with the document locked, the snapshot itself needs no locking.
+	 */
+	Document* createSnapshot(bool copyPages = true);
+
 	void setFilename(Path filename);
 	Path getFilename();
 	Path getPdfFilename();
@@ -74,8 +91,20 @@ public:
 
 	Path getEvMetadataFilename();
 
+	/**
+	 * The bookmarks of the PDF. The model is built when it is used first, and only with the bookmarks
+	 * of the first two levels, the others are added by expandContentsRow().
+	 *
+	 * @return NULL if the PDF has no bookmarks
+	 */
 	GtkTreeModel* getContentsModel();
 
+	/**
+	 * A row of the contents model was expanded, adds the bookmarks below its children,
+	 * so the children which have bookmarks below them can be expanded
+	 */
+	void expandContentsRow(GtkTreeIter* iter);
+
 	void setCreateBackupOnSave(bool backup);
 	bool shouldCreateBackupOnSave();
 
@@ -95,9 +124,16 @@ private:
 	void freeTreeContentModel();
 	static bool freeTreeContentEntry(GtkTreeModel* treeModel, GtkTreePath* path, GtkTreeIter* iter, Document* doc);
 
-	void buildTreeContentsModel(GtkTreeIter* parent, XojPdfBookmarkIterator* iter);
+	/**
+	 * Adds the bookmarks of the iterator, and the bookmarks below them up to depth levels.
+	 * The iterators of deeper levels are stored in their rows, until the rows are expanded.
+	 */
+	void addContentsRows(GtkTreeIter* parent, XojPdfBookmarkIterator* iter, int depth);
+	void loadContentsChildren(GtkTreeIter* iter);
+
+	void setPageLabel(GtkTreeIter* iter, size_t pdfPage);
 	void updateIndexPageNumbers();
-	static bool fillPageLabels(GtkTreeModel* tree_model, GtkTreePath* path, GtkTreeIter* iter, Document* doc);
+	void updatePdfPageIndex();
 
 private:
 	XOJ_TYPE_ATTRIB;
@@ -127,6 +163,21 @@ private:
 	 * The bookmark contents model
 	 */
 	GtkTreeModel* contentsModel = NULL;
+	bool contentsModelBuilt = false;
+
+	/**
+	 * The rows of the contents model by PDF page, to update their page labels.
+	 * The iterators of a GtkTreeStore stay valid as long as the row exists.
+	 */
+	std::unordered_multimap<size_t, GtkTreeIter> contentsRows;
+
+	/**
+	 * The index of the first page with each PDF page as background. It is built again when it is used
+	 * after pages were added or removed, or after the background of any page was changed.
+	 */
+	std::unordered_map<size_t, size_t> pdfPageIndex;
+	bool pdfPageIndexValid = false;
+	gint pdfPageIndexRevision = 0;
 
 	/**
 	 *  create a backup before save, because the original file was an older fileversion
@@ -1,5 +1,7 @@
 #include "Element.h"
 
+#include "SpatialIndex.h"
+
 #include <serializing/ObjectInputStream.h>
 #include <serializing/ObjectOutputStream.h>
 
@@ -26,6 +28,7 @@ void Element::setX(double x)
 	XOJ_CHECK_TYPE(Element);
 
 	this->x = x;
+	boundsChanged();
 }
 
 void Element::setY(double y)
@@ -33,6 +36,7 @@ void Element::setY(double y)
 	XOJ_CHECK_TYPE(Element);
 
 	this->y = y;
+	boundsChanged();
 }
 
 double Element::getX()
@@ -65,6 +69,8 @@ void Element::move(double dx, double dy)
 
 	this->x += dx;
 	this->y += dy;
+
+	boundsChanged();
 }
 
 double Element::getElementWidth()
@@ -96,6 +102,16 @@ Rectangle Element::boundingRect()
 	return Rectangle(getX(), getY(), getElementWidth(), getElementHeight());
 }
 
+void Element::boundsChanged()
+{
+	XOJ_CHECK_TYPE(Element);
+
+	if (this->spatialIndex)
+	{
+		this->spatialIndex->update(this);
+	}
+}
+
 void Element::setColor(int color)
 {
 	XOJ_CHECK_TYPE(Element);
@@ -143,6 +159,12 @@ bool Element::isInSelection(ShapeContainer* container)
 {
 	XOJ_CHECK_TYPE(Element);
 
+	ShapeContainment bounds = container->containsArea(getX(), getY(), getElementWidth(), getElementHeight());
+	if (bounds != SHAPE_PARTIAL)
+	{
+		return bounds == SHAPE_INSIDE;
+	}
+
 	if (!container->contains(getX(), getY()))
 	{
 		return false;
@@ -25,11 +25,29 @@ enum ElementType
 	ELEMENT_TEXT
 };
 
+class SpatialIndex;
+
+enum ShapeContainment
+{
+	SHAPE_OUTSIDE,
+	SHAPE_PARTIAL,
+	SHAPE_INSIDE
+};
+
 class ShapeContainer
 {
 public:
 	virtual bool contains(double x, double y) = 0;
 
+	/**
+	 * Classifies a whole rectangle, so elements completely inside or outside do not need to test
+	 * each point. SHAPE_PARTIAL means the points have to be tested one by one.
+	 */
+	virtual ShapeContainment containsArea(double x, double y, double width, double height)
+	{
+		return SHAPE_PARTIAL;
+	}
+
 	virtual ~ShapeContainer() { }
 };
 
@@ -82,6 +100,14 @@ protected:
 	void serializeElement(ObjectOutputStream& out);
 	void readSerializedElement(ObjectInputStream& in);
 
+	/**
+	 * Has to be called after the position or the size of the element has changed,
+	 * updates the spatial index of the layer containing the element.
+	 *
+	 * Must not be called from calcSize()
+	 */
+	void boundsChanged();
+
 protected:
 	// If the size has been calculated
 	bool sizeCalculated = false;
@@ -103,5 +129,12 @@ private:
 	 * The color in RGB format
 	 */
 	int color = 0;
+
+	/**
+	 * The index of the layer containing this element, if any
+	 */
+	SpatialIndex* spatialIndex = NULL;
+
+	friend class SpatialIndex;
 };
 
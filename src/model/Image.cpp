@@ -1,9 +1,39 @@
 #include "Image.h"
 
+#include "ImageCache.h"
+
 #include <pixbuf-utils.h>
 #include <serializing/ObjectInputStream.h>
 #include <serializing/ObjectOutputStream.h>
 
+/*
+ * The encoded image, the decoded image is only held by the ImageCache
+ */
+struct Image::Content
+{
+	Content(string png)
+			: png(std::make_shared<const string>(std::move(png))), id(ImageCache::getInstance()->newImageId())
+	{
+		if (!this->png->empty() && !ImageCache::readPngSize(*this->png, this->width, this->height))
+		{
+			g_warning("Image: the image data is no PNG");
+		}
+	}
+
+	~Content()
+	{
+		ImageCache::getInstance()->remove(this->id);
+	}
+
+	Content(const Content&) = delete;
+	Content& operator=(const Content&) = delete;
+
+	std::shared_ptr<const string> png;
+	int id;
+	int width = 0;
+	int height = 0;
+};
+
 Image::Image()
  : Element(ELEMENT_IMAGE)
 {
@@ -16,12 +46,6 @@ Image::~Image()
 {
 	XOJ_CHECK_TYPE(Image);
 
-	if (this->image)
-	{
-		cairo_surface_destroy(this->image);
-		this->image = NULL;
-	}
-
 	XOJ_RELEASE_TYPE(Image);
 }
 
@@ -36,9 +60,7 @@ Element* Image::clone()
 	img->setColor(this->getColor());
 	img->width = this->width;
 	img->height = this->height;
-	img->data = this->data;
-
-	img->image = cairo_surface_reference(this->image);
+	img->content = this->content;
 
 	return img;
 }
@@ -48,6 +70,7 @@ void Image::setWidth(double width)
 	XOJ_CHECK_TYPE(Image);
 
 	this->width = width;
+	boundsChanged();
 }
 
 void Image::setHeight(double height)
@@ -55,35 +78,14 @@ void Image::setHeight(double height)
 	XOJ_CHECK_TYPE(Image);
 
 	this->height = height;
-}
-
-cairo_status_t Image::cairoReadFunction(Image* image, unsigned char* data, unsigned int length)
-{
-	XOJ_CHECK_TYPE_OBJ(image, Image);
-
-	for (unsigned int i = 0; i < length; i++, image->read++)
-	{
-		if (image->read >= image->data.length())
-		{
-			return CAIRO_STATUS_READ_ERROR;
-		}
-
-		data[i] = image->data[image->read];
-	}
-
-	return CAIRO_STATUS_SUCCESS;
+	boundsChanged();
 }
 
 void Image::setImage(string data)
 {
 	XOJ_CHECK_TYPE(Image);
 
-	if (this->image)
-	{
-		cairo_surface_destroy(this->image);
-		this->image = NULL;
-	}
-	this->data = data;
+	this->content = std::make_shared<Content>(std::move(data));
 }
 
 void Image::setImage(GdkPixbuf* img)
@@ -95,26 +97,48 @@ void Image::setImage(cairo_surface_t* image)
 {
 	XOJ_CHECK_TYPE(Image);
 
-	if (this->image)
+	// Encoded once, the image is already decoded and does not need to be decoded for painting
+	this->content = std::make_shared<Content>(ImageCache::encodePng(image));
+	ImageCache::getInstance()->put(this->content->id, image);
+	cairo_surface_destroy(image);
+}
+
+cairo_surface_t* Image::getImage(int level)
+{
+	XOJ_CHECK_TYPE(Image);
+
+	std::shared_ptr<Content> content = this->content;
+	if (!content || content->png->empty())
 	{
-		cairo_surface_destroy(this->image);
-		this->image = NULL;
+		return NULL;
 	}
 
-	this->image = image;
+	return ImageCache::getInstance()->get(content->id, *content->png, level);
 }
 
-cairo_surface_t* Image::getImage()
+std::shared_ptr<const string> Image::getData()
 {
 	XOJ_CHECK_TYPE(Image);
 
-	if (this->image == NULL && this->data.length())
+	if (!this->content)
 	{
-		this->read = 0;
-		this->image = cairo_image_surface_create_from_png_stream((cairo_read_func_t) &cairoReadFunction, this);
+		return std::make_shared<const string>();
 	}
+	return this->content->png;
+}
 
-	return this->image;
+int Image::getImageWidth()
+{
+	XOJ_CHECK_TYPE(Image);
+
+	return this->content ? this->content->width : 0;
+}
+
+int Image::getImageHeight()
+{
+	XOJ_CHECK_TYPE(Image);
+
+	return this->content ? this->content->height : 0;
 }
 
 void Image::scale(double x0, double y0, double fx, double fy)
@@ -130,6 +154,8 @@ void Image::scale(double x0, double y0, double fx, double fy)
 
 	this->width *= fx;
 	this->height *= fy;
+
+	boundsChanged();
 }
 
 void Image::rotate(double x0, double y0, double xo, double yo, double th)
@@ -148,7 +174,7 @@ void Image::serialize(ObjectOutputStream& out)
 	out.writeDouble(this->width);
 	out.writeDouble(this->height);
 
-	out.writeImage(this->image);
+	out.writeImage(*getData());
 
 	out.endObject();
 }
@@ -164,13 +190,7 @@ void Image::readSerialized(ObjectInputStream& in)
 	this->width = in.readDouble();
 	this->height = in.readDouble();
 
-	if (this->image)
-	{
-		cairo_surface_destroy(this->image);
-		this->image = NULL;
-	}
-
-	this->image = in.readImage();
+	setImage(in.readImage());
 
 	in.endObject();
 }
@@ -14,6 +14,8 @@
 #include "Element.h"
 #include <XournalType.h>
 
+#include <memory>
+
 class Image : public Element
 {
 public:
@@ -24,10 +26,32 @@ public:
 	void setWidth(double width);
 	void setHeight(double height);
 
+	/**
+	 * @param data The PNG encoded image
+	 */
 	void setImage(string data);
+
+	/**
+	 * @param image The image, the ownership is taken
+	 */
 	void setImage(cairo_surface_t* image);
 	void setImage(GdkPixbuf* img);
-	cairo_surface_t* getImage();
+
+	/**
+	 * The image is decoded when it is painted the first time, see ImageCache
+	 *
+	 * @param level The mipmap level, each level halves the size
+	 * @return A new reference to the image, NULL if there is no image
+	 */
+	cairo_surface_t* getImage(int level = 0);
+
+	/**
+	 * @return The PNG encoded image, it's not encoded again on each save
+	 */
+	std::shared_ptr<const string> getData();
+
+	int getImageWidth();
+	int getImageHeight();
 
 	virtual void scale(double x0, double y0, double fx, double fy);
 	virtual void rotate(double x0, double y0, double xo, double yo, double th);
@@ -45,14 +69,13 @@ public:
 private:
 	virtual void calcSize();
 
-	static cairo_status_t cairoReadFunction(Image* image, unsigned char* data, unsigned int length);
 private:
-	XOJ_TYPE_ATTRIB;
-
+	struct Content;
 
-	cairo_surface_t* image = NULL;
-
-	string data;
+	XOJ_TYPE_ATTRIB;
 
-	string::size_type read = false;
+	/**
+	 * Shared with the clones of this image
+	 */
+	std::shared_ptr<Content> content;
 };
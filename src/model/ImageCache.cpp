@@ -0,0 +1,283 @@
+#include "ImageCache.h"
+
+#include <algorithm>
+
+ImageCache::ImageCache(size_t maxBytes)
+ : maxBytes(maxBytes)
+{
+	XOJ_INIT_TYPE(ImageCache);
+
+	g_mutex_init(&this->mutex);
+	g_cond_init(&this->decodeFinished);
+}
+
+ImageCache::~ImageCache()
+{
+	XOJ_CHECK_TYPE(ImageCache);
+
+	for (CacheEntry& e : this->data)
+	{
+		cairo_surface_destroy(e.img);
+	}
+	this->data.clear();
+	this->index.clear();
+
+	g_cond_clear(&this->decodeFinished);
+	g_mutex_clear(&this->mutex);
+
+	XOJ_RELEASE_TYPE(ImageCache);
+}
+
+ImageCache* ImageCache::getInstance()
+{
+	// Never deleted, the images of the clipboard and the undo stack may be destroyed until the very end
+	static ImageCache* instance = new ImageCache(IMAGE_CACHE_BYTES);
+	return instance;
+}
+
+size_t ImageCache::CacheKeyHash::operator()(const CacheKey& key) const
+{
+	return std::hash<int>()(key.imageId) * 31 + std::hash<int>()(key.level);
+}
+
+int ImageCache::newImageId()
+{
+	XOJ_CHECK_TYPE(ImageCache);
+
+	return ++this->lastImageId;
+}
+
+size_t ImageCache::surfaceBytes(cairo_surface_t* img)
+{
+	return cairo_image_surface_get_stride(img) * cairo_image_surface_get_height(img);
+}
+
+ImageCache::EntryList::iterator ImageCache::findUnlocked(const CacheKey& key)
+{
+	XOJ_CHECK_TYPE(ImageCache);
+
+	auto it = this->index.find(key);
+	if (it == this->index.end())
+	{
+		return this->data.end();
+	}
+	return it->second;
+}
+
+void ImageCache::eraseUnlocked(EntryList::iterator it)
+{
+	XOJ_CHECK_TYPE(ImageCache);
+
+	this->bytes -= surfaceBytes(it->img);
+	cairo_surface_destroy(it->img);
+	this->index.erase(it->key);
+	this->data.erase(it);
+}
+
+void ImageCache::storeUnlocked(const CacheKey& key, cairo_surface_t* img)
+{
+	XOJ_CHECK_TYPE(ImageCache);
+
+	EntryList::iterator it = findUnlocked(key);
+	if (it != this->data.end())
+	{
+		eraseUnlocked(it);
+	}
+
+	this->data.push_front({ key, img });
+	this->index[key] = this->data.begin();
+	this->bytes += surfaceBytes(img);
+
+	// The first entry is the one just decoded, never remove it
+	while (this->bytes > this->maxBytes && this->data.size() > 1)
+	{
+		eraseUnlocked(std::prev(this->data.end()));
+	}
+}
+
+cairo_surface_t* ImageCache::get(int imageId, const string& png, int level)
+{
+	XOJ_CHECK_TYPE(ImageCache);
+
+	CacheKey key = { imageId, level };
+
+	g_mutex_lock(&this->mutex);
+
+	while (true)
+	{
+		EntryList::iterator it = findUnlocked(key);
+		if (it != this->data.end())
+		{
+			this->data.splice(this->data.begin(), this->data, it);
+
+			cairo_surface_t* img = cairo_surface_reference(it->img);
+			g_mutex_unlock(&this->mutex);
+			return img;
+		}
+
+		if (this->decoding.count(key) == 0)
+		{
+			break;
+		}
+		g_cond_wait(&this->decodeFinished, &this->mutex);
+	}
+
+	// A larger level which is already decoded is scaled down, instead of decoding the PNG again
+	cairo_surface_t* source = NULL;
+	int sourceLevel = 0;
+	for (int l = level - 1; l >= 0 && source == NULL; l--)
+	{
+		EntryList::iterator it = findUnlocked({ imageId, l });
+		if (it != this->data.end())
+		{
+			source = cairo_surface_reference(it->img);
+			sourceLevel = l;
+		}
+	}
+
+	this->decoding.insert(key);
+	g_mutex_unlock(&this->mutex);
+
+	if (source == NULL)
+	{
+		source = decodePng(png);
+		sourceLevel = 0;
+	}
+
+	cairo_surface_t* img = source;
+	if (source != NULL && sourceLevel != level)
+	{
+		img = scaleDown(source, level - sourceLevel);
+		cairo_surface_destroy(source);
+	}
+
+	g_mutex_lock(&this->mutex);
+	if (img != NULL)
+	{
+		storeUnlocked(key, cairo_surface_reference(img));
+	}
+	this->decoding.erase(key);
+	g_cond_broadcast(&this->decodeFinished);
+	g_mutex_unlock(&this->mutex);
+
+	return img;
+}
+
+void ImageCache::put(int imageId, cairo_surface_t* img)
+{
+	XOJ_CHECK_TYPE(ImageCache);
+
+	g_mutex_lock(&this->mutex);
+	storeUnlocked({ imageId, 0 }, cairo_surface_reference(img));
+	g_mutex_unlock(&this->mutex);
+}
+
+void ImageCache::remove(int imageId)
+{
+	XOJ_CHECK_TYPE(ImageCache);
+
+	g_mutex_lock(&this->mutex);
+	for (int level = 0; level <= MAX_LEVEL; level++)
+	{
+		EntryList::iterator it = findUnlocked({ imageId, level });
+		if (it != this->data.end())
+		{
+			eraseUnlocked(it);
+		}
+	}
+	g_mutex_unlock(&this->mutex);
+}
+
+int ImageCache::levelForSize(int imageWidth, double paintedWidth)
+{
+	if (paintedWidth <= 0)
+	{
+		return 0;
+	}
+
+	int level = 0;
+	while (level < MAX_LEVEL && (imageWidth >> (level + 1)) >= paintedWidth)
+	{
+		level++;
+	}
+	return level;
+}
+
+cairo_surface_t* ImageCache::scaleDown(cairo_surface_t* img, int levels)
+{
+	int width = cairo_image_surface_get_width(img);
+	int height = cairo_image_surface_get_height(img);
+	int scaledWidth = std::max(1, width >> levels);
+	int scaledHeight = std::max(1, height >> levels);
+
+	cairo_surface_t* scaled = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, scaledWidth, scaledHeight);
+	cairo_t* cr = cairo_create(scaled);
+	cairo_scale(cr, (double) scaledWidth / width, (double) scaledHeight / height);
+	cairo_set_source_surface(cr, img, 0, 0);
+	cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_GOOD);
+	cairo_paint(cr);
+	cairo_destroy(cr);
+
+	return scaled;
+}
+
+bool ImageCache::readPngSize(const string& png, int& width, int& height)
+{
+	// 8 bytes signature, the IHDR chunk has to be the first: length, type, width, height
+	if (png.length() < 24 || png.compare(0, 8, "\x89PNG\r\n\x1a\n") != 0 || png.compare(12, 4, "IHDR") != 0)
+	{
+		return false;
+	}
+
+	const unsigned char* d = (const unsigned char*) png.data();
+	width = (d[16] << 24) | (d[17] << 16) | (d[18] << 8) | d[19];
+	height = (d[20] << 24) | (d[21] << 16) | (d[22] << 8) | d[23];
+	return true;
+}
+
+struct PngReadPosition
+{
+	const string* png;
+	string::size_type pos;
+};
+
+static cairo_status_t pngReadFunction(PngReadPosition* source, unsigned char* data, unsigned int length)
+{
+	if (source->pos + length > source->png->length())
+	{
+		return CAIRO_STATUS_READ_ERROR;
+	}
+
+	source->png->copy((char*) data, length, source->pos);
+	source->pos += length;
+
+	return CAIRO_STATUS_SUCCESS;
+}
+
+cairo_surface_t* ImageCache::decodePng(const string& png)
+{
+	PngReadPosition source = { &png, 0 };
+	cairo_surface_t* img = cairo_image_surface_create_from_png_stream((cairo_read_func_t) &pngReadFunction, &source);
+
+	if (cairo_surface_status(img) != CAIRO_STATUS_SUCCESS)
+	{
+		g_warning("ImageCache: could not decode image: %s", cairo_status_to_string(cairo_surface_status(img)));
+		cairo_surface_destroy(img);
+		return NULL;
+	}
+
+	return img;
+}
+
+static cairo_status_t pngWriteFunction(string* png, const unsigned char* data, unsigned int length)
+{
+	png->append((const char*) data, length);
+	return CAIRO_STATUS_SUCCESS;
+}
+
+string ImageCache::encodePng(cairo_surface_t* img)
+{
+	string png;
+	cairo_surface_write_to_png_stream(img, (cairo_write_func_t) &pngWriteFunction, &png);
+	return png;
+}
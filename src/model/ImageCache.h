@@ -0,0 +1,158 @@
+/*
+ * Xournal++
+ *
+ * Caches the decoded images of Image elements
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <XournalType.h>
+
+#include <cairo/cairo.h>
+#include <glib.h>
+
+#include <atomic>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+
+/**
+ * Memory budget for all decoded images
+ */
+#define IMAGE_CACHE_BYTES (256 * 1024 * 1024)
+
+/**
+ * Image elements only keep the encoded PNG. The decoded image is cached here, as mipmap levels:
+ * level 0 is the full size image, each further level halves the width and the height. Only the
+ * levels which are painted are created, the least recently used levels are dropped if the cache
+ * exceeds its byte budget.
+ *
+ * The cache is used by the render threads, a level is never decoded by two threads at the same time.
+ */
+class ImageCache
+{
+private:
+	ImageCache(size_t maxBytes);
+	virtual ~ImageCache();
+
+	ImageCache(const ImageCache& cache);
+	void operator=(const ImageCache& cache);
+
+public:
+	static ImageCache* getInstance();
+
+	/**
+	 * @return A new ID to identify the images of an encoded PNG
+	 */
+	int newImageId();
+
+	/**
+	 * @param level The mipmap level, each level halves the size
+	 * @return A new reference to the image, the image is decoded if needed. NULL if the PNG cannot be decoded
+	 */
+	cairo_surface_t* get(int imageId, const string& png, int level);
+
+	/**
+	 * Adds an already decoded full size image, so it does not need to be decoded again
+	 *
+	 * @param img The image, a new reference is taken
+	 */
+	void put(int imageId, cairo_surface_t* img);
+
+	/**
+	 * Removes all levels of the image
+	 */
+	void remove(int imageId);
+
+	/**
+	 * @return The smallest level which is still at least as wide as painted
+	 */
+	static int levelForSize(int imageWidth, double paintedWidth);
+
+	/**
+	 * Reads the size from the PNG header, without decoding the image
+	 */
+	static bool readPngSize(const string& png, int& width, int& height);
+
+	/**
+	 * @return A new image, NULL if the PNG is not valid
+	 */
+	static cairo_surface_t* decodePng(const string& png);
+
+	/**
+	 * @return The PNG encoded image
+	 */
+	static string encodePng(cairo_surface_t* img);
+
+private:
+	struct CacheKey
+	{
+		int imageId;
+		int level;
+
+		bool operator==(const CacheKey& other) const
+		{
+			return imageId == other.imageId && level == other.level;
+		}
+	};
+
+	struct CacheKeyHash
+	{
+		size_t operator()(const CacheKey& key) const;
+	};
+
+	struct CacheEntry
+	{
+		CacheKey key;
+		cairo_surface_t* img;
+	};
+
+	typedef std::list<CacheEntry> EntryList;
+
+private:
+	EntryList::iterator findUnlocked(const CacheKey& key);
+	void storeUnlocked(const CacheKey& key, cairo_surface_t* img);
+	void eraseUnlocked(EntryList::iterator it);
+
+	static cairo_surface_t* scaleDown(cairo_surface_t* img, int levels);
+	static size_t surfaceBytes(cairo_surface_t* img);
+
+private:
+	XOJ_TYPE_ATTRIB;
+
+	/**
+	 * Protects the entries and the levels being decoded, not held while decoding
+	 */
+	GMutex mutex;
+
+	/**
+	 * Signaled each time a level has been decoded
+	 */
+	GCond decodeFinished;
+
+	/**
+	 * Most recently used entries first
+	 */
+	EntryList data;
+	std::unordered_map<CacheKey, EntryList::iterator, CacheKeyHash> index;
+
+	/**
+	 * The levels currently decoded by a thread
+	 */
+	std::unordered_set<CacheKey, CacheKeyHash> decoding;
+
+	size_t bytes = 0;
+	size_t maxBytes;
+
+	std::atomic<int> lastImageId{0};
+
+	/**
+	 * Images are not reduced below this size
+	 */
+	static const int MAX_LEVEL = 12;
+};
@@ -2,9 +2,13 @@
 
 #include <Stacktrace.h>
 
+#include <algorithm>
+
 Layer::Layer()
 {
 	XOJ_INIT_TYPE(Layer);
+
+	g_mutex_init(&this->positionsMutex);
 }
 
 Layer::~Layer()
@@ -17,6 +21,8 @@ Layer::~Layer()
 	}
 	this->elements.clear();
 
+	g_mutex_clear(&this->positionsMutex);
+
 	XOJ_RELEASE_TYPE(Layer);
 }
 
@@ -30,6 +36,7 @@ Layer* Layer::clone()
 	{
 		layer->addElement(e->clone());
 	}
+	layer->visible = this->visible;
 
 	return layer;
 }
@@ -45,16 +52,21 @@ void Layer::addElement(Element* e)
 		return;
 	}
 
-	for (Element* elem2 : this->elements)
+	if (this->index.contains(e))
 	{
-		if (e == elem2)
-		{
-			g_warning("Layer::addElement: Element is already on this layer!");
-			return;
-		}
+		g_warning("Layer::addElement: Element is already on this layer!");
+		return;
 	}
 
+	g_mutex_lock(&this->positionsMutex);
 	this->elements.push_back(e);
+	if (this->positionsValid)
+	{
+		this->positions[e] = this->elements.size() - 1;
+	}
+	g_mutex_unlock(&this->positionsMutex);
+
+	this->index.insert(e);
 }
 
 void Layer::insertElement(Element* e, int pos)
@@ -68,14 +80,11 @@ void Layer::insertElement(Element* e, int pos)
 		return;
 	}
 
-	for (Element* elem2 : this->elements)
+	if (this->index.contains(e))
 	{
-		if (e == elem2)
-		{
-			g_warning("Layer::insertElement() try to add an element twice!");
-			Stacktrace::printStracktrace();
-			return;
-		}
+		g_warning("Layer::insertElement() try to add an element twice!");
+		Stacktrace::printStracktrace();
+		return;
 	}
 
 	// prevent crash, even if this never should happen,
@@ -85,50 +94,92 @@ void Layer::insertElement(Element* e, int pos)
 		pos = 0;
 	}
 
+	g_mutex_lock(&this->positionsMutex);
+
 	// If the element should be inserted at the top
 	if (pos >= (int)this->elements.size())
 	{
 		this->elements.push_back(e);
+
+		if (this->positionsValid)
+		{
+			this->positions[e] = this->elements.size() - 1;
+		}
 	}
 	else
 	{
 		this->elements.insert(this->elements.begin() + pos, e);
+		this->positionsValid = false;
 	}
+
+	g_mutex_unlock(&this->positionsMutex);
+
+	this->index.insert(e);
 }
 
 int Layer::indexOf(Element* e)
 {
 	XOJ_CHECK_TYPE(Layer);
-	
+
+	g_mutex_lock(&this->positionsMutex);
+
+	updatePositionsUnlocked();
+
+	int pos = -1;
+	auto it = this->positions.find(e);
+	if (it != this->positions.end())
+	{
+		pos = it->second;
+	}
+
+	g_mutex_unlock(&this->positionsMutex);
+
+	return pos;
+}
+
+void Layer::updatePositionsUnlocked()
+{
+	XOJ_CHECK_TYPE(Layer);
+
+	if (this->positionsValid)
+	{
+		return;
+	}
+
+	this->positions.clear();
 	for (unsigned int i = 0; i < this->elements.size(); i++)
 	{
-		if (this->elements[i] == e)
-		{
-			return i;
-		}
+		this->positions[this->elements[i]] = i;
 	}
-	
-	return -1;
+	this->positionsValid = true;
 }
 
 int Layer::removeElement(Element* e, bool free)
 {
 	XOJ_CHECK_TYPE(Layer);
 
-	for (unsigned int i = 0; i < this->elements.size(); i++)
+	int pos = indexOf(e);
+	if (pos != -1)
 	{
-		if (e == this->elements[i])
+		g_mutex_lock(&this->positionsMutex);
+		this->elements.erase(this->elements.begin() + pos);
+		this->positions.erase(e);
+		if (pos != (int) this->elements.size())
+		{
+			// The following elements moved
+			this->positionsValid = false;
+		}
+		g_mutex_unlock(&this->positionsMutex);
+
+		this->index.remove(e);
+
+		if (free)
 		{
-			this->elements.erase(this->elements.begin() + i);
-			
-			if (free)
-			{
-				delete e;
-			}
-			return i;
+			delete e;
 		}
+		return pos;
 	}
-	
+
 	g_warning("Could not remove element from layer, it's not on the layer!");
 	Stacktrace::printStracktrace();
 	return -1;
@@ -167,3 +218,47 @@ vector<Element*>* Layer::getElements()
 
 	return &this->elements;
 }
+
+vector<Element*> Layer::getElementsInArea(double x, double y, double width, double height)
+{
+	XOJ_CHECK_TYPE(Layer);
+
+	vector<Element*> result;
+	this->index.query(x, y, width, height, result);
+	sortByPosition(result);
+
+	return result;
+}
+
+vector<Element*> Layer::getElementsAt(double x, double y)
+{
+	XOJ_CHECK_TYPE(Layer);
+
+	vector<Element*> result;
+	this->index.queryPoint(x, y, result);
+	sortByPosition(result);
+
+	return result;
+}
+
+void Layer::sortByPosition(vector<Element*>& elements)
+{
+	XOJ_CHECK_TYPE(Layer);
+
+	g_mutex_lock(&this->positionsMutex);
+
+	updatePositionsUnlocked();
+
+	// An element which is added or removed at the same time may be in the index, but not in the positions
+	elements.erase(std::remove_if(elements.begin(), elements.end(), [&](Element* e)
+	{
+		return this->positions.find(e) == this->positions.end();
+	}), elements.end());
+
+	std::sort(elements.begin(), elements.end(), [&](Element* a, Element* b)
+	{
+		return this->positions.find(a)->second < this->positions.find(b)->second;
+	});
+
+	g_mutex_unlock(&this->positionsMutex);
+}
@@ -12,8 +12,11 @@
 #pragma once
 
 #include "Element.h"
+#include "SpatialIndex.h"
 #include <XournalType.h>
 
+#include <unordered_map>
+
 class Layer
 {
 public:
@@ -50,6 +53,16 @@ public:
 	 */
 	vector<Element*>* getElements();
 
+	/**
+	 * Returns the Element%s whose bounding box intersects the area, in drawing order
+	 */
+	vector<Element*> getElementsInArea(double x, double y, double width, double height);
+
+	/**
+	 * Returns the Element%s whose bounding box contains the point, in drawing order
+	 */
+	vector<Element*> getElementsAt(double x, double y);
+
 	/**
 	 * Returns whether or not the Layer is empty
 	 */
@@ -70,10 +83,38 @@ public:
 	 */
 	Layer* clone();
 
+private:
+	/**
+	 * Sorts the elements by their position in this Layer
+	 */
+	void sortByPosition(vector<Element*>& elements);
+
+	/**
+	 * The positionsMutex has to be locked by the caller
+	 */
+	void updatePositionsUnlocked();
+
 private:
 	XOJ_TYPE_ATTRIB;
 
 	vector<Element*> elements;
 
+	/**
+	 * Bounding boxes of the elements for hit-testing and culling
+	 */
+	SpatialIndex index;
+
+	/**
+	 * Position of each element in the list, rebuilt lazily after inserting in the middle or removing
+	 */
+	std::unordered_map<Element*, int> positions;
+	bool positionsValid = true;
+
+	/**
+	 * Protects the positions. They are rebuilt by queries, which run without the document lock
+	 * in the UI thread and with it in the render threads at the same time
+	 */
+	GMutex positionsMutex;
+
 	bool visible = true;
 };
@@ -73,7 +73,12 @@ enum
 	DOCUMENT_LINKS_COLUMN_NAME,
 	DOCUMENT_LINKS_COLUMN_LINK,
 	DOCUMENT_LINKS_COLUMN_EXPAND,
-	DOCUMENT_LINKS_COLUMN_PAGE_NUMBER
+	DOCUMENT_LINKS_COLUMN_PAGE_NUMBER,
+
+	/**
+	 * The iterator of the bookmarks below the row, until they are added to the model
+	 */
+	DOCUMENT_LINKS_COLUMN_CHILDREN
 };
 
 #define TYPE_LINK_DEST              (link_dest_get_type())
@@ -2,9 +2,16 @@
 
 #include "PageListener.h"
 
+/**
+ * The last change id, the ids are unique over all pages
+ */
+static int lastChangeId = 0;
+
 PageHandler::PageHandler()
 {
 	XOJ_INIT_TYPE(PageHandler);
+
+	contentChanged();
 }
 
 PageHandler::~PageHandler()
@@ -28,10 +35,26 @@ void PageHandler::removeListener(PageListener* l)
 	this->listener.remove(l);
 }
 
+void PageHandler::contentChanged()
+{
+	XOJ_CHECK_TYPE(PageHandler);
+
+	g_atomic_int_set(&this->changeId, g_atomic_int_add(&lastChangeId, 1) + 1);
+}
+
+int PageHandler::getChangeId()
+{
+	XOJ_CHECK_TYPE(PageHandler);
+
+	return g_atomic_int_get(&this->changeId);
+}
+
 void PageHandler::fireRectChanged(Rectangle &rect)
 {
 	XOJ_CHECK_TYPE(PageHandler);
 
+	contentChanged();
+
 	for (PageListener* pl : this->listener)
 	{
 		pl->rectChanged(rect);
@@ -42,6 +65,8 @@ void PageHandler::fireRangeChanged(Range &range)
 {
 	XOJ_CHECK_TYPE(PageHandler);
 
+	contentChanged();
+
 	for (PageListener* pl : this->listener)
 	{
 		pl->rangeChanged(range);
@@ -52,6 +77,8 @@ void PageHandler::fireElementChanged(Element *elem)
 {
 	XOJ_CHECK_TYPE(PageHandler);
 
+	contentChanged();
+
 	for (PageListener* pl : this->listener)
 	{
 		pl->elementChanged(elem);
@@ -62,6 +89,8 @@ void PageHandler::firePageChanged()
 {
 	XOJ_CHECK_TYPE(PageHandler);
 
+	contentChanged();
+
 	for (PageListener* pl : this->listener)
 	{
 		pl->pageChanged();
@@ -32,6 +32,18 @@ public:
 	void fireElementChanged(Element* elem);
 	void firePageChanged();
 
+	/**
+	 * Marks the content as changed without notifying the listeners. Called by all fire methods.
+	 */
+	void contentChanged();
+
+	/**
+	 * Changes with every change of the content, unique over all pages
+	 *
+	 * This is used to check if a copy of the page is still up to date, may be called without lock
+	 */
+	int getChangeId();
+
 private:
 	void addListener(PageListener* l);
 	void removeListener(PageListener* l);
@@ -41,5 +53,7 @@ private:
 
 	std::list<PageListener*> listener;
 
+	int changeId = 0;
+
 	friend class PageListener;
 };
@@ -13,9 +13,14 @@
 
 #include <XournalType.h>
 
+#include <type_traits>
+
 /**
  * @class Point
  * @brief Representation of a point.
+ *
+ * Strokes store their points in one contiguous array which is copied with memcpy / realloc,
+ * therefore this is a plain value type without virtual methods or type tag.
  */
 class Point
 {
@@ -30,7 +35,7 @@ public:
 	 * @brief Copy constructor.
 	 * @param p The point to copy.
 	 */
-	Point(const Point& p);
+	Point(const Point& p) = default;
 
 	/**
 	 * @brief Point from two values.
@@ -47,7 +52,7 @@ public:
 	 */
 	Point(double x, double y, double z);
 
-	virtual ~Point();
+	Point& operator=(const Point& p) = default;
 
 public:
 
@@ -80,8 +85,6 @@ public:
 	bool equalsPos(const Point& p);
 
 public:
-	XOJ_TYPE_ATTRIB;
-
 	/**
 	 * @brief Private storage for x coordinate.
 	 */
@@ -99,3 +102,5 @@ public:
 
 	static constexpr double NO_PRESSURE = -1;
 };
+
+static_assert(std::is_trivially_copyable<Point>::value, "Point is stored in realloc'ed arrays");
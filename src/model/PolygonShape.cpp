@@ -0,0 +1,299 @@
+#include "PolygonShape.h"
+
+#include <algorithm>
+#include <cmath>
+
+PolygonShape::PolygonShape()
+{
+	XOJ_INIT_TYPE(PolygonShape);
+}
+
+PolygonShape::~PolygonShape()
+{
+	XOJ_RELEASE_TYPE(PolygonShape);
+}
+
+void PolygonShape::addPoint(double x, double y)
+{
+	XOJ_CHECK_TYPE(PolygonShape);
+
+	if (this->points.empty())
+	{
+		this->x1 = this->x2 = x;
+		this->y1 = this->y2 = y;
+	}
+	else
+	{
+		this->x1 = std::min(this->x1, x);
+		this->x2 = std::max(this->x2, x);
+		this->y1 = std::min(this->y1, y);
+		this->y2 = std::max(this->y2, y);
+	}
+
+	this->points.push_back(Point(x, y));
+	this->compiled = false;
+}
+
+const vector<Point>& PolygonShape::getPoints() const
+{
+	XOJ_CHECK_TYPE(PolygonShape);
+
+	return this->points;
+}
+
+double PolygonShape::getX1() const
+{
+	XOJ_CHECK_TYPE(PolygonShape);
+
+	return this->x1;
+}
+
+double PolygonShape::getY1() const
+{
+	XOJ_CHECK_TYPE(PolygonShape);
+
+	return this->y1;
+}
+
+double PolygonShape::getX2() const
+{
+	XOJ_CHECK_TYPE(PolygonShape);
+
+	return this->x2;
+}
+
+double PolygonShape::getY2() const
+{
+	XOJ_CHECK_TYPE(PolygonShape);
+
+	return this->y2;
+}
+
+int PolygonShape::rowOf(double y) const
+{
+	int row = (int) std::floor((y - this->y1) / this->cellSize);
+	return std::max(0, std::min(this->rows - 1, row));
+}
+
+int PolygonShape::colOf(double x) const
+{
+	int col = (int) std::floor((x - this->x1) / this->cellSize);
+	return std::max(0, std::min(this->cols - 1, col));
+}
+
+void PolygonShape::compile()
+{
+	XOJ_CHECK_TYPE(PolygonShape);
+
+	this->compiled = true;
+	this->cells.clear();
+	this->edges.clear();
+	this->rowStart.clear();
+	this->rowEdges.clear();
+
+	double width = this->x2 - this->x1;
+	double height = this->y2 - this->y1;
+
+	this->empty = this->points.size() < 3 || width <= 0 || height <= 0;
+	if (this->empty)
+	{
+		return;
+	}
+
+	this->cellSize = std::max(width, height) / GRID_SIZE;
+	this->cols = std::max(1, std::min(GRID_SIZE, (int) std::ceil(width / this->cellSize)));
+	this->rows = std::max(1, std::min(GRID_SIZE, (int) std::ceil(height / this->cellSize)));
+	this->epsilon = this->cellSize * 1e-6;
+	this->cells.assign(this->cols * this->rows, CELL_OUTSIDE);
+
+	size_t count = this->points.size();
+	for (size_t i = 0; i < count; i++)
+	{
+		const Point& a = this->points[i];
+		const Point& b = this->points[(i + 1) % count];
+
+		markEdgeCells(a, b);
+
+		// Horizontal edges are never crossed by the horizontal test ray
+		if (a.y == b.y)
+		{
+			continue;
+		}
+
+		const Point& top = a.y < b.y ? a : b;
+		const Point& bottom = a.y < b.y ? b : a;
+		this->edges.push_back({ top.x, top.y, bottom.y, (bottom.x - top.x) / (bottom.y - top.y) });
+	}
+
+	// Bucket the edges by row: count, prefix sum, fill
+	this->rowStart.assign(this->rows + 1, 0);
+	for (const Edge& e : this->edges)
+	{
+		for (int r = rowOf(e.y1 - this->epsilon); r <= rowOf(e.y2 + this->epsilon); r++)
+		{
+			this->rowStart[r + 1]++;
+		}
+	}
+	for (int r = 0; r < this->rows; r++)
+	{
+		this->rowStart[r + 1] += this->rowStart[r];
+	}
+
+	this->rowEdges.resize(this->rowStart[this->rows]);
+	vector<int> fill(this->rowStart.begin(), this->rowStart.end() - 1);
+	for (int i = 0; i < (int) this->edges.size(); i++)
+	{
+		const Edge& e = this->edges[i];
+		for (int r = rowOf(e.y1 - this->epsilon); r <= rowOf(e.y2 + this->epsilon); r++)
+		{
+			this->rowEdges[fill[r]++] = i;
+		}
+	}
+
+	// No edge separates neighboring cells which are not crossed by an edge, so one exact
+	// test decides a whole run of them
+	for (int r = 0; r < this->rows; r++)
+	{
+		CellState* row = &this->cells[r * this->cols];
+		bool known = false;
+		CellState state = CELL_OUTSIDE;
+
+		for (int c = 0; c < this->cols; c++)
+		{
+			if (row[c] == CELL_EDGE)
+			{
+				known = false;
+				continue;
+			}
+
+			if (!known)
+			{
+				double cx = this->x1 + (c + 0.5) * this->cellSize;
+				double cy = this->y1 + (r + 0.5) * this->cellSize;
+				state = containsExact(cx, cy, r) ? CELL_INSIDE : CELL_OUTSIDE;
+				known = true;
+			}
+			row[c] = state;
+		}
+	}
+}
+
+void PolygonShape::markEdgeCells(const Point& a, const Point& b)
+{
+	XOJ_CHECK_TYPE(PolygonShape);
+
+	double top = std::min(a.y, b.y);
+	double bottom = std::max(a.y, b.y);
+
+	for (int r = rowOf(top - this->epsilon); r <= rowOf(bottom + this->epsilon); r++)
+	{
+		double xa = a.x;
+		double xb = b.x;
+
+		// Only the part of the edge inside of this row
+		if (a.y != b.y)
+		{
+			double rowTop = this->y1 + r * this->cellSize - this->epsilon;
+			double rowBottom = rowTop + this->cellSize + 2 * this->epsilon;
+			double slope = (b.x - a.x) / (b.y - a.y);
+
+			xa = a.x + (std::max(top, rowTop) - a.y) * slope;
+			xb = a.x + (std::min(bottom, rowBottom) - a.y) * slope;
+		}
+
+		int c1 = colOf(std::min(xa, xb) - this->epsilon);
+		int c2 = colOf(std::max(xa, xb) + this->epsilon);
+		std::fill(this->cells.begin() + r * this->cols + c1, this->cells.begin() + r * this->cols + c2 + 1, CELL_EDGE);
+	}
+}
+
+bool PolygonShape::containsExact(double x, double y, int row) const
+{
+	bool inside = false;
+
+	for (int i = this->rowStart[row]; i < this->rowStart[row + 1]; i++)
+	{
+		const Edge& e = this->edges[this->rowEdges[i]];
+
+		// Half open in y, so a ray through a vertex counts the two edges of the vertex once
+		if (y >= e.y1 && y < e.y2 && x < e.x1 + (y - e.y1) * e.slope)
+		{
+			inside = !inside;
+		}
+	}
+
+	return inside;
+}
+
+bool PolygonShape::contains(double x, double y)
+{
+	XOJ_CHECK_TYPE(PolygonShape);
+
+	if (!this->compiled)
+	{
+		compile();
+	}
+
+	if (this->empty || x < this->x1 || x > this->x2 || y < this->y1 || y > this->y2)
+	{
+		return false;
+	}
+
+	int row = rowOf(y);
+	CellState state = this->cells[row * this->cols + colOf(x)];
+	if (state != CELL_EDGE)
+	{
+		return state == CELL_INSIDE;
+	}
+
+	return containsExact(x, y, row);
+}
+
+ShapeContainment PolygonShape::containsArea(double x, double y, double width, double height)
+{
+	XOJ_CHECK_TYPE(PolygonShape);
+
+	if (!this->compiled)
+	{
+		compile();
+	}
+
+	if (this->empty || x > this->x2 || y > this->y2 || x + width < this->x1 || y + height < this->y1)
+	{
+		return SHAPE_OUTSIDE;
+	}
+
+	// Everything outside of the bounding box is outside of the polygon
+	bool outside = x < this->x1 || y < this->y1 || x + width > this->x2 || y + height > this->y2;
+	bool inside = false;
+
+	int c1 = colOf(x);
+	int c2 = colOf(x + width);
+	for (int r = rowOf(y); r <= rowOf(y + height); r++)
+	{
+		for (int c = c1; c <= c2; c++)
+		{
+			CellState state = this->cells[r * this->cols + c];
+			if (state == CELL_EDGE)
+			{
+				return SHAPE_PARTIAL;
+			}
+
+			if (state == CELL_INSIDE)
+			{
+				inside = true;
+			}
+			else
+			{
+				outside = true;
+			}
+
+			if (inside && outside)
+			{
+				return SHAPE_PARTIAL;
+			}
+		}
+	}
+
+	return inside ? SHAPE_INSIDE : SHAPE_OUTSIDE;
+}
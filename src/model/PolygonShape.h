@@ -0,0 +1,127 @@
+/*
+ * Xournal++
+ *
+ * A closed polygon with a fast point in polygon test, used by the lasso selection
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include "Element.h"
+#include "Point.h"
+
+#include <XournalType.h>
+
+#include <vector>
+using std::vector;
+
+/**
+ * The polygon is compiled with the first query into a coarse grid over its bounding box.
+ * Each cell is known to be inside, outside or crossed by an edge; only points in a crossed
+ * cell are tested exactly (even-odd rule), against the edges overlapping the row of the cell.
+ *
+ * Adding a point after a query compiles the polygon again with the next query.
+ */
+class PolygonShape : public ShapeContainer
+{
+public:
+	PolygonShape();
+	virtual ~PolygonShape();
+
+private:
+	PolygonShape(const PolygonShape& shape);
+	void operator=(const PolygonShape& shape);
+
+public:
+	void addPoint(double x, double y);
+	const vector<Point>& getPoints() const;
+
+	/**
+	 * The bounding box of the points, all 0 if there are no points
+	 */
+	double getX1() const;
+	double getY1() const;
+	double getX2() const;
+	double getY2() const;
+
+	virtual bool contains(double x, double y);
+	virtual ShapeContainment containsArea(double x, double y, double width, double height);
+
+private:
+	enum CellState : unsigned char
+	{
+		CELL_OUTSIDE = 0,
+		CELL_INSIDE,
+		CELL_EDGE
+	};
+
+	/**
+	 * A non-horizontal edge, from top (y1) to bottom (y2)
+	 */
+	struct Edge
+	{
+		double x1;
+		double y1;
+		double y2;
+
+		/**
+		 * dx / dy
+		 */
+		double slope;
+	};
+
+	void compile();
+	void markEdgeCells(const Point& a, const Point& b);
+	int rowOf(double y) const;
+	int colOf(double x) const;
+
+	/**
+	 * The exact even-odd test, only with the edges of the row
+	 */
+	bool containsExact(double x, double y, int row) const;
+
+private:
+	XOJ_TYPE_ATTRIB;
+
+	vector<Point> points;
+
+	double x1 = 0;
+	double y1 = 0;
+	double x2 = 0;
+	double y2 = 0;
+
+	bool compiled = false;
+
+	/**
+	 * Less than three points or no area
+	 */
+	bool empty = true;
+
+	int cols = 0;
+	int rows = 0;
+	double cellSize = 0;
+
+	/**
+	 * Tolerance for rounding errors at cell borders, the cells are marked a little too large
+	 */
+	double epsilon = 0;
+
+	vector<CellState> cells;
+
+	vector<Edge> edges;
+
+	/**
+	 * The indices of the edges overlapping row r are rowEdges[rowStart[r]] to rowEdges[rowStart[r + 1] - 1]
+	 */
+	vector<int> rowStart;
+	vector<int> rowEdges;
+
+	/**
+	 * Cells along the longer side of the bounding box
+	 */
+	static const int GRID_SIZE = 256;
+};
@@ -0,0 +1,293 @@
+#include "SpatialIndex.h"
+
+#include "Element.h"
+
+#include <algorithm>
+#include <cmath>
+
+SpatialIndex::SpatialIndex(double cellSize)
+ : cellSize(cellSize)
+{
+	XOJ_INIT_TYPE(SpatialIndex);
+
+	g_mutex_init(&this->mutex);
+}
+
+SpatialIndex::~SpatialIndex()
+{
+	XOJ_CHECK_TYPE(SpatialIndex);
+
+	// The elements may already be deleted, only the own data is freed
+	this->entries.clear();
+	this->cells.clear();
+	this->largeEntries.clear();
+	this->changedEntries.clear();
+
+	g_mutex_clear(&this->mutex);
+
+	XOJ_RELEASE_TYPE(SpatialIndex);
+}
+
+int64_t SpatialIndex::cellKey(int cx, int cy)
+{
+	return (int64_t) ((((uint64_t) (uint32_t) cx) << 32) | (uint32_t) cy);
+}
+
+int SpatialIndex::cellIndex(double v)
+{
+	XOJ_CHECK_TYPE(SpatialIndex);
+
+	return (int) std::floor(v / this->cellSize);
+}
+
+void SpatialIndex::insert(Element* e)
+{
+	XOJ_CHECK_TYPE(SpatialIndex);
+
+	g_mutex_lock(&this->mutex);
+
+	Entry& entry = this->entries[e];
+	entry = { e, 0, 0, 0, 0, 0, 0, 0, 0, false, false, true, 0 };
+	this->changedEntries.push_back(&entry);
+
+	e->spatialIndex = this;
+
+	g_mutex_unlock(&this->mutex);
+}
+
+void SpatialIndex::remove(Element* e)
+{
+	XOJ_CHECK_TYPE(SpatialIndex);
+
+	g_mutex_lock(&this->mutex);
+
+	auto it = this->entries.find(e);
+	if (it != this->entries.end())
+	{
+		Entry* entry = &it->second;
+		removeFromGridUnlocked(entry);
+
+		if (entry->changed)
+		{
+			this->changedEntries.erase(std::find(this->changedEntries.begin(), this->changedEntries.end(), entry));
+		}
+
+		this->entries.erase(it);
+		e->spatialIndex = NULL;
+	}
+
+	g_mutex_unlock(&this->mutex);
+}
+
+void SpatialIndex::update(Element* e)
+{
+	XOJ_CHECK_TYPE(SpatialIndex);
+
+	g_mutex_lock(&this->mutex);
+
+	auto it = this->entries.find(e);
+	if (it != this->entries.end() && !it->second.changed)
+	{
+		it->second.changed = true;
+		this->changedEntries.push_back(&it->second);
+	}
+
+	g_mutex_unlock(&this->mutex);
+}
+
+bool SpatialIndex::contains(Element* e)
+{
+	XOJ_CHECK_TYPE(SpatialIndex);
+
+	g_mutex_lock(&this->mutex);
+	bool found = this->entries.find(e) != this->entries.end();
+	g_mutex_unlock(&this->mutex);
+
+	return found;
+}
+
+void SpatialIndex::removeFromGridUnlocked(Entry* entry)
+{
+	XOJ_CHECK_TYPE(SpatialIndex);
+
+	if (entry->large)
+	{
+		this->largeEntries.erase(std::find(this->largeEntries.begin(), this->largeEntries.end(), entry));
+		entry->large = false;
+		return;
+	}
+
+	if (!entry->inGrid)
+	{
+		return;
+	}
+
+	for (int cy = entry->cy1; cy <= entry->cy2; cy++)
+	{
+		for (int cx = entry->cx1; cx <= entry->cx2; cx++)
+		{
+			auto it = this->cells.find(cellKey(cx, cy));
+			if (it == this->cells.end())
+			{
+				continue;
+			}
+
+			Cell& cell = it->second;
+			auto pos = std::find(cell.begin(), cell.end(), entry);
+			if (pos != cell.end())
+			{
+				*pos = cell.back();
+				cell.pop_back();
+			}
+
+			if (cell.empty())
+			{
+				this->cells.erase(it);
+			}
+		}
+	}
+
+	entry->inGrid = false;
+}
+
+void SpatialIndex::addToGridUnlocked(Entry* entry)
+{
+	XOJ_CHECK_TYPE(SpatialIndex);
+
+	Element* e = entry->element;
+	entry->x1 = e->getX();
+	entry->y1 = e->getY();
+	entry->x2 = entry->x1 + e->getElementWidth();
+	entry->y2 = entry->y1 + e->getElementHeight();
+
+	int cx1 = cellIndex(entry->x1);
+	int cy1 = cellIndex(entry->y1);
+	int cx2 = cellIndex(entry->x2);
+	int cy2 = cellIndex(entry->y2);
+
+	if ((int64_t) (cx2 - cx1 + 1) * (cy2 - cy1 + 1) > MAX_CELLS_PER_ELEMENT)
+	{
+		entry->large = true;
+		this->largeEntries.push_back(entry);
+		return;
+	}
+
+	entry->cx1 = cx1;
+	entry->cy1 = cy1;
+	entry->cx2 = cx2;
+	entry->cy2 = cy2;
+	entry->inGrid = true;
+
+	for (int cy = cy1; cy <= cy2; cy++)
+	{
+		for (int cx = cx1; cx <= cx2; cx++)
+		{
+			this->cells[cellKey(cx, cy)].push_back(entry);
+		}
+	}
+}
+
+void SpatialIndex::applyChangesUnlocked()
+{
+	XOJ_CHECK_TYPE(SpatialIndex);
+
+	for (Entry* entry : this->changedEntries)
+	{
+		removeFromGridUnlocked(entry);
+		addToGridUnlocked(entry);
+		entry->changed = false;
+	}
+	this->changedEntries.clear();
+}
+
+void SpatialIndex::queryUnlocked(double x1, double y1, double x2, double y2, bool inclusive, vector<Element*>& result)
+{
+	XOJ_CHECK_TYPE(SpatialIndex);
+
+	applyChangesUnlocked();
+
+	unsigned int mark = ++this->queryCounter;
+
+	auto matches = [&](Entry* entry)
+	{
+		if (entry->queryMark == mark)
+		{
+			return false;
+		}
+		entry->queryMark = mark;
+
+		if (inclusive)
+		{
+			return entry->x1 <= x2 && x1 <= entry->x2 && entry->y1 <= y2 && y1 <= entry->y2;
+		}
+		return entry->x1 < x2 && x1 < entry->x2 && entry->y1 < y2 && y1 < entry->y2;
+	};
+
+	int cx1 = cellIndex(x1);
+	int cy1 = cellIndex(y1);
+	int cx2 = cellIndex(x2);
+	int cy2 = cellIndex(y2);
+
+	if ((int64_t) (cx2 - cx1 + 1) * (cy2 - cy1 + 1) > (int64_t) this->cells.size())
+	{
+		// Querying a large area, check the occupied cells only
+		for (auto& it : this->cells)
+		{
+			for (Entry* entry : it.second)
+			{
+				if (matches(entry))
+				{
+					result.push_back(entry->element);
+				}
+			}
+		}
+	}
+	else
+	{
+		for (int cy = cy1; cy <= cy2; cy++)
+		{
+			for (int cx = cx1; cx <= cx2; cx++)
+			{
+				auto it = this->cells.find(cellKey(cx, cy));
+				if (it == this->cells.end())
+				{
+					continue;
+				}
+
+				for (Entry* entry : it->second)
+				{
+					if (matches(entry))
+					{
+						result.push_back(entry->element);
+					}
+				}
+			}
+		}
+	}
+
+	for (Entry* entry : this->largeEntries)
+	{
+		if (matches(entry))
+		{
+			result.push_back(entry->element);
+		}
+	}
+}
+
+void SpatialIndex::query(double x, double y, double width, double height, vector<Element*>& result)
+{
+	XOJ_CHECK_TYPE(SpatialIndex);
+
+	g_mutex_lock(&this->mutex);
+	queryUnlocked(x, y, x + width, y + height, true, result);
+	g_mutex_unlock(&this->mutex);
+}
+
+void SpatialIndex::queryPoint(double x, double y, vector<Element*>& result)
+{
+	XOJ_CHECK_TYPE(SpatialIndex);
+
+	g_mutex_lock(&this->mutex);
+	queryUnlocked(x, y, x, y, true, result);
+	g_mutex_unlock(&this->mutex);
+}
@@ -0,0 +1,129 @@
+/*
+ * Xournal++
+ *
+ * Uniform grid over the bounding boxes of the elements of a layer
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <XournalType.h>
+
+#include <unordered_map>
+
+class Element;
+
+/**
+ * Spatial index for hit testing and culling. Every element is stored in the grid cells
+ * its bounding box overlaps, elements covering too many cells are kept in a separate list.
+ *
+ * Elements notify the index if their bounds change (Element::boundsChanged), the new
+ * bounds are applied lazily with the next query, so e.g. loading a document does not
+ * calculate the size of each element.
+ */
+class SpatialIndex
+{
+public:
+	/**
+	 * @param cellSize The size of a grid cell in page coordinates
+	 */
+	SpatialIndex(double cellSize = 32);
+	virtual ~SpatialIndex();
+
+private:
+	SpatialIndex(const SpatialIndex& index);
+	void operator=(const SpatialIndex& index);
+
+public:
+	void insert(Element* e);
+	void remove(Element* e);
+
+	/**
+	 * Called if the bounds of the element have changed
+	 */
+	void update(Element* e);
+
+	bool contains(Element* e);
+
+	/**
+	 * Appends all elements whose bounding box intersects the rectangle to result,
+	 * in no particular order
+	 */
+	void query(double x, double y, double width, double height, vector<Element*>& result);
+
+	/**
+	 * Appends all elements whose bounding box contains the point to result,
+	 * in no particular order
+	 */
+	void queryPoint(double x, double y, vector<Element*>& result);
+
+private:
+	struct Entry
+	{
+		Element* element;
+
+		/**
+		 * The indexed bounding box
+		 */
+		double x1, y1, x2, y2;
+
+		/**
+		 * The covered cells, only valid if inGrid is set
+		 */
+		int cx1, cy1, cx2, cy2;
+		bool inGrid;
+
+		/**
+		 * Stored in largeEntries instead of the grid
+		 */
+		bool large;
+
+		/**
+		 * The bounds have changed and need to be indexed again
+		 */
+		bool changed;
+
+		/**
+		 * The last query which returned this entry, to prevent duplicates
+		 */
+		unsigned int queryMark;
+	};
+
+	typedef vector<Entry*> Cell;
+
+private:
+	void applyChangesUnlocked();
+	void addToGridUnlocked(Entry* entry);
+	void removeFromGridUnlocked(Entry* entry);
+	void queryUnlocked(double x1, double y1, double x2, double y2, bool inclusive, vector<Element*>& result);
+
+	static int64_t cellKey(int cx, int cy);
+	int cellIndex(double v);
+
+private:
+	XOJ_TYPE_ATTRIB;
+
+	GMutex mutex;
+
+	double cellSize;
+
+	std::unordered_map<Element*, Entry> entries;
+	std::unordered_map<int64_t, Cell> cells;
+
+	/**
+	 * Elements covering more cells than this are not stored in the grid
+	 */
+	static const int MAX_CELLS_PER_ELEMENT = 256;
+	vector<Entry*> largeEntries;
+
+	/**
+	 * Entries which are indexed again with the next query
+	 */
+	vector<Entry*> changedEntries;
+
+	unsigned int queryCounter = 0;
+};
@@ -17,10 +17,7 @@ Stroke::~Stroke()
 {
 	XOJ_CHECK_TYPE(Stroke);
 
-	g_free(this->points);
-	this->points = NULL;
-	this->pointCount = 0;
-	this->pointAllocCount = 0;
+	freePoints();
 
 	XOJ_RELEASE_TYPE(Stroke);
 }
@@ -46,13 +43,71 @@ Stroke* Stroke::cloneStroke() const
 	Stroke* s = new Stroke();
 	s->applyStyleFrom(this);
 
-	s->allocPointSize(this->pointCount);
-	memcpy(s->points, this->points, this->pointCount * sizeof(Point));
-	s->pointCount = this->pointCount;
+	if (this->pointCount > 0)
+	{
+		if (this->pointsShared == NULL)
+		{
+			this->pointsShared = g_new(gint, 1);
+			*this->pointsShared = 1;
+		}
+		g_atomic_int_inc(this->pointsShared);
+
+		s->points = this->points;
+		s->pointCount = this->pointCount;
+		s->pointAllocCount = this->pointAllocCount;
+		s->pointsShared = this->pointsShared;
+	}
 
 	return s;
 }
 
+void Stroke::makePointsWritable()
+{
+	XOJ_CHECK_TYPE(Stroke);
+
+	if (this->pointsShared == NULL)
+	{
+		return;
+	}
+
+	if (g_atomic_int_get(this->pointsShared) == 1)
+	{
+		// The other strokes are gone, only this one can share the points again
+		g_free(this->pointsShared);
+		this->pointsShared = NULL;
+		return;
+	}
+
+	// Copied before releasing, else the last other stroke could already change them
+	Point* copy = (Point*) g_malloc(this->pointAllocCount * sizeof(Point));
+	memcpy(copy, this->points, this->pointCount * sizeof(Point));
+
+	if (g_atomic_int_dec_and_test(this->pointsShared))
+	{
+		g_free(this->points);
+		g_free(this->pointsShared);
+	}
+
+	this->points = copy;
+	this->pointsShared = NULL;
+}
+
+void Stroke::freePoints()
+{
+	XOJ_CHECK_TYPE(Stroke);
+
+	if (this->pointsShared == NULL || g_atomic_int_dec_and_test(this->pointsShared))
+	{
+		g_free(this->points);
+		g_free(this->pointsShared);
+	}
+
+	this->points = NULL;
+	this->pointsShared = NULL;
+	this->pointCount = 0;
+	this->pointAllocCount = 0;
+}
+
 Element* Stroke::clone()
 {
 	XOJ_CHECK_TYPE(Stroke);
@@ -74,6 +129,8 @@ void Stroke::serialize(ObjectOutputStream& out)
 
 	out.writeInt(fill);
 
+	// The points are written as they are in memory, changing Point needs a new stream version (XML_VERSION_STR)
+	static_assert(sizeof(Point) == 3 * sizeof(double), "Stroke point layout changed");
 	out.writeData(this->points, this->pointCount, sizeof(Point));
 
 	this->lineStyle.serialize(out);
@@ -95,10 +152,10 @@ void Stroke::readSerialized(ObjectInputStream& in)
 
 	this->fill = in.readInt();
 
-	g_free(this->points);
-	this->points = NULL;
-	this->pointCount = 0;
+	freePoints();
 	in.readData((void**) &this->points, &this->pointCount);
+	this->pointAllocCount = this->pointCount;
+	this->sizeCalculated = false;
 
 	this->lineStyle.readSerialized(in);
 
@@ -138,6 +195,9 @@ void Stroke::setWidth(double width)
 	XOJ_CHECK_TYPE(Stroke);
 
 	this->width = width;
+
+	this->sizeCalculated = false;
+	boundsChanged();
 }
 
 double Stroke::getWidth() const
@@ -151,6 +211,13 @@ bool Stroke::isInSelection(ShapeContainer* container)
 {
 	XOJ_CHECK_TYPE(Stroke);
 
+	// All points are inside of the bounding box
+	ShapeContainment bounds = container->containsArea(getX(), getY(), getElementWidth(), getElementHeight());
+	if (bounds != SHAPE_PARTIAL)
+	{
+		return bounds == SHAPE_INSIDE;
+	}
+
 	for (int i = 0; i < this->pointCount; i++)
 	{
 		double px = this->points[i].x;
@@ -171,10 +238,13 @@ void Stroke::setFirstPoint(double x, double y)
 
 	if (this->pointCount > 0)
 	{
+		makePointsWritable();
+
 		Point& p = this->points[0];
 		p.x = x;
 		p.y = y;
 		this->sizeCalculated = false;
+		boundsChanged();
 	}
 }
 
@@ -184,10 +254,13 @@ void Stroke::setLastPoint(double x, double y)
 
 	if (this->pointCount > 0)
 	{
+		makePointsWritable();
+
 		Point& p = this->points[this->pointCount - 1];
 		p.x = x;
 		p.y = y;
 		this->sizeCalculated = false;
+		boundsChanged();
 	}
 }
 
@@ -200,18 +273,24 @@ void Stroke::addPoint(Point p)
 {
 	XOJ_CHECK_TYPE(Stroke);
 
-	if (this->pointCount >= this->pointAllocCount - 1)
+	makePointsWritable();
+
+	if (this->pointCount >= this->pointAllocCount)
 	{
-		this->allocPointSize(this->pointAllocCount + 100);
+		// Grow geometrically, so recording a long stroke does not copy the points again and again
+		this->allocPointSize(this->pointAllocCount > 0 ? this->pointAllocCount * 2 : MIN_POINT_ALLOC_COUNT);
 	}
 	this->points[this->pointCount++] = p;
 	this->sizeCalculated = false;
+	boundsChanged();
 }
 
 void Stroke::allocPointSize(int size)
 {
 	XOJ_CHECK_TYPE(Stroke);
 
+	makePointsWritable();
+
 	this->pointAllocCount = size;
 	this->points = (Point*) g_realloc(this->points, this->pointAllocCount * sizeof(Point));
 }
@@ -223,6 +302,13 @@ int Stroke::getPointCount() const
 	return this->pointCount;
 }
 
+int Stroke::getPointAllocCount() const
+{
+	XOJ_CHECK_TYPE(Stroke);
+
+	return this->pointAllocCount;
+}
+
 ArrayIterator<Point> Stroke::pointIterator() const
 {
 	XOJ_CHECK_TYPE(Stroke);
@@ -239,6 +325,17 @@ void Stroke::deletePointsFrom(int index)
 		return;
 	}
 	this->pointCount = index;
+
+	this->sizeCalculated = false;
+	boundsChanged();
+}
+
+void Stroke::releasePoints()
+{
+	XOJ_CHECK_TYPE(Stroke);
+
+	// The size is kept, it is calculated again after readSerialized()
+	freePoints();
 }
 
 void Stroke::deletePoint(int index)
@@ -250,14 +347,13 @@ void Stroke::deletePoint(int index)
 		return;
 	}
 
-	for (int i = 0; i < this->pointCount; i++)
-	{
-		if (i >= index)
-		{
-			this->points[i] = this->points[i + 1];
-		}
-	}
+	makePointsWritable();
+
+	memmove(this->points + index, this->points + index + 1, (this->pointCount - index - 1) * sizeof(Point));
 	this->pointCount--;
+
+	this->sizeCalculated = false;
+	boundsChanged();
 }
 
 Point Stroke::getPoint(int index) const
@@ -283,12 +379,11 @@ void Stroke::freeUnusedPointItems()
 {
 	XOJ_CHECK_TYPE(Stroke);
 
-	if (this->pointAllocCount == this->pointCount)
+	if (this->pointAllocCount == this->pointCount || this->pointCount == 0)
 	{
 		return;
 	}
-	this->pointAllocCount = this->pointCount + 1;
-	this->points = (Point*) g_realloc(this->points, this->pointAllocCount * sizeof(Point));
+	allocPointSize(this->pointCount);
 }
 
 void Stroke::setToolType(StrokeTool type)
@@ -323,6 +418,8 @@ void Stroke::move(double dx, double dy)
 {
 	XOJ_CHECK_TYPE(Stroke);
 
+	makePointsWritable();
+
 	for (int i = 0; i < pointCount; i++)
 	{
 		points[i].x += dx;
@@ -330,11 +427,14 @@ void Stroke::move(double dx, double dy)
 	}
 
 	this->sizeCalculated = false;
+	boundsChanged();
 }
 
 void Stroke::rotate(double x0, double y0, double xo, double yo, double th)
 {
 	XOJ_CHECK_TYPE(Stroke);
+
+	makePointsWritable();
 	
 	for (int i = 0; i < this->pointCount; i++)
 	{
@@ -359,12 +459,15 @@ void Stroke::rotate(double x0, double y0, double xo, double yo, double th)
 	}
 	//Width and Height will likely be changed after this operation
 	calcSize();
+	boundsChanged();
 }
 
 void Stroke::scale(double x0, double y0, double fx, double fy)
 {
 	XOJ_CHECK_TYPE(Stroke);
 
+	makePointsWritable();
+
 	double fz = sqrt(fx * fy);
 
 	for (int i = 0; i < this->pointCount; i++)
@@ -387,6 +490,7 @@ void Stroke::scale(double x0, double y0, double fx, double fy)
 	this->width *= fz;
 
 	this->sizeCalculated = false;
+	boundsChanged();
 }
 
 bool Stroke::hasPressure() const
@@ -419,6 +523,9 @@ void Stroke::scalePressure(double factor)
 	{
 		return;
 	}
+
+	makePointsWritable();
+
 	for (int i = 0; i < this->pointCount; i++)
 	{
 		this->points[i].z *= factor;
@@ -429,6 +536,8 @@ void Stroke::clearPressure()
 {
 	XOJ_CHECK_TYPE(Stroke);
 
+	makePointsWritable();
+
 	for (int i = 0; i < this->pointCount; i++)
 	{
 		this->points[i].z = Point::NO_PRESSURE;
@@ -441,6 +550,8 @@ void Stroke::setLastPressure(double pressure)
 
 	if (this->pointCount > 0)
 	{
+		makePointsWritable();
+
 		this->points[this->pointCount - 1].z = pressure;
 	}
 }
@@ -456,6 +567,8 @@ void Stroke::setPressure(const vector<double>& pressure)
 		return;
 	}
 
+	makePointsWritable();
+
 	for (int i = 0; i < this->pointCount && i < (int)pressure.size(); i++)
 	{
 		this->points[i].z = pressure[i];
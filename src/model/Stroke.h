@@ -32,6 +32,9 @@ public:
 	virtual ~Stroke();
 
 public:
+	/**
+	 * The clone shares the points with this stroke, they are copied by the first of both which changes them
+	 */
 	Stroke* cloneStroke() const;
 	virtual Element* clone();
 
@@ -66,6 +69,11 @@ public:
 	void setFirstPoint(double x, double y);
 	void setLastPoint(Point p);
 	int getPointCount() const;
+
+	/**
+	 * The number of points the point array can hold without growing
+	 */
+	int getPointAllocCount() const;
 	void freeUnusedPointItems();
 	ArrayIterator<Point> pointIterator() const;
 	Point getPoint(int index) const;
@@ -74,6 +82,12 @@ public:
 	void deletePoint(int index);
 	void deletePointsFrom(int index);
 
+	/**
+	 * Frees the points of a stroke which is only kept by the undo history,
+	 * they are restored by readSerialized()
+	 */
+	void releasePoints();
+
 	void setToolType(StrokeTool type);
 	StrokeTool getToolType() const;
 
@@ -111,6 +125,13 @@ protected:
 	virtual void calcSize();
 	void allocPointSize(int size);
 
+private:
+	/**
+	 * Copies the points if they are shared with a clone, has to be called before the points are changed
+	 */
+	void makePointsWritable();
+	void freePoints();
+
 private:
 	XOJ_TYPE_ATTRIB;
 
@@ -124,6 +145,17 @@ private:
 	int pointCount = 0;
 	int pointAllocCount = 0;
 
+	/**
+	 * The count of strokes sharing the point array, NULL if it was not shared yet. The strokes may
+	 * be in different threads, e.g. in the document and in a snapshot which is saved.
+	 */
+	mutable gint* pointsShared = NULL;
+
+	/**
+	 * Initial capacity of the point array, it is doubled if it is full
+	 */
+	static const int MIN_POINT_ALLOC_COUNT = 16;
+
 	/**
 	 * Dashed line
 	 */
@@ -139,4 +171,9 @@ private:
 	 *   1: The shape is nearly fully transparent filled
 	 */
 	int fill = -1;
+
+	/**
+	 * Creates the strokes left by the eraser with the final point count
+	 */
+	friend class EraseableStroke;
 };
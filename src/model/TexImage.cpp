@@ -76,6 +76,7 @@ void TexImage::setWidth(double width)
 	XOJ_CHECK_TYPE(TexImage);
 
 	this->width = width;
+	boundsChanged();
 }
 
 void TexImage::setHeight(double height)
@@ -83,6 +84,7 @@ void TexImage::setHeight(double height)
 	XOJ_CHECK_TYPE(TexImage);
 
 	this->height = height;
+	boundsChanged();
 }
 
 cairo_status_t TexImage::cairoReadFunction(TexImage* image, unsigned char* data, unsigned int length)
@@ -234,6 +236,8 @@ void TexImage::scale(double x0, double y0, double fx, double fy)
 
 	this->width *= fx;
 	this->height *= fy;
+
+	boundsChanged();
 }
 
 void TexImage::rotate(double x0, double y0, double xo, double yo, double th)
@@ -6,6 +6,11 @@
 #include <serializing/ObjectOutputStream.h>
 #include <Stacktrace.h>
 
+/**
+ * The last change id, the ids are unique over all Texts. Texts are also created by the loader threads.
+ */
+static int lastChangeId = 0;
+
 Text::Text()
  : AudioElement(ELEMENT_TEXT)
 {
@@ -13,10 +18,16 @@ Text::Text()
 
 	this->font.setName("Sans");
 	this->font.setSize(12);
+
+	textChanged();
 }
 
 Text::~Text()
 {
+	XOJ_CHECK_TYPE(Text);
+
+	TextView::releaseLayout(this);
+
 	XOJ_RELEASE_TYPE(Text);
 }
 
@@ -47,6 +58,9 @@ void Text::setFont(XojFont& font)
 	XOJ_CHECK_TYPE(Text);
 
 	this->font = font;
+
+	this->sizeCalculated = false;
+	boundsChanged();
 }
 
 string Text::getText()
@@ -61,8 +75,29 @@ void Text::setText(string text)
 	XOJ_CHECK_TYPE(Text);
 
 	this->text = text;
+	textChanged();
 
 	calcSize();
+	boundsChanged();
+}
+
+void Text::textChanged()
+{
+	XOJ_CHECK_TYPE(Text);
+
+	this->changeId = g_atomic_int_add(&lastChangeId, 1) + 1;
+}
+
+int Text::getChangeId()
+{
+	XOJ_CHECK_TYPE(Text);
+
+	return this->changeId;
+}
+
+int Text::getLastChangeId()
+{
+	return g_atomic_int_get(&lastChangeId);
 }
 
 void Text::calcSize()
@@ -77,6 +112,7 @@ void Text::setWidth(double width)
 	XOJ_CHECK_TYPE(Text);
 
 	this->width = width;
+	boundsChanged();
 }
 
 void Text::setHeight(double height)
@@ -84,6 +120,7 @@ void Text::setHeight(double height)
 	XOJ_CHECK_TYPE(Text);
 
 	this->height = height;
+	boundsChanged();
 }
 
 void Text::setInEditing(bool inEditing)
@@ -115,6 +152,7 @@ void Text::scale(double x0, double y0, double fx, double fy)
 	this->font.setSize(size);
 
 	this->sizeCalculated = false;
+	boundsChanged();
 }
 
 void Text::rotate(double x0, double y0, double xo, double yo, double th)
@@ -179,6 +217,7 @@ void Text::readSerialized(ObjectInputStream& in)
 	readSerializedAudioElement(in);
 
 	this->text = in.readString();
+	textChanged();
 
 	font.readSerialized(in);
 
@@ -17,6 +17,8 @@
 
 #include <gtk/gtk.h>
 
+class TextLayout;
+
 class Text : public AudioElement
 {
 public:
@@ -30,6 +32,16 @@ public:
 	string getText();
 	void setText(string text);
 
+	/**
+	 * Changes with every change of the text, unique over all Texts, e.g. for reindexing only changed Texts
+	 */
+	int getChangeId();
+
+	/**
+	 * The change id of the Text changed last
+	 */
+	static int getLastChangeId();
+
 	void setWidth(double width);
 	void setHeight(double height);
 
@@ -57,6 +69,9 @@ public:
 protected:
 	virtual void calcSize();
 
+private:
+	void textChanged();
+
 private:
 	XOJ_TYPE_ATTRIB;
 
@@ -64,5 +79,14 @@ private:
 
 	string text;
 
+	int changeId = 0;
+
 	bool inEditing = false;
+
+	/**
+	 * The shaped text, managed by TextView
+	 */
+	TextLayout* layout = NULL;
+
+	friend class TextView;
 };
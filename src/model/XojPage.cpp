@@ -3,6 +3,8 @@
 #include "BackgroundImage.h"
 #include "Document.h"
 
+gint XojPage::backgroundRevision = 0;
+
 XojPage::XojPage(double width, double height)
 {
 	XOJ_INIT_TYPE(XojPage);
@@ -58,16 +60,24 @@ XojPage* XojPage::clone()
 	page->bgType = this->bgType;
 	page->pdfBackgroundPage = this->pdfBackgroundPage;
 	page->backgroundColor = this->backgroundColor;
+	page->backgroundVisible = this->backgroundVisible;
 
 	return page;
 }
 
+gint XojPage::getBackgroundRevision()
+{
+	return g_atomic_int_get(&backgroundRevision);
+}
+
 void XojPage::addLayer(Layer* layer)
 {
 	XOJ_CHECK_TYPE(XojPage);
 
 	this->layer.push_back(layer);
 	this->currentLayer = size_t_npos;
+
+	contentChanged();
 }
 
 void XojPage::insertLayer(Layer* layer, int index)
@@ -82,6 +92,8 @@ void XojPage::insertLayer(Layer* layer, int index)
 
 	this->layer.insert(this->layer.begin() + index, layer);
 	this->currentLayer = index + 1;
+
+	contentChanged();
 }
 
 void XojPage::removeLayer(Layer* layer)
@@ -97,6 +109,8 @@ void XojPage::removeLayer(Layer* layer)
 		}
 	}
 	this->currentLayer = size_t_npos;
+
+	contentChanged();
 }
 
 void XojPage::setSelectedLayerId(int id)
@@ -145,6 +159,7 @@ void XojPage::setLayerVisible(int layerId, bool visible)
 	if (layerId == 0)
 	{
 		backgroundVisible = visible;
+		contentChanged();
 		return;
 	}
 
@@ -155,6 +170,7 @@ void XojPage::setLayerVisible(int layerId, bool visible)
 	}
 
 	this->layer[layerId]->setVisible(visible);
+	contentChanged();
 }
 
 bool XojPage::isLayerVisible(int layerId)
@@ -194,6 +210,9 @@ void XojPage::setBackgroundPdfPageNr(size_t page)
 	this->pdfBackgroundPage = page;
 	this->bgType.format = PageTypeFormat::Pdf;
 	this->bgType.config = "";
+	g_atomic_int_inc(&backgroundRevision);
+
+	contentChanged();
 }
 
 void XojPage::setBackgroundColor(int color)
@@ -201,6 +220,8 @@ void XojPage::setBackgroundColor(int color)
 	XOJ_CHECK_TYPE(XojPage);
 
 	this->backgroundColor = color;
+
+	contentChanged();
 }
 
 int XojPage::getBackgroundColor()
@@ -216,6 +237,8 @@ void XojPage::setSize(double width, double height)
 
 	this->width = width;
 	this->height = height;
+
+	contentChanged();
 }
 
 double XojPage::getWidth() const
@@ -267,6 +290,9 @@ void XojPage::setBackgroundType(PageType bgType)
 	{
 		this->backgroundImage.free();
 	}
+	g_atomic_int_inc(&backgroundRevision);
+
+	contentChanged();
 }
 
 PageType XojPage::getBackgroundType()
@@ -288,6 +314,8 @@ void XojPage::setBackgroundImage(BackgroundImage img)
 	XOJ_CHECK_TYPE(XojPage);
 
 	this->backgroundImage = img;
+
+	contentChanged();
 }
 
 Layer* XojPage::getSelectedLayer()
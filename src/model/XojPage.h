@@ -79,6 +79,11 @@ public:
 	 */
 	XojPage* clone();
 
+	/**
+	 * Counts the background changes of all pages, so an index of the backgrounds knows it is outdated
+	 */
+	static gint getBackgroundRevision();
+
 private:
 	XOJ_TYPE_ATTRIB;
 
@@ -118,6 +123,8 @@ private:
 	 */
 	size_t pdfBackgroundPage = size_t_npos;
 
+	static gint backgroundRevision;
+
 	/**
 	 * The background color if the background type is palain
 	 */
@@ -1,7 +1,5 @@
 #include "EraseableStroke.h"
 
-#include "EraseableStrokePart.h"
-#include "PartList.h"
 #include "model/Stroke.h"
 
 #include <Range.h>
@@ -13,12 +11,14 @@ EraseableStroke::EraseableStroke(Stroke* stroke)
 {
 	XOJ_INIT_TYPE(EraseableStroke);
 
-	this->parts = new PartList();
 	g_mutex_init(&this->partLock);
 
-	for (int i = 1; i < stroke->getPointCount(); i++)
+	int segmentCount = stroke->getPointCount() - 1;
+	if (segmentCount > 0)
 	{
-		this->parts->add(new EraseableStrokePart(stroke->getPoint(i - 1), stroke->getPoint(i)));
+		this->segments.resize(segmentCount);
+		this->tree.reserve(2 * (segmentCount / LEAF_SEGMENTS + 1));
+		buildTree(0, segmentCount);
 	}
 }
 
@@ -26,12 +26,138 @@ EraseableStroke::~EraseableStroke()
 {
 	XOJ_CHECK_TYPE(EraseableStroke);
 
-	delete this->parts;
-	this->parts = NULL;
+	g_mutex_clear(&this->partLock);
 
 	XOJ_RELEASE_TYPE(EraseableStroke);
 }
 
+int EraseableStroke::buildTree(int first, int last)
+{
+	XOJ_CHECK_TYPE(EraseableStroke);
+
+	int index = this->tree.size();
+	this->tree.push_back(TreeNode());
+
+	if (last - first <= LEAF_SEGMENTS)
+	{
+		// The segments first to last - 1 use the points first to last
+		const Point* points = this->stroke->getPoints();
+
+		TreeNode& node = this->tree[index];
+		node.x1 = node.x2 = points[first].x;
+		node.y1 = node.y2 = points[first].y;
+		for (int i = first + 1; i <= last; i++)
+		{
+			node.x1 = MIN(node.x1, points[i].x);
+			node.x2 = MAX(node.x2, points[i].x);
+			node.y1 = MIN(node.y1, points[i].y);
+			node.y2 = MAX(node.y2, points[i].y);
+		}
+		node.first = first;
+		node.last = last;
+		node.left = -1;
+		node.right = -1;
+
+		return index;
+	}
+
+	// The points of a stroke follow the pen, so splitting the range in the middle keeps the
+	// boxes of the children small
+	int middle = (first + last) / 2;
+	int left = buildTree(first, middle);
+	int right = buildTree(middle, last);
+
+	TreeNode& node = this->tree[index];
+	const TreeNode& l = this->tree[left];
+	const TreeNode& r = this->tree[right];
+	node.x1 = MIN(l.x1, r.x1);
+	node.x2 = MAX(l.x2, r.x2);
+	node.y1 = MIN(l.y1, r.y1);
+	node.y2 = MAX(l.y2, r.y2);
+	node.first = first;
+	node.last = last;
+	node.left = left;
+	node.right = right;
+
+	return index;
+}
+
+void EraseableStroke::findSegments(double x1, double y1, double x2, double y2, std::vector<int>& result)
+{
+	XOJ_CHECK_TYPE(EraseableStroke);
+
+	if (this->tree.empty())
+	{
+		return;
+	}
+
+	const Point* points = this->stroke->getPoints();
+
+	// The tree is balanced, so the depth is at most the count of bits of an int
+	int stack[64];
+	int top = 0;
+	stack[top++] = 0;
+
+	while (top > 0)
+	{
+		const TreeNode& node = this->tree[stack[--top]];
+		if (node.x2 < x1 || node.x1 > x2 || node.y2 < y1 || node.y1 > y2)
+		{
+			continue;
+		}
+
+		if (node.left != -1)
+		{
+			// The left child is handled first, the result is in stroke order
+			stack[top++] = node.right;
+			stack[top++] = node.left;
+			continue;
+		}
+
+		for (int i = node.first; i < node.last; i++)
+		{
+			const Point& a = points[i];
+			const Point& b = points[i + 1];
+			if (MAX(a.x, b.x) < x1 || MIN(a.x, b.x) > x2 || MAX(a.y, b.y) < y1 || MIN(a.y, b.y) > y2)
+			{
+				continue;
+			}
+
+			const PartList& segment = this->segments[i];
+			if (segment.split && segment.parts.empty())
+			{
+				// Already erased completely
+				continue;
+			}
+
+			result.push_back(i);
+		}
+	}
+}
+
+template <typename Fn>
+void EraseableStroke::forEachPart(Fn fn)
+{
+	XOJ_CHECK_TYPE(EraseableStroke);
+
+	const Point* points = this->stroke->getPoints();
+
+	for (size_t i = 0; i < this->segments.size(); i++)
+	{
+		PartList& segment = this->segments[i];
+		if (!segment.split)
+		{
+			fn(points + i, 2, points[i].z);
+			continue;
+		}
+
+		for (EraseableStrokePart& part : segment.parts)
+		{
+			fn(part.points.data(), part.points.size(), part.width);
+		}
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // This is done in a Thread, every thing else in the main loop /////////////////
 ////////////////////////////////////////////////////////////////////////////////
@@ -40,40 +166,69 @@ void EraseableStroke::draw(cairo_t* cr)
 {
 	XOJ_CHECK_TYPE(EraseableStroke);
 
-	Point lastPoint;
+	/**
+	 * A polyline, it continues the polyline before if connected
+	 */
+	class DrawPart
+	{
+	public:
+		size_t end;
+		double width;
+		bool connected;
+	};
+
+	std::vector<Point> path;
+	std::vector<DrawPart> drawParts;
 
+	// Only the points are copied with the lock held, the eraser is not blocked while cairo draws
 	g_mutex_lock(&this->partLock);
-	PartList * tmpCopy = this->parts->clone();
+
+	path.reserve(this->segments.size() + 1);
+	forEachPart([&](const Point* points, size_t count, double width)
+	{
+		bool connected = !drawParts.empty() && drawParts.back().width == width && path.back().equalsPos(points[0]);
+		path.insert(path.end(), connected ? points + 1 : points, points + count);
+		drawParts.push_back({ path.size(), width, connected });
+	});
+
 	g_mutex_unlock(&this->partLock);
 
-	double w = this->stroke->getWidth();
+	double strokeWidth = this->stroke->getWidth();
+	double currentWidth = NAN;
+	size_t start = 0;
 
-	for (GList* l = tmpCopy->data; l != NULL; l = l->next)
+	for (const DrawPart& part : drawParts)
 	{
-		EraseableStrokePart* part = (EraseableStrokePart*) l->data;
-		if (part->getWidth() == Point::NO_PRESSURE)
+		double width = part.width == Point::NO_PRESSURE ? strokeWidth : part.width;
+
+		// All parts with the same width are drawn with one stroke, so the round caps of
+		// the parts do not overlap a transparent highlighter
+		if (width != currentWidth)
 		{
-			cairo_set_line_width(cr, w);
+			if (!std::isnan(currentWidth))
+			{
+				cairo_stroke(cr);
+			}
+			cairo_set_line_width(cr, width);
+			currentWidth = width;
 		}
-		else
+
+		if (!part.connected)
 		{
-			cairo_set_line_width(cr, part->getWidth());
+			cairo_move_to(cr, path[start].x, path[start].y);
+			start++;
 		}
 
-		GList* pl = part->getPoints();
-		Point* p = (Point*) pl->data;
-		cairo_move_to(cr, p->x, p->y);
-
-		pl = pl->next;
-		for (; pl != NULL; pl = pl->next)
+		for (; start < part.end; start++)
 		{
-			Point* p = (Point*) pl->data;
-			cairo_line_to(cr, p->x, p->y);
+			cairo_line_to(cr, path[start].x, path[start].y);
 		}
-		cairo_stroke(cr);
 	}
 
-	delete tmpCopy;
+	if (!std::isnan(currentWidth))
+	{
+		cairo_stroke(cr);
+	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////
@@ -89,25 +244,55 @@ Range* EraseableStroke::erase(double x, double y, double halfEraserSize, Range*
 
 	this->repaintRect = range;
 
-	g_mutex_lock(&this->partLock);
-	PartList* tmpCopy = this->parts->clone();
-	g_mutex_unlock(&this->partLock);
+	// A part is also removed if both ends are within 1.2 * halfEraserSize of the eraser
+	double searchSize = halfEraserSize * 1.2;
+
+	this->foundSegments.clear();
+	findSegments(x - searchSize, y - searchSize, x + searchSize, y + searchSize, this->foundSegments);
 
-	for (GList* l = tmpCopy->data; l != NULL;)
+	for (int segment : this->foundSegments)
 	{
-		EraseableStrokePart* p = (EraseableStrokePart*) l->data;
-		l = l->next;
-		erase(x, y, halfEraserSize, p, tmpCopy);
+		eraseSegment(x, y, halfEraserSize, segment);
 	}
 
-	g_mutex_lock(&this->partLock);
-	PartList* old = this->parts;
-	this->parts = tmpCopy;
-	g_mutex_unlock(&this->partLock);
+	return this->repaintRect;
+}
 
-	delete old;
+void EraseableStroke::eraseSegment(double x, double y, double halfEraserSize, int segment)
+{
+	XOJ_CHECK_TYPE(EraseableStroke);
 
-	return this->repaintRect;
+	// Only this thread changes the segments, so they are read without the lock
+	PartList& list = this->segments[segment];
+
+	std::vector<EraseableStrokePart> parts;
+	if (list.split)
+	{
+		parts = list.parts;
+	}
+	else
+	{
+		parts.emplace_back(this->stroke->getPoint(segment), this->stroke->getPoint(segment + 1));
+	}
+
+	std::vector<EraseableStrokePart> result;
+	result.reserve(parts.size() + 1);
+
+	bool changed = false;
+	for (EraseableStrokePart& part : parts)
+	{
+		changed |= erase(x, y, halfEraserSize, part, result);
+	}
+
+	if (!changed)
+	{
+		return;
+	}
+
+	g_mutex_lock(&this->partLock);
+	list.parts.swap(result);
+	list.split = true;
+	g_mutex_unlock(&this->partLock);
 }
 
 void EraseableStroke::addRepaintRect(double x, double y, double width, double height)
@@ -126,27 +311,26 @@ void EraseableStroke::addRepaintRect(double x, double y, double width, double he
 	this->repaintRect->addPoint(x + width, y + height);
 }
 
-void EraseableStroke::erase(double x, double y, double halfEraserSize, EraseableStrokePart* part, PartList* list)
+bool EraseableStroke::erase(double x, double y, double halfEraserSize, EraseableStrokePart& part,
+							std::vector<EraseableStrokePart>& result)
 {
 	XOJ_CHECK_TYPE(EraseableStroke);
 
-	if (part->points->next == NULL)
+	if (part.points.size() < 2)
 	{
-		return;
+		result.push_back(std::move(part));
+		return false;
 	}
 
 	Point eraser(x, y);
 
-	Point* a = (Point*) g_list_first(part->points)->data;
-	Point* b = (Point*) g_list_last(part->points)->data;
+	const Point& a = part.points.front();
+	const Point& b = part.points.back();
 
-	if (eraser.lineLengthTo(*a) < halfEraserSize * 1.2 && eraser.lineLengthTo(*b) < halfEraserSize * 1.2)
+	if (eraser.lineLengthTo(a) < halfEraserSize * 1.2 && eraser.lineLengthTo(b) < halfEraserSize * 1.2)
 	{
-		list->data = g_list_remove(list->data, part);
-		addRepaintRect(part->getX(), part->getY(), part->getElementWidth(), part->getElementHeight());
-
-		delete part;
-		return;
+		addRepaintRect(part.getX(), part.getY(), part.getElementWidth(), part.getElementHeight());
+		return true;
 	}
 
 	double x1 = x - halfEraserSize;
@@ -154,47 +338,21 @@ void EraseableStroke::erase(double x, double y, double halfEraserSize, Eraseable
 	double y1 = y - halfEraserSize;
 	double y2 = y + halfEraserSize;
 
-	double aX = a->x;
-	double aY = a->y;
-	double bX = b->x;
-	double bY = b->y;
+	double aX = a.x;
+	double aY = a.y;
+	double bX = b.x;
+	double bY = b.y;
 
 	// check first point
 	if (aX >= x1 && aY >= y1 && aX <= x2 && aY <= y2)
 	{
-		bool deleteAfter = false;
-
-		if (erasePart(x, y, halfEraserSize, part, list, &deleteAfter))
-		{
-			addRepaintRect(part->getX(), part->getY(), part->getElementWidth(), part->getElementHeight());
-			part->calcSize();
-		}
-
-		if (deleteAfter)
-		{
-			delete part;
-		}
-
-		return;
+		return erasePart(x, y, halfEraserSize, part, result);
 	}
 
 	// check last point
 	if (bX >= x1 && bY >= y1 && bX <= x2 && bY <= y2)
 	{
-		bool deleteAfter = false;
-
-		if (erasePart(x, y, halfEraserSize, part, list, &deleteAfter))
-		{
-			addRepaintRect(part->getX(), part->getY(), part->getElementWidth(), part->getElementHeight());
-			part->calcSize();
-		}
-
-		if (deleteAfter)
-		{
-			delete part;
-		}
-
-		return;
+		return erasePart(x, y, halfEraserSize, part, result);
 	}
 
 	double len = hypot(bX - aX, bY - aY);
@@ -220,139 +378,66 @@ void EraseableStroke::erase(double x, double y, double halfEraserSize, Eraseable
 
 		if (distance <= (len / 2) + 0.1)
 		{
-			bool deleteAfter = false;
-
-			if (erasePart(x, y, halfEraserSize, part, list, &deleteAfter))
-			{
-				addRepaintRect(part->getX(), part->getY(), part->getElementWidth(), part->getElementHeight());
-				part->calcSize();
-			}
-
-			if (deleteAfter)
-			{
-				delete part;
-			}
-
-			return;
+			return erasePart(x, y, halfEraserSize, part, result);
 		}
 	}
+
+	result.push_back(std::move(part));
+	return false;
 }
 
-bool EraseableStroke::erasePart(double x, double y, double halfEraserSize, EraseableStrokePart* part,
-								PartList* list, bool* deleteStrokeAfter)
+bool EraseableStroke::erasePart(double x, double y, double halfEraserSize, EraseableStrokePart& part,
+								std::vector<EraseableStrokePart>& result)
 {
 	XOJ_CHECK_TYPE(EraseableStroke);
 
-	bool changed = false;
-
-	part->splitFor(halfEraserSize);
+	part.splitFor(halfEraserSize);
 
 	double x1 = x - halfEraserSize;
 	double x2 = x + halfEraserSize;
 	double y1 = y - halfEraserSize;
 	double y2 = y + halfEraserSize;
 
+	const std::vector<Point>& points = part.points;
 	/**
-	 * erase the beginning
+	 * The points outside of the eraser are kept, each run of them is a new part
 	 */
-	for (GList* l = part->getPoints(); l != NULL;)
+	size_t runStart = 0;
+	for (size_t i = 0; i <= points.size(); i++)
 	{
-		Point* p = (Point*) l->data;
-		l = l->next;
-		if (p->x >= x1 && p->y >= y1 && p->x <= x2 && p->y <= y2)
+		if (i < points.size())
 		{
-			part->points = g_list_remove(part->points, p);
-			delete p;
-			changed = true;
-		}
-		else
-		{
-			// only the beginning is handled here
-			break;
-		}
-	}
-
-	/**
-	 * erase the end
-	 */
-	for (GList* l = g_list_last(part->getPoints()); l != NULL;)
-	{
-		Point* p = (Point*) l->data;
-		l = l->prev;
-		if (p->x >= x1 && p->y >= y1 && p->x <= x2 && p->y <= y2)
-		{
-			part->points = g_list_remove(part->points, p);
-			delete p;
-			changed = true;
-		}
-		else
-		{
-			// only the end is handled here
-			break;
-		}
-	}
-
-	/**
-	 * handle the rest
-	 */
-
-	GList* lists = NULL;
-	GList* current = NULL;
-
-	for (GList* l = part->points; l != NULL;)
-	{
-		Point* p = (Point*) l->data;
-		l = l->next;
-		if (p->x >= x1 && p->y >= y1 && p->x <= x2 && p->y <= y2)
-		{
-			part->points = g_list_remove(part->points, p);
-			delete p;
-			if (current)
+			const Point& p = points[i];
+			if (!(p.x >= x1 && p.y >= y1 && p.x <= x2 && p.y <= y2))
 			{
-				lists = g_list_append(lists, current);
-				current = NULL;
+				continue;
 			}
-			changed = true;
 		}
-		else
+
+		if (runStart == 0 && i == points.size())
 		{
-			current = g_list_append(current, p);
+			// Nothing erased, the part stays as it is
+			result.push_back(std::move(part));
+			return false;
 		}
-	}
 
-	if (current)
-	{
-		lists = g_list_append(lists, current);
-		current = NULL;
-	}
-
-	g_list_free(part->points);
-	part->points = NULL;
-	if (lists)
-	{
-		part->points = (GList*) lists->data;
-		lists = g_list_delete_link(lists, lists);
-
-		int pos = g_list_index(list->data, part) + 1;
-		
-		// create data structure for all new (splitted) parts
-		for (GList* l = lists; l != NULL; l = l->next)
+		// A single point is not visible
+		if (i - runStart >= 2)
 		{
-			EraseableStrokePart* newPart = new EraseableStrokePart(part->width);
-			newPart->points = (GList*) l->data;
-			list->data = g_list_insert(list->data, newPart, pos++);
+			result.emplace_back(part.width);
+			EraseableStrokePart& newPart = result.back();
+			newPart.points.assign(points.begin() + runStart, points.begin() + i);
+			newPart.splitSize = part.splitSize;
+			newPart.calcSize();
 		}
 
-		g_list_free(lists);
-	}
-	else
-	{
-		// no parts, all deleted
-		list->data = g_list_remove(list->data, part);
-		*deleteStrokeAfter = true;
+		runStart = i + 1;
 	}
 
-	return changed;
+	// The part is split on its line, so the part before splitting covers all new parts
+	addRepaintRect(part.getX(), part.getY(), part.getElementWidth(), part.getElementHeight());
+
+	return true;
 }
 
 GList* EraseableStroke::getStroke(Stroke* original)
@@ -361,40 +446,52 @@ GList* EraseableStroke::getStroke(Stroke* original)
 
 	GList* list = NULL;
 
-	Stroke* s = NULL;
+	// The points of the stroke being built, the stroke is created with the final size
+	std::vector<Point> points;
+	points.reserve(this->segments.size() + 1);
+
+	auto createStroke = [&]()
+	{
+		Stroke* s = new Stroke();
+		s->setColor(original->getColor());
+		s->setToolType(original->getToolType());
+		s->setLineStyle(original->getLineStyle());
+		s->setWidth(original->getWidth());
+
+		s->allocPointSize(points.size());
+		for (const Point& p : points)
+		{
+			s->addPoint(p);
+		}
+
+		list = g_list_append(list, s);
+		points.clear();
+	};
+
 	Point lastPoint(NAN, NAN);
-	for (GList* l = this->parts->data; l != NULL; l = l->next)
+	forEachPart([&](const Point* partPoints, size_t count, double width)
 	{
-		EraseableStrokePart* p = (EraseableStrokePart*) l->data;
-		GList* points = p->getPoints();
-		if (g_list_length(points) < 2)
+		if (count < 2)
 		{
-			continue;
+			return;
 		}
 
-		Point a = *((Point*) g_list_first(points)->data);
-		Point b = *((Point*) g_list_last(points)->data);
-		a.z = p->width;
+		Point a = partPoints[0];
+		a.z = width;
 
-		if (!lastPoint.equalsPos(a) || s == NULL)
+		if (!lastPoint.equalsPos(a) && !points.empty())
 		{
-			if (s)
-			{
-				s->addPoint(lastPoint);
-			}
-			s = new Stroke();
-			s->setColor(original->getColor());
-			s->setToolType(original->getToolType());
-			s->setLineStyle(original->getLineStyle());
-			s->setWidth(original->getWidth());
-			list = g_list_append(list, s);
+			points.push_back(lastPoint);
+			createStroke();
 		}
-		s->addPoint(a);
-		lastPoint = b;
-	}
-	if (s)
+		points.push_back(a);
+		lastPoint = partPoints[count - 1];
+	});
+
+	if (!points.empty())
 	{
-		s->addPoint(lastPoint);
+		points.push_back(lastPoint);
+		createStroke();
 	}
 
 	return list;
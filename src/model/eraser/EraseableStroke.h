@@ -11,16 +11,23 @@
 
 #pragma once
 
+#include "PartList.h"
+
 #include "model/Point.h"
 #include <XournalType.h>
 
 #include <gtk/gtk.h>
 
-class EraseableStrokePart;
-class PartList;
+#include <vector>
+
 class Range;
 class Stroke;
 
+/**
+ * The parts of a stroke left by the eraser. The parts are kept per segment of the original
+ * stroke, a segment is only split into parts if the eraser touches it. The segments near the
+ * eraser are found with a bounding volume hierarchy over the segments, built once.
+ */
 class EraseableStroke
 {
 public:
@@ -38,18 +45,76 @@ public:
 	void draw(cairo_t* cr);
 
 private:
-	void erase(double x, double y, double halfEraserSize, EraseableStrokePart* part, PartList* list);
-	bool erasePart(double x, double y, double halfEraserSize, EraseableStrokePart* part,
-				   PartList* list, bool* deleteStrokeAfter);
+	/**
+	 * Bounding box of the segments first to last - 1
+	 */
+	class TreeNode
+	{
+	public:
+		double x1, y1, x2, y2;
+		int first, last;
+
+		/**
+		 * The children, -1 for a leaf
+		 */
+		int left, right;
+	};
+
+	int buildTree(int first, int last);
+
+	/**
+	 * Appends the segments whose bounding box intersects the rectangle to result, in stroke order
+	 */
+	void findSegments(double x1, double y1, double x2, double y2, std::vector<int>& result);
+
+	void eraseSegment(double x, double y, double halfEraserSize, int segment);
+
+	/**
+	 * Appends what remains of part to result
+	 *
+	 * @return true if something was erased
+	 */
+	bool erase(double x, double y, double halfEraserSize, EraseableStrokePart& part,
+			   std::vector<EraseableStrokePart>& result);
+	bool erasePart(double x, double y, double halfEraserSize, EraseableStrokePart& part,
+				   std::vector<EraseableStrokePart>& result);
+
+	/**
+	 * Calls fn(points, count, width) for all parts in stroke order, the partLock has to be held
+	 * if not called from the thread erasing
+	 */
+	template <typename Fn>
+	void forEachPart(Fn fn);
 
 	void addRepaintRect(double x, double y, double width, double height);
 
 private:
 	XOJ_TYPE_ATTRIB;
 
-
+	/**
+	 * Protects the segments, they are drawn by the render threads
+	 */
 	GMutex partLock;
-	PartList * parts = NULL;
+
+	/**
+	 * The segment i is the line from the point i to the point i + 1 of the stroke
+	 */
+	std::vector<PartList> segments;
+
+	/**
+	 * The root is the first node
+	 */
+	std::vector<TreeNode> tree;
+
+	/**
+	 * Reused for each erase call
+	 */
+	std::vector<int> foundSegments;
+
+	/**
+	 * Segments per leaf of the tree
+	 */
+	static const int LEAF_SEGMENTS = 4;
 
 	Range* repaintRect = NULL;
 
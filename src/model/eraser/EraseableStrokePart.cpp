@@ -1,11 +1,14 @@
 #include "EraseableStrokePart.h"
 
+#include <algorithm>
+
 EraseableStrokePart::EraseableStrokePart(Point a, Point b)
 {
 	XOJ_INIT_TYPE(EraseableStrokePart);
 
-	addPoint(a);
-	addPoint(b);
+	this->points.reserve(2);
+	this->points.push_back(a);
+	this->points.push_back(b);
 	this->width = a.z;
 
 	this->splitSize = 0;
@@ -17,33 +20,76 @@ EraseableStrokePart::EraseableStrokePart(double width)
 {
 	XOJ_INIT_TYPE(EraseableStrokePart);
 
-	this->points = NULL;
 	this->width = width;
 	this->splitSize = 0;
 
 	calcSize();
 }
 
+EraseableStrokePart::EraseableStrokePart(const EraseableStrokePart& part)
+ : width(part.width),
+   splitSize(part.splitSize),
+   points(part.points),
+   x(part.x),
+   y(part.y),
+   elementWidth(part.elementWidth),
+   elementHeight(part.elementHeight)
+{
+	XOJ_INIT_TYPE(EraseableStrokePart);
+}
+
+EraseableStrokePart::EraseableStrokePart(EraseableStrokePart&& part) noexcept
+ : width(part.width),
+   splitSize(part.splitSize),
+   points(std::move(part.points)),
+   x(part.x),
+   y(part.y),
+   elementWidth(part.elementWidth),
+   elementHeight(part.elementHeight)
+{
+	XOJ_INIT_TYPE(EraseableStrokePart);
+}
+
 EraseableStrokePart::~EraseableStrokePart()
+{
+	XOJ_RELEASE_TYPE(EraseableStrokePart);
+}
+
+EraseableStrokePart& EraseableStrokePart::operator=(const EraseableStrokePart& part)
 {
 	XOJ_CHECK_TYPE(EraseableStrokePart);
 
-	for (GList* l = this->points; l != NULL; l = l->next)
-	{
-		Point* p = (Point*) l->data;
-		delete p;
-	}
-	g_list_free(this->points);
-	this->points = NULL;
+	this->width = part.width;
+	this->splitSize = part.splitSize;
+	this->points = part.points;
+	this->x = part.x;
+	this->y = part.y;
+	this->elementWidth = part.elementWidth;
+	this->elementHeight = part.elementHeight;
 
-	XOJ_RELEASE_TYPE(EraseableStrokePart);
+	return *this;
+}
+
+EraseableStrokePart& EraseableStrokePart::operator=(EraseableStrokePart&& part) noexcept
+{
+	XOJ_CHECK_TYPE(EraseableStrokePart);
+
+	this->width = part.width;
+	this->splitSize = part.splitSize;
+	this->points = std::move(part.points);
+	this->x = part.x;
+	this->y = part.y;
+	this->elementWidth = part.elementWidth;
+	this->elementHeight = part.elementHeight;
+
+	return *this;
 }
 
 void EraseableStrokePart::calcSize()
 {
 	XOJ_CHECK_TYPE(EraseableStrokePart);
 
-	if (this->points == NULL)
+	if (this->points.empty())
 	{
 		this->x = 0;
 		this->y = 0;
@@ -52,18 +98,17 @@ void EraseableStrokePart::calcSize()
 		return;
 	}
 
-	double x1 = ((Point*) g_list_first(this->points)->data)->x;
-	double y1 = ((Point*) g_list_first(this->points)->data)->y;
-	double x2 = ((Point*) g_list_first(this->points)->data)->x;
-	double y2 = ((Point*) g_list_first(this->points)->data)->y;
+	double x1 = this->points[0].x;
+	double y1 = this->points[0].y;
+	double x2 = x1;
+	double y2 = y1;
 
-	for (GList* l = this->points; l != NULL; l = l->next)
+	for (const Point& p : this->points)
 	{
-		Point* p = (Point*) l->data;
-		x1 = MIN(x1, p->x);
-		x2 = MAX(x2, p->x);
-		y1 = MIN(y1, p->y);
-		y2 = MAX(y2, p->y);
+		x1 = MIN(x1, p.x);
+		x2 = MAX(x2, p.x);
+		y1 = MIN(y1, p.y);
+		y2 = MAX(y2, p.y);
 	}
 
 	this->x = x1;
@@ -72,23 +117,6 @@ void EraseableStrokePart::calcSize()
 	this->elementHeight = y2 - y1;
 }
 
-EraseableStrokePart* EraseableStrokePart::clone()
-{
-	XOJ_CHECK_TYPE(EraseableStrokePart);
-
-	EraseableStrokePart* part = new EraseableStrokePart(this->width);
-
-	for (GList* l = this->points; l != NULL; l = l->next)
-	{
-		Point* p = (Point*) l->data;
-		part->addPoint(*p);
-	}
-
-	part->splitSize = this->splitSize;
-
-	return part;
-}
-
 double EraseableStrokePart::getX()
 {
 	XOJ_CHECK_TYPE(EraseableStrokePart);
@@ -121,9 +149,9 @@ void EraseableStrokePart::addPoint(Point p)
 {
 	XOJ_CHECK_TYPE(EraseableStrokePart);
 
-	calcSize();
+	this->points.push_back(p);
 
-	this->points = g_list_append(this->points, new Point(p));
+	calcSize();
 }
 
 double EraseableStrokePart::getWidth()
@@ -133,7 +161,7 @@ double EraseableStrokePart::getWidth()
 	return this->width;
 }
 
-GList* EraseableStrokePart::getPoints()
+std::vector<Point>& EraseableStrokePart::getPoints()
 {
 	XOJ_CHECK_TYPE(EraseableStrokePart);
 
@@ -144,14 +172,9 @@ void EraseableStrokePart::clearSplitData()
 {
 	XOJ_CHECK_TYPE(EraseableStrokePart);
 
-	for (GList* l = this->points->next; l->next != NULL;)
+	if (this->points.size() > 2)
 	{
-		Point* p = (Point*) l->data;
-		delete p;
-		GList* link = l;
-		l = l->next;
-
-		this->points = g_list_delete_link(this->points, link);
+		this->points.erase(this->points.begin() + 1, this->points.end() - 1);
 	}
 }
 
@@ -166,23 +189,30 @@ void EraseableStrokePart::splitFor(double halfEraserSize)
 
 	this->splitSize = halfEraserSize;
 
-	Point* a = (Point*) g_list_first(this->points)->data;
-	Point* b = (Point*) g_list_last(this->points)->data;
+	Point a = this->points.front();
+	Point b = this->points.back();
 
 	// nothing to do, the size is enough small
-	if (a->lineLengthTo(*b) <= halfEraserSize)
+	if (a.lineLengthTo(b) <= halfEraserSize)
 	{
 		return;
 	}
 
 	clearSplitData();
 
-	double len = a->lineLengthTo(*b);
+	double len = a.lineLengthTo(b);
 	halfEraserSize /= 2;
 
-	while (len > halfEraserSize)
+	// A point each halfEraserSize, measured from the end
+	std::vector<Point> split;
+	split.reserve((size_t) (len / halfEraserSize) + 2);
+	split.push_back(a);
+	for (double l = len - halfEraserSize; l > halfEraserSize; l -= halfEraserSize)
 	{
-		this->points = g_list_insert(this->points, new Point(a->lineTo(*b, len)), 1);
-		len -= halfEraserSize;
+		split.push_back(a.lineTo(b, l));
 	}
+	std::reverse(split.begin() + 1, split.end());
+	split.push_back(b);
+
+	this->points.swap(split);
 }
@@ -14,27 +14,34 @@
 #include "model/Point.h"
 #include <XournalType.h>
 
+#include <vector>
+
+/**
+ * A polyline on one segment of the original stroke. The points are stored in a contiguous
+ * array, the part is copied by value.
+ */
 class EraseableStrokePart
 {
 public:
 	EraseableStrokePart(Point a, Point b);
 	EraseableStrokePart(double width);
+	EraseableStrokePart(const EraseableStrokePart& part);
+	EraseableStrokePart(EraseableStrokePart&& part) noexcept;
 	virtual ~EraseableStrokePart();
 
-private:
-	EraseableStrokePart(const EraseableStrokePart& part);
+public:
+	EraseableStrokePart& operator=(const EraseableStrokePart& part);
+	EraseableStrokePart& operator=(EraseableStrokePart&& part) noexcept;
 
 public:
 	void addPoint(Point p);
 	double getWidth();
 
-	GList* getPoints();
+	std::vector<Point>& getPoints();
 
 	void clearSplitData();
 	void splitFor(double halfEraserSize);
 
-	EraseableStrokePart* clone();
-
 	void calcSize();
 
 public:
@@ -43,15 +50,13 @@ public:
 	double getElementWidth();
 	double getElementHeight();
 
-	static void printDebugStrokeParts();
-
 private:
 	XOJ_TYPE_ATTRIB;
 
 	double width = 0;
 	double splitSize = 0;
 
-	GList* points = NULL;
+	std::vector<Point> points;
 
 	double x = 0;
 	double y = 0;
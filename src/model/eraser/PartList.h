@@ -11,30 +11,21 @@
 
 #pragma once
 
-#include <XournalType.h>
+#include "EraseableStrokePart.h"
 
-#include <gtk/gtk.h>
-
-class EraseableStrokePart;
+#include <vector>
 
+/**
+ * The remaining parts of one segment of the original stroke, in stroke order
+ */
 class PartList
 {
 public:
-	PartList();
-	virtual ~PartList();
-
-private:
-	PartList(const PartList& list);
-	void operator=(const PartList& list);
-
-public:
-	void add(EraseableStrokePart* part);
-	PartList* clone();
-
-private:
-	XOJ_TYPE_ATTRIB;
-
-	GList* data = NULL;
+	/**
+	 * False as long as the eraser did not touch the segment, the segment is then
+	 * read from the points of the original stroke and has no parts
+	 */
+	bool split = false;
 
-	friend class EraseableStroke;
+	std::vector<EraseableStrokePart> parts;
 };
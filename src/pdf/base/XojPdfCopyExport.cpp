@@ -0,0 +1,788 @@
+#include "XojPdfCopyExport.h"
+
+#include "XojCairoPdfExport.h"
+
+#include "view/DocumentView.h"
+
+#include <i18n.h>
+
+#include <cairo/cairo-pdf.h>
+#include <glib/gstdio.h>
+
+#include <algorithm>
+#include <cmath>
+
+XojPdfCopyExport::XojPdfCopyExport(Document* doc, ProgressListener* progressListener)
+ : doc(doc),
+   progressListener(progressListener)
+{
+	XOJ_INIT_TYPE(XojPdfCopyExport);
+}
+
+XojPdfCopyExport::~XojPdfCopyExport()
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	XOJ_RELEASE_TYPE(XojPdfCopyExport);
+}
+
+/**
+ * Export without background
+ */
+void XojPdfCopyExport::setNoBackgroundExport(bool noBackgroundExport)
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	this->noBackgroundExport = noBackgroundExport;
+}
+
+bool XojPdfCopyExport::createPdf(Path file, PageRangeVector& range)
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	vector<size_t> pages;
+	for (PageRangeEntry* e : range)
+	{
+		for (int i = e->getFirst(); i <= e->getLast(); i++)
+		{
+			if (i >= 0 && i < (int) doc->getPageCount())
+			{
+				pages.push_back(i);
+			}
+		}
+	}
+
+	if (pages.empty())
+	{
+		this->lastError = _("No pages to export!");
+		return false;
+	}
+
+	if (copyPdf(file, pages))
+	{
+		return true;
+	}
+
+	// The progress is started again, the pages rendered for the copy are rendered again
+	XojCairoPdfExport fallback(this->doc, this->progressListener);
+	fallback.setNoBackgroundExport(this->noBackgroundExport);
+	bool ok = fallback.createPdf(file, range);
+	this->lastError = fallback.getLastError();
+
+	return ok;
+}
+
+bool XojPdfCopyExport::createPdf(Path file)
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	if (doc->getPageCount() < 1)
+	{
+		this->lastError = _("No pages to export!");
+		return false;
+	}
+
+	vector<size_t> pages;
+	for (size_t i = 0; i < doc->getPageCount(); i++)
+	{
+		pages.push_back(i);
+	}
+
+	if (copyPdf(file, pages))
+	{
+		return true;
+	}
+
+	// The progress is started again, the pages rendered for the copy are rendered again
+	XojCairoPdfExport fallback(this->doc, this->progressListener);
+	fallback.setNoBackgroundExport(this->noBackgroundExport);
+	bool ok = fallback.createPdf(file);
+	this->lastError = fallback.getLastError();
+
+	return ok;
+}
+
+string XojPdfCopyExport::getLastError()
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	return this->lastError;
+}
+
+bool XojPdfCopyExport::copyPdf(Path file, const vector<size_t>& pages)
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	// Without background there is nothing to copy
+	if (this->noBackgroundExport || !doc->isPdfDocumentLoaded())
+	{
+		return false;
+	}
+
+	string sourcePath;
+	if (!saveSource(sourcePath))
+	{
+		return false;
+	}
+
+	GMappedFile* source = g_mapped_file_new(sourcePath.c_str(), false, NULL);
+	bool ok = source != NULL &&
+	          copyPages(file, pages, g_mapped_file_get_contents(source), g_mapped_file_get_length(source));
+
+	if (source != NULL)
+	{
+		g_mapped_file_unref(source);
+	}
+	g_unlink(sourcePath.c_str());
+
+	return ok;
+}
+
+bool XojPdfCopyExport::saveSource(string& path)
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	gchar* tmpPath = NULL;
+	int fd = g_file_open_tmp("xournalpp-export-XXXXXX.pdf", &tmpPath, NULL);
+	if (fd == -1)
+	{
+		g_warning("Could not create a temporary file for the PDF export");
+		return false;
+	}
+	g_close(fd, NULL);
+
+	path = tmpPath;
+	g_free(tmpPath);
+
+	GError* error = NULL;
+	if (!doc->getPdfDocument().save(Path(path), &error))
+	{
+		g_warning("Could not save the background PDF for the export: %s", error ? error->message : "");
+		if (error)
+		{
+			g_error_free(error);
+		}
+		g_unlink(path.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+bool XojPdfCopyExport::copyPages(Path file, const vector<size_t>& pages, const char* sourceData, size_t sourceLength)
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	XojPdfFile sourceFile;
+	if (!sourceFile.open(sourceData, sourceLength) || sourceFile.getPageCount() != doc->getPdfPageCount())
+	{
+		g_message("The background PDF is rendered, it can not be copied: %s", sourceFile.getLastError().c_str());
+		return false;
+	}
+	this->source = &sourceFile;
+
+	vector<int> rotation;
+	vector<double> boxes(4 * pages.size());
+	bool copy = false;
+	for (size_t i = 0; i < pages.size(); i++)
+	{
+		rotation.push_back(getCopyRotation(pages[i], &boxes[4 * i]));
+		copy |= rotation.back() != -1;
+	}
+
+	string overlayData;
+	XojPdfFile overlayFile;
+	this->overlay = &overlayFile;
+
+	// If no page is copied, the rendering export is used as it is
+	bool ok = copy && renderOverlay(pages, rotation, overlayData) &&
+	          overlayFile.open(overlayData.data(), overlayData.size()) &&
+	          overlayFile.getPageCount() == pages.size() &&
+	          writePdf(file, pages, rotation, boxes);
+
+	this->source = NULL;
+	this->overlay = NULL;
+
+	return ok;
+}
+
+int XojPdfCopyExport::getCopyRotation(size_t page, double* box)
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	PageRef p = doc->getPage(page);
+	if (!p->getBackgroundType().isPdfPage() || !p->isLayerVisible(0) || p->getPdfPageNr() >= source->getPageCount())
+	{
+		return -1;
+	}
+
+	const XojPdfObject& dict = source->getPage(p->getPdfPageNr());
+
+	if (dict.get("UserUnit") && source->resolve(*dict.get("UserUnit")).getNumber() != 1)
+	{
+		return -1;
+	}
+
+	double rotate = dict.get("Rotate") ? source->resolve(*dict.get("Rotate")).getNumber() : 0;
+	if (rotate != std::floor(rotate) || (int) rotate % 90 != 0)
+	{
+		return -1;
+	}
+	int rotation = ((int) rotate % 360 + 360) % 360;
+
+	// The crop box is clipped to the media box, as poppler does
+	double crop[4];
+	if (!readBox(dict, "MediaBox", box))
+	{
+		return -1;
+	}
+	if (readBox(dict, "CropBox", crop))
+	{
+		box[0] = std::max(box[0], crop[0]);
+		box[1] = std::max(box[1], crop[1]);
+		box[2] = std::min(box[2], crop[2]);
+		box[3] = std::min(box[3], crop[3]);
+	}
+
+	double width = box[2] - box[0];
+	double height = box[3] - box[1];
+	if (rotation == 90 || rotation == 270)
+	{
+		std::swap(width, height);
+	}
+
+	// The page size was changed in Xournal++, the background is drawn scaled
+	if (width <= 0 || height <= 0 || std::abs(width - p->getWidth()) > 0.5 || std::abs(height - p->getHeight()) > 0.5)
+	{
+		return -1;
+	}
+
+	return rotation;
+}
+
+bool XojPdfCopyExport::readBox(const XojPdfObject& page, const char* key, double* box)
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	if (!page.get(key))
+	{
+		return false;
+	}
+
+	XojPdfObject array = source->resolve(*page.get(key));
+	if (!array.isArray() || array.items.size() != 4)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < 4; i++)
+	{
+		XojPdfObject value = source->resolve(array.items[i]);
+		if (!value.isNumber())
+		{
+			return false;
+		}
+		box[i] = value.getNumber();
+	}
+
+	// The corners may be any two opposite corners
+	if (box[0] > box[2])
+	{
+		std::swap(box[0], box[2]);
+	}
+	if (box[1] > box[3])
+	{
+		std::swap(box[1], box[3]);
+	}
+
+	return true;
+}
+
+cairo_status_t XojPdfCopyExport::writeOverlayData(string* overlay, const unsigned char* data, unsigned int length)
+{
+	overlay->append((const char*) data, length);
+	return CAIRO_STATUS_SUCCESS;
+}
+
+bool XojPdfCopyExport::renderOverlay(const vector<size_t>& pages, const vector<int>& rotation, string& overlay)
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	cairo_surface_t* surface = cairo_pdf_surface_create_for_stream((cairo_write_func_t) writeOverlayData, &overlay, 0, 0);
+	cairo_t* cr = cairo_create(surface);
+
+	if (this->progressListener)
+	{
+		this->progressListener->setMaximumState(pages.size());
+	}
+
+	for (size_t i = 0; i < pages.size(); i++)
+	{
+		PageRef p = doc->getPage(pages[i]);
+
+		cairo_pdf_surface_set_size(surface, p->getWidth(), p->getHeight());
+
+		if (rotation[i] == -1 && p->getBackgroundType().isPdfPage())
+		{
+			// Not copied, rendered as by the XojCairoPdfExport
+			XojPdfPageSPtr popplerPage = doc->getPdfPage(p->getPdfPageNr());
+			if (popplerPage)
+			{
+				popplerPage->render(cr, true);
+			}
+		}
+
+		DocumentView view;
+		view.drawPage(p, cr, true /* dont render eraseable */);
+
+		cairo_show_page(cr);
+
+		if (this->progressListener)
+		{
+			this->progressListener->setCurrentState(i);
+		}
+	}
+
+	cairo_destroy(cr);
+	cairo_surface_finish(surface);
+	bool ok = cairo_surface_status(surface) == CAIRO_STATUS_SUCCESS;
+	cairo_surface_destroy(surface);
+
+	return ok;
+}
+
+bool XojPdfCopyExport::writePdf(Path file, const vector<size_t>& pages, const vector<int>& rotation,
+                                vector<double>& boxes)
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	this->out = g_fopen(file.c_str(), "wb");
+	if (this->out == NULL)
+	{
+		this->lastError = FS(_F("Error opening file: \"{1}\"") % file.str());
+		return false;
+	}
+
+	this->offset = 0;
+	this->offsets.assign(1, 0);
+	this->copiedObjects.clear();
+	this->pending.clear();
+	this->copiedPages.clear();
+	this->saveStateNum = -1;
+
+	// The binary comment marks the file as binary for transfer programs
+	write("%PDF-1.7\n%\xe2\xe3\xcf\xd3\n");
+
+	int catalogNum = addObject();
+	this->pagesNum = addObject();
+
+	// The numbers of all pages are needed before any object is copied, objects may reference pages
+	vector<int> pageNums;
+	for (size_t i = 0; i < pages.size(); i++)
+	{
+		int num = addObject();
+		pageNums.push_back(num);
+
+		if (rotation[i] != -1)
+		{
+			int sourceNum = source->getPageObject(doc->getPage(pages[i])->getPdfPageNr());
+			if (this->copiedPages.count(sourceNum) == 0)
+			{
+				this->copiedPages[sourceNum] = num;
+			}
+		}
+	}
+
+	bool ok = true;
+	for (size_t i = 0; i < pages.size() && ok; i++)
+	{
+		if (rotation[i] == -1)
+		{
+			ok = writeOverlayPage(pageNums[i], i);
+		}
+		else
+		{
+			ok = writeCopiedPage(pageNums[i], doc->getPage(pages[i])->getPdfPageNr(), i, rotation[i], &boxes[4 * i]);
+		}
+
+		// Written after each page, so only the objects of one page are in memory
+		writePending();
+	}
+
+	if (ok)
+	{
+		XojPdfObject kids = XojPdfObject::array();
+		for (int num : pageNums)
+		{
+			kids.items.push_back(XojPdfObject::ref(num));
+		}
+
+		XojPdfObject pagesDict = XojPdfObject::dict();
+		pagesDict.set("Type", XojPdfObject::name("Pages"));
+		pagesDict.set("Kids", kids);
+		pagesDict.set("Count", XojPdfObject::number(pageNums.size()));
+		writeObject(this->pagesNum, pagesDict);
+
+		XojPdfObject catalog = XojPdfObject::dict();
+		catalog.set("Type", XojPdfObject::name("Catalog"));
+		catalog.set("Pages", XojPdfObject::ref(this->pagesNum));
+		writeObject(catalogNum, catalog);
+
+		gint64 xrefOffset = this->offset;
+
+		// Each entry has exactly 20 bytes
+		string xref = "xref\n0 " + std::to_string(this->offsets.size()) + "\n0000000000 65535 f \n";
+		char entry[32];
+		for (size_t i = 1; i < this->offsets.size(); i++)
+		{
+			g_snprintf(entry, sizeof(entry), "%010" G_GINT64_FORMAT " 00000 n \n", this->offsets[i]);
+			xref += entry;
+		}
+
+		XojPdfObject trailer = XojPdfObject::dict();
+		trailer.set("Size", XojPdfObject::number(this->offsets.size()));
+		trailer.set("Root", XojPdfObject::ref(catalogNum));
+
+		xref += "trailer\n";
+		trailer.write(xref);
+		xref += "\nstartxref\n" + std::to_string(xrefOffset) + "\n%%EOF\n";
+		write(xref);
+	}
+
+	if (ferror(this->out))
+	{
+		this->lastError = FS(_F("Error writing file: \"{1}\"") % file.str());
+		ok = false;
+	}
+	fclose(this->out);
+	this->out = NULL;
+
+	return ok;
+}
+
+bool XojPdfCopyExport::writeOverlayPage(int pageNum, int overlayPage)
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	XojPdfObject page = XojPdfObject::dict();
+	for (const std::pair<string, XojPdfObject>& e : overlay->getPage(overlayPage).entries)
+	{
+		if (e.first != "Parent")
+		{
+			page.entries.push_back(std::make_pair(e.first, translate(overlay, e.second)));
+		}
+	}
+	page.set("Parent", XojPdfObject::ref(this->pagesNum));
+
+	writeObject(pageNum, page);
+
+	return true;
+}
+
+bool XojPdfCopyExport::createOverlayForm(int overlayPage, XojPdfObject& form)
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	const XojPdfObject& page = overlay->getPage(overlayPage);
+
+	XojPdfObject bbox = page.get("MediaBox") ? overlay->resolve(*page.get("MediaBox")) : XojPdfObject();
+	if (!bbox.isArray())
+	{
+		return false;
+	}
+
+	form = XojPdfObject::dict();
+	form.type = PDF_OBJECT_STREAM;
+	form.set("Type", XojPdfObject::name("XObject"));
+	form.set("Subtype", XojPdfObject::name("Form"));
+	form.set("BBox", bbox);
+
+	if (page.get("Resources"))
+	{
+		form.set("Resources", translate(overlay, *page.get("Resources")));
+	}
+
+	// The transparency group of the page is not used, so the blend mode of the highlighter
+	// applies to the background
+
+	XojPdfObject contents = page.get("Contents") ? overlay->resolve(*page.get("Contents")) : XojPdfObject();
+	if (contents.isStream())
+	{
+		form.data = contents.data;
+		for (const char* key : { "Filter", "DecodeParms" })
+		{
+			if (contents.get(key))
+			{
+				form.set(key, translate(overlay, *contents.get(key)));
+			}
+		}
+	}
+	else if (contents.isArray())
+	{
+		for (const XojPdfObject& item : contents.items)
+		{
+			XojPdfObject stream = overlay->resolve(item);
+			string decoded;
+			if (!stream.isStream() || !overlay->decodeStream(stream, decoded))
+			{
+				return false;
+			}
+
+			form.data += decoded;
+			form.data += "\n";
+		}
+	}
+
+	return true;
+}
+
+bool XojPdfCopyExport::writeCopiedPage(int pageNum, size_t sourcePage, int overlayPage, int rotation, double* box)
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	XojPdfObject form;
+	if (!createOverlayForm(overlayPage, form))
+	{
+		return false;
+	}
+
+	// The overlay is drawn as the page is displayed, the matrix maps it to the space of the not rotated page
+	double width = box[2] - box[0];
+	double height = box[3] - box[1];
+	double matrix[4][6] = {
+		{ 1, 0, 0, 1, box[0], box[1] },
+		{ 0, 1, -1, 0, box[0] + width, box[1] },
+		{ -1, 0, 0, -1, box[0] + width, box[1] + height },
+		{ 0, -1, 1, 0, box[0], box[1] + height }
+	};
+
+	XojPdfObject matrixArray = XojPdfObject::array();
+	for (double v : matrix[rotation / 90])
+	{
+		matrixArray.items.push_back(XojPdfObject::number(v));
+	}
+	form.set("Matrix", matrixArray);
+
+	int formNum = addObject();
+	writeObject(formNum, form);
+
+	const XojPdfObject& src = source->getPage(sourcePage);
+
+	// The overlay is added to the XObjects of the page, with a name not used by the page
+	XojPdfObject resources = src.get("Resources") ? source->resolve(*src.get("Resources")) : XojPdfObject();
+	if (!resources.isDict())
+	{
+		resources = XojPdfObject::dict();
+	}
+
+	XojPdfObject xobjects = resources.get("XObject") ? source->resolve(*resources.get("XObject")) : XojPdfObject();
+	if (!xobjects.isDict())
+	{
+		xobjects = XojPdfObject::dict();
+	}
+
+	string name = "XojOverlay";
+	for (int i = 1; xobjects.get(name.c_str()); i++)
+	{
+		name = "XojOverlay" + std::to_string(i);
+	}
+
+	resources.set("XObject", xobjects);
+	resources = translate(source, resources);
+	xobjects = *resources.get("XObject");
+	xobjects.set(name.c_str(), XojPdfObject::ref(formNum));
+	resources.set("XObject", xobjects);
+
+	// The original content is enclosed in q / Q, so it can not change the state the overlay is drawn with
+	if (this->saveStateNum == -1)
+	{
+		XojPdfObject saveState = XojPdfObject::dict();
+		saveState.type = PDF_OBJECT_STREAM;
+		saveState.data = "q\n";
+
+		this->saveStateNum = addObject();
+		writeObject(this->saveStateNum, saveState);
+	}
+
+	XojPdfObject contents = XojPdfObject::array();
+	contents.items.push_back(XojPdfObject::ref(this->saveStateNum));
+
+	if (src.get("Contents"))
+	{
+		XojPdfObject original = *src.get("Contents");
+		if (original.isRef())
+		{
+			XojPdfObject resolved = source->resolve(original);
+			if (resolved.isArray())
+			{
+				original = resolved;
+			}
+		}
+
+		if (original.isArray())
+		{
+			for (const XojPdfObject& item : original.items)
+			{
+				contents.items.push_back(translate(source, item));
+			}
+		}
+		else
+		{
+			contents.items.push_back(translate(source, original));
+		}
+	}
+
+	XojPdfObject drawOverlay = XojPdfObject::dict();
+	drawOverlay.type = PDF_OBJECT_STREAM;
+	drawOverlay.data = "\nQ q /" + name + " Do Q\n";
+
+	int drawOverlayNum = addObject();
+	writeObject(drawOverlayNum, drawOverlay);
+	contents.items.push_back(XojPdfObject::ref(drawOverlayNum));
+
+	// The structure tree and the article threads of the source are not copied
+	XojPdfObject page = XojPdfObject::dict();
+	for (const std::pair<string, XojPdfObject>& e : src.entries)
+	{
+		if (e.first != "Parent" && e.first != "Contents" && e.first != "Resources" && e.first != "B" &&
+		    e.first != "StructParents")
+		{
+			page.entries.push_back(std::make_pair(e.first, translate(source, e.second)));
+		}
+	}
+	page.set("Parent", XojPdfObject::ref(this->pagesNum));
+	page.set("Resources", resources);
+	page.set("Contents", contents);
+
+	writeObject(pageNum, page);
+
+	return true;
+}
+
+int XojPdfCopyExport::addObject()
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	this->offsets.push_back(0);
+	return this->offsets.size() - 1;
+}
+
+void XojPdfCopyExport::writeObject(int num, const XojPdfObject& obj)
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	string data = std::to_string(num) + " 0 obj\n";
+	obj.write(data);
+	data += "\nendobj\n";
+
+	this->offsets[num] = this->offset;
+	write(data);
+}
+
+void XojPdfCopyExport::write(const string& data)
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	fwrite(data.data(), 1, data.size(), this->out);
+	this->offset += data.size();
+}
+
+int XojPdfCopyExport::copyObject(XojPdfFile* file, int num)
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	std::pair<XojPdfFile*, int> key = std::make_pair(file, num);
+	auto it = this->copiedObjects.find(key);
+	if (it != this->copiedObjects.end())
+	{
+		return it->second;
+	}
+
+	PendingObject obj;
+	obj.file = file;
+	obj.num = num;
+	obj.newNum = addObject();
+
+	this->copiedObjects[key] = obj.newNum;
+	this->pending.push_back(obj);
+
+	return obj.newNum;
+}
+
+XojPdfObject XojPdfCopyExport::translate(XojPdfFile* file, const XojPdfObject& obj)
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	if (obj.isRef())
+	{
+		if (file->getPageIndex(obj.num) != -1)
+		{
+			auto it = this->copiedPages.find(obj.num);
+			if (file == this->source && it != this->copiedPages.end())
+			{
+				return XojPdfObject::ref(it->second);
+			}
+
+			// A page which is not exported
+			return XojPdfObject();
+		}
+
+		// The page tree is written new
+		if (file->isPageTreeObject(obj.num))
+		{
+			return XojPdfObject();
+		}
+
+		return XojPdfObject::ref(copyObject(file, obj.num));
+	}
+
+	if (obj.isArray())
+	{
+		XojPdfObject result = XojPdfObject::array();
+		for (const XojPdfObject& item : obj.items)
+		{
+			result.items.push_back(translate(file, item));
+		}
+		return result;
+	}
+
+	if (obj.isDict())
+	{
+		XojPdfObject result;
+		result.type = obj.type;
+		result.data = obj.data;
+
+		for (const std::pair<string, XojPdfObject>& e : obj.entries)
+		{
+			// The length is written with the data
+			if (!(obj.isStream() && e.first == "Length"))
+			{
+				result.entries.push_back(std::make_pair(e.first, translate(file, e.second)));
+			}
+		}
+		return result;
+	}
+
+	return obj;
+}
+
+void XojPdfCopyExport::writePending()
+{
+	XOJ_CHECK_TYPE(XojPdfCopyExport);
+
+	// Copying an object adds the objects it references
+	for (size_t i = 0; i < this->pending.size(); i++)
+	{
+		PendingObject p = this->pending[i];
+
+		XojPdfObject obj;
+		if (!p.file->getObject(p.num, obj))
+		{
+			g_warning("Could not read the object %i of the PDF file, it is written as null", p.num);
+		}
+
+		writeObject(p.newNum, translate(p.file, obj));
+	}
+
+	this->pending.clear();
+}
@@ -0,0 +1,143 @@
+/*
+ * Xournal++
+ *
+ * PDF export which copies the pages of the background PDF
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include "XojPdfExport.h"
+#include "XojPdfFile.h"
+
+#include "control/jobs/ProgressListener.h"
+#include "model/Document.h"
+
+#include <cstdio>
+#include <map>
+
+/**
+ * Copies the page objects of the background PDF (content streams, fonts, images) into the exported
+ * file, and draws only the layers of Xournal++ on top of them. The layers are rendered with cairo
+ * into a second PDF, whose pages are added to the copied pages as form XObjects.
+ *
+ * So the background is neither interpreted nor rendered again, the time to export depends on the
+ * annotations only. Pages which can not be copied, e.g. because their size was changed, are rendered
+ * as the XojCairoPdfExport does. If the background PDF can not be read at all, the export falls
+ * back to the XojCairoPdfExport.
+ */
+class XojPdfCopyExport : public XojPdfExport
+{
+public:
+	XojPdfCopyExport(Document* doc, ProgressListener* progressListener);
+	virtual ~XojPdfCopyExport();
+
+public:
+	virtual bool createPdf(Path file);
+	virtual bool createPdf(Path file, PageRangeVector& range);
+	virtual string getLastError();
+
+	/**
+	 * Export without background
+	 */
+	virtual void setNoBackgroundExport(bool noBackgroundExport);
+
+private:
+	class PendingObject
+	{
+	public:
+		XojPdfFile* file;
+		int num;
+		int newNum;
+	};
+
+	/**
+	 * @return false if the pages could not be copied, then they are rendered
+	 */
+	bool copyPdf(Path file, const vector<size_t>& pages);
+	bool copyPages(Path file, const vector<size_t>& pages, const char* sourceData, size_t sourceLength);
+	bool writePdf(Path file, const vector<size_t>& pages, const vector<int>& rotation, vector<double>& boxes);
+
+	/**
+	 * Saves the background PDF as it is loaded into a temporary file, it may be attached to the document
+	 */
+	bool saveSource(string& path);
+
+	/**
+	 * @param box The crop box of the source page
+	 * @return The rotation of the page, -1 if the page can not be copied
+	 */
+	int getCopyRotation(size_t page, double* box);
+	bool readBox(const XojPdfObject& page, const char* key, double* box);
+
+	/**
+	 * Renders the layers of all pages, and the background of the pages which are not copied
+	 */
+	bool renderOverlay(const vector<size_t>& pages, const vector<int>& rotation, string& overlay);
+
+	bool writeCopiedPage(int pageNum, size_t sourcePage, int overlayPage, int rotation, double* box);
+	bool writeOverlayPage(int pageNum, int overlayPage);
+
+	/**
+	 * @return The content of the overlay page as form XObject
+	 */
+	bool createOverlayForm(int overlayPage, XojPdfObject& form);
+
+	int addObject();
+	void writeObject(int num, const XojPdfObject& obj);
+	void write(const string& data);
+
+	/**
+	 * @return The number of the object in the exported file, it is written by writePending()
+	 */
+	int copyObject(XojPdfFile* file, int num);
+
+	/**
+	 * @return The object with all references changed to objects in the exported file
+	 */
+	XojPdfObject translate(XojPdfFile* file, const XojPdfObject& obj);
+	void writePending();
+
+	static cairo_status_t writeOverlayData(string* overlay, const unsigned char* data, unsigned int length);
+
+private:
+	XOJ_TYPE_ATTRIB;
+
+	Document* doc = NULL;
+	ProgressListener* progressListener = NULL;
+
+	bool noBackgroundExport = false;
+
+	string lastError;
+
+	XojPdfFile* source = NULL;
+	XojPdfFile* overlay = NULL;
+
+	FILE* out = NULL;
+	gint64 offset = 0;
+
+	int pagesNum = 0;
+
+	/**
+	 * A stream with "q", to save the graphics state before the content of a copied page
+	 */
+	int saveStateNum = -1;
+
+	/**
+	 * The offset of each object in the exported file
+	 */
+	vector<gint64> offsets;
+
+	std::map<std::pair<XojPdfFile*, int>, int> copiedObjects;
+	vector<PendingObject> pending;
+
+	/**
+	 * The object number of a source page and of its first copy, references to the page
+	 * (e.g. of links) point to the copy
+	 */
+	std::map<int, int> copiedPages;
+};
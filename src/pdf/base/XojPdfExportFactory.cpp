@@ -2,7 +2,7 @@
 
 #include <config-features.h>
 
-#include "XojCairoPdfExport.h"
+#include "XojPdfCopyExport.h"
 
 XojPdfExportFactory::XojPdfExportFactory()
 {
@@ -16,6 +16,6 @@ XojPdfExportFactory::~XojPdfExportFactory()
 
 XojPdfExport* XojPdfExportFactory::createExport(Document* doc, ProgressListener* listener)
 {
-	return new XojCairoPdfExport(doc, listener);
+	return new XojPdfCopyExport(doc, listener);
 }
 
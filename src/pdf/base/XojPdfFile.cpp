@@ -0,0 +1,1170 @@
+#include "XojPdfFile.h"
+
+#include <i18n.h>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+/**
+ * The attributes a page inherits from the nodes of the page tree
+ */
+static const char* INHERITABLE_ATTRIBUTES[] = { "Resources", "MediaBox", "CropBox", "Rotate" };
+
+static inline bool isWhiteChar(char c)
+{
+	return c == 0 || c == '\t' || c == '\n' || c == '\f' || c == '\r' || c == ' ';
+}
+
+static inline bool isDelimiterChar(char c)
+{
+	return c == '(' || c == ')' || c == '<' || c == '>' || c == '[' || c == ']' || c == '{' || c == '}' ||
+	       c == '/' || c == '%';
+}
+
+static inline bool isDigitChar(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+/**
+ * @return The position of the text in the data starting at from, string::npos if not found
+ */
+static size_t findText(const char* data, size_t from, size_t length, const char* text)
+{
+	const char* end = data + length;
+	const char* found = std::search(data + from, end, text, text + strlen(text));
+	return found == end ? string::npos : found - data;
+}
+
+/**
+ * @return The position of the last occurrence of the text in the data, string::npos if not found
+ */
+static size_t findLastText(const char* data, size_t length, const char* text)
+{
+	size_t textLength = strlen(text);
+	for (size_t pos = length; pos >= textLength; pos--)
+	{
+		if (memcmp(data + pos - textLength, text, textLength) == 0)
+		{
+			return pos - textLength;
+		}
+	}
+	return string::npos;
+}
+
+XojPdfFile::XojPdfFile()
+{
+	XOJ_INIT_TYPE(XojPdfFile);
+}
+
+XojPdfFile::~XojPdfFile()
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	XOJ_RELEASE_TYPE(XojPdfFile);
+}
+
+bool XojPdfFile::open(const char* data, size_t length)
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	this->data = data;
+	this->length = length;
+
+	bool ok = false;
+	size_t startxref = findLastText(data, length, "startxref");
+	if (startxref != string::npos)
+	{
+		size_t pos = startxref + 9;
+		string offset = readToken(data, length, pos);
+
+		std::set<size_t> visited;
+		ok = isInteger(offset) && readXref(strtoull(offset.c_str(), NULL, 10), visited) && !this->trailer.isNull();
+	}
+
+	if (ok && this->trailer.get("Encrypt"))
+	{
+		this->lastError = _("The PDF file is encrypted");
+		return false;
+	}
+
+	if (!ok || !readPages())
+	{
+		g_message("The cross reference of the PDF file is damaged, it is reconstructed");
+
+		if (!reconstructXref() || !readPages())
+		{
+			if (this->lastError.empty())
+			{
+				this->lastError = _("The PDF file is damaged");
+			}
+			return false;
+		}
+	}
+
+	return true;
+}
+
+size_t XojPdfFile::getPageCount()
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	return this->pages.size();
+}
+
+int XojPdfFile::getPageObject(size_t page)
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	return this->pages[page].num;
+}
+
+const XojPdfObject& XojPdfFile::getPage(size_t page)
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	return this->pages[page].dict;
+}
+
+int XojPdfFile::getPageIndex(int num)
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	auto it = this->pageIndex.find(num);
+	return it == this->pageIndex.end() ? -1 : it->second;
+}
+
+bool XojPdfFile::isPageTreeObject(int num)
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	return this->pageTreeObjects.count(num) > 0;
+}
+
+string XojPdfFile::getLastError()
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	return this->lastError;
+}
+
+bool XojPdfFile::readXref(size_t offset, std::set<size_t>& visited)
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	if (offset >= this->length || !visited.insert(offset).second)
+	{
+		return false;
+	}
+
+	size_t pos = offset;
+	if (readToken(this->data, this->length, pos) == "xref")
+	{
+		XojPdfObject dict;
+		if (!readXrefTable(pos) || !parseObject(this->data, this->length, pos, dict) || !dict.isDict())
+		{
+			return false;
+		}
+
+		if (this->trailer.isNull())
+		{
+			this->trailer = dict;
+		}
+
+		// Hybrid files have the objects in object streams in an additional cross reference stream,
+		// which comes before the previous sections
+		const XojPdfObject* xrefStm = dict.get("XRefStm");
+		if (xrefStm && xrefStm->isNumber() && !readXref((size_t) xrefStm->getNumber(), visited))
+		{
+			return false;
+		}
+
+		const XojPdfObject* prev = dict.get("Prev");
+		if (prev && prev->isNumber())
+		{
+			return readXref((size_t) prev->getNumber(), visited);
+		}
+
+		return true;
+	}
+
+	XojPdfObject stream;
+	if (!parseIndirectObject(offset, -1, stream) || !stream.isStream() || !stream.get("Type") ||
+	    !stream.get("Type")->isName("XRef"))
+	{
+		return false;
+	}
+
+	if (this->trailer.isNull())
+	{
+		// The stream dictionary is the trailer
+		this->trailer = stream;
+		this->trailer.type = PDF_OBJECT_DICT;
+		this->trailer.data.clear();
+	}
+
+	if (!readXrefStream(stream))
+	{
+		return false;
+	}
+
+	const XojPdfObject* prev = stream.get("Prev");
+	if (prev && prev->isNumber())
+	{
+		return readXref((size_t) prev->getNumber(), visited);
+	}
+
+	return true;
+}
+
+/**
+ * Reads the sections of a cross reference table, up to and including the trailer keyword.
+ * The sections are read from the newest to the oldest, so the first entry of an object is used.
+ */
+bool XojPdfFile::readXrefTable(size_t& pos)
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	while (true)
+	{
+		string start = readToken(this->data, this->length, pos);
+		if (start == "trailer")
+		{
+			return true;
+		}
+
+		string count = readToken(this->data, this->length, pos);
+		if (!isInteger(start) || !isInteger(count))
+		{
+			return false;
+		}
+
+		int first = atoi(start.c_str());
+		int n = atoi(count.c_str());
+		if (first < 0 || n < 0)
+		{
+			return false;
+		}
+
+		for (int i = 0; i < n; i++)
+		{
+			string offset = readToken(this->data, this->length, pos);
+			string gen = readToken(this->data, this->length, pos);
+			string type = readToken(this->data, this->length, pos);
+			if (!isInteger(offset) || !isInteger(gen) || (type != "n" && type != "f"))
+			{
+				return false;
+			}
+
+			if (this->xref.count(first + i) == 0)
+			{
+				XrefEntry& entry = this->xref[first + i];
+				entry.type = type == "n" ? 1 : 0;
+				entry.offset = strtoull(offset.c_str(), NULL, 10);
+			}
+		}
+	}
+}
+
+bool XojPdfFile::readXrefStream(const XojPdfObject& stream)
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	const XojPdfObject* w = stream.get("W");
+	if (!w || !w->isArray() || w->items.size() != 3)
+	{
+		return false;
+	}
+
+	int widths[3];
+	size_t entrySize = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		widths[i] = (int) w->items[i].getNumber();
+		if (widths[i] < 0 || widths[i] > 8)
+		{
+			return false;
+		}
+		entrySize += widths[i];
+	}
+
+	string decoded;
+	if (entrySize == 0 || !decodeStream(stream, decoded))
+	{
+		return false;
+	}
+
+	vector<int> index;
+	const XojPdfObject* indexObj = stream.get("Index");
+	if (indexObj && indexObj->isArray())
+	{
+		for (const XojPdfObject& i : indexObj->items)
+		{
+			index.push_back((int) i.getNumber());
+		}
+	}
+	else
+	{
+		const XojPdfObject* size = stream.get("Size");
+		index.push_back(0);
+		index.push_back(size ? (int) size->getNumber() : 0);
+	}
+
+	size_t pos = 0;
+	for (size_t i = 0; i + 1 < index.size(); i += 2)
+	{
+		for (int j = 0; j < index[i + 1]; j++)
+		{
+			if (pos + entrySize > decoded.size())
+			{
+				// Truncated, the entries read so far are used
+				return true;
+			}
+
+			size_t fields[3];
+			for (int f = 0; f < 3; f++)
+			{
+				size_t value = 0;
+				for (int b = 0; b < widths[f]; b++)
+				{
+					value = (value << 8) | (unsigned char) decoded[pos++];
+				}
+				fields[f] = value;
+			}
+
+			// The type is 1 if it is not stored
+			if (widths[0] == 0)
+			{
+				fields[0] = 1;
+			}
+
+			int num = index[i] + j;
+			if (this->xref.count(num))
+			{
+				continue;
+			}
+
+			// Free entries and unknown types are null objects
+			XrefEntry& entry = this->xref[num];
+			if (fields[0] == 1 || fields[0] == 2)
+			{
+				entry.type = (int) fields[0];
+				entry.offset = fields[1];
+				entry.index = (int) fields[2];
+			}
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Finds all "n g obj" in the file, the last object with a number is used, as a newer version
+ * of an object is appended to the file
+ */
+bool XojPdfFile::reconstructXref()
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	this->xref.clear();
+	this->trailer = XojPdfObject();
+	this->objectStreams.clear();
+	this->pages.clear();
+	this->pageIndex.clear();
+	this->pageTreeObjects.clear();
+
+	size_t pos = 0;
+	while ((pos = findText(this->data, pos, this->length, "obj")) != string::npos)
+	{
+		size_t objPos = pos;
+		pos += 3;
+
+		if (pos < this->length && !isWhiteChar(this->data[pos]) && !isDelimiterChar(this->data[pos]))
+		{
+			continue;
+		}
+
+		// The keyword follows the object number and the generation, "endobj" does not
+		size_t p = objPos;
+		while (p > 0 && isWhiteChar(this->data[p - 1]))
+		{
+			p--;
+		}
+		size_t genEnd = p;
+		while (p > 0 && isDigitChar(this->data[p - 1]))
+		{
+			p--;
+		}
+		size_t genStart = p;
+		while (p > 0 && isWhiteChar(this->data[p - 1]))
+		{
+			p--;
+		}
+		size_t numEnd = p;
+		while (p > 0 && isDigitChar(this->data[p - 1]))
+		{
+			p--;
+		}
+
+		if (genStart == genEnd || numEnd == genStart || p == numEnd)
+		{
+			continue;
+		}
+
+		int num = atoi(string(this->data + p, numEnd - p).c_str());
+		XrefEntry& entry = this->xref[num];
+		entry.type = 1;
+		entry.offset = p;
+	}
+
+	size_t trailerPos = findLastText(this->data, this->length, "trailer");
+	if (trailerPos != string::npos)
+	{
+		size_t pos = trailerPos + 7;
+		XojPdfObject dict;
+		if (parseObject(this->data, this->length, pos, dict) && dict.isDict() && dict.get("Root"))
+		{
+			this->trailer = dict;
+		}
+	}
+
+	int catalog = -1;
+	std::map<int, XrefEntry> objects = this->xref;
+	for (auto& e : objects)
+	{
+		XojPdfObject obj;
+		if (!parseIndirectObject(e.second.offset, e.first, obj) || !obj.isDict())
+		{
+			continue;
+		}
+
+		const XojPdfObject* type = obj.get("Type");
+		if (type && type->isName("ObjStm"))
+		{
+			ObjectStream* stream = getObjectStream(e.first);
+			for (size_t i = 0; stream && i < stream->objects.size(); i++)
+			{
+				int num = stream->objects[i].first;
+				if (this->xref.count(num) == 0)
+				{
+					XrefEntry& entry = this->xref[num];
+					entry.type = 2;
+					entry.offset = e.first;
+					entry.index = (int) i;
+				}
+			}
+		}
+		else if (type && type->isName("XRef") && this->trailer.isNull() && obj.get("Root"))
+		{
+			this->trailer = obj;
+			this->trailer.type = PDF_OBJECT_DICT;
+			this->trailer.data.clear();
+		}
+		else if (type && type->isName("Catalog"))
+		{
+			catalog = e.first;
+		}
+	}
+
+	if (this->trailer.isNull() && catalog != -1)
+	{
+		this->trailer = XojPdfObject::dict();
+		this->trailer.set("Root", XojPdfObject::ref(catalog));
+	}
+
+	if (!this->trailer.isNull() && this->trailer.get("Encrypt"))
+	{
+		this->lastError = _("The PDF file is encrypted");
+		return false;
+	}
+
+	return !this->trailer.isNull();
+}
+
+bool XojPdfFile::readPages()
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	this->pages.clear();
+	this->pageIndex.clear();
+	this->pageTreeObjects.clear();
+
+	const XojPdfObject* root = this->trailer.get("Root");
+	if (!root || !root->isRef())
+	{
+		return false;
+	}
+
+	XojPdfObject catalog;
+	if (!getObject(root->num, catalog) || !catalog.isDict())
+	{
+		return false;
+	}
+	this->pageTreeObjects.insert(root->num);
+
+	const XojPdfObject* pagesRef = catalog.get("Pages");
+	if (!pagesRef || !pagesRef->isRef() || !readPageTree(pagesRef->num, XojPdfObject::dict(), 0))
+	{
+		return false;
+	}
+
+	return !this->pages.empty();
+}
+
+bool XojPdfFile::readPageTree(int num, XojPdfObject inherited, int depth)
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	// A loop in the tree
+	if (depth > 64 || this->pageTreeObjects.count(num) || this->pageIndex.count(num))
+	{
+		return false;
+	}
+
+	XojPdfObject node;
+	if (!getObject(num, node) || !node.isDict())
+	{
+		return false;
+	}
+
+	const XojPdfObject* type = node.get("Type");
+	const XojPdfObject* kids = node.get("Kids");
+
+	if (kids && !(type && type->isName("Page")))
+	{
+		this->pageTreeObjects.insert(num);
+
+		for (const char* key : INHERITABLE_ATTRIBUTES)
+		{
+			if (node.get(key))
+			{
+				inherited.set(key, *node.get(key));
+			}
+		}
+
+		XojPdfObject kidsArray = resolve(*kids);
+		for (const XojPdfObject& kid : kidsArray.items)
+		{
+			// A page which is not found would change the index of the following pages
+			if (!kid.isRef() || !readPageTree(kid.num, inherited, depth + 1))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	PageEntry page;
+	page.num = num;
+	page.dict = node;
+	for (const char* key : INHERITABLE_ATTRIBUTES)
+	{
+		if (!node.get(key) && inherited.get(key))
+		{
+			page.dict.set(key, *inherited.get(key));
+		}
+	}
+
+	this->pageIndex[num] = this->pages.size();
+	this->pages.push_back(page);
+
+	return true;
+}
+
+XojPdfFile::ObjectStream* XojPdfFile::getObjectStream(int num)
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	auto it = this->objectStreams.find(num);
+	if (it != this->objectStreams.end())
+	{
+		return &it->second;
+	}
+
+	// Object streams are not stored in object streams
+	auto entry = this->xref.find(num);
+	XojPdfObject stream;
+	if (entry == this->xref.end() || entry->second.type != 1 ||
+	    !parseIndirectObject(entry->second.offset, num, stream) || !stream.isStream())
+	{
+		return NULL;
+	}
+
+	ObjectStream& objectStream = this->objectStreams[num];
+	if (!decodeStream(stream, objectStream.data))
+	{
+		this->objectStreams.erase(num);
+		return NULL;
+	}
+
+	const XojPdfObject* n = stream.get("N");
+	const XojPdfObject* first = stream.get("First");
+	int count = n ? (int) n->getNumber() : 0;
+	size_t firstOffset = first ? (size_t) first->getNumber() : 0;
+
+	size_t pos = 0;
+	for (int i = 0; i < count; i++)
+	{
+		string objNum = readToken(objectStream.data.data(), objectStream.data.size(), pos);
+		string offset = readToken(objectStream.data.data(), objectStream.data.size(), pos);
+		if (!isInteger(objNum) || !isInteger(offset))
+		{
+			break;
+		}
+
+		objectStream.objects.push_back(std::make_pair(atoi(objNum.c_str()), firstOffset + strtoull(offset.c_str(), NULL, 10)));
+	}
+
+	return &objectStream;
+}
+
+bool XojPdfFile::getObject(int num, XojPdfObject& obj)
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	obj = XojPdfObject();
+
+	auto it = this->xref.find(num);
+	if (it == this->xref.end() || it->second.type == 0)
+	{
+		return false;
+	}
+
+	if (it->second.type == 1)
+	{
+		return parseIndirectObject(it->second.offset, num, obj);
+	}
+
+	ObjectStream* stream = getObjectStream((int) it->second.offset);
+	if (stream == NULL)
+	{
+		return false;
+	}
+
+	size_t index = it->second.index;
+	if (index >= stream->objects.size() || stream->objects[index].first != num)
+	{
+		// The index of the cross reference is wrong, the object is searched
+		for (index = 0; index < stream->objects.size() && stream->objects[index].first != num; index++)
+		{
+		}
+
+		if (index == stream->objects.size())
+		{
+			return false;
+		}
+	}
+
+	size_t pos = stream->objects[index].second;
+	return parseObject(stream->data.data(), stream->data.size(), pos, obj);
+}
+
+XojPdfObject XojPdfFile::resolve(const XojPdfObject& obj)
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	if (!obj.isRef())
+	{
+		return obj;
+	}
+
+	XojPdfObject resolved;
+	getObject(obj.num, resolved);
+	return resolved;
+}
+
+bool XojPdfFile::parseIndirectObject(size_t pos, int num, XojPdfObject& obj)
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	if (pos >= this->length)
+	{
+		return false;
+	}
+
+	string n = readToken(this->data, this->length, pos);
+	string gen = readToken(this->data, this->length, pos);
+	if (!isInteger(n) || !isInteger(gen) || readToken(this->data, this->length, pos) != "obj")
+	{
+		return false;
+	}
+
+	if (num >= 0 && atoi(n.c_str()) != num)
+	{
+		return false;
+	}
+
+	if (!parseObject(this->data, this->length, pos, obj))
+	{
+		return false;
+	}
+
+	size_t streamPos = pos;
+	if (obj.isDict() && readToken(this->data, this->length, streamPos) == "stream")
+	{
+		return readStreamData(streamPos, obj);
+	}
+
+	return true;
+}
+
+bool XojPdfFile::readStreamData(size_t& pos, XojPdfObject& obj)
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	// The data starts after the end of line of the stream keyword
+	if (pos < this->length && this->data[pos] == '\r')
+	{
+		pos++;
+	}
+	if (pos < this->length && this->data[pos] == '\n')
+	{
+		pos++;
+	}
+
+	obj.type = PDF_OBJECT_STREAM;
+
+	double streamLength = -1;
+	const XojPdfObject* lengthObj = obj.get("Length");
+	if (lengthObj && lengthObj->isRef())
+	{
+		// The length object is no stream, so this does not recurse further
+		if (this->readDepth == 0)
+		{
+			this->readDepth++;
+			streamLength = resolve(*lengthObj).getNumber();
+			this->readDepth--;
+		}
+	}
+	else if (lengthObj)
+	{
+		streamLength = lengthObj->getNumber();
+	}
+
+	if (streamLength >= 0 && streamLength <= this->length - pos)
+	{
+		size_t end = pos + (size_t) streamLength;
+		if (readToken(this->data, this->length, end) == "endstream")
+		{
+			obj.data.assign(this->data + pos, (size_t) streamLength);
+			pos = end;
+			return true;
+		}
+	}
+
+	// The length is wrong, the data ends before the endstream keyword
+	size_t end = findText(this->data, pos, this->length, "endstream");
+	if (end == string::npos)
+	{
+		return false;
+	}
+
+	size_t dataEnd = end;
+	if (dataEnd > pos && this->data[dataEnd - 1] == '\n')
+	{
+		dataEnd--;
+	}
+	if (dataEnd > pos && this->data[dataEnd - 1] == '\r')
+	{
+		dataEnd--;
+	}
+
+	obj.data.assign(this->data + pos, dataEnd - pos);
+	pos = end + 9;
+
+	return true;
+}
+
+void XojPdfFile::skipWhite(const char* data, size_t length, size_t& pos)
+{
+	while (pos < length)
+	{
+		if (isWhiteChar(data[pos]))
+		{
+			pos++;
+		}
+		else if (data[pos] == '%')
+		{
+			while (pos < length && data[pos] != '\n' && data[pos] != '\r')
+			{
+				pos++;
+			}
+		}
+		else
+		{
+			break;
+		}
+	}
+}
+
+string XojPdfFile::readToken(const char* data, size_t length, size_t& pos)
+{
+	skipWhite(data, length, pos);
+
+	size_t start = pos;
+	while (pos < length && !isWhiteChar(data[pos]) && !isDelimiterChar(data[pos]))
+	{
+		pos++;
+	}
+
+	return string(data + start, pos - start);
+}
+
+bool XojPdfFile::isInteger(const string& token)
+{
+	size_t i = (!token.empty() && (token[0] == '-' || token[0] == '+')) ? 1 : 0;
+	if (i == token.size())
+	{
+		return false;
+	}
+
+	for (; i < token.size(); i++)
+	{
+		if (!isDigitChar(token[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool XojPdfFile::parseObject(const char* data, size_t length, size_t& pos, XojPdfObject& obj, int depth)
+{
+	// Nested too deep, the file is damaged
+	if (depth > 100)
+	{
+		return false;
+	}
+
+	skipWhite(data, length, pos);
+	if (pos >= length)
+	{
+		return false;
+	}
+
+	size_t start = pos;
+	char c = data[pos];
+
+	if (c == '/')
+	{
+		pos++;
+		while (pos < length && !isWhiteChar(data[pos]) && !isDelimiterChar(data[pos]))
+		{
+			pos++;
+		}
+
+		obj = XojPdfObject::token(string(data + start, pos - start));
+		return true;
+	}
+
+	if (c == '(')
+	{
+		int nesting = 0;
+		while (pos < length)
+		{
+			char ch = data[pos++];
+			if (ch == '\\')
+			{
+				pos++;
+			}
+			else if (ch == '(')
+			{
+				nesting++;
+			}
+			else if (ch == ')' && --nesting == 0)
+			{
+				obj = XojPdfObject::token(string(data + start, pos - start));
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	if (c == '<' && pos + 1 < length && data[pos + 1] == '<')
+	{
+		pos += 2;
+		obj = XojPdfObject::dict();
+
+		while (true)
+		{
+			skipWhite(data, length, pos);
+			if (pos + 1 < length && data[pos] == '>' && data[pos + 1] == '>')
+			{
+				pos += 2;
+				return true;
+			}
+
+			XojPdfObject key;
+			XojPdfObject value;
+			if (pos >= length || data[pos] != '/' || !parseObject(data, length, pos, key, depth + 1) ||
+			    !parseObject(data, length, pos, value, depth + 1))
+			{
+				return false;
+			}
+
+			// A null entry is the same as no entry
+			if (!value.isNull())
+			{
+				obj.entries.push_back(std::make_pair(key.text.substr(1), value));
+			}
+		}
+	}
+
+	if (c == '<')
+	{
+		const char* end = (const char*) memchr(data + pos, '>', length - pos);
+		if (end == NULL)
+		{
+			return false;
+		}
+
+		pos = end - data + 1;
+		obj = XojPdfObject::token(string(data + start, pos - start));
+		return true;
+	}
+
+	if (c == '[')
+	{
+		pos++;
+		obj = XojPdfObject::array();
+
+		while (true)
+		{
+			skipWhite(data, length, pos);
+			if (pos < length && data[pos] == ']')
+			{
+				pos++;
+				return true;
+			}
+
+			XojPdfObject item;
+			if (!parseObject(data, length, pos, item, depth + 1))
+			{
+				return false;
+			}
+			obj.items.push_back(item);
+		}
+	}
+
+	string token = readToken(data, length, pos);
+	if (token.empty() || token == "R" || token == "obj" || token == "endobj" || token == "stream" ||
+	    token == "endstream")
+	{
+		// An unexpected delimiter or keyword
+		return false;
+	}
+
+	if (isInteger(token))
+	{
+		size_t refPos = pos;
+		string gen = readToken(data, length, refPos);
+		if (isInteger(gen) && readToken(data, length, refPos) == "R")
+		{
+			pos = refPos;
+			obj = XojPdfObject::ref(atoi(token.c_str()), atoi(gen.c_str()));
+			return true;
+		}
+	}
+
+	if (token == "null")
+	{
+		obj = XojPdfObject();
+	}
+	else
+	{
+		obj = XojPdfObject::token(token);
+	}
+
+	return true;
+}
+
+bool XojPdfFile::decodeStream(const XojPdfObject& stream, string& decoded)
+{
+	XOJ_CHECK_TYPE(XojPdfFile);
+
+	XojPdfObject filter;
+	XojPdfObject params;
+	if (stream.get("Filter"))
+	{
+		filter = resolve(*stream.get("Filter"));
+	}
+	if (stream.get("DecodeParms"))
+	{
+		params = resolve(*stream.get("DecodeParms"));
+	}
+
+	if (filter.isArray())
+	{
+		if (filter.items.size() > 1)
+		{
+			this->lastError = _("Unsupported PDF stream filter");
+			return false;
+		}
+
+		filter = filter.items.empty() ? XojPdfObject() : filter.items[0];
+		params = (params.isArray() && !params.items.empty()) ? resolve(params.items[0]) : XojPdfObject();
+	}
+
+	if (filter.isNull())
+	{
+		decoded = stream.data;
+		return true;
+	}
+
+	if (!filter.isName("FlateDecode") && !filter.isName("Fl"))
+	{
+		this->lastError = _("Unsupported PDF stream filter");
+		return false;
+	}
+
+	if (!inflateData(stream.data, decoded) || !unpredict(params, decoded))
+	{
+		this->lastError = _("Could not decode a PDF stream");
+		return false;
+	}
+
+	return true;
+}
+
+bool XojPdfFile::inflateData(const string& data, string& out)
+{
+	z_stream zs;
+	memset(&zs, 0, sizeof(zs));
+	if (inflateInit(&zs) != Z_OK)
+	{
+		return false;
+	}
+
+	zs.next_in = (Bytef*) data.data();
+	zs.avail_in = data.size();
+
+	out.clear();
+	char buffer[64 * 1024];
+	bool ok = false;
+
+	while (true)
+	{
+		zs.next_out = (Bytef*) buffer;
+		zs.avail_out = sizeof(buffer);
+
+		int ret = ::inflate(&zs, Z_NO_FLUSH);
+		out.append(buffer, sizeof(buffer) - zs.avail_out);
+
+		if (out.size() > MAX_DECODED_SIZE)
+		{
+			g_warning("A PDF stream decodes to more than %i MB, it is not used", (int) (MAX_DECODED_SIZE / 1024 / 1024));
+			out = string();
+			break;
+		}
+
+		if (ret == Z_STREAM_END)
+		{
+			ok = true;
+			break;
+		}
+		if (ret == Z_BUF_ERROR && zs.avail_in == 0)
+		{
+			// Truncated, as written by some producers, the data is used like other readers do
+			ok = true;
+			break;
+		}
+		if (ret != Z_OK && ret != Z_BUF_ERROR)
+		{
+			break;
+		}
+	}
+
+	inflateEnd(&zs);
+	return ok;
+}
+
+/**
+ * Reverses the PNG predictors, which are used for cross reference streams
+ */
+bool XojPdfFile::unpredict(const XojPdfObject& params, string& data)
+{
+	if (!params.isDict() || !params.get("Predictor"))
+	{
+		return true;
+	}
+
+	int predictor = (int) params.get("Predictor")->getNumber();
+	if (predictor < 10)
+	{
+		// The TIFF predictor is not supported
+		return predictor <= 1;
+	}
+
+	int colors = params.get("Colors") ? (int) params.get("Colors")->getNumber() : 1;
+	int bits = params.get("BitsPerComponent") ? (int) params.get("BitsPerComponent")->getNumber() : 8;
+	int columns = params.get("Columns") ? (int) params.get("Columns")->getNumber() : 1;
+	if (colors < 1 || bits < 1 || columns < 1)
+	{
+		return false;
+	}
+
+	size_t bpp = std::max(1, colors * bits / 8);
+	size_t rowLength = ((size_t) colors * bits * columns + 7) / 8;
+
+	string out;
+	out.reserve(data.size());
+	vector<unsigned char> previous(rowLength, 0);
+	vector<unsigned char> row(rowLength);
+
+	for (size_t pos = 0; pos < data.size(); pos += rowLength + 1)
+	{
+		int type = (unsigned char) data[pos];
+		size_t n = std::min(rowLength, data.size() - pos - 1);
+		std::fill(row.begin(), row.end(), 0);
+		memcpy(row.data(), data.data() + pos + 1, n);
+
+		for (size_t i = 0; i < rowLength; i++)
+		{
+			int a = i >= bpp ? row[i - bpp] : 0;
+			int b = previous[i];
+			int c = i >= bpp ? previous[i - bpp] : 0;
+
+			int predicted = 0;
+			switch (type)
+			{
+			case 0:
+				break;
+			case 1:
+				predicted = a;
+				break;
+			case 2:
+				predicted = b;
+				break;
+			case 3:
+				predicted = (a + b) / 2;
+				break;
+			case 4:
+			{
+				int p = a + b - c;
+				int pa = std::abs(p - a);
+				int pb = std::abs(p - b);
+				int pc = std::abs(p - c);
+				predicted = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+				break;
+			}
+			default:
+				return false;
+			}
+
+			row[i] = (unsigned char) (row[i] + predicted);
+		}
+
+		out.append((const char*) row.data(), n);
+		previous.swap(row);
+		row.resize(rowLength);
+	}
+
+	data.swap(out);
+	return true;
+}
@@ -0,0 +1,160 @@
+/*
+ * Xournal++
+ *
+ * Reads the objects of a PDF file
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include "XojPdfObject.h"
+
+#include <XournalType.h>
+
+#include <map>
+#include <set>
+
+/**
+ * Reads the objects of a PDF file in memory, to copy them into another PDF file.
+ *
+ * Cross reference tables and streams, object streams and the FlateDecode filter are supported.
+ * If the cross reference is damaged, it is reconstructed from the objects found in the file.
+ * Encrypted files are not supported, their objects would have to be decrypted.
+ */
+class XojPdfFile
+{
+public:
+	XojPdfFile();
+	virtual ~XojPdfFile();
+
+public:
+	/**
+	 * Reads the cross reference and the page tree
+	 *
+	 * @param data The file, has to be valid as long as objects are read
+	 * @return false if the file is damaged or encrypted
+	 */
+	bool open(const char* data, size_t length);
+
+	size_t getPageCount();
+
+	/**
+	 * @return The object number of the page
+	 */
+	int getPageObject(size_t page);
+
+	/**
+	 * @return The page dictionary, with the attributes inherited from the page tree
+	 */
+	const XojPdfObject& getPage(size_t page);
+
+	/**
+	 * @return The index of the page with this object number, -1 if it is no page
+	 */
+	int getPageIndex(int num);
+
+	/**
+	 * @return true for the catalog and the nodes of the page tree
+	 */
+	bool isPageTreeObject(int num);
+
+	bool getObject(int num, XojPdfObject& obj);
+
+	/**
+	 * @return The referenced object, or the object itself if it is no reference
+	 */
+	XojPdfObject resolve(const XojPdfObject& obj);
+
+	/**
+	 * Decodes the data of a stream, only FlateDecode is supported
+	 */
+	bool decodeStream(const XojPdfObject& stream, string& decoded);
+
+	string getLastError();
+
+private:
+	class XrefEntry
+	{
+	public:
+		/**
+		 * 0: free, 1: at offset, 2: in the object stream with the number offset
+		 */
+		int type = 0;
+		size_t offset = 0;
+		int index = 0;
+	};
+
+	class ObjectStream
+	{
+	public:
+		string data;
+
+		/**
+		 * The object number and the offset in data of each object
+		 */
+		vector<std::pair<int, size_t>> objects;
+	};
+
+	class PageEntry
+	{
+	public:
+		int num = 0;
+		XojPdfObject dict;
+	};
+
+	bool readXref(size_t offset, std::set<size_t>& visited);
+	bool readXrefTable(size_t& pos);
+	bool readXrefStream(const XojPdfObject& stream);
+	bool reconstructXref();
+
+	bool readPages();
+	bool readPageTree(int num, XojPdfObject inherited, int depth);
+
+	ObjectStream* getObjectStream(int num);
+
+	bool parseIndirectObject(size_t pos, int num, XojPdfObject& obj);
+	bool readStreamData(size_t& pos, XojPdfObject& obj);
+
+	static void skipWhite(const char* data, size_t length, size_t& pos);
+	static string readToken(const char* data, size_t length, size_t& pos);
+	static bool isInteger(const string& token);
+	static bool parseObject(const char* data, size_t length, size_t& pos, XojPdfObject& obj, int depth = 0);
+
+	/**
+	 * @return false if the data is damaged or decodes to more than MAX_DECODED_SIZE
+	 */
+	static bool inflateData(const string& data, string& out);
+	static bool unpredict(const XojPdfObject& params, string& data);
+
+public:
+	/**
+	 * Streams are not decoded to more than this, so a small damaged or malicious file can not fill the memory
+	 */
+	static const size_t MAX_DECODED_SIZE = 256 * 1024 * 1024;
+
+private:
+	XOJ_TYPE_ATTRIB;
+
+	const char* data = NULL;
+	size_t length = 0;
+
+	std::map<int, XrefEntry> xref;
+	XojPdfObject trailer;
+
+	std::map<int, ObjectStream> objectStreams;
+
+	vector<PageEntry> pages;
+	std::map<int, int> pageIndex;
+	std::set<int> pageTreeObjects;
+
+	/**
+	 * The /Length of a stream may be an indirect object, which is read while the stream is read
+	 */
+	int readDepth = 0;
+
+	string lastError;
+};
@@ -0,0 +1,213 @@
+#include "XojPdfObject.h"
+
+#include <cmath>
+#include <cstring>
+
+XojPdfObject::XojPdfObject()
+{
+}
+
+XojPdfObject XojPdfObject::token(const string& token)
+{
+	XojPdfObject obj;
+	obj.type = PDF_OBJECT_TOKEN;
+	obj.text = token;
+	return obj;
+}
+
+XojPdfObject XojPdfObject::number(double value)
+{
+	if (value == std::floor(value) && std::abs(value) < 1e9)
+	{
+		return token(std::to_string((long) value));
+	}
+
+	// Locale independent, PDF allows no exponent
+	char buffer[G_ASCII_DTOSTR_BUF_SIZE];
+	g_ascii_formatd(buffer, sizeof(buffer), "%.6f", value);
+	return token(buffer);
+}
+
+XojPdfObject XojPdfObject::name(const string& name)
+{
+	return token("/" + name);
+}
+
+XojPdfObject XojPdfObject::ref(int num, int gen)
+{
+	XojPdfObject obj;
+	obj.type = PDF_OBJECT_REF;
+	obj.num = num;
+	obj.gen = gen;
+	return obj;
+}
+
+XojPdfObject XojPdfObject::array()
+{
+	XojPdfObject obj;
+	obj.type = PDF_OBJECT_ARRAY;
+	return obj;
+}
+
+XojPdfObject XojPdfObject::dict()
+{
+	XojPdfObject obj;
+	obj.type = PDF_OBJECT_DICT;
+	return obj;
+}
+
+bool XojPdfObject::isNull() const
+{
+	return this->type == PDF_OBJECT_NULL;
+}
+
+bool XojPdfObject::isDict() const
+{
+	return this->type == PDF_OBJECT_DICT || this->type == PDF_OBJECT_STREAM;
+}
+
+bool XojPdfObject::isStream() const
+{
+	return this->type == PDF_OBJECT_STREAM;
+}
+
+bool XojPdfObject::isArray() const
+{
+	return this->type == PDF_OBJECT_ARRAY;
+}
+
+bool XojPdfObject::isRef() const
+{
+	return this->type == PDF_OBJECT_REF;
+}
+
+bool XojPdfObject::isNumber() const
+{
+	if (this->type != PDF_OBJECT_TOKEN || this->text.empty())
+	{
+		return false;
+	}
+
+	char c = this->text[0];
+	return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.';
+}
+
+bool XojPdfObject::isName(const char* name) const
+{
+	return this->type == PDF_OBJECT_TOKEN && this->text.size() > 1 && this->text[0] == '/' &&
+	       strcmp(this->text.c_str() + 1, name) == 0;
+}
+
+double XojPdfObject::getNumber() const
+{
+	if (!isNumber())
+	{
+		return 0;
+	}
+
+	return g_ascii_strtod(this->text.c_str(), NULL);
+}
+
+const XojPdfObject* XojPdfObject::get(const char* key) const
+{
+	for (const std::pair<string, XojPdfObject>& e : this->entries)
+	{
+		if (e.first == key)
+		{
+			return &e.second;
+		}
+	}
+
+	return NULL;
+}
+
+void XojPdfObject::set(const char* key, const XojPdfObject& value)
+{
+	for (std::pair<string, XojPdfObject>& e : this->entries)
+	{
+		if (e.first == key)
+		{
+			e.second = value;
+			return;
+		}
+	}
+
+	this->entries.push_back(std::make_pair(string(key), value));
+}
+
+void XojPdfObject::remove(const char* key)
+{
+	for (auto it = this->entries.begin(); it != this->entries.end(); it++)
+	{
+		if (it->first == key)
+		{
+			this->entries.erase(it);
+			return;
+		}
+	}
+}
+
+void XojPdfObject::write(string& out) const
+{
+	switch (this->type)
+	{
+	case PDF_OBJECT_NULL:
+		out += "null";
+		break;
+
+	case PDF_OBJECT_TOKEN:
+		out += this->text;
+		break;
+
+	case PDF_OBJECT_REF:
+		out += std::to_string(this->num);
+		out += " ";
+		out += std::to_string(this->gen);
+		out += " R";
+		break;
+
+	case PDF_OBJECT_ARRAY:
+		out += "[";
+		for (size_t i = 0; i < this->items.size(); i++)
+		{
+			if (i > 0)
+			{
+				out += " ";
+			}
+			this->items[i].write(out);
+		}
+		out += "]";
+		break;
+
+	case PDF_OBJECT_DICT:
+	case PDF_OBJECT_STREAM:
+		out += "<<";
+		for (const std::pair<string, XojPdfObject>& e : this->entries)
+		{
+			if (this->type == PDF_OBJECT_STREAM && e.first == "Length")
+			{
+				continue;
+			}
+
+			out += "/";
+			out += e.first;
+			out += " ";
+			e.second.write(out);
+			out += "\n";
+		}
+
+		if (this->type == PDF_OBJECT_STREAM)
+		{
+			out += "/Length ";
+			out += std::to_string(this->data.size());
+			out += ">>\nstream\n";
+			out += this->data;
+			out += "\nendstream";
+		}
+		else
+		{
+			out += ">>";
+		}
+		break;
+	}
+}
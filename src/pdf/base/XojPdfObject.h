@@ -0,0 +1,119 @@
+/*
+ * Xournal++
+ *
+ * An object of a PDF file
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <XournalType.h>
+
+#include <utility>
+
+enum XojPdfObjectType
+{
+	PDF_OBJECT_NULL,
+
+	/**
+	 * A boolean, number, name or string
+	 */
+	PDF_OBJECT_TOKEN,
+	PDF_OBJECT_ARRAY,
+	PDF_OBJECT_DICT,
+	PDF_OBJECT_REF,
+
+	/**
+	 * A dictionary with the (still encoded) stream data
+	 */
+	PDF_OBJECT_STREAM
+};
+
+/**
+ * An object as needed to copy objects from one PDF file into another.
+ *
+ * Booleans, numbers, names and strings are kept as they are written in the file,
+ * so they are written again unchanged.
+ */
+class XojPdfObject
+{
+public:
+	XojPdfObject();
+
+	static XojPdfObject token(const string& token);
+	static XojPdfObject number(double value);
+
+	/**
+	 * @param name without the leading /
+	 */
+	static XojPdfObject name(const string& name);
+	static XojPdfObject ref(int num, int gen = 0);
+	static XojPdfObject array();
+	static XojPdfObject dict();
+
+public:
+	bool isNull() const;
+
+	/**
+	 * @return true also for streams
+	 */
+	bool isDict() const;
+	bool isStream() const;
+	bool isArray() const;
+	bool isRef() const;
+	bool isNumber() const;
+	bool isName(const char* name) const;
+
+	/**
+	 * @return 0 if this is not a number
+	 */
+	double getNumber() const;
+
+	/**
+	 * The entry of a dict or stream
+	 *
+	 * @return NULL if there is no such entry
+	 */
+	const XojPdfObject* get(const char* key) const;
+
+	/**
+	 * Set the entry of a dict or stream, replaces an existing entry
+	 */
+	void set(const char* key, const XojPdfObject& value);
+	void remove(const char* key);
+
+	/**
+	 * Write the object in PDF syntax, streams with the length of their data
+	 */
+	void write(string& out) const;
+
+public:
+	XojPdfObjectType type = PDF_OBJECT_NULL;
+
+	/**
+	 * The text of a token object
+	 */
+	string text;
+
+	/**
+	 * The object number of a reference
+	 */
+	int num = 0;
+	int gen = 0;
+
+	vector<XojPdfObject> items;
+
+	/**
+	 * The entries of a dict or stream, the keys without the leading /
+	 */
+	vector<std::pair<string, XojPdfObject>> entries;
+
+	/**
+	 * The data of a stream
+	 */
+	string data;
+};
@@ -41,10 +41,20 @@ public:
 	virtual double getWidth() = 0;
 	virtual double getHeight() = 0;
 
+	/**
+	 * render, findText and getText may be called from any thread,
+	 * the calls into the same PDF document are serialized by the implementation
+	 */
 	virtual void render(cairo_t* cr, bool forPrinting = false) = 0;
 
 	virtual vector<XojPdfRectangle> findText(string& text) = 0;
 
+	/**
+	 * @param charRects Returns the bounding box of each character of the text
+	 * @return The text of the page
+	 */
+	virtual string getText(vector<XojPdfRectangle>& charRects) = 0;
+
 	virtual int getPageId() = 0;
 
 private:
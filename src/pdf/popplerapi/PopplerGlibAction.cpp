@@ -1,4 +1,5 @@
 #include "PopplerGlibAction.h"
+#include "PopplerGlibDocument.h"
 
 PopplerGlibAction::PopplerGlibAction(PopplerAction* action, PopplerDocument* document)
  : action(action),
@@ -60,7 +61,11 @@ void PopplerGlibAction::linkFromDest(LinkDestination* link, PopplerDest* pDest)
 		break;
 	case POPPLER_DEST_XYZ:
 		{
+			GMutex* lock = PopplerGlibDocument::getLock(document);
+			g_mutex_lock(lock);
 			PopplerPage* page = poppler_document_get_page(document, pDest->page_num);
+			g_mutex_unlock(lock);
+
 			if (page == NULL)
 			{
 				return;
@@ -119,7 +124,11 @@ void PopplerGlibAction::linkFromDest(LinkDestination* link, PopplerDest* pDest)
 		break;
 	case POPPLER_DEST_NAMED:
 		{
+			GMutex* lock = PopplerGlibDocument::getLock(document);
+			g_mutex_lock(lock);
 			PopplerDest* pDest2 = poppler_document_find_dest(document, pDest->named_dest);
+			g_mutex_unlock(lock);
+
 			if (pDest2 != NULL)
 			{
 				linkFromDest(link, pDest2);
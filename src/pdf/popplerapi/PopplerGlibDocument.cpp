@@ -5,6 +5,29 @@
 #include <Util.h>
 #include <memory>
 
+static void freeLock(GMutex* lock)
+{
+	g_mutex_clear(lock);
+	g_free(lock);
+}
+
+GMutex* PopplerGlibDocument::getLock(PopplerDocument* document)
+{
+	static GMutex createLock;
+
+	// Attached to the poppler document, so all wrappers and pages of the document share it
+	g_mutex_lock(&createLock);
+	GMutex* lock = (GMutex*) g_object_get_data(G_OBJECT(document), "xoj-lock");
+	if (lock == NULL)
+	{
+		lock = g_new(GMutex, 1);
+		g_mutex_init(lock);
+		g_object_set_data_full(G_OBJECT(document), "xoj-lock", lock, (GDestroyNotify) freeLock);
+	}
+	g_mutex_unlock(&createLock);
+
+	return lock;
+}
 
 PopplerGlibDocument::PopplerGlibDocument()
 {
@@ -72,7 +95,13 @@ bool PopplerGlibDocument::save(Path filename, GError** error)
 	{
 		return false;
 	}
-	return poppler_document_save(document, uri.c_str(), error);
+
+	GMutex* lock = getLock(document);
+	g_mutex_lock(lock);
+	bool saved = poppler_document_save(document, uri.c_str(), error);
+	g_mutex_unlock(lock);
+
+	return saved;
 }
 
 bool PopplerGlibDocument::load(Path filename, string password, GError** error)
@@ -123,8 +152,12 @@ XojPdfPageSPtr PopplerGlibDocument::getPage(size_t page)
 		return NULL;
 	}
 
+	GMutex* lock = getLock(document);
+	g_mutex_lock(lock);
 	PopplerPage* pg = poppler_document_get_page(document, page);
-	XojPdfPageSPtr pageptr = std::make_shared<PopplerGlibPage>(pg);
+	g_mutex_unlock(lock);
+
+	XojPdfPageSPtr pageptr = std::make_shared<PopplerGlibPage>(pg, lock);
 	g_object_unref(pg);
 
 	return pageptr;
@@ -139,7 +172,12 @@ size_t PopplerGlibDocument::getPageCount()
 		return 0;
 	}
 
-	return poppler_document_get_n_pages(document);
+	GMutex* lock = getLock(document);
+	g_mutex_lock(lock);
+	size_t count = poppler_document_get_n_pages(document);
+	g_mutex_unlock(lock);
+
+	return count;
 }
 
 XojPdfBookmarkIterator* PopplerGlibDocument::getContentsIter()
@@ -151,7 +189,10 @@ XojPdfBookmarkIterator* PopplerGlibDocument::getContentsIter()
 		return NULL;
 	}
 
+	GMutex* lock = getLock(document);
+	g_mutex_lock(lock);
 	PopplerIndexIter* iter = poppler_index_iter_new(document);
+	g_mutex_unlock(lock);
 
 	if (iter == NULL)
 	{
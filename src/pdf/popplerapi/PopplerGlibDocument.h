@@ -36,6 +36,13 @@ public:
 	virtual size_t getPageCount();
 	virtual XojPdfBookmarkIterator* getContentsIter();
 
+public:
+	/**
+	 * poppler is not thread safe for the same document, every call into the document
+	 * and its pages, from any thread, has to hold this lock
+	 */
+	static GMutex* getLock(PopplerDocument* document);
+
 private:
 	XOJ_TYPE_ATTRIB;
 
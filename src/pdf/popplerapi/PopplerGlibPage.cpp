@@ -1,8 +1,9 @@
 #include "PopplerGlibPage.h"
 
 
-PopplerGlibPage::PopplerGlibPage(PopplerPage* page)
- : page(page)
+PopplerGlibPage::PopplerGlibPage(PopplerPage* page, GMutex* lock)
+ : page(page),
+   lock(lock)
 {
 	XOJ_INIT_TYPE(PopplerGlibPage);
 
@@ -13,7 +14,8 @@ PopplerGlibPage::PopplerGlibPage(PopplerPage* page)
 }
 
 PopplerGlibPage::PopplerGlibPage(const PopplerGlibPage& other)
- : page(other.page)
+ : page(other.page),
+   lock(other.lock)
 {
 	XOJ_INIT_TYPE(PopplerGlibPage);
 
@@ -47,6 +49,7 @@ void PopplerGlibPage::operator=(const PopplerGlibPage& other)
 	}
 
 	page = other.page;
+	lock = other.lock;
 	if (page != NULL)
 	{
 		g_object_ref(page);
@@ -77,6 +80,7 @@ void PopplerGlibPage::render(cairo_t* cr, bool forPrinting)
 {
 	XOJ_CHECK_TYPE(PopplerGlibPage);
 
+	g_mutex_lock(lock);
 	if (forPrinting)
 	{
 		poppler_page_render_for_printing(page, cr);
@@ -85,6 +89,7 @@ void PopplerGlibPage::render(cairo_t* cr, bool forPrinting)
 	{
 		poppler_page_render(page, cr);
 	}
+	g_mutex_unlock(lock);
 }
 
 int PopplerGlibPage::getPageId()
@@ -101,7 +106,9 @@ vector<XojPdfRectangle> PopplerGlibPage::findText(string& text)
 	vector<XojPdfRectangle> findings;
 
 	double height = getHeight();
+	g_mutex_lock(lock);
 	GList* matches = poppler_page_find_text(page, text.c_str());
+	g_mutex_unlock(lock);
 
 	for (GList* l = matches; l && l->data; l = g_list_next(l))
 	{
@@ -115,3 +122,38 @@ vector<XojPdfRectangle> PopplerGlibPage::findText(string& text)
 
 	return findings;
 }
+
+string PopplerGlibPage::getText(vector<XojPdfRectangle>& charRects)
+{
+	XOJ_CHECK_TYPE(PopplerGlibPage);
+
+	g_mutex_lock(lock);
+
+	char* text = poppler_page_get_text(page);
+	if (text == NULL)
+	{
+		g_mutex_unlock(lock);
+		return "";
+	}
+
+	// One rectangle per character of the text, with the origin at the top like the page
+	PopplerRectangle* rects = NULL;
+	guint count = 0;
+	bool hasLayout = poppler_page_get_text_layout(page, &rects, &count);
+
+	g_mutex_unlock(lock);
+
+	if (hasLayout)
+	{
+		for (guint i = 0; i < count; i++)
+		{
+			charRects.push_back(XojPdfRectangle(rects[i].x1, rects[i].y1, rects[i].x2, rects[i].y2));
+		}
+		g_free(rects);
+	}
+
+	string str = text;
+	g_free(text);
+
+	return str;
+}
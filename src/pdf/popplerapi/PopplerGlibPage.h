@@ -19,7 +19,10 @@
 class PopplerGlibPage : public XojPdfPage
 {
 public:
-	PopplerGlibPage(PopplerPage* page);
+	/**
+	 * @param lock The lock of the document, see PopplerGlibDocument::getLock
+	 */
+	PopplerGlibPage(PopplerPage* page, GMutex* lock);
 	PopplerGlibPage(const PopplerGlibPage& other);
 	virtual ~PopplerGlibPage();
 	void operator=(const PopplerGlibPage& other);
@@ -31,6 +34,7 @@ public:
 	virtual void render(cairo_t* cr, bool forPrinting = false);
 
 	virtual vector<XojPdfRectangle> findText(string& text);
+	virtual string getText(vector<XojPdfRectangle>& charRects);
 
 	virtual int getPageId();
 
@@ -38,5 +42,10 @@ private:
 	XOJ_TYPE_ATTRIB;
 
 	PopplerPage* page;
+
+	/**
+	 * Held for all calls which parse or render the page, the size is fixed when the page is created
+	 */
+	GMutex* lock;
 };
 
@@ -1,4 +1,5 @@
 #include "PopplerGlibPageBookmarkIterator.h"
+#include "PopplerGlibDocument.h"
 
 PopplerGlibPageBookmarkIterator::PopplerGlibPageBookmarkIterator(PopplerIndexIter* iter, PopplerDocument* document)
  : iter(iter),
@@ -28,21 +29,35 @@ bool PopplerGlibPageBookmarkIterator::next()
 {
 	XOJ_CHECK_TYPE(PopplerGlibPageBookmarkIterator);
 
-	return poppler_index_iter_next(iter);
+	GMutex* lock = PopplerGlibDocument::getLock(document);
+	g_mutex_lock(lock);
+	bool hasNext = poppler_index_iter_next(iter);
+	g_mutex_unlock(lock);
+
+	return hasNext;
 }
 
 bool PopplerGlibPageBookmarkIterator::isOpen()
 {
 	XOJ_CHECK_TYPE(PopplerGlibPageBookmarkIterator);
 
-	return poppler_index_iter_is_open(iter);
+	GMutex* lock = PopplerGlibDocument::getLock(document);
+	g_mutex_lock(lock);
+	bool open = poppler_index_iter_is_open(iter);
+	g_mutex_unlock(lock);
+
+	return open;
 }
 
 XojPdfBookmarkIterator* PopplerGlibPageBookmarkIterator::getChildIter()
 {
 	XOJ_CHECK_TYPE(PopplerGlibPageBookmarkIterator);
 
+	GMutex* lock = PopplerGlibDocument::getLock(document);
+	g_mutex_lock(lock);
 	PopplerIndexIter* child = poppler_index_iter_get_child(iter);
+	g_mutex_unlock(lock);
+
 	if (child == NULL)
 	{
 		return NULL;
@@ -55,7 +70,10 @@ XojPdfAction* PopplerGlibPageBookmarkIterator::getAction()
 {
 	XOJ_CHECK_TYPE(PopplerGlibPageBookmarkIterator);
 
+	GMutex* lock = PopplerGlibDocument::getLock(document);
+	g_mutex_lock(lock);
 	PopplerAction* action = poppler_index_iter_get_action(iter);
+	g_mutex_unlock(lock);
 
 	if (action == NULL)
 	{
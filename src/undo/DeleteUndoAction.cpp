@@ -4,6 +4,7 @@
 #include "model/Element.h"
 #include "model/Layer.h"
 #include "model/PageRef.h"
+#include "model/Stroke.h"
 #include "PageLayerPosEntry.h"
 
 #include <i18n.h>
@@ -90,6 +91,27 @@ bool DeleteUndoAction::redo(Control*)
 	return true;
 }
 
+vector<Stroke*> DeleteUndoAction::getOwnedStrokes()
+{
+	XOJ_CHECK_TYPE(DeleteUndoAction);
+
+	vector<Stroke*> strokes;
+	if (this->undone)
+	{
+		return strokes;
+	}
+
+	for (GList* l = this->elements; l != nullptr; l = l->next)
+	{
+		auto e = (PageLayerPosEntry<Element>*) l->data;
+		if (e->element->getType() == ELEMENT_STROKE)
+		{
+			strokes.push_back((Stroke*) e->element);
+		}
+	}
+	return strokes;
+}
+
 string DeleteUndoAction::getText()
 {
 	XOJ_CHECK_TYPE(DeleteUndoAction);
@@ -17,6 +17,7 @@
 class Element;
 class Layer;
 class Redrawable;
+class Stroke;
 
 class DeleteUndoAction : public UndoAction
 {
@@ -32,6 +33,9 @@ public:
 
 	string getText() override;
 
+protected:
+	vector<Stroke*> getOwnedStrokes() override;
+
 private:
 	XOJ_TYPE_ATTRIB;
 
@@ -122,6 +122,18 @@ void EraseUndoAction::finalize()
 	this->page->firePageChanged();
 }
 
+vector<Stroke*> EraseUndoAction::getOwnedStrokes()
+{
+	XOJ_CHECK_TYPE(EraseUndoAction);
+
+	vector<Stroke*> strokes;
+	for (GList* l = this->undone ? this->edited : this->original; l != NULL; l = l->next)
+	{
+		strokes.push_back(((PageLayerPosEntry<Stroke>*) l->data)->element);
+	}
+	return strokes;
+}
+
 string EraseUndoAction::getText()
 {
 	XOJ_CHECK_TYPE(EraseUndoAction);
@@ -35,7 +35,10 @@ public:
 	void finalize();
 
 	virtual string getText();
-	
+
+protected:
+	virtual vector<Stroke*> getOwnedStrokes();
+
 private:
 	XOJ_TYPE_ATTRIB;
 
@@ -4,6 +4,8 @@
 #include "gui/XournalppCursor.h"
 #include "model/PageRef.h"
 #include "model/Document.h"
+#include "model/Layer.h"
+#include "model/Stroke.h"
 
 #include <i18n.h>
 
@@ -30,6 +32,8 @@ bool InsertDeletePageUndoAction::undo(Control* control)
 {
 	XOJ_CHECK_TYPE(InsertDeletePageUndoAction);
 
+	this->undone = true;
+
 	if (this->inserted)
 	{
 		return deletePage(control);
@@ -44,6 +48,8 @@ bool InsertDeletePageUndoAction::redo(Control* control)
 {
 	XOJ_CHECK_TYPE(InsertDeletePageUndoAction);
 
+	this->undone = false;
+
 	if (this->inserted)
 	{
 		return insertPage(control);
@@ -116,6 +122,31 @@ bool InsertDeletePageUndoAction::deletePage(Control* control)
 	return true;
 }
 
+vector<Stroke*> InsertDeletePageUndoAction::getOwnedStrokes()
+{
+	XOJ_CHECK_TYPE(InsertDeletePageUndoAction);
+
+	vector<Stroke*> strokes;
+
+	// The page is only owned while it is not part of the document
+	if (this->inserted != this->undone)
+	{
+		return strokes;
+	}
+
+	for (Layer* l : *this->page->getLayers())
+	{
+		for (Element* e : *l->getElements())
+		{
+			if (e->getType() == ELEMENT_STROKE)
+			{
+				strokes.push_back((Stroke*) e);
+			}
+		}
+	}
+	return strokes;
+}
+
 string InsertDeletePageUndoAction::getText()
 {
 	XOJ_CHECK_TYPE(InsertDeletePageUndoAction);
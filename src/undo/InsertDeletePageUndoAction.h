@@ -25,6 +25,10 @@ public:
 	virtual bool redo(Control* control);
 
 	virtual string getText();
+
+protected:
+	virtual vector<Stroke*> getOwnedStrokes();
+
 private:
 	bool insertPage(Control* control);
 	bool deletePage(Control* control);
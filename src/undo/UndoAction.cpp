@@ -1,6 +1,11 @@
 #include "UndoAction.h"
 
+#include "model/Stroke.h"
+
 #include <Rectangle.h>
+#include <serializing/BinObjectEncoding.h>
+#include <serializing/ObjectInputStream.h>
+#include <serializing/ObjectOutputStream.h>
 
 UndoAction::UndoAction(const char* className)
  : className(className)
@@ -10,6 +15,11 @@ UndoAction::UndoAction(const char* className)
 
 UndoAction::~UndoAction()
 {
+	if (this->spillFile)
+	{
+		this->spillFile->release(this->spillRecord);
+	}
+
 	XOJ_RELEASE_TYPE(UndoAction);
 }
 
@@ -26,3 +36,107 @@ const char* UndoAction::getClassName() const
 {
 	return this->className;
 }
+
+vector<Stroke*> UndoAction::getOwnedStrokes()
+{
+	XOJ_CHECK_TYPE(UndoAction);
+
+	return vector<Stroke*>();
+}
+
+size_t UndoAction::getMemoryUsage()
+{
+	XOJ_CHECK_TYPE(UndoAction);
+
+	size_t memory = sizeof(UndoAction);
+	for (Stroke* s : getOwnedStrokes())
+	{
+		memory += sizeof(Stroke) + s->getPointAllocCount() * sizeof(Point);
+	}
+	return memory;
+}
+
+bool UndoAction::spill(UndoSpillFile* file)
+{
+	XOJ_CHECK_TYPE(UndoAction);
+
+	if (isSpilled())
+	{
+		return false;
+	}
+
+	vector<Stroke*> strokes = getOwnedStrokes();
+	if (strokes.empty())
+	{
+		return false;
+	}
+
+	ObjectOutputStream out(new BinObjectEncoding());
+	for (Stroke* s : strokes)
+	{
+		s->serialize(out);
+	}
+
+	GString* data = out.getStr();
+	UndoSpillRecord record = file->write(data->str, data->len);
+	g_string_free(data, true);
+
+	if (!record.isValid())
+	{
+		return false;
+	}
+
+	// The strokes are kept, other actions may still point to them
+	for (Stroke* s : strokes)
+	{
+		s->releasePoints();
+	}
+
+	this->spillFile = file;
+	this->spillRecord = record;
+	this->spilledStrokes = strokes;
+
+	return true;
+}
+
+bool UndoAction::unspill()
+{
+	XOJ_CHECK_TYPE(UndoAction);
+
+	if (!isSpilled())
+	{
+		return true;
+	}
+
+	string data;
+	bool ok = this->spillFile->read(this->spillRecord, data);
+
+	ObjectInputStream in;
+	ok = ok && in.read(data.data(), data.size());
+
+	try
+	{
+		for (size_t i = 0; ok && i < this->spilledStrokes.size(); i++)
+		{
+			this->spilledStrokes[i]->readSerialized(in);
+		}
+	}
+	catch (std::exception& e)
+	{
+		g_warning("Could not read the spilled undo action: %s", e.what());
+		ok = false;
+	}
+
+	this->spillFile->release(this->spillRecord);
+	this->spillFile = NULL;
+	this->spilledStrokes.clear();
+
+	return ok;
+}
+
+bool UndoAction::isSpilled()
+{
+	XOJ_CHECK_TYPE(UndoAction);
+
+	return this->spillFile != NULL;
+}
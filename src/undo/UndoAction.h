@@ -11,11 +11,14 @@
 
 #pragma once
 
+#include "UndoSpillFile.h"
+
 #include "model/PageRef.h"
 
 #include <config.h>
 
 class Control;
+class Stroke;
 class XojPage;
 
 class UndoAction
@@ -37,6 +40,31 @@ public:
 
 	const char* getClassName() const;
 
+	/**
+	 * The memory in bytes used by the action, mostly by the elements it owns
+	 */
+	virtual size_t getMemoryUsage();
+
+	/**
+	 * Moves the points of the owned strokes into the spill file, to free their memory
+	 *
+	 * @return false if nothing was spilled
+	 */
+	bool spill(UndoSpillFile* file);
+
+	/**
+	 * Reloads the spilled points, has to be called before undo / redo
+	 */
+	bool unspill();
+
+	bool isSpilled();
+
+protected:
+	/**
+	 * The strokes owned by the action in its current state, which are not part of the document
+	 */
+	virtual vector<Stroke*> getOwnedStrokes();
+
 protected:
 	XOJ_TYPE_ATTRIB;
 
@@ -45,4 +73,9 @@ protected:
 
 	PageRef page;
 	bool undone = false;
+
+private:
+	UndoSpillFile* spillFile = NULL;
+	UndoSpillRecord spillRecord;
+	vector<Stroke*> spilledStrokes;
 };
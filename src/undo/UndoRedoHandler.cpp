@@ -79,6 +79,9 @@ void UndoRedoHandler::clearContents()
 	undoList.clear();
 	clearRedo();
 
+	this->memoryUsage = 0;
+	this->actionMemory.clear();
+
 	this->savedUndo = nullptr;
 	this->autosavedUndo = nullptr;
 
@@ -94,6 +97,10 @@ void UndoRedoHandler::clearRedo()
 		g_message("clearRedo()::Delete UndoAction: %" PRIu64 " / %s", (size_t) &undoAction, undoAction.getClassName());
 	}
 #endif
+	for (auto const& undoAction: this->redoList)
+	{
+		uncountMemory(undoAction.get());
+	}
 	redoList.clear();
 	PRINTCONTENTS();
 }
@@ -115,7 +122,9 @@ void UndoRedoHandler::undo()
 
 	Document* doc = control->getDocument();
 	doc->lock();
-	bool undoResult = undoAction.undo(this->control);
+	// The action is undone even if the points could not be read, to keep the document consistent
+	bool unspillResult = undoAction.unspill();
+	bool undoResult = undoAction.undo(this->control) && unspillResult;
 	doc->unlock();
 
 	if (!undoResult)
@@ -126,7 +135,10 @@ void UndoRedoHandler::undo()
 		XojMsgBox::showErrorToUser(control->getGtkWindow(), msg);
 	}
 
+	countMemory(&undoAction);
+
 	fireUpdateUndoRedoButtons(undoAction.getPages());
+	limitMemory();
 
 	PRINTCONTENTS();
 }
@@ -149,7 +161,8 @@ void UndoRedoHandler::redo()
 
 	Document* doc = control->getDocument();
 	doc->lock();
-	bool redoResult = redoAction.redo(this->control);
+	bool unspillResult = redoAction.unspill();
+	bool redoResult = redoAction.redo(this->control) && unspillResult;
 	doc->unlock();
 
 	if (!redoResult)
@@ -160,11 +173,73 @@ void UndoRedoHandler::redo()
 		XojMsgBox::showErrorToUser(control->getGtkWindow(), msg);
 	}
 
+	countMemory(&redoAction);
+
 	fireUpdateUndoRedoButtons(redoAction.getPages());
+	limitMemory();
 
 	PRINTCONTENTS();
 }
 
+void UndoRedoHandler::countMemory(UndoAction* action)
+{
+	XOJ_CHECK_TYPE(UndoRedoHandler);
+
+	size_t& counted = this->actionMemory[action];
+	this->memoryUsage -= counted;
+	counted = action->getMemoryUsage();
+	this->memoryUsage += counted;
+}
+
+void UndoRedoHandler::uncountMemory(UndoAction* action)
+{
+	XOJ_CHECK_TYPE(UndoRedoHandler);
+
+	auto it = this->actionMemory.find(action);
+	if (it != this->actionMemory.end())
+	{
+		this->memoryUsage -= it->second;
+		this->actionMemory.erase(it);
+	}
+}
+
+void UndoRedoHandler::limitMemory()
+{
+	XOJ_CHECK_TYPE(UndoRedoHandler);
+
+	if (!this->undoList.empty())
+	{
+		countMemory(this->undoList.back().get());
+	}
+
+	int limit = this->control ? this->control->getSettings()->getUndoMemoryLimit() : 0;
+	if (limit <= 0)
+	{
+		return;
+	}
+	size_t maxMemory = (size_t) limit * 1024 * 1024;
+
+	auto spillAction = [&](UndoAction* action)
+	{
+		if (action->spill(&this->spillFile))
+		{
+			countMemory(action);
+		}
+	};
+
+	// The last undo and the next redo action are kept in memory, they are executed without delay.
+	// The last undo action may also still be changed, e.g. while erasing
+	for (size_t i = 0; i + 1 < this->undoList.size() && this->memoryUsage > maxMemory; i++)
+	{
+		spillAction(this->undoList[i].get());
+	}
+
+	for (size_t i = 0; i + 1 < this->redoList.size() && this->memoryUsage > maxMemory; i++)
+	{
+		spillAction(this->redoList[i].get());
+	}
+}
+
 bool UndoRedoHandler::canUndo()
 {
 	XOJ_CHECK_TYPE(UndoRedoHandler);
@@ -189,9 +264,16 @@ void UndoRedoHandler::addUndoAction(UndoActionPtr action)
 		return;
 	}
 
+	// The previous action may have been changed since it was counted, it is not the last one anymore
+	if (!this->undoList.empty())
+	{
+		countMemory(this->undoList.back().get());
+	}
+
 	this->undoList.emplace_back(std::move(action));
 	clearRedo();
 	fireUpdateUndoRedoButtons(this->undoList.back()->getPages());
+	limitMemory();
 
 	PRINTCONTENTS();
 }
@@ -209,9 +291,12 @@ void UndoRedoHandler::addUndoActionBefore(UndoActionPtr action, UndoAction* befo
 		addUndoAction(std::move(action));
 		return;
 	}
+	UndoAction* added = action.get();
 	this->undoList.emplace(iter, std::move(action));
+	countMemory(added);
 	clearRedo();
 	fireUpdateUndoRedoButtons(this->undoList.back()->getPages());
+	limitMemory();
 
 	PRINTCONTENTS();
 }
@@ -227,6 +312,7 @@ bool UndoRedoHandler::removeUndoAction(UndoAction* action)
 	{
 		return false;
 	}
+	uncountMemory(action);
 	this->undoList.erase(iter);
 	clearRedo();
 	fireUpdateUndoRedoButtons(action->getPages());
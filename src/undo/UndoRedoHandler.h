@@ -13,9 +13,11 @@
 
 #include <XournalType.h>
 #include "UndoAction.h"
+#include "UndoSpillFile.h"
 
 #include <deque>
 #include <stack>
+#include <unordered_map>
 #include <vector>
 
 class Control;
@@ -66,11 +68,40 @@ public:
 private:
 	void clearRedo();
 
+	/**
+	 * Moves the points of the oldest actions into the spill file, until the
+	 * history uses less memory than configured
+	 */
+	void limitMemory();
+
+	/**
+	 * Updates memoryUsage with the current memory of the action, after it was added or changed
+	 */
+	void countMemory(UndoAction* action);
+
+	/**
+	 * Removes the action from memoryUsage, before it is deleted
+	 */
+	void uncountMemory(UndoAction* action);
+
 private:
 	XOJ_TYPE_ATTRIB;
+
+	/**
+	 * Has to be destroyed after the actions
+	 */
+	UndoSpillFile spillFile;
+
 	std::deque<UndoActionPtr> undoList;
 	std::deque<UndoActionPtr> redoList;
 
+	/**
+	 * The memory of all actions, as counted when each of them was added or changed the last time.
+	 * The last undo action may still change, it is counted again before the memory is limited.
+	 */
+	size_t memoryUsage = 0;
+	std::unordered_map<UndoAction*, size_t> actionMemory;
+
 	UndoAction* savedUndo = nullptr;
 	UndoAction* autosavedUndo = nullptr;
 
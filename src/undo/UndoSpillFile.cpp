@@ -0,0 +1,185 @@
+#include "UndoSpillFile.h"
+
+#include <glib/gstdio.h>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+
+UndoSpillFile::UndoSpillFile()
+{
+	XOJ_INIT_TYPE(UndoSpillFile);
+}
+
+UndoSpillFile::~UndoSpillFile()
+{
+	XOJ_CHECK_TYPE(UndoSpillFile);
+
+	if (this->fp)
+	{
+		fclose(this->fp);
+		this->fp = NULL;
+	}
+
+	if (!this->filename.empty())
+	{
+		g_unlink(this->filename.c_str());
+	}
+
+	XOJ_RELEASE_TYPE(UndoSpillFile);
+}
+
+bool UndoSpillFile::open()
+{
+	XOJ_CHECK_TYPE(UndoSpillFile);
+
+	gchar* path = NULL;
+	int fd = g_file_open_tmp("xournalpp-undo-XXXXXX", &path, NULL);
+	if (fd == -1)
+	{
+		g_warning("Could not create a temporary file for the undo history");
+		return false;
+	}
+
+	this->filename = path;
+	g_free(path);
+
+	this->fp = fdopen(fd, "w+b");
+	if (this->fp == NULL)
+	{
+		g_warning("Could not open the temporary file \"%s\" for the undo history", this->filename.c_str());
+		close(fd);
+		return false;
+	}
+
+	return true;
+}
+
+bool UndoSpillFile::seek(gint64 offset)
+{
+	XOJ_CHECK_TYPE(UndoSpillFile);
+
+	// fseek takes a long, which has 32 bits on Windows
+#ifdef WIN32
+	return _fseeki64(this->fp, offset, SEEK_SET) == 0;
+#else
+	return fseeko(this->fp, (off_t) offset, SEEK_SET) == 0;
+#endif
+}
+
+void UndoSpillFile::truncate()
+{
+	XOJ_CHECK_TYPE(UndoSpillFile);
+
+	fflush(this->fp);
+
+#ifdef WIN32
+	bool ok = _chsize_s(_fileno(this->fp), this->size) == 0;
+#else
+	bool ok = ftruncate(fileno(this->fp), (off_t) this->size) == 0;
+#endif
+
+	if (!ok)
+	{
+		g_warning("Could not truncate the temporary file \"%s\" for the undo history", this->filename.c_str());
+	}
+}
+
+UndoSpillRecord UndoSpillFile::write(const char* data, gsize length)
+{
+	XOJ_CHECK_TYPE(UndoSpillFile);
+
+	UndoSpillRecord record;
+
+	if (this->fp == NULL && !open())
+	{
+		return record;
+	}
+
+	// The first free space between the used records which is large enough, else after the last record
+	gint64 offset = 0;
+	for (auto& r : this->records)
+	{
+		if (r.first - offset >= (gint64) length)
+		{
+			break;
+		}
+		offset = r.first + r.second;
+	}
+
+	if (!seek(offset) || fwrite(data, 1, length, this->fp) != length)
+	{
+		g_warning("Could not write to the temporary file \"%s\" for the undo history", this->filename.c_str());
+		return record;
+	}
+
+	record.offset = offset;
+	record.length = length;
+
+	this->records[offset] = length;
+	this->size = std::max(this->size, offset + (gint64) length);
+
+	return record;
+}
+
+bool UndoSpillFile::read(const UndoSpillRecord& record, string& data)
+{
+	XOJ_CHECK_TYPE(UndoSpillFile);
+
+	if (this->fp == NULL || !record.isValid())
+	{
+		return false;
+	}
+
+	data.resize(record.length);
+	if (!seek(record.offset) || fread(&data[0], 1, record.length, this->fp) != record.length)
+	{
+		g_warning("Could not read the temporary file \"%s\" for the undo history", this->filename.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+void UndoSpillFile::release(UndoSpillRecord& record)
+{
+	XOJ_CHECK_TYPE(UndoSpillFile);
+
+	if (!record.isValid())
+	{
+		return;
+	}
+	this->records.erase(record.offset);
+	record = UndoSpillRecord();
+
+	// The free space at the end is given back, the free space between used records is reused by write
+	gint64 end = 0;
+	if (!this->records.empty())
+	{
+		end = this->records.rbegin()->first + this->records.rbegin()->second;
+	}
+
+	if (end < this->size)
+	{
+		this->size = end;
+		truncate();
+	}
+}
+
+gint64 UndoSpillFile::getSize()
+{
+	XOJ_CHECK_TYPE(UndoSpillFile);
+
+	return this->size;
+}
+
+string UndoSpillFile::getFilename()
+{
+	XOJ_CHECK_TYPE(UndoSpillFile);
+
+	return this->filename;
+}
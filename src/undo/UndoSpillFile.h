@@ -0,0 +1,86 @@
+/*
+ * Xournal++
+ *
+ * Temporary file for the data of undo actions
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <XournalType.h>
+
+#include <cstdio>
+#include <map>
+
+class UndoSpillRecord
+{
+public:
+	bool isValid() const
+	{
+		return this->offset >= 0;
+	}
+
+public:
+	gint64 offset = -1;
+	gsize length = 0;
+};
+
+/**
+ * The undo history moves the data of old actions into this file, to limit its memory.
+ * A record is written into the first free space large enough for it, else appended. The file is
+ * truncated after the last used record each time a record is released.
+ */
+class UndoSpillFile
+{
+public:
+	UndoSpillFile();
+	virtual ~UndoSpillFile();
+
+public:
+	/**
+	 * @return an invalid record if the data could not be written
+	 */
+	UndoSpillRecord write(const char* data, gsize length);
+
+	bool read(const UndoSpillRecord& record, string& data);
+
+	/**
+	 * The record is not used anymore
+	 */
+	void release(UndoSpillRecord& record);
+
+	/**
+	 * The end of the last used record, the file is not larger
+	 */
+	gint64 getSize();
+
+	/**
+	 * The temporary file, empty if nothing was written yet
+	 */
+	string getFilename();
+
+private:
+	bool open();
+	bool seek(gint64 offset);
+	void truncate();
+
+private:
+	XOJ_TYPE_ATTRIB;
+
+	FILE* fp = NULL;
+	string filename;
+
+	/**
+	 * The end of the last used record
+	 */
+	gint64 size = 0;
+
+	/**
+	 * The length of each used record, by offset
+	 */
+	std::map<gint64, gsize> records;
+};
@@ -39,6 +39,8 @@ void emergencySave()
 	Path filename = Util::getConfigFile("emergencysave.xopp");
 
 	SaveHandler handler;
+	// No new threads while crashing
+	handler.setThreadCount(1);
 	handler.prepareSave(document);
 	handler.saveTo(filename);
 
@@ -73,3 +73,96 @@ void GzOutputStream::close()
 		this->fp = NULL;
 	}
 }
+
+////////////////////////////////////////////////////////
+/// GzMemoryOutputStream ///////////////////////////////
+////////////////////////////////////////////////////////
+
+GzMemoryOutputStream::GzMemoryOutputStream(int level)
+{
+	XOJ_INIT_TYPE(GzMemoryOutputStream);
+
+	memset(&this->stream, 0, sizeof(this->stream));
+
+	// 15 bits window, +16 for the gzip header
+	if (deflateInit2(&this->stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		this->error = _("Could not initialize the compression");
+		return;
+	}
+	this->open = true;
+}
+
+GzMemoryOutputStream::~GzMemoryOutputStream()
+{
+	XOJ_CHECK_TYPE(GzMemoryOutputStream);
+
+	if (this->open)
+	{
+		deflateEnd(&this->stream);
+		this->open = false;
+	}
+
+	XOJ_RELEASE_TYPE(GzMemoryOutputStream);
+}
+
+void GzMemoryOutputStream::deflateInput(int flush)
+{
+	XOJ_CHECK_TYPE(GzMemoryOutputStream);
+
+	char buffer[16384];
+	int ret;
+	do
+	{
+		this->stream.next_out = (Bytef*) buffer;
+		this->stream.avail_out = sizeof(buffer);
+		ret = deflate(&this->stream, flush);
+		this->data.append(buffer, sizeof(buffer) - this->stream.avail_out);
+	}
+	while (this->stream.avail_out == 0 || (flush == Z_FINISH && ret == Z_OK));
+}
+
+void GzMemoryOutputStream::write(const char* data, int len)
+{
+	XOJ_CHECK_TYPE(GzMemoryOutputStream);
+
+	if (!this->open)
+	{
+		return;
+	}
+
+	this->stream.next_in = (Bytef*) data;
+	this->stream.avail_in = len;
+	deflateInput(Z_NO_FLUSH);
+}
+
+void GzMemoryOutputStream::close()
+{
+	XOJ_CHECK_TYPE(GzMemoryOutputStream);
+
+	if (!this->open)
+	{
+		return;
+	}
+
+	this->stream.next_in = NULL;
+	this->stream.avail_in = 0;
+	deflateInput(Z_FINISH);
+
+	deflateEnd(&this->stream);
+	this->open = false;
+}
+
+string& GzMemoryOutputStream::getData()
+{
+	XOJ_CHECK_TYPE(GzMemoryOutputStream);
+
+	return this->data;
+}
+
+string& GzMemoryOutputStream::getLastError()
+{
+	XOJ_CHECK_TYPE(GzMemoryOutputStream);
+
+	return this->error;
+}
@@ -53,3 +53,41 @@ private:
 	string target;
 	Path filename;
 };
+
+/**
+ * Compresses the written data into a gzip member in memory.
+ *
+ * Concatenated gzip members are read as one stream by zlib, so a file
+ * can be assembled from separately compressed parts.
+ */
+class GzMemoryOutputStream : public OutputStream
+{
+public:
+	GzMemoryOutputStream(int level = Z_DEFAULT_COMPRESSION);
+	virtual ~GzMemoryOutputStream();
+
+public:
+	using OutputStream::write;
+	virtual void write(const char* data, int len);
+
+	virtual void close();
+
+	/**
+	 * The compressed data, complete after close()
+	 */
+	string& getData();
+
+	string& getLastError();
+
+private:
+	void deflateInput(int flush);
+
+private:
+	XOJ_TYPE_ATTRIB;
+
+	z_stream stream;
+	bool open = false;
+
+	string data;
+	string error;
+};
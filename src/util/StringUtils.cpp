@@ -95,3 +95,62 @@ bool StringUtils::iequals(string a, string b)
 }
 
 
+
+double StringUtils::parseDouble(const char* str, char** endPtr)
+{
+	// Powers of ten which are exactly representable as double
+	static const double POW10[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	const char* p = str;
+	while (g_ascii_isspace(*p))
+	{
+		p++;
+	}
+
+	bool negative = *p == '-';
+	if (*p == '-' || *p == '+')
+	{
+		p++;
+	}
+
+	guint64 mantissa = 0;
+	int digits = 0;
+	int fractionDigits = 0;
+
+	for (; g_ascii_isdigit(*p); p++)
+	{
+		mantissa = mantissa * 10 + (*p - '0');
+		digits++;
+	}
+
+	if (*p == '.')
+	{
+		for (p++; g_ascii_isdigit(*p); p++)
+		{
+			mantissa = mantissa * 10 + (*p - '0');
+			digits++;
+			fractionDigits++;
+		}
+	}
+
+	// Exponents, hex numbers, inf / nan, too many digits for the mantissa, or no number at all:
+	// use the slow path. The result of a single division of two exact values is correctly rounded,
+	// so the fast path returns exactly the same value as g_ascii_strtod().
+	if (digits == 0 || digits > 19 || mantissa > (G_GUINT64_CONSTANT(1) << 53) || fractionDigits > 22 ||
+	    *p == 'e' || *p == 'E' || *p == 'x' || *p == 'X' || *p == 'n' || *p == 'N' || *p == 'i' || *p == 'I')
+	{
+		return g_ascii_strtod(str, endPtr);
+	}
+
+	double value = (double) mantissa / POW10[fractionDigits];
+
+	if (endPtr)
+	{
+		*endPtr = (char*) p;
+	}
+
+	return negative ? -value : value;
+}
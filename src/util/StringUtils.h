@@ -30,4 +30,11 @@ public:
 	static string rtrim(string str);
 	static string trim(string str);
 	static bool iequals(string a, string b);
+
+	/**
+	 * Locale independent string to double conversion, with the same result as g_ascii_strtod().
+	 * Plain decimal numbers like the coordinates in the document files are converted without
+	 * calling g_ascii_strtod(), which is a lot faster.
+	 */
+	static double parseDouble(const char* str, char** endPtr);
 };
@@ -104,6 +104,14 @@ Path Util::getTmpDirSubfolder(Path subfolder)
 	return Util::ensureFolderExists(p);
 }
 
+Path Util::getCacheSubfolder(Path subfolder)
+{
+	Path p(g_get_user_cache_dir());
+	p /= "xournalpp";
+	p /= subfolder;
+	return Util::ensureFolderExists(p);
+}
+
 Path Util::ensureFolderExists(Path p)
 {
 	if (g_mkdir_with_parents(p.c_str(), 0700) == -1)
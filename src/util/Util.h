@@ -45,6 +45,11 @@ public:
 
 	static Path getTmpDirSubfolder(Path subfolder = "");
 
+	/**
+	 * A folder in the user cache directory (e.g. ~/.cache/xournalpp), for files which can be recreated
+	 */
+	static Path getCacheSubfolder(Path subfolder = "");
+
 	static Path ensureFolderExists(Path p);
 
 	/**
@@ -61,7 +61,6 @@ XOJ_DECLARE_TYPE(PrintHandler, 49);
 XOJ_DECLARE_TYPE(RecentManager, 50);
 XOJ_DECLARE_TYPE(SaveHandler, 51);
 XOJ_DECLARE_TYPE(ScrollHandler, 52);
-XOJ_DECLARE_TYPE(PdfCacheEntry, 53);
 XOJ_DECLARE_TYPE(PdfCache, 54);
 XOJ_DECLARE_TYPE(LoadHandler, 55);
 XOJ_DECLARE_TYPE(ParseException, 56);
@@ -126,7 +125,6 @@ XOJ_DECLARE_TYPE(XojPage, 114);
 XOJ_DECLARE_TYPE(LinkDestination, 115);
 XOJ_DECLARE_TYPE(Rectangle, 116);
 XOJ_DECLARE_TYPE(ScaleUndoAction, 117);
-XOJ_DECLARE_TYPE(Point, 118);
 XOJ_DECLARE_TYPE(Stroke, 119);
 XOJ_DECLARE_TYPE(TextUndoAction, 120);
 XOJ_DECLARE_TYPE(InsertUndoAction, 121);
@@ -153,7 +151,6 @@ XOJ_DECLARE_TYPE(GzOutputStream, 142);
 XOJ_DECLARE_TYPE(PageBackgroundChangedUndoAction, 143);
 XOJ_DECLARE_TYPE(PdfExportJob, 144);
 XOJ_DECLARE_TYPE(BackgroundImage, 145);
-XOJ_DECLARE_TYPE(PartList, 146);
 XOJ_DECLARE_TYPE(PageRangeEntry, 147);
 XOJ_DECLARE_TYPE(ImageExport, 148);
 XOJ_DECLARE_TYPE(ColorSelectImage, 149);
@@ -297,3 +294,19 @@ XOJ_DECLARE_TYPE(TouchDisableGdk, 287);
 XOJ_DECLARE_TYPE(DeviceClassConfigGui, 288);
 XOJ_DECLARE_TYPE(FloatingToolbox, 289);
 XOJ_DECLARE_TYPE(StavesBackgroundPainter, 290);
+XOJ_DECLARE_TYPE(PageTileCache, 291);
+XOJ_DECLARE_TYPE(SpatialIndex, 292);
+XOJ_DECLARE_TYPE(GzMemoryOutputStream, 293);
+XOJ_DECLARE_TYPE(AutosaveHandler, 294);
+XOJ_DECLARE_TYPE(PdfPrefetchJob, 295);
+XOJ_DECLARE_TYPE(ImageCache, 296);
+XOJ_DECLARE_TYPE(PolygonShape, 297);
+XOJ_DECLARE_TYPE(SearchIndex, 298);
+XOJ_DECLARE_TYPE(SearchIndexJob, 299);
+XOJ_DECLARE_TYPE(ThumbnailCache, 300);
+XOJ_DECLARE_TYPE(SettingsWriter, 301);
+XOJ_DECLARE_TYPE(UndoSpillFile, 302);
+XOJ_DECLARE_TYPE(LiveStrokeView, 303);
+XOJ_DECLARE_TYPE(BatchExport, 304);
+XOJ_DECLARE_TYPE(XojPdfFile, 305);
+XOJ_DECLARE_TYPE(XojPdfCopyExport, 306);
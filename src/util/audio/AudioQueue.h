@@ -13,18 +13,40 @@
 
 #include <XournalType.h>
 
-#include <vector>
-#include <deque>
-#include <mutex>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <mutex>
+#include <vector>
 
+/**
+ * Fixed size single producer / single consumer ring buffer
+ *
+ * push() and pop() copy whole blocks of samples, they never allocate memory, never
+ * take a lock and never wait, so they can be called from the PortAudio callbacks.
+ * Only one thread may push and only one thread may pop at the same time.
+ *
+ * The side which is not running in an audio callback can wait for the other side
+ * with waitForProducer() / waitForConsumer(). The audio callbacks do not notify
+ * the waiting thread, it polls the queue every POLL_INTERVAL instead.
+ */
 template <typename T>
-class AudioQueue : protected std::deque<T>
+class AudioQueue
 {
 public:
-	AudioQueue()
+	explicit AudioQueue(unsigned long minCapacity = DEFAULT_CAPACITY)
 	{
 		XOJ_INIT_TYPE(AudioQueue);
+
+		unsigned long capacity = 1;
+		while (capacity < minCapacity)
+		{
+			capacity <<= 1;
+		}
+
+		this->buffer.resize(capacity);
+		this->mask = capacity - 1;
 	}
 
 	~AudioQueue()
@@ -35,14 +57,17 @@ public:
 	}
 
 public:
+	/**
+	 * Clears the queue, neither the producer nor the consumer may be running
+	 */
 	void reset()
 	{
 		XOJ_CHECK_TYPE(AudioQueue);
 
-		this->popNotified = false;
-		this->pushNotified = false;
 		this->streamEnd = false;
-		this->clear();
+		this->readIndex = 0;
+		this->writeIndex = 0;
+		this->overrunCount = 0;
 
 		this->sampleRate = -1;
 		this->channels = 0;
@@ -52,31 +77,76 @@ public:
 	{
 		XOJ_CHECK_TYPE(AudioQueue);
 
-		return std::deque<T>::empty();
+		return size() == 0;
 	}
 
+	/**
+	 * Number of samples which can be popped
+	 */
 	unsigned long size()
 	{
 		XOJ_CHECK_TYPE(AudioQueue);
 
-		return std::deque<T>::size();
+		// Read the consumer position first, so the producer position cannot be behind
+		unsigned long read = this->readIndex.load(std::memory_order_acquire);
+		unsigned long write = this->writeIndex.load(std::memory_order_acquire);
+		return write - read;
 	}
 
-	void push(T* samples, unsigned long nSamples)
+	/**
+	 * Number of samples which can be pushed without dropping samples
+	 */
+	unsigned long freeSpace()
 	{
 		XOJ_CHECK_TYPE(AudioQueue);
 
-		for (unsigned long i = 0; i < nSamples; i++)
+		return capacity() - size();
+	}
+
+	unsigned long capacity()
+	{
+		XOJ_CHECK_TYPE(AudioQueue);
+
+		return this->mask + 1;
+	}
+
+	/**
+	 * Appends the samples. If there is not enough space, only as many whole frames
+	 * as fit are appended and the rest is counted as overrun.
+	 *
+	 * @return The number of samples appended
+	 */
+	unsigned long push(const T* samples, unsigned long nSamples)
+	{
+		XOJ_CHECK_TYPE(AudioQueue);
+
+		unsigned long write = this->writeIndex.load(std::memory_order_relaxed);
+		unsigned long read = this->readIndex.load(std::memory_order_acquire);
+
+		unsigned long count = std::min(nSamples, capacity() - (write - read));
+		if (this->channels > 1)
 		{
-			this->push_front(samples[i]);
+			count -= count % this->channels;
 		}
 
-		this->popNotified = false;
+		unsigned long start = write & this->mask;
+		unsigned long first = std::min(count, capacity() - start);
+		std::copy(samples, samples + first, this->buffer.begin() + start);
+		std::copy(samples + first, samples + count, this->buffer.begin());
+
+		this->writeIndex.store(write + count, std::memory_order_release);
 
-		this->pushNotified = true;
-		this->pushLockCondition.notify_one();
+		if (count < nSamples)
+		{
+			this->overrunCount.fetch_add(nSamples - count, std::memory_order_relaxed);
+		}
+
+		return count;
 	}
 
+	/**
+	 * Removes up to nSamples samples, but only whole frames
+	 */
 	void pop(T* returnBuffer, unsigned long& returnBufferLength, unsigned long nSamples)
 	{
 		XOJ_CHECK_TYPE(AudioQueue);
@@ -84,54 +154,71 @@ public:
 		if (this->channels == 0)
 		{
 			returnBufferLength = 0;
-
-			this->popNotified = true;
-			this->popLockCondition.notify_one();
-
 			return;
 		}
 
-		returnBufferLength = std::min(nSamples, this->size() - this->size() % this->channels);
-		for (long i = 0; i < returnBufferLength; i++)
-		{
-			returnBuffer[i] = this->back();
-			this->pop_back();
-		}
+		unsigned long read = this->readIndex.load(std::memory_order_relaxed);
+		unsigned long write = this->writeIndex.load(std::memory_order_acquire);
+		unsigned long available = write - read;
+
+		unsigned long count = std::min(nSamples, available);
+		count -= count % this->channels;
+
+		unsigned long start = read & this->mask;
+		unsigned long first = std::min(count, capacity() - start);
+		std::copy(this->buffer.begin() + start, this->buffer.begin() + start + first, returnBuffer);
+		std::copy(this->buffer.begin(), this->buffer.begin() + (count - first), returnBuffer + first);
 
-		this->pushNotified = false;
+		this->readIndex.store(read + count, std::memory_order_release);
 
-		this->popNotified = true;
-		this->popLockCondition.notify_one();
+		returnBufferLength = count;
+	}
+
+	/**
+	 * Number of samples dropped by push() since the last reset()
+	 */
+	unsigned long getOverrunCount()
+	{
+		XOJ_CHECK_TYPE(AudioQueue);
+
+		return this->overrunCount.load(std::memory_order_relaxed);
 	}
 
 	void signalEndOfStream()
 	{
 		XOJ_CHECK_TYPE(AudioQueue);
 
-		this->streamEnd = true;
-		this->pushNotified = true;
-		this->pushLockCondition.notify_one();
-		this->popNotified = true;
-		this->popLockCondition.notify_one();
+		this->streamEnd.store(true, std::memory_order_release);
+
+		// May be called from an audio callback, so the lock is not taken. A missed
+		// notification only delays the waiting thread until its next poll.
+		this->pushLockCondition.notify_all();
+		this->popLockCondition.notify_all();
 	}
 
+	/**
+	 * Waits until there are samples to pop or the stream has ended
+	 */
 	void waitForProducer(std::unique_lock<std::mutex>& lock)
 	{
 		XOJ_CHECK_TYPE(AudioQueue);
 
-		while (!this->pushNotified)
+		while (empty() && !hasStreamEnded())
 		{
-			this->pushLockCondition.wait(lock);
+			this->pushLockCondition.wait_for(lock, POLL_INTERVAL);
 		}
 	}
 
-	void waitForConsumer(std::unique_lock<std::mutex>& lock)
+	/**
+	 * Waits until nSamples samples can be pushed or the stream has ended
+	 */
+	void waitForConsumer(std::unique_lock<std::mutex>& lock, unsigned long nSamples)
 	{
 		XOJ_CHECK_TYPE(AudioQueue);
 
-		while (!this->popNotified)
+		while (freeSpace() < nSamples && !hasStreamEnded())
 		{
-			this->popLockCondition.wait(lock);
+			this->popLockCondition.wait_for(lock, POLL_INTERVAL);
 		}
 	}
 
@@ -139,9 +226,12 @@ public:
 	{
 		XOJ_CHECK_TYPE(AudioQueue);
 
-		return this->streamEnd;
+		return this->streamEnd.load(std::memory_order_acquire);
 	}
 
+	/**
+	 * Mutex for waitForProducer() / waitForConsumer(), never used by push() and pop()
+	 */
 	std::mutex& syncMutex()
 	{
 		XOJ_CHECK_TYPE(AudioQueue);
@@ -149,6 +239,9 @@ public:
 		return this->queueLock;
 	}
 
+	/**
+	 * Has to be set before the producer and the consumer are started
+	 */
 	void setAudioAttributes(double sampleRate, unsigned int channels)
 	{
 		this->sampleRate = sampleRate;
@@ -164,14 +257,34 @@ public:
 private:
 	XOJ_TYPE_ATTRIB;
 
+public:
+	/**
+	 * About 2.7s of stereo audio at 48 kHz
+	 */
+	static const unsigned long DEFAULT_CAPACITY = 1 << 18;
+
 protected:
+	static constexpr std::chrono::milliseconds POLL_INTERVAL = std::chrono::milliseconds(5);
+
+	std::vector<T> buffer;
+	unsigned long mask = 0;
+
+	/**
+	 * Total number of samples pushed / popped, the position in the buffer is index & mask
+	 */
+	std::atomic<unsigned long> writeIndex{0};
+	std::atomic<unsigned long> readIndex{0};
+
+	std::atomic<unsigned long> overrunCount{0};
+	std::atomic<bool> streamEnd{false};
+
 	std::mutex queueLock;
-	bool streamEnd = false;
 	std::condition_variable pushLockCondition;
-	bool pushNotified = false;
 	std::condition_variable popLockCondition;
-	bool popNotified = false;
 
 	double sampleRate = -1;
 	unsigned int channels = 0;
 };
+
+template <typename T>
+constexpr std::chrono::milliseconds AudioQueue<T>::POLL_INTERVAL;
@@ -97,6 +97,7 @@ bool PortAudioConsumer::startPlaying()
 	}
 
 	this->outputChannels = channels;
+	this->underflowCount = 0;
 	portaudio::DirectionSpecificStreamParameters outParams(*device, channels, portaudio::FLOAT32, true, device->defaultLowOutputLatency(), nullptr);
 	portaudio::StreamParameters params(portaudio::DirectionSpecificStreamParameters::null(), outParams, sampleRate, this->framesPerBuffer, paNoFlag);
 
@@ -143,10 +144,11 @@ int PortAudioConsumer::playCallback(const void* inputBuffer, void* outputBuffer,
 
 		if (outputBufferLength < framesPerBuffer * this->outputChannels)
 		{
-			// Show frame underflow warning if there are not enough samples and the stream is not yet finished
+			// Count the underflow if there are not enough samples and the stream is not yet finished,
+			// it is reported when the playback stops, as logging is not allowed in the audio callback
 			if (!this->audioQueue->hasStreamEnded())
 			{
-				g_warning("PortAudioConsumer: Not enough audio samples available to fill requested frame");
+				this->underflowCount++;
 			}
 
 			auto outputBufferImpl = (float*) outputBuffer;
@@ -209,4 +211,10 @@ void PortAudioConsumer::stopPlaying()
 			 */
 		}
 	}
+
+	if (this->underflowCount > 0)
+	{
+		g_warning("PortAudioConsumer: Not enough audio samples available to fill %d requested frames", this->underflowCount.load());
+		this->underflowCount = 0;
+	}
 }
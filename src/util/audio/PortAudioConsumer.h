@@ -20,6 +20,7 @@
 
 #include <portaudiocpp/PortAudioCpp.hxx>
 
+#include <atomic>
 #include <list>
 
 class AudioPlayer;
@@ -51,5 +52,10 @@ protected:
 
 	int outputChannels = 0;
 
+	/**
+	 * Number of callbacks which could not be filled with samples
+	 */
+	std::atomic<int> underflowCount{0};
+
 	portaudio::MemFunCallbackStream<PortAudioConsumer>* outputStream = nullptr;
 };
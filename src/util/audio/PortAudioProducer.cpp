@@ -119,7 +119,6 @@ int PortAudioProducer::recordCallback(const void* inputBuffer, void* outputBuffe
 									  const PaStreamCallbackTimeInfo* timeInfo, PaStreamCallbackFlags statusFlags)
 {
 	XOJ_CHECK_TYPE(PortAudioProducer);
-	std::unique_lock<std::mutex> lock(this->audioQueue->syncMutex());
 
 	if (statusFlags)
 	{
@@ -130,7 +129,8 @@ int PortAudioProducer::recordCallback(const void* inputBuffer, void* outputBuffe
 	{
 		unsigned long providedFrames = framesPerBuffer * this->inputChannels;
 
-		this->audioQueue->push((float*) inputBuffer, providedFrames);
+		// Never blocks, if the consumer is too slow the samples are dropped and counted by the queue
+		this->audioQueue->push((const float*) inputBuffer, providedFrames);
 	}
 	return paContinue;
 }
@@ -159,6 +159,11 @@ void PortAudioProducer::stopRecording()
 		}
 	}
 
+	if (this->audioQueue->getOverrunCount() > 0)
+	{
+		g_warning("PortAudioProducer: %lu audio samples were dropped, the consumer was too slow", this->audioQueue->getOverrunCount());
+	}
+
 	// Notify the consumer at the other side that ther will be no more data
 	this->audioQueue->signalEndOfStream();
 
@@ -46,28 +46,33 @@ bool VorbisConsumer::start(string filename)
 			{
 				std::unique_lock<std::mutex> lock(audioQueue->syncMutex());
 
-				float buffer[64 * channels];
+				std::vector<float> buffer(1024 * channels);
 				unsigned long bufferLength;
 				double audioGain = this->settings->getAudioGain();
 
-				while (!(this->stopConsumer || (audioQueue->hasStreamEnded() && audioQueue->empty())))
+				// The producer only pushes whole frames, so nothing is left once the stream has ended and no whole frame is queued
+				while (!(this->stopConsumer || (audioQueue->hasStreamEnded() && audioQueue->size() < channels)))
 				{
 					audioQueue->waitForProducer(lock);
 
 					while (!audioQueue->empty())
 					{
-						this->audioQueue->pop(buffer, bufferLength, 64 * channels);
+						this->audioQueue->pop(buffer.data(), bufferLength, buffer.size());
+						if (bufferLength == 0)
+						{
+							break;
+						}
 
 						// apply gain
 						if (audioGain != 1.0)
 						{
-							for (unsigned int i = 0; i < 64 * channels; ++i)
+							for (unsigned long i = 0; i < bufferLength; ++i)
 							{
 								buffer[i] = buffer[i] * audioGain;
 							}
 						}
 
-						sf_writef_float(sfFile, buffer, 64);
+						sf_writef_float(sfFile, buffer.data(), bufferLength / channels);
 					}
 				}
 
@@ -40,6 +40,8 @@ bool VorbisProducer::start(std::string filename, unsigned int timestamp)
 	this->producerThread = new std::thread(
 			[&, filename]
 			{
+				std::unique_lock<std::mutex> lock(this->audioQueue->syncMutex());
+
 				long numSamples = 1;
 				auto sampleBuffer = new float[1024 * this->sfInfo.channels];
 
@@ -47,10 +49,8 @@ bool VorbisProducer::start(std::string filename, unsigned int timestamp)
 				{
 					numSamples = sf_readf_float(this->sfFile, sampleBuffer, 1024);
 
-					while (this->audioQueue->size() >= this->sample_buffer_size && !this->audioQueue->hasStreamEnded() && !this->stopProducer)
-					{
-						std::this_thread::sleep_for(std::chrono::microseconds(100));
-					}
+					// Returns early when the stream is ended, AudioPlayer::stop() ends it before aborting
+					this->audioQueue->waitForConsumer(lock, static_cast<unsigned long>(1024 * this->sfInfo.channels));
 
 					this->audioQueue->push(sampleBuffer, static_cast<unsigned long>(numSamples * this->sfInfo.channels));
 				}
@@ -1,6 +1,12 @@
 #include "InputStreamException.h"
 
-const char* XML_VERSION_STR = "XojStrm1:";
+/**
+ * Version of the binary stream used by the clipboard and the undo history.
+ * Increase it if the layout of a serialized object changes, the stream of another version is rejected.
+ *
+ * 2: A stroke point is written as x, y, pressure (24 bytes)
+ */
+const char* XML_VERSION_STR = "XojStrm2:";
 
 InputStreamException::InputStreamException(string message, string filename, int line)
 {
@@ -208,37 +208,7 @@ void ObjectInputStream::readData(void** data, int* length)
 
 }
 
-class PngDatasource
-{
-public:
-
-	PngDatasource(char* start, int len)
-	{
-		this->data = start;
-		this->len = len;
-		this->pos = 0;
-	}
-
-	char* data;
-	int len;
-	int pos;
-};
-
-cairo_status_t cairoReadFunction(PngDatasource* obj, unsigned char* data, unsigned int length)
-{
-	for (unsigned int i = 0; i < length; i++, obj->pos++)
-	{
-		if (obj->pos >= obj->len)
-		{
-			return CAIRO_STATUS_READ_ERROR;
-		}
-		data[i] = obj->data[obj->pos];
-	}
-
-	return CAIRO_STATUS_SUCCESS;
-}
-
-cairo_surface_t* ObjectInputStream::readImage()
+string ObjectInputStream::readImage()
 {
 	XOJ_CHECK_TYPE(ObjectInputStream);
 
@@ -259,13 +229,11 @@ cairo_surface_t* ObjectInputStream::readImage()
 		throw InputStreamException("End reached, but try to read an image", __FILE__, __LINE__);
 	}
 
-	PngDatasource source(this->str->str + this->pos, len);
-	//cairo_surface_t * img = cairo_image_surface_create_from_png_stream((cairo_read_func_t) cairoReadFunction, &source);
-	cairo_surface_t* img = cairo_image_surface_create_from_png_stream((cairo_read_func_t) &cairoReadFunction, &source);
+	string png(this->str->str + this->pos, len);
 
 	this->pos += len;
 
-	return img;
+	return png;
 }
 
 void ObjectInputStream::checkType(char type)
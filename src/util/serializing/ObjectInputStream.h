@@ -37,7 +37,11 @@ public:
 	string readString();
 
 	void readData(void** data, int* len);
-	cairo_surface_t* readImage();
+
+	/**
+	 * @return The PNG encoded image
+	 */
+	string readImage();
 
 private:
 	void checkType(char type);
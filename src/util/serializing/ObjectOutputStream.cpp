@@ -95,26 +95,16 @@ void ObjectOutputStream::writeData(const void* data, int len, int width)
 	}
 }
 
-static cairo_status_t cairoWriteFunction(GString* string, const unsigned char* data, unsigned int length)
-{
-	g_string_append_len(string, (const gchar*) data, length);
-	return CAIRO_STATUS_SUCCESS;
-}
-
-void ObjectOutputStream::writeImage(cairo_surface_t* img)
+void ObjectOutputStream::writeImage(const string& png)
 {
 	XOJ_CHECK_TYPE(ObjectOutputStream);
 
-	GString* imgStr = g_string_sized_new(102400);
-
-	cairo_surface_write_to_png_stream(img, (cairo_write_func_t) &cairoWriteFunction, imgStr);
+	gsize len = png.length();
 
 	this->encoder->addStr("_m");
-	this->encoder->addData(&imgStr->len, sizeof(gsize));
-
-	this->encoder->addData(imgStr->str, imgStr->len);
+	this->encoder->addData(&len, sizeof(gsize));
 
-	g_string_free(imgStr, true);
+	this->encoder->addData(png.data(), len);
 }
 
 GString* ObjectOutputStream::getStr()
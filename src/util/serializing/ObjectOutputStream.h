@@ -35,7 +35,11 @@ public:
 	void writeString(const string& s);
 
 	void writeData(const void* data, int len, int width);
-	void writeImage(cairo_surface_t* img);
+
+	/**
+	 * @param png The PNG encoded image
+	 */
+	void writeImage(const string& png);
 
 	GString* getStr();
 
@@ -7,12 +7,16 @@
 #include "control/tools/EditSelection.h"
 #include "control/tools/Selection.h"
 #include "model/BackgroundImage.h"
+#include "model/ImageCache.h"
 #include "model/eraser/EraseableStroke.h"
 #include "model/Layer.h"
+#include "pdf/popplerapi/PopplerGlibDocument.h"
 
 #include <config.h>
 #include <config-debug.h>
 
+#include <cmath>
+
 
 DocumentView::DocumentView()
 {
@@ -115,7 +119,22 @@ void DocumentView::drawImage(cairo_t* cr, Image* i)
 	cairo_matrix_t defaultMatrix = { 0 };
 	cairo_get_matrix(cr, &defaultMatrix);
 
-	cairo_surface_t* img = i->getImage();
+	// On screen the smallest sufficient mipmap level is painted, exports and prints get the full image
+	int level = 0;
+	if (cairo_surface_get_type(cairo_get_target(cr)) == CAIRO_SURFACE_TYPE_IMAGE)
+	{
+		double dx = i->getElementWidth();
+		double dy = 0;
+		cairo_user_to_device_distance(cr, &dx, &dy);
+		level = ImageCache::levelForSize(i->getImageWidth(), std::hypot(dx, dy));
+	}
+
+	cairo_surface_t* img = i->getImage(level);
+	if (img == NULL)
+	{
+		return;
+	}
+
 	int width = cairo_image_surface_get_width(img);
 	int height = cairo_image_surface_get_height(img);
 
@@ -130,6 +149,7 @@ void DocumentView::drawImage(cairo_t* cr, Image* i)
 	cairo_paint(cr);
 
 	cairo_set_matrix(cr, &defaultMatrix);
+	cairo_surface_destroy(img);
 }
 
 void DocumentView::drawTexImage(cairo_t* cr, TexImage* texImage)
@@ -144,8 +164,13 @@ void DocumentView::drawTexImage(cairo_t* cr, TexImage* texImage)
 
 	if (pdf != nullptr)
 	{
+		// The same element may be drawn by a render and a preview job at the same time
+		GMutex* lock = PopplerGlibDocument::getLock(pdf);
+		g_mutex_lock(lock);
+
 		if (poppler_document_get_n_pages(pdf) < 1)
 		{
+			g_mutex_unlock(lock);
 			g_warning("Got latex PDf without pages!: %s", texImage->getText().c_str());
 			return;
 		}
@@ -162,6 +187,9 @@ void DocumentView::drawTexImage(cairo_t* cr, TexImage* texImage)
 		cairo_translate(cr, texImage->getX(), texImage->getY());
 		cairo_scale(cr, xFactor, yFactor);
 		poppler_page_render(page, cr);
+		g_object_unref(page);
+
+		g_mutex_unlock(lock);
 	}
 	else if (img != nullptr)
 	{
@@ -215,11 +243,20 @@ void DocumentView::drawLayer(cairo_t* cr, Layer* l)
 
 	cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
 
+	// Only the elements in the limited area are drawn, they are looked up in the index of the layer
+	vector<Element*> areaElements;
+	vector<Element*>* elements = l->getElements();
+	if (this->lX != -1)
+	{
+		areaElements = l->getElementsInArea(this->lX, this->lY, this->lWidth, this->lHeight);
+		elements = &areaElements;
+	}
+
 #ifdef DEBUG_SHOW_REPAINT_BOUNDS
 	int drawn = 0;
 	int notDrawn = 0;
 #endif // DEBUG_SHOW_REPAINT_BOUNDS
-	for (Element* e : *l->getElements())
+	for (Element* e : *elements)
 	{
 #ifdef DEBUG_SHOW_ELEMENT_BOUNDS
 		cairo_set_source_rgb(cr, 0, 1, 0);
@@ -229,33 +266,14 @@ void DocumentView::drawLayer(cairo_t* cr, Layer* l)
 #endif // DEBUG_SHOW_REPAINT_BOUNDS
 		//cairo_new_path(cr);
 
-		if (this->lX != -1)
-		{
-			if (e->intersectsArea(this->lX, this->lY, this->width, this->height))
-			{
-				drawElement(cr, e);
-#ifdef DEBUG_SHOW_REPAINT_BOUNDS
-				drawn++;
-#endif // DEBUG_SHOW_REPAINT_BOUNDS
-			}
-#ifdef DEBUG_SHOW_REPAINT_BOUNDS
-			else
-			{
-				notDrawn++;
-			}
-#endif // DEBUG_SHOW_REPAINT_BOUNDS
-
-		}
-		else
-		{
 #ifdef DEBUG_SHOW_REPAINT_BOUNDS
-			drawn++;
+		drawn++;
 #endif // DEBUG_SHOW_REPAINT_BOUNDS
-			drawElement(cr, e);
-		}
+		drawElement(cr, e);
 	}
 
 #ifdef DEBUG_SHOW_REPAINT_BOUNDS
+	notDrawn = l->getElements()->size() - drawn;
 	g_message("DBG:DocumentView: draw %i / not draw %i", drawn, notDrawn);
 #endif // DEBUG_SHOW_REPAINT_BOUNDS
 }
@@ -0,0 +1,270 @@
+#include "LiveStrokeView.h"
+
+#include "DocumentView.h"
+
+#include "model/Stroke.h"
+
+#include <algorithm>
+#include <cmath>
+
+LiveStrokeView::LiveStrokeView(Stroke* s, int width, int height, double scale)
+ : s(s),
+   width(width),
+   height(height),
+   scale(scale)
+{
+	XOJ_INIT_TYPE(LiveStrokeView);
+
+	// New image surfaces are transparent
+	this->surfMask = cairo_image_surface_create(CAIRO_FORMAT_A8, width, height);
+	this->crMask = cairo_create(this->surfMask);
+	cairo_scale(this->crMask, scale, scale);
+
+	cairo_set_line_join(this->crMask, CAIRO_LINE_JOIN_ROUND);
+	cairo_set_line_cap(this->crMask, CAIRO_LINE_CAP_ROUND);
+
+	if (s->getFill() != -1 && s->getToolType() != STROKE_TOOL_HIGHLIGHTER)
+	{
+		this->surfFill = cairo_image_surface_create(CAIRO_FORMAT_A8, width, height);
+		this->winding.assign((size_t) width * height, 0);
+	}
+}
+
+LiveStrokeView::~LiveStrokeView()
+{
+	XOJ_CHECK_TYPE(LiveStrokeView);
+
+	cairo_destroy(this->crMask);
+	cairo_surface_destroy(this->surfMask);
+
+	if (this->surfFill)
+	{
+		cairo_surface_destroy(this->surfFill);
+	}
+
+	XOJ_RELEASE_TYPE(LiveStrokeView);
+}
+
+void LiveStrokeView::applyDashed()
+{
+	XOJ_CHECK_TYPE(LiveStrokeView);
+
+	const double* dashes = NULL;
+	int dashCount = 0;
+	if (s->getLineStyle().getDashes(dashes, dashCount))
+	{
+		cairo_set_dash(this->crMask, dashes, dashCount, this->dashOffset);
+	}
+}
+
+Range LiveStrokeView::drawLastSegment()
+{
+	XOJ_CHECK_TYPE(LiveStrokeView);
+
+	this->visitedPoints = 0;
+
+	int count = s->getPointCount();
+	Point p = getPoint(count - 1);
+	Range range(p.x, p.y);
+
+	if (count < 2)
+	{
+		return range;
+	}
+
+	Point last = getPoint(count - 2);
+	range.addPoint(last.x, last.y);
+
+	double width = s->getWidth();
+	if (last.z != Point::NO_PRESSURE && s->getToolType() != STROKE_TOOL_HIGHLIGHTER)
+	{
+		width = last.z;
+	}
+
+	cairo_set_operator(this->crMask, CAIRO_OPERATOR_OVER);
+	cairo_set_source_rgba(this->crMask, 1, 1, 1, 1);
+	cairo_set_line_width(this->crMask, width);
+	applyDashed();
+
+	cairo_move_to(this->crMask, last.x, last.y);
+	cairo_line_to(this->crMask, p.x, p.y);
+	cairo_stroke(this->crMask);
+
+	this->dashOffset += last.lineLengthTo(p);
+
+	if (this->surfFill)
+	{
+		Point first = getPoint(0);
+		fillTriangle(first, last, p);
+		range.addPoint(first.x, first.y);
+	}
+
+	range.addPoint(range.getX() - width, range.getY() - width);
+	range.addPoint(range.getX2() + width, range.getY2() + width);
+
+	return range;
+}
+
+Point LiveStrokeView::getPoint(int index)
+{
+	XOJ_CHECK_TYPE(LiveStrokeView);
+
+	this->visitedPoints++;
+	return s->getPoint(index);
+}
+
+/**
+ * Division rounding up, the divisor has to be positive
+ */
+static gint64 ceilDiv(gint64 a, gint64 b)
+{
+	return a >= 0 ? (a + b - 1) / b : -(-a / b);
+}
+
+void LiveStrokeView::fillTriangle(const Point& a, const Point& b, const Point& c)
+{
+	XOJ_CHECK_TYPE(LiveStrokeView);
+
+	// The device coordinates are rounded to 1/256 pixel, so the winding is computed exactly: the edge
+	// from the first point to the previous point is added by the last triangle and removed by this one,
+	// and both count the same pixels. Else the fan edges would leave a trace of wrong pixels.
+	const gint64 sub = 256;
+	const Point* points[] = { &a, &b, &c };
+	gint64 x[3];
+	gint64 y[3];
+	for (int i = 0; i < 3; i++)
+	{
+		x[i] = std::llround(points[i]->x * this->scale * sub);
+		y[i] = std::llround(points[i]->y * this->scale * sub);
+	}
+
+	// The rows with their pixel center within the triangle
+	gint64 minY = std::min(y[0], std::min(y[1], y[2]));
+	gint64 maxY = std::max(y[0], std::max(y[1], y[2]));
+	int row1 = (int) std::max((gint64) 0, ceilDiv(minY - sub / 2, sub));
+	int row2 = (int) std::min((gint64) this->height, ceilDiv(maxY - sub / 2, sub));
+
+	cairo_surface_flush(this->surfFill);
+	unsigned char* data = cairo_image_surface_get_data(this->surfFill);
+	int stride = cairo_image_surface_get_stride(this->surfFill);
+
+	int col1 = this->width;
+	int col2 = 0;
+
+	for (int row = row1; row < row2; row++)
+	{
+		gint64 yc = row * sub + sub / 2;
+
+		// A row crosses the edges of a triangle twice. Each crossing adds its direction to the
+		// winding of the pixels left of it, so the pixels between the crossings are changed.
+		int crossCol[2];
+		int crossDir[2];
+		int crossings = 0;
+
+		for (int i = 0; i < 3 && crossings < 2; i++)
+		{
+			int j = (i + 1) % 3;
+			int from = i;
+			int to = j;
+			int dir = 1;
+			if (y[j] < y[i])
+			{
+				std::swap(from, to);
+				dir = -1;
+			}
+
+			// Half open, so a row through a vertex crosses only one of its edges
+			if (yc < y[from] || yc >= y[to])
+			{
+				continue;
+			}
+
+			// The pixel centers left of the crossing: col * sub + sub / 2 < crossing x
+			gint64 dy = y[to] - y[from];
+			gint64 crossX = x[from] * dy + (yc - y[from]) * (x[to] - x[from]);
+			gint64 col = ceilDiv(crossX - sub / 2 * dy, sub * dy);
+
+			crossCol[crossings] = (int) std::max((gint64) 0, std::min((gint64) this->width, col));
+			crossDir[crossings] = dir;
+			crossings++;
+		}
+
+		if (crossings != 2 || crossCol[0] == crossCol[1])
+		{
+			continue;
+		}
+
+		int from = std::min(crossCol[0], crossCol[1]);
+		int to = std::max(crossCol[0], crossCol[1]);
+		int dir = crossCol[0] > crossCol[1] ? crossDir[0] : crossDir[1];
+
+		short* w = &this->winding[(size_t) row * this->width];
+		unsigned char* pixel = data + row * stride;
+		for (int col = from; col < to; col++)
+		{
+			w[col] += dir;
+			pixel[col] = w[col] != 0 ? 255 : 0;
+		}
+
+		col1 = std::min(col1, from);
+		col2 = std::max(col2, to);
+	}
+
+	if (col1 < col2)
+	{
+		cairo_surface_mark_dirty_rectangle(this->surfFill, col1, row1, col2 - col1, row2 - row1);
+	}
+}
+
+void LiveStrokeView::drawStroke(DocumentView& view)
+{
+	XOJ_CHECK_TYPE(LiveStrokeView);
+
+	view.drawStroke(this->crMask, s, 0, 1, true, true);
+}
+
+void LiveStrokeView::paint(cairo_t* cr)
+{
+	XOJ_CHECK_TYPE(LiveStrokeView);
+
+	if (this->surfFill)
+	{
+		cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+		DocumentView::applyColor(cr, (Element*) s, s->getFill());
+		cairo_mask_surface(cr, this->surfFill, 0, 0);
+	}
+
+	DocumentView::applyColor(cr, s);
+
+	if (s->getToolType() == STROKE_TOOL_HIGHLIGHTER)
+	{
+		cairo_set_operator(cr, CAIRO_OPERATOR_MULTIPLY);
+	}
+	else
+	{
+		cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+	}
+
+	cairo_mask_surface(cr, this->surfMask, 0, 0);
+}
+
+cairo_surface_t* LiveStrokeView::getMask()
+{
+	XOJ_CHECK_TYPE(LiveStrokeView);
+
+	return this->surfMask;
+}
+
+cairo_surface_t* LiveStrokeView::getFillMask()
+{
+	XOJ_CHECK_TYPE(LiveStrokeView);
+
+	return this->surfFill;
+}
+
+int LiveStrokeView::getVisitedPoints()
+{
+	XOJ_CHECK_TYPE(LiveStrokeView);
+
+	return this->visitedPoints;
+}
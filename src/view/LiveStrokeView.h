@@ -0,0 +1,124 @@
+/*
+ * Xournal++
+ *
+ * Draws the stroke which is currently drawn
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include "model/Point.h"
+
+#include <Range.h>
+#include <XournalType.h>
+
+#include <gtk/gtk.h>
+
+#include <vector>
+
+class DocumentView;
+class Stroke;
+
+/**
+ * The stroke is drawn into masks with the size of the page view, one segment for each
+ * new point, so adding a point does not take longer for a longer stroke.
+ *
+ * Dashes continue with the length of the stroke drawn so far as dash offset.
+ *
+ * The fill is drawn into a separate mask. The winding number of the stroke around each pixel
+ * is kept, a new point adds the winding of the triangle of the first, the previous and the new
+ * point, so only the pixels of this triangle are updated, and no other point is read. The fill
+ * is not antialiased while drawing, its edge is covered by the stroke.
+ */
+class LiveStrokeView
+{
+public:
+	/**
+	 * @param width the width of the masks in pixel
+	 * @param height the height of the masks in pixel
+	 * @param scale pixel per page unit
+	 */
+	LiveStrokeView(Stroke* s, int width, int height, double scale);
+	virtual ~LiveStrokeView();
+
+public:
+	/**
+	 * Draws the segment to the last point of the stroke
+	 *
+	 * @return The changed area, in page coordinates
+	 */
+	Range drawLastSegment();
+
+	/**
+	 * Draws the whole stroke over the masks
+	 */
+	void drawStroke(DocumentView& view);
+
+	/**
+	 * Paints the stroke, the context has to be in pixel of the masks
+	 */
+	void paint(cairo_t* cr);
+
+	cairo_surface_t* getMask();
+
+	/**
+	 * @return NULL if the stroke is not filled while drawing
+	 */
+	cairo_surface_t* getFillMask();
+
+	/**
+	 * @return The count of stroke points read by the last drawLastSegment()
+	 */
+	int getVisitedPoints();
+
+private:
+	void applyDashed();
+
+	/**
+	 * Reads a point of the stroke and counts it
+	 */
+	Point getPoint(int index);
+
+	/**
+	 * Adds the winding of the triangle to the pixels of the fill mask, in page coordinates
+	 */
+	void fillTriangle(const Point& a, const Point& b, const Point& c);
+
+private:
+	XOJ_TYPE_ATTRIB;
+
+	Stroke* s;
+
+	cairo_surface_t* surfMask = NULL;
+	cairo_t* crMask = NULL;
+
+	/**
+	 * Highlighter strokes are filled only when they are finished, they have no fill mask
+	 */
+	cairo_surface_t* surfFill = NULL;
+
+	/**
+	 * The winding number of the stroke, closed to its first point, around the center of each pixel
+	 * of the fill mask, empty if there is no fill mask
+	 */
+	std::vector<short> winding;
+
+	int width = 0;
+	int height = 0;
+
+	/**
+	 * Pixel per page unit
+	 */
+	double scale = 1;
+
+	int visitedPoints = 0;
+
+	/**
+	 * The length of the stroke up to the last drawn point
+	 */
+	double dashOffset = 0;
+};
@@ -8,13 +8,13 @@ PdfView::PdfView() { }
 PdfView::~PdfView() { }
 
 void PdfView::drawPage(PdfCache* cache, XojPdfPageSPtr popplerPage, cairo_t* cr,
-					   double zoom, double width, double height, bool forPrinting)
+					   double zoom, double width, double height, bool forPrinting, bool lowResolution)
 {
 	if (popplerPage)
 	{
 		if (cache && !forPrinting)
 		{
-			cache->render(cr, popplerPage, zoom);
+			cache->render(cr, popplerPage, zoom, lowResolution);
 		}
 		else
 		{
@@ -23,6 +23,10 @@ private:
 	virtual ~PdfView();
 
 public:
+	/**
+	 * @param lowResolution Paint a cached render of another zoom scaled if the page is not
+	 *                      rendered for this zoom yet, see PdfCache::render
+	 */
 	static void drawPage(PdfCache* cache, XojPdfPageSPtr popplerPage, cairo_t* cr,
-						 double zoom, double width, double height, bool forPrinting = false);
+						 double zoom, double width, double height, bool forPrinting = false, bool lowResolution = false);
 };
@@ -13,6 +13,32 @@ TextView::~TextView() { }
 
 static int textDpi = 72;
 
+class TextLayout
+{
+public:
+	PangoLayout* layout = NULL;
+
+	/**
+	 * What the layout was shaped for
+	 */
+	string text;
+	string fontName;
+	double fontSize = 0;
+	int dpi = 0;
+};
+
+/**
+ * Layouts are used by the render jobs and the UI thread, Pango objects must not be used by two
+ * threads at the same time
+ */
+static GMutex layoutMutex;
+
+/**
+ * The context of all cached layouts, independent of any cairo target: the layouts are shaped
+ * without transformation, like initPango() does
+ */
+static PangoContext* layoutContext = NULL;
+
 void TextView::setDpi(int dpi)
 {
 	textDpi = dpi;
@@ -44,82 +70,135 @@ void TextView::updatePangoFont(PangoLayout* layout, Text* t)
 	pango_font_description_free(desc);
 }
 
-void TextView::drawText(cairo_t* cr, Text* t)
+void TextView::releaseLayout(Text* t)
 {
-	cairo_save(cr);
+	g_mutex_lock(&layoutMutex);
 
-	cairo_translate(cr, t->getX(), t->getY());
+	if (t->layout)
+	{
+		g_object_unref(t->layout->layout);
+		delete t->layout;
+		t->layout = NULL;
+	}
 
-	PangoLayout* layout = initPango(cr, t);
-	string str = t->getText();
-	pango_layout_set_text(layout, str.c_str(), str.length());
+	g_mutex_unlock(&layoutMutex);
+}
 
-	pango_cairo_show_layout(cr, layout);
+PangoLayout* TextView::getLayoutLocked(Text* t)
+{
+	if (layoutContext == NULL)
+	{
+		PangoFontMap* fontMap = pango_cairo_font_map_new();
+		layoutContext = pango_font_map_create_context(fontMap);
+		g_object_unref(fontMap);
+	}
 
-	g_object_unref(layout);
+	TextLayout* cached = t->layout;
+	if (cached == NULL)
+	{
+		cached = t->layout = new TextLayout();
+	}
 
-	cairo_restore(cr);
+	string text = t->getText();
+	string fontName = t->getFont().getName();
+	double fontSize = t->getFont().getSize();
+
+	if (cached->layout && cached->dpi == textDpi && cached->fontSize == fontSize &&
+		cached->fontName == fontName && cached->text == text)
+	{
+		return cached->layout;
+	}
+
+	if (cached->layout)
+	{
+		g_object_unref(cached->layout);
+	}
+
+	if (pango_cairo_context_get_resolution(layoutContext) != textDpi)
+	{
+		pango_cairo_context_set_resolution(layoutContext, textDpi);
+	}
+
+	cached->layout = pango_layout_new(layoutContext);
+	updatePangoFont(cached->layout, t);
+	pango_layout_set_text(cached->layout, text.c_str(), text.length());
+
+	cached->text = text;
+	cached->fontName = fontName;
+	cached->fontSize = fontSize;
+	cached->dpi = textDpi;
+
+	return cached->layout;
 }
 
-vector<XojPdfRectangle> TextView::findText(Text* t, string& search)
+void TextView::drawText(cairo_t* cr, Text* t)
 {
-	cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
-	cairo_t* cr = cairo_create(surface);
+	cairo_save(cr);
 
-	PangoLayout* layout = initPango(cr, t);
-	string str = t->getText();
-	pango_layout_set_text(layout, str.c_str(), str.length());
+	cairo_translate(cr, t->getX(), t->getY());
 
+	g_mutex_lock(&layoutMutex);
+	pango_cairo_show_layout(cr, getLayoutLocked(t));
+	g_mutex_unlock(&layoutMutex);
 
-	string text = t->getText();
+	cairo_restore(cr);
+}
 
+vector<XojPdfRectangle> TextView::findText(Text* t, string& search)
+{
+	string text = StringUtils::toLowerCase(t->getText());
 	string srch = StringUtils::toLowerCase(search);
 
+	vector<std::pair<int, int>> ranges;
+	for (size_t pos = text.find(srch); pos != string::npos; pos = text.find(srch, pos + 1))
+	{
+		ranges.push_back(std::make_pair(pos, pos + srch.length()));
+	}
+
+	return getTextRectangles(t, ranges);
+}
+
+vector<XojPdfRectangle> TextView::getTextRectangles(Text* t, const vector<std::pair<int, int>>& ranges)
+{
 	vector<XojPdfRectangle> list;
+	if (ranges.empty())
+	{
+		return list;
+	}
 
-	int pos = -1;
-	do
+	g_mutex_lock(&layoutMutex);
+	PangoLayout* layout = getLayoutLocked(t);
+
+	for (const std::pair<int, int>& range : ranges)
 	{
-		pos = StringUtils::toLowerCase(text).find(srch, pos + 1);
-		if (pos != -1)
-		{
-			XojPdfRectangle mark;
-			PangoRectangle rect = { 0 };
-			pango_layout_index_to_pos(layout, pos, &rect);
-			mark.x1 = ((double) rect.x) / PANGO_SCALE + t->getX();
-			mark.y1 = ((double) rect.y) / PANGO_SCALE + t->getY();
-
-			pango_layout_index_to_pos(layout, pos + srch.length(), &rect);
-			mark.x2 = ((double) rect.x + rect.width) / PANGO_SCALE + t->getX();
-			mark.y2 = ((double) rect.y + rect.height) / PANGO_SCALE + t->getY();
-
-			list.push_back(mark);
-		}
+		XojPdfRectangle mark;
+		PangoRectangle rect = { 0 };
+		pango_layout_index_to_pos(layout, range.first, &rect);
+		mark.x1 = ((double) rect.x) / PANGO_SCALE + t->getX();
+		mark.y1 = ((double) rect.y) / PANGO_SCALE + t->getY();
+
+		pango_layout_index_to_pos(layout, range.second, &rect);
+		mark.x2 = ((double) rect.x + rect.width) / PANGO_SCALE + t->getX();
+		mark.y2 = ((double) rect.y + rect.height) / PANGO_SCALE + t->getY();
+
+		list.push_back(mark);
 	}
-	while (pos != -1);
 
-	g_object_unref(layout);
-	cairo_surface_destroy(surface);
-	cairo_destroy(cr);
+	g_mutex_unlock(&layoutMutex);
 
 	return list;
 }
 
 void TextView::calcSize(Text* t, double& width, double& height)
 {
-	cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
-	cairo_t* cr = cairo_create(surface);
+	g_mutex_lock(&layoutMutex);
 
-	PangoLayout* layout = initPango(cr, t);
-	string str = t->getText();
-	pango_layout_set_text(layout, str.c_str(), str.length());
 	int w = 0;
 	int h = 0;
-	pango_layout_get_size(layout, &w, &h);
+	pango_layout_get_size(getLayoutLocked(t), &w, &h);
+
+	g_mutex_unlock(&layoutMutex);
+
 	width = ((double) w) / PANGO_SCALE;
 	height = ((double) h) / PANGO_SCALE;
-	g_object_unref(layout);
-
-	cairo_surface_destroy(surface);
-	cairo_destroy(cr);
 }
@@ -17,6 +17,11 @@
 
 class Text;
 
+/**
+ * The shaped layout of a Text, cached in the Text across draws, size calculation and search
+ */
+class TextLayout;
+
 class TextView
 {
 private:
@@ -41,6 +46,16 @@ public:
 	 */
 	static vector<XojPdfRectangle> findText(Text* t, string& text);
 
+	/**
+	 * The rectangles of ranges of the text, the ranges are byte offsets (start, end)
+	 */
+	static vector<XojPdfRectangle> getTextRectangles(Text* t, const vector<std::pair<int, int>>& ranges);
+
+	/**
+	 * Frees the cached layout of the Text, called when the Text is deleted
+	 */
+	static void releaseLayout(Text* t);
+
 	/**
 	 * Initialize a Pango layout
 	 */
@@ -50,4 +65,11 @@ public:
 	 * Sets the font name from Text model
 	 */
 	static void updatePangoFont(PangoLayout* layout, Text* t);
+
+private:
+	/**
+	 * The cached layout of the Text, shaped again only if the text, the font or the DPI changed.
+	 * The layout mutex has to be held while the layout is used.
+	 */
+	static PangoLayout* getLayoutLocked(Text* t);
 };
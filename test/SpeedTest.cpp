@@ -12,6 +12,7 @@
 
 #include <StringUtils.h>
 
+#include <chrono>
 #include <ctime>
 using std::clock;
 #include <functional>
@@ -33,20 +34,26 @@ public:
 		cout << endl << "== Speed test of " << target << " ==" << endl;
 		this->target = target;
 		begin = clock();
+		wallBegin = std::chrono::steady_clock::now();
 	}
 	
 	void endTest()
 	{
 		clock_t end = clock();
+		std::chrono::duration<double> wall = std::chrono::steady_clock::now() - wallBegin;
 
 		printMemory();
 
 		double elapsed_secs = double(end - begin) / CLOCKS_PER_SEC;
 		cout << "Time to " << target << ": " << std::to_string(elapsed_secs) << endl;
+
+		// The CPU time of all threads, multithreaded code needs the real time
+		cout << "Wall time to " << target << ": " << std::to_string(wall.count()) << endl;
 	}
 	
 private:
 	clock_t begin;
+	std::chrono::steady_clock::time_point wallBegin;
 	string target;
 	
 	static void printMemory()
@@ -0,0 +1,143 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include "control/jobs/ImageExport.h"
+#include "control/jobs/ProgressListener.h"
+#include "control/xojfile/LoadHandler.h"
+#include "TestDocument.h"
+#include <config-test.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <glib/gstdio.h>
+
+class ImageExportTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE(ImageExportTest);
+
+	CPPUNIT_TEST(testExportThreads);
+	CPPUNIT_TEST(testExportThreadsPdfBackground);
+
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp()
+	{
+	}
+
+	void tearDown()
+	{
+	}
+
+	/**
+	 * The pages rendered in parallel are the same images as rendered by one thread
+	 */
+	void testExportThreads()
+	{
+		string file = TestDocument::write(9, 20, 50);
+
+		LoadHandler loader;
+		Document* doc = loader.loadDocument(file);
+		CPPUNIT_ASSERT(doc != NULL);
+		g_unlink(file.c_str());
+
+		PageRangeVector exportRange;
+		exportRange.push_back(new PageRangeEntry(0, 8));
+		DummyProgressListener progress;
+
+		for (int threads : { 1, 4 })
+		{
+			string png = file + "-" + std::to_string(threads) + ".png";
+
+			ImageExport imgExport(doc, png, EXPORT_GRAPHICS_PNG, false, exportRange);
+			imgExport.setPngDpi(30);
+			imgExport.setThreadCount(threads);
+			imgExport.exportGraphics(&progress);
+			CPPUNIT_ASSERT_EQUAL(string(""), imgExport.getLastErrorMsg());
+
+			vector<double> pageTimes = imgExport.getPageTimes();
+			CPPUNIT_ASSERT_EQUAL((size_t) 9, pageTimes.size());
+			for (double t : pageTimes)
+			{
+				CPPUNIT_ASSERT(t >= 0);
+			}
+		}
+
+		for (int page = 1; page <= 9; page++)
+		{
+			string single = file + "-1-" + std::to_string(page) + ".png";
+			string parallel = file + "-4-" + std::to_string(page) + ".png";
+
+			CPPUNIT_ASSERT(TestDocument::readFile(single) == TestDocument::readFile(parallel));
+
+			g_unlink(single.c_str());
+			g_unlink(parallel.c_str());
+		}
+
+		delete exportRange[0];
+	}
+
+	/**
+	 * All threads render the background pages of the same PDF document
+	 */
+	void testExportThreadsPdfBackground()
+	{
+		LoadHandler loader;
+		Document* doc = loader.loadDocument(GET_TESTFILE("packaged_xopp/pdfBackground/new.xopp"));
+		CPPUNIT_ASSERT(doc != NULL);
+		CPPUNIT_ASSERT(doc->isPdfDocumentLoaded());
+
+		int count = doc->getPageCount();
+
+		gchar* path = NULL;
+		int fd = g_file_open_tmp("xournalpp_export_XXXXXX.png", &path, NULL);
+		CPPUNIT_ASSERT(fd != -1);
+		g_close(fd, NULL);
+		g_unlink(path);
+		string file = path;
+		g_free(path);
+
+		PageRangeVector exportRange;
+		exportRange.push_back(new PageRangeEntry(0, count - 1));
+		DummyProgressListener progress;
+
+		// Export each page several times, so the threads render the PDF at the same time
+		for (int round = 0; round < 5; round++)
+		{
+			for (int threads : { 1, 4 })
+			{
+				string png = file + "-" + std::to_string(threads) + ".png";
+
+				ImageExport imgExport(doc, png, EXPORT_GRAPHICS_PNG, false, exportRange);
+				imgExport.setPngDpi(30);
+				imgExport.setThreadCount(threads);
+				imgExport.exportGraphics(&progress);
+				CPPUNIT_ASSERT_EQUAL(string(""), imgExport.getLastErrorMsg());
+			}
+
+			for (int page = 1; page <= count; page++)
+			{
+				string single = file + "-1-" + std::to_string(page) + ".png";
+				string parallel = file + "-4-" + std::to_string(page) + ".png";
+
+				CPPUNIT_ASSERT(TestDocument::readFile(single) == TestDocument::readFile(parallel));
+
+				g_unlink(single.c_str());
+				g_unlink(parallel.c_str());
+			}
+		}
+
+		delete exportRange[0];
+	}
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(ImageExportTest);
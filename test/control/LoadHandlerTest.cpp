@@ -10,6 +10,8 @@
  */
 
 #include "control/xojfile/LoadHandler.h"
+#include "control/xojfile/SaveHandler.h"
+#include "TestDocument.h"
 #include <config-test.h>
 
 #ifdef TEST_CHECK_SPEED
@@ -18,6 +20,9 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 
+#include <glib/gstdio.h>
+
+#include <stdio.h>
 #include <stdlib.h>
 
 class LoadHandlerTest : public CppUnit::TestFixture
@@ -26,6 +31,7 @@ class LoadHandlerTest : public CppUnit::TestFixture
 
 #ifdef TEST_CHECK_SPEED
 	CPPUNIT_TEST(testSpeed);
+	CPPUNIT_TEST(testSpeedThreads);
 #endif
 
 	CPPUNIT_TEST(testLoad);
@@ -42,6 +48,8 @@ class LoadHandlerTest : public CppUnit::TestFixture
 	CPPUNIT_TEST(testTextZipped);
 	CPPUNIT_TEST(testStroke);
 	CPPUNIT_TEST(loadImage);
+	CPPUNIT_TEST(testThreads);
+	CPPUNIT_TEST(testThreadsGenerated);
 
 	CPPUNIT_TEST_SUITE_END();
 
@@ -54,6 +62,20 @@ public:
 	{
 	}
 
+	static void checkSameWithThreads(string file)
+	{
+		LoadHandler sequential;
+		sequential.setThreadCount(1);
+		Document* expected = sequential.loadDocument(file);
+
+		for (int threads : { 2, 4, 0 })
+		{
+			LoadHandler handler;
+			handler.setThreadCount(threads);
+			TestDocument::checkSame(expected, handler.loadDocument(file));
+		}
+	}
+
 #ifdef TEST_CHECK_SPEED
 	void testSpeed()
 	{
@@ -76,6 +98,28 @@ public:
 
 		speed.endTest();
 	}
+
+	/**
+	 * Load time of a generated document, parsed by one thread and by all CPU cores
+	 */
+	void testSpeedThreads()
+	{
+		string file = TestDocument::write(200, 200, 100);
+
+		for (int threads : { 1, 0 })
+		{
+			SpeedTest speed;
+			speed.startTest(threads == 1 ? "load 4M points with 1 thread" : "load 4M points with all CPU cores");
+
+			LoadHandler handler;
+			handler.setThreadCount(threads);
+			CPPUNIT_ASSERT(handler.loadDocument(file) != NULL);
+
+			speed.endTest();
+		}
+
+		g_unlink(file.c_str());
+	}
 #endif
 
 	void testLoad()
@@ -303,6 +347,39 @@ public:
 
 	}
 
+	/**
+	 * The pages parsed in parallel have to be the same as parsed sequentially
+	 */
+	void testThreads()
+	{
+		checkSameWithThreads(GET_TESTFILE("load/pages.xoj"));
+		checkSameWithThreads(GET_TESTFILE("load/layer.xoj"));
+		checkSameWithThreads(GET_TESTFILE("packaged_xopp/pages.xopp"));
+		checkSameWithThreads(GET_TESTFILE("packaged_xopp/layer.xopp"));
+	}
+
+	void testThreadsGenerated()
+	{
+		string file = TestDocument::write(23, 20, 50);
+
+		LoadHandler handler;
+		handler.setThreadCount(4);
+		Document* doc = handler.loadDocument(file);
+		CPPUNIT_ASSERT(doc != NULL);
+		CPPUNIT_ASSERT_EQUAL((size_t) 23, doc->getPageCount());
+
+		Layer* layer = (*doc->getPage(22)->getLayers())[0];
+		CPPUNIT_ASSERT_EQUAL((size_t) 21, layer->getElements()->size());
+		Stroke* stroke = (Stroke*) (*layer->getElements())[0];
+		CPPUNIT_ASSERT_EQUAL(50, stroke->getPointCount());
+		CPPUNIT_ASSERT_EQUAL(42.0, stroke->getPoint(0).y);
+		CPPUNIT_ASSERT_EQUAL(string("page 23"), ((Text*) (*layer->getElements())[20])->getText());
+
+		checkSameWithThreads(file);
+
+		g_unlink(file.c_str());
+	}
+
 };
 
 // Registers the fixture into the 'registry'
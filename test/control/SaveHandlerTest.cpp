@@ -0,0 +1,228 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include "control/xojfile/LoadHandler.h"
+#include "control/xojfile/SaveHandler.h"
+#include "TestDocument.h"
+#include <config-test.h>
+
+#ifdef TEST_CHECK_SPEED
+#include "SpeedTest.cpp"
+#endif
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <glib/gstdio.h>
+
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+class SaveHandlerTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE(SaveHandlerTest);
+
+#ifdef TEST_CHECK_SPEED
+	CPPUNIT_TEST(testSpeedSave);
+#endif
+
+	CPPUNIT_TEST(testSaveThreads);
+	CPPUNIT_TEST(testSaveKeepsOtherFiles);
+#ifndef WIN32
+	CPPUNIT_TEST(testSaveSymlink);
+#endif
+
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp()
+	{
+	}
+
+	void tearDown()
+	{
+	}
+
+#ifdef TEST_CHECK_SPEED
+	/**
+	 * Save throughput, the document compressed into a single stream compared to the compressed blocks
+	 */
+	void testSpeedSave()
+	{
+		string file = TestDocument::write(200, 200, 100);
+
+		LoadHandler loader;
+		Document* doc = loader.loadDocument(file);
+		CPPUNIT_ASSERT(doc != NULL);
+		g_unlink(file.c_str());
+
+		string saved = file + ".xopp";
+
+		{
+			SaveHandler handler;
+			handler.prepareSave(doc);
+
+			SpeedTest speed;
+			speed.startTest("save 4M points into a single gzip stream");
+
+			GzOutputStream out(saved);
+			handler.saveTo(&out, saved);
+			out.close();
+
+			speed.endTest();
+		}
+
+		for (int threads : { 1, 0 })
+		{
+			SaveHandler handler;
+			handler.setThreadCount(threads);
+			handler.prepareSave(doc);
+
+			SpeedTest speed;
+			speed.startTest(threads == 1 ? "save 4M points with 1 thread" : "save 4M points with all CPU cores");
+
+			handler.saveTo(saved);
+			CPPUNIT_ASSERT_EQUAL(string(""), handler.getErrorMessage());
+
+			speed.endTest();
+		}
+
+		g_unlink(saved.c_str());
+	}
+#endif
+
+	/**
+	 * The temporary files of a save next to the file
+	 */
+	static int countTempFiles(const string& file)
+	{
+		gchar* dir = g_path_get_dirname(file.c_str());
+		gchar* base = g_path_get_basename(file.c_str());
+		string prefix = string(".") + base + ".";
+
+		int count = 0;
+		GDir* d = g_dir_open(dir, 0, NULL);
+		const gchar* name;
+		while (d && (name = g_dir_read_name(d)) != NULL)
+		{
+			if (g_str_has_prefix(name, prefix.c_str()))
+			{
+				count++;
+			}
+		}
+		if (d)
+		{
+			g_dir_close(d);
+		}
+
+		g_free(base);
+		g_free(dir);
+		return count;
+	}
+
+	/**
+	 * The blocks compressed in parallel are loaded as the same document, and replace the old file
+	 */
+	void testSaveThreads()
+	{
+		string file = TestDocument::write(23, 20, 50);
+
+		LoadHandler loader;
+		Document* expected = loader.loadDocument(file);
+		CPPUNIT_ASSERT(expected != NULL);
+		g_unlink(file.c_str());
+
+		string saved = file + ".xopp";
+		for (int threads : { 1, 4, 0 })
+		{
+			SaveHandler handler;
+			handler.setThreadCount(threads);
+			handler.prepareSave(expected);
+			handler.saveTo(saved);
+			CPPUNIT_ASSERT_EQUAL(string(""), handler.getErrorMessage());
+			CPPUNIT_ASSERT_EQUAL(0, countTempFiles(saved));
+
+			LoadHandler handler2;
+			TestDocument::checkSame(expected, handler2.loadDocument(saved));
+		}
+
+		g_unlink(saved.c_str());
+	}
+
+	/**
+	 * A file named like a temporary file of an older version is not touched
+	 */
+	void testSaveKeepsOtherFiles()
+	{
+		string file = TestDocument::write(2, 2, 10);
+
+		LoadHandler loader;
+		Document* doc = loader.loadDocument(file);
+		CPPUNIT_ASSERT(doc != NULL);
+		g_unlink(file.c_str());
+
+		string saved = file + ".xopp";
+		string other = saved + ".tmp";
+		CPPUNIT_ASSERT(g_file_set_contents(other.c_str(), "keep", -1, NULL));
+
+		SaveHandler handler;
+		handler.prepareSave(doc);
+		handler.saveTo(saved);
+		CPPUNIT_ASSERT_EQUAL(string(""), handler.getErrorMessage());
+
+		CPPUNIT_ASSERT_EQUAL(string("keep"), TestDocument::readFile(other));
+		CPPUNIT_ASSERT_EQUAL(0, countTempFiles(saved));
+
+		g_unlink(other.c_str());
+		g_unlink(saved.c_str());
+	}
+
+#ifndef WIN32
+	/**
+	 * Saving to a link replaces the file it points to, the link stays a link
+	 */
+	void testSaveSymlink()
+	{
+		string file = TestDocument::write(2, 2, 10);
+
+		LoadHandler loader;
+		Document* expected = loader.loadDocument(file);
+		CPPUNIT_ASSERT(expected != NULL);
+		g_unlink(file.c_str());
+
+		string target = file + ".xopp";
+		string link = file + "-link.xopp";
+		CPPUNIT_ASSERT(g_file_set_contents(target.c_str(), "old", -1, NULL));
+
+		// A relative link, resolved against the folder of the link
+		gchar* targetName = g_path_get_basename(target.c_str());
+		CPPUNIT_ASSERT_EQUAL(0, symlink(targetName, link.c_str()));
+		g_free(targetName);
+
+		SaveHandler handler;
+		handler.prepareSave(expected);
+		handler.saveTo(link);
+		CPPUNIT_ASSERT_EQUAL(string(""), handler.getErrorMessage());
+
+		CPPUNIT_ASSERT(g_file_test(link.c_str(), G_FILE_TEST_IS_SYMLINK));
+		CPPUNIT_ASSERT_EQUAL(0, countTempFiles(target));
+
+		LoadHandler handler2;
+		TestDocument::checkSame(expected, handler2.loadDocument(target));
+
+		g_unlink(link.c_str());
+		g_unlink(target.c_str());
+	}
+#endif
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(SaveHandlerTest);
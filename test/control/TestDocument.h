@@ -0,0 +1,135 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ * Helper to create and compare documents in tests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include "model/Document.h"
+#include "model/Stroke.h"
+#include "model/Text.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <stdio.h>
+
+class TestDocument
+{
+public:
+	/**
+	 * Writes an uncompressed document with strokes and texts, which is loaded like an old .xoj file
+	 *
+	 * @return The temporary file, has to be removed by the caller
+	 */
+	static string write(int pages, int strokesPerPage, int pointsPerStroke)
+	{
+		gchar* path = NULL;
+		int fd = g_file_open_tmp("xournalpp_load_XXXXXX.xoj", &path, NULL);
+		CPPUNIT_ASSERT(fd != -1);
+		FILE* fp = fdopen(fd, "w");
+
+		fprintf(fp, "<?xml version=\"1.0\" standalone=\"no\"?>\n<xournal creator=\"Xournal++ test\" fileversion=\"4\">\n");
+		fprintf(fp, "<title>Xournal document - see http://xournal.sourceforge.net/</title>\n");
+		for (int p = 0; p < pages; p++)
+		{
+			fprintf(fp, "<page width=\"595.28\" height=\"841.89\">\n");
+			fprintf(fp, "<background type=\"solid\" color=\"#ffffffff\" style=\"%s\"/>\n", p % 2 ? "lined" : "graph");
+			fprintf(fp, "<layer>\n");
+			for (int s = 0; s < strokesPerPage; s++)
+			{
+				fprintf(fp, "<stroke tool=\"pen\" ts=\"0\" fn=\"\" color=\"#0000ffff\" width=\"1.41");
+				for (int i = 0; i < pointsPerStroke - 1; i++)
+				{
+					fprintf(fp, " %.2f", 1 + (i % 7) * 0.25);
+				}
+				fprintf(fp, "\">");
+				for (int i = 0; i < pointsPerStroke; i++)
+				{
+					fprintf(fp, "%.4f %.4f ", 10 + s * 0.5 + i * 0.1234, 20 + p + i * 0.0625);
+				}
+				fprintf(fp, "</stroke>\n");
+			}
+			fprintf(fp, "<text font=\"Sans\" size=\"12.00\" x=\"10.00\" y=\"20.00\" color=\"#000000ff\">page %d</text>\n", p + 1);
+			fprintf(fp, "</layer>\n</page>\n");
+		}
+		fprintf(fp, "</xournal>\n");
+		fclose(fp);
+
+		string file = path;
+		g_free(path);
+		return file;
+	}
+
+	/**
+	 * Compares the pages, layers and elements of two loaded documents
+	 */
+	static void checkSame(Document* expected, Document* doc)
+	{
+		CPPUNIT_ASSERT(expected != NULL);
+		CPPUNIT_ASSERT(doc != NULL);
+		CPPUNIT_ASSERT_EQUAL(expected->getPageCount(), doc->getPageCount());
+
+		for (size_t p = 0; p < expected->getPageCount(); p++)
+		{
+			PageRef expectedPage = expected->getPage(p);
+			PageRef page = doc->getPage(p);
+
+			CPPUNIT_ASSERT_EQUAL(expectedPage->getWidth(), page->getWidth());
+			CPPUNIT_ASSERT_EQUAL(expectedPage->getHeight(), page->getHeight());
+			CPPUNIT_ASSERT(expectedPage->getBackgroundType() == page->getBackgroundType());
+			CPPUNIT_ASSERT_EQUAL(expectedPage->getBackgroundImage().isEmpty(), page->getBackgroundImage().isEmpty());
+			CPPUNIT_ASSERT_EQUAL(expectedPage->getLayerCount(), page->getLayerCount());
+
+			for (size_t l = 0; l < expectedPage->getLayerCount(); l++)
+			{
+				vector<Element*>* expectedElements = (*expectedPage->getLayers())[l]->getElements();
+				vector<Element*>* elements = (*page->getLayers())[l]->getElements();
+				CPPUNIT_ASSERT_EQUAL(expectedElements->size(), elements->size());
+
+				for (size_t i = 0; i < expectedElements->size(); i++)
+				{
+					Element* e1 = (*expectedElements)[i];
+					Element* e2 = (*elements)[i];
+					CPPUNIT_ASSERT_EQUAL(e1->getType(), e2->getType());
+					CPPUNIT_ASSERT_EQUAL(e1->getX(), e2->getX());
+					CPPUNIT_ASSERT_EQUAL(e1->getY(), e2->getY());
+
+					if (e1->getType() == ELEMENT_STROKE)
+					{
+						Stroke* s1 = (Stroke*) e1;
+						Stroke* s2 = (Stroke*) e2;
+						CPPUNIT_ASSERT_EQUAL(s1->getPointCount(), s2->getPointCount());
+						CPPUNIT_ASSERT_EQUAL(s1->getWidth(), s2->getWidth());
+						for (int k = 0; k < s1->getPointCount(); k++)
+						{
+							CPPUNIT_ASSERT(s1->getPoint(k).equalsPos(s2->getPoint(k)));
+							CPPUNIT_ASSERT_EQUAL(s1->getPoint(k).z, s2->getPoint(k).z);
+						}
+					}
+					else if (e1->getType() == ELEMENT_TEXT)
+					{
+						CPPUNIT_ASSERT_EQUAL(((Text*) e1)->getText(), ((Text*) e2)->getText());
+					}
+				}
+			}
+		}
+	}
+
+	static string readFile(const string& path)
+	{
+		gchar* contents = NULL;
+		gsize length = 0;
+		CPPUNIT_ASSERT(g_file_get_contents(path.c_str(), &contents, &length, NULL));
+
+		string data(contents, length);
+		g_free(contents);
+		return data;
+	}
+};
@@ -0,0 +1,229 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include "model/Stroke.h"
+#include "model/eraser/EraseableStroke.h"
+#include <config-test.h>
+#include <Range.h>
+
+#ifdef TEST_CHECK_SPEED
+#include "SpeedTest.cpp"
+#endif
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <cmath>
+
+class EraseableStrokeTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE(EraseableStrokeTest);
+
+#ifdef TEST_CHECK_SPEED
+	CPPUNIT_TEST(testSpeedErase);
+#endif
+
+	CPPUNIT_TEST(testEraseNothing);
+	CPPUNIT_TEST(testEraseMiddle);
+	CPPUNIT_TEST(testEraseAll);
+	CPPUNIT_TEST(testErasePressure);
+	CPPUNIT_TEST(testEraseRepeated);
+
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp()
+	{
+	}
+
+	void tearDown()
+	{
+	}
+
+	/**
+	 * A horizontal line from (x, y), a point every step
+	 */
+	static Stroke* createLine(double x, double y, int count, double step)
+	{
+		Stroke* s = new Stroke();
+		s->setWidth(2);
+		s->setColor(0xff0000);
+		for (int i = 0; i < count; i++)
+		{
+			s->addPoint(Point(x + i * step, y));
+		}
+		return s;
+	}
+
+	static void freeStrokes(GList* strokes)
+	{
+		for (GList* l = strokes; l != NULL; l = l->next)
+		{
+			delete (Stroke*) l->data;
+		}
+		g_list_free(strokes);
+	}
+
+	void testEraseNothing()
+	{
+		Stroke* s = createLine(0, 0, 11, 10);
+		EraseableStroke eraseable(s);
+
+		Range* range = eraseable.erase(50, 50, 5);
+		CPPUNIT_ASSERT(range == NULL);
+
+		GList* strokes = eraseable.getStroke(s);
+		CPPUNIT_ASSERT_EQUAL(1U, g_list_length(strokes));
+
+		Stroke* result = (Stroke*) strokes->data;
+		CPPUNIT_ASSERT_EQUAL(0.0, result->getPoint(0).x);
+		CPPUNIT_ASSERT_EQUAL(100.0, result->getPoint(result->getPointCount() - 1).x);
+		CPPUNIT_ASSERT_EQUAL(0xff0000, result->getColor());
+		CPPUNIT_ASSERT_EQUAL(2.0, result->getWidth());
+
+		freeStrokes(strokes);
+		delete s;
+	}
+
+	void testEraseMiddle()
+	{
+		Stroke* s = createLine(0, 0, 11, 10);
+		EraseableStroke eraseable(s);
+
+		Range* range = eraseable.erase(50, 0, 5);
+		CPPUNIT_ASSERT(range != NULL);
+		CPPUNIT_ASSERT(range->getX() <= 45);
+		CPPUNIT_ASSERT(range->getX2() >= 55);
+		delete range;
+
+		GList* strokes = eraseable.getStroke(s);
+		CPPUNIT_ASSERT_EQUAL(2U, g_list_length(strokes));
+
+		Stroke* first = (Stroke*) g_list_nth_data(strokes, 0);
+		Stroke* second = (Stroke*) g_list_nth_data(strokes, 1);
+
+		CPPUNIT_ASSERT_EQUAL(0.0, first->getPoint(0).x);
+		CPPUNIT_ASSERT(first->getPoint(first->getPointCount() - 1).x <= 45);
+		CPPUNIT_ASSERT(second->getPoint(0).x >= 55);
+		CPPUNIT_ASSERT_EQUAL(100.0, second->getPoint(second->getPointCount() - 1).x);
+
+		// The strokes are created with their final size
+		CPPUNIT_ASSERT_EQUAL(first->getPointCount(), first->getPointAllocCount());
+		CPPUNIT_ASSERT_EQUAL(second->getPointCount(), second->getPointAllocCount());
+
+		freeStrokes(strokes);
+		delete s;
+	}
+
+	void testEraseAll()
+	{
+		Stroke* s = createLine(0, 0, 5, 1);
+		EraseableStroke eraseable(s);
+
+		Range* range = eraseable.erase(2, 0, 5);
+		CPPUNIT_ASSERT(range != NULL);
+		delete range;
+
+		GList* strokes = eraseable.getStroke(s);
+		CPPUNIT_ASSERT(strokes == NULL);
+
+		delete s;
+	}
+
+	void testErasePressure()
+	{
+		Stroke* s = new Stroke();
+		s->setWidth(2);
+		for (int i = 0; i < 11; i++)
+		{
+			s->addPoint(Point(i * 10, 0, 1 + i));
+		}
+
+		EraseableStroke eraseable(s);
+		delete eraseable.erase(50, 0, 5);
+
+		GList* strokes = eraseable.getStroke(s);
+		CPPUNIT_ASSERT_EQUAL(2U, g_list_length(strokes));
+
+		// Each point keeps the pressure of its segment
+		Stroke* first = (Stroke*) strokes->data;
+		CPPUNIT_ASSERT_EQUAL(1.0, first->getPoint(0).z);
+		CPPUNIT_ASSERT_EQUAL(2.0, first->getPoint(1).z);
+
+		Stroke* second = (Stroke*) strokes->next->data;
+		CPPUNIT_ASSERT_EQUAL(100.0, second->getPoint(second->getPointCount() - 1).x);
+
+		freeStrokes(strokes);
+		delete s;
+	}
+
+	void testEraseRepeated()
+	{
+		Stroke* s = createLine(0, 0, 101, 1);
+		EraseableStroke eraseable(s);
+
+		// Erase the same spot again, and a second spot
+		delete eraseable.erase(30, 0, 3);
+		delete eraseable.erase(30, 0, 3);
+		delete eraseable.erase(70, 0, 3);
+		CPPUNIT_ASSERT(eraseable.erase(30, 0, 3) == NULL);
+
+		GList* strokes = eraseable.getStroke(s);
+		CPPUNIT_ASSERT_EQUAL(3U, g_list_length(strokes));
+
+		double lastX = -1;
+		for (GList* l = strokes; l != NULL; l = l->next)
+		{
+			Stroke* part = (Stroke*) l->data;
+			for (int i = 0; i < part->getPointCount(); i++)
+			{
+				double x = part->getPoint(i).x;
+				CPPUNIT_ASSERT(x > lastX);
+				CPPUNIT_ASSERT(std::abs(x - 30) >= 3 && std::abs(x - 70) >= 3);
+				lastX = x;
+			}
+		}
+
+		freeStrokes(strokes);
+		delete s;
+	}
+
+#ifdef TEST_CHECK_SPEED
+	void testSpeedErase()
+	{
+		const int POINTS = 5000;
+
+		Stroke* s = new Stroke();
+		s->setWidth(1);
+		for (int i = 0; i < POINTS; i++)
+		{
+			s->addPoint(Point(i * 0.2, 400 + 50 * std::sin(i * 0.01)));
+		}
+
+		SpeedTest speed;
+		speed.startTest("erase along a stroke with " + std::to_string(POINTS) + " points");
+
+		EraseableStroke eraseable(s);
+		for (int i = 0; i < POINTS; i += 10)
+		{
+			delete eraseable.erase(i * 0.2, 400 + 50 * std::sin(i * 0.01) + 2, 3);
+		}
+		GList* strokes = eraseable.getStroke(s);
+
+		speed.endTest();
+
+		freeStrokes(strokes);
+		delete s;
+	}
+#endif
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(EraseableStrokeTest);
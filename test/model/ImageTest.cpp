@@ -0,0 +1,147 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include "model/Image.h"
+#include "model/ImageCache.h"
+#include <config-test.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <stdlib.h>
+
+class ImageTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE(ImageTest);
+
+	CPPUNIT_TEST(testPngSize);
+	CPPUNIT_TEST(testDataUnchanged);
+	CPPUNIT_TEST(testLevels);
+	CPPUNIT_TEST(testLevelForSize);
+	CPPUNIT_TEST(testCloneSharesData);
+	CPPUNIT_TEST(testInvalidData);
+
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp()
+	{
+	}
+
+	void tearDown()
+	{
+	}
+
+	static string createPng(int width, int height)
+	{
+		cairo_surface_t* img = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+		cairo_t* cr = cairo_create(img);
+		cairo_set_source_rgb(cr, 1, 0, 0);
+		cairo_paint(cr);
+		cairo_destroy(cr);
+
+		string png = ImageCache::encodePng(img);
+		cairo_surface_destroy(img);
+		return png;
+	}
+
+	void testPngSize()
+	{
+		int width = 0;
+		int height = 0;
+		CPPUNIT_ASSERT(ImageCache::readPngSize(createPng(300, 200), width, height));
+		CPPUNIT_ASSERT_EQUAL(300, width);
+		CPPUNIT_ASSERT_EQUAL(200, height);
+
+		CPPUNIT_ASSERT(!ImageCache::readPngSize("no png", width, height));
+	}
+
+	/**
+	 * The encoded data is saved as it was loaded, it is not encoded again
+	 */
+	void testDataUnchanged()
+	{
+		string png = createPng(64, 32);
+
+		Image image;
+		image.setImage(png);
+		CPPUNIT_ASSERT_EQUAL(64, image.getImageWidth());
+		CPPUNIT_ASSERT_EQUAL(32, image.getImageHeight());
+
+		cairo_surface_destroy(image.getImage());
+		CPPUNIT_ASSERT(png == *image.getData());
+	}
+
+	void testLevels()
+	{
+		Image image;
+		image.setImage(createPng(256, 100));
+
+		cairo_surface_t* full = image.getImage(0);
+		CPPUNIT_ASSERT_EQUAL(256, cairo_image_surface_get_width(full));
+		CPPUNIT_ASSERT_EQUAL(100, cairo_image_surface_get_height(full));
+
+		cairo_surface_t* level2 = image.getImage(2);
+		CPPUNIT_ASSERT_EQUAL(64, cairo_image_surface_get_width(level2));
+		CPPUNIT_ASSERT_EQUAL(25, cairo_image_surface_get_height(level2));
+
+		// Cached, the same surface is returned again
+		cairo_surface_t* again = image.getImage(2);
+		CPPUNIT_ASSERT(level2 == again);
+
+		cairo_surface_destroy(full);
+		cairo_surface_destroy(level2);
+		cairo_surface_destroy(again);
+	}
+
+	void testLevelForSize()
+	{
+		CPPUNIT_ASSERT_EQUAL(0, ImageCache::levelForSize(1000, 1000));
+		CPPUNIT_ASSERT_EQUAL(0, ImageCache::levelForSize(1000, 2000));
+		CPPUNIT_ASSERT_EQUAL(0, ImageCache::levelForSize(1000, 501));
+		CPPUNIT_ASSERT_EQUAL(1, ImageCache::levelForSize(1000, 500));
+		CPPUNIT_ASSERT_EQUAL(3, ImageCache::levelForSize(4000, 400));
+		CPPUNIT_ASSERT_EQUAL(0, ImageCache::levelForSize(4000, 0));
+	}
+
+	void testCloneSharesData()
+	{
+		Image image;
+		image.setImage(createPng(16, 16));
+
+		Element* clone = image.clone();
+		CPPUNIT_ASSERT(image.getData() == ((Image*) clone)->getData());
+
+		// The decoded image is shared too
+		cairo_surface_t* img1 = image.getImage();
+		cairo_surface_t* img2 = ((Image*) clone)->getImage();
+		CPPUNIT_ASSERT(img1 == img2);
+		cairo_surface_destroy(img1);
+		cairo_surface_destroy(img2);
+
+		delete clone;
+
+		img1 = image.getImage();
+		CPPUNIT_ASSERT(img1 != NULL);
+		cairo_surface_destroy(img1);
+	}
+
+	void testInvalidData()
+	{
+		Image image;
+		CPPUNIT_ASSERT(image.getImage() == NULL);
+
+		image.setImage(string("no png"));
+		CPPUNIT_ASSERT(image.getImage() == NULL);
+	}
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(ImageTest);
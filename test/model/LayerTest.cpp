@@ -0,0 +1,328 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include "model/Layer.h"
+#include "model/Stroke.h"
+#include <config-test.h>
+
+#ifdef TEST_CHECK_SPEED
+#include "SpeedTest.cpp"
+#endif
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <stdlib.h>
+#include <thread>
+
+class LayerTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE(LayerTest);
+
+#ifdef TEST_CHECK_SPEED
+	CPPUNIT_TEST(testSpeedQuery);
+#endif
+
+	CPPUNIT_TEST(testQueryArea);
+	CPPUNIT_TEST(testQueryPoint);
+	CPPUNIT_TEST(testQueryOrder);
+	CPPUNIT_TEST(testMovedElement);
+	CPPUNIT_TEST(testChangedStroke);
+	CPPUNIT_TEST(testRemoveElement);
+	CPPUNIT_TEST(testLargeElement);
+	CPPUNIT_TEST(testIndexOf);
+	CPPUNIT_TEST(testConcurrentQuery);
+	CPPUNIT_TEST(testQueryWhileChanged);
+
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp()
+	{
+	}
+
+	void tearDown()
+	{
+	}
+
+	static Stroke* createStroke(double x, double y, double length)
+	{
+		Stroke* s = new Stroke();
+		s->setWidth(1);
+		s->addPoint(Point(x, y));
+		s->addPoint(Point(x + length, y + length));
+		return s;
+	}
+
+#ifdef TEST_CHECK_SPEED
+	void testSpeedQuery()
+	{
+		for (int count : { 1000, 10000, 100000 })
+		{
+			Layer layer;
+			srand(42);
+			for (int i = 0; i < count; i++)
+			{
+				layer.addElement(createStroke(rand() % 600, rand() % 800, rand() % 20));
+			}
+
+			// Build the index before measuring the queries
+			layer.getElementsInArea(0, 0, 1, 1);
+
+			const int QUERIES = 1000;
+			size_t found = 0;
+
+			SpeedTest speed;
+			speed.startTest("scan " + std::to_string(count) + " strokes");
+			for (int i = 0; i < QUERIES; i++)
+			{
+				double x = rand() % 600;
+				double y = rand() % 800;
+				for (Element* e : *layer.getElements())
+				{
+					if (e->intersectsArea(x, y, 20, 20))
+					{
+						found++;
+					}
+				}
+			}
+			speed.endTest();
+
+			speed.startTest("query index of " + std::to_string(count) + " strokes");
+			for (int i = 0; i < QUERIES; i++)
+			{
+				found += layer.getElementsInArea(rand() % 600, rand() % 800, 20, 20).size();
+			}
+			speed.endTest();
+
+			CPPUNIT_ASSERT(found > 0);
+		}
+	}
+#endif
+
+	void testQueryArea()
+	{
+		Layer layer;
+		Stroke* s1 = createStroke(10, 10, 10);
+		Stroke* s2 = createStroke(100, 100, 10);
+		Stroke* s3 = createStroke(-50, -50, 10);
+		layer.addElement(s1);
+		layer.addElement(s2);
+		layer.addElement(s3);
+
+		vector<Element*> result = layer.getElementsInArea(0, 0, 50, 50);
+		CPPUNIT_ASSERT_EQUAL((size_t) 1, result.size());
+		CPPUNIT_ASSERT(result[0] == s1);
+
+		result = layer.getElementsInArea(-100, -100, 300, 300);
+		CPPUNIT_ASSERT_EQUAL((size_t) 3, result.size());
+
+		result = layer.getElementsInArea(-60, -60, 20, 20);
+		CPPUNIT_ASSERT_EQUAL((size_t) 1, result.size());
+		CPPUNIT_ASSERT(result[0] == s3);
+
+		result = layer.getElementsInArea(300, 300, 50, 50);
+		CPPUNIT_ASSERT(result.empty());
+	}
+
+	void testQueryPoint()
+	{
+		Layer layer;
+		Stroke* s1 = createStroke(10, 10, 10);
+		layer.addElement(s1);
+
+		CPPUNIT_ASSERT_EQUAL((size_t) 1, layer.getElementsAt(15, 15).size());
+		CPPUNIT_ASSERT(layer.getElementsAt(40, 15).empty());
+	}
+
+	void testQueryOrder()
+	{
+		Layer layer;
+		Stroke* s1 = createStroke(10, 10, 100);
+		Stroke* s2 = createStroke(20, 20, 100);
+		Stroke* s3 = createStroke(30, 30, 100);
+		layer.addElement(s1);
+		layer.addElement(s3);
+		layer.insertElement(s2, 1);
+
+		vector<Element*> result = layer.getElementsInArea(40, 40, 10, 10);
+		CPPUNIT_ASSERT_EQUAL((size_t) 3, result.size());
+		CPPUNIT_ASSERT(result[0] == s1);
+		CPPUNIT_ASSERT(result[1] == s2);
+		CPPUNIT_ASSERT(result[2] == s3);
+	}
+
+	void testMovedElement()
+	{
+		Layer layer;
+		Stroke* s1 = createStroke(10, 10, 10);
+		layer.addElement(s1);
+		CPPUNIT_ASSERT_EQUAL((size_t) 1, layer.getElementsInArea(0, 0, 30, 30).size());
+
+		s1->move(500, 500);
+		CPPUNIT_ASSERT(layer.getElementsInArea(0, 0, 30, 30).empty());
+		CPPUNIT_ASSERT_EQUAL((size_t) 1, layer.getElementsInArea(500, 500, 30, 30).size());
+	}
+
+	void testChangedStroke()
+	{
+		Layer layer;
+		Stroke* s1 = createStroke(10, 10, 10);
+		layer.addElement(s1);
+		CPPUNIT_ASSERT(layer.getElementsInArea(200, 200, 10, 10).empty());
+
+		s1->addPoint(Point(205, 205));
+		CPPUNIT_ASSERT_EQUAL((size_t) 1, layer.getElementsInArea(200, 200, 10, 10).size());
+
+		s1->deletePointsFrom(2);
+		CPPUNIT_ASSERT(layer.getElementsInArea(200, 200, 10, 10).empty());
+	}
+
+	void testRemoveElement()
+	{
+		Layer layer;
+		Stroke* s1 = createStroke(10, 10, 10);
+		Stroke* s2 = createStroke(12, 12, 10);
+		layer.addElement(s1);
+		layer.addElement(s2);
+
+		CPPUNIT_ASSERT_EQUAL(0, layer.removeElement(s1, false));
+		vector<Element*> result = layer.getElementsInArea(0, 0, 50, 50);
+		CPPUNIT_ASSERT_EQUAL((size_t) 1, result.size());
+		CPPUNIT_ASSERT(result[0] == s2);
+
+		// Not indexed anymore
+		s1->move(1, 1);
+		CPPUNIT_ASSERT_EQUAL((size_t) 1, layer.getElementsInArea(0, 0, 50, 50).size());
+		delete s1;
+	}
+
+	void testLargeElement()
+	{
+		Layer layer;
+		Stroke* s1 = createStroke(0, 0, 5000);
+		Stroke* s2 = createStroke(10, 10, 10);
+		layer.addElement(s1);
+		layer.addElement(s2);
+
+		vector<Element*> result = layer.getElementsInArea(2000, 2000, 10, 10);
+		CPPUNIT_ASSERT_EQUAL((size_t) 1, result.size());
+		CPPUNIT_ASSERT(result[0] == s1);
+
+		// No duplicates if the area covers many cells
+		CPPUNIT_ASSERT_EQUAL((size_t) 2, layer.getElementsInArea(-10, -10, 6000, 6000).size());
+	}
+
+	void testIndexOf()
+	{
+		Layer layer;
+		Stroke* s1 = createStroke(10, 10, 10);
+		Stroke* s2 = createStroke(20, 20, 10);
+		Stroke* s3 = createStroke(30, 30, 10);
+		layer.addElement(s1);
+		layer.addElement(s2);
+		layer.insertElement(s3, 0);
+
+		CPPUNIT_ASSERT_EQUAL(0, layer.indexOf(s3));
+		CPPUNIT_ASSERT_EQUAL(1, layer.indexOf(s1));
+		CPPUNIT_ASSERT_EQUAL(2, layer.indexOf(s2));
+
+		layer.removeElement(s3, true);
+		CPPUNIT_ASSERT_EQUAL(0, layer.indexOf(s1));
+		CPPUNIT_ASSERT_EQUAL(1, layer.indexOf(s2));
+
+		// Adding twice is ignored
+		layer.addElement(s1);
+		CPPUNIT_ASSERT_EQUAL((size_t) 2, layer.getElements()->size());
+	}
+
+	void testConcurrentQuery()
+	{
+		// The UI thread and the render threads query the same layer, the positions are rebuilt by the first query
+		for (int round = 0; round < 20; round++)
+		{
+			Layer layer;
+			vector<Element*> strokes;
+			for (int i = 0; i < 200; i++)
+			{
+				Stroke* s = createStroke(i % 20, i % 20, 50);
+				strokes.push_back(s);
+				layer.insertElement(s, 0);
+			}
+
+			vector<std::thread> threads;
+			bool ordered[4] = { false, false, false, false };
+			for (int t = 0; t < 4; t++)
+			{
+				threads.push_back(std::thread([&layer, &ordered, t]()
+				{
+					vector<Element*> result = layer.getElementsInArea(30, 30, 5, 5);
+					ordered[t] = result.size() == 200 && result.front() == layer.getElements()->front();
+				}));
+			}
+			for (std::thread& t : threads)
+			{
+				t.join();
+			}
+
+			for (int t = 0; t < 4; t++)
+			{
+				CPPUNIT_ASSERT(ordered[t]);
+			}
+			CPPUNIT_ASSERT_EQUAL(0, layer.indexOf(strokes.back()));
+		}
+	}
+
+	void testQueryWhileChanged()
+	{
+		// A render thread queries the layer while elements are added and removed
+		Layer layer;
+		for (int i = 0; i < 100; i++)
+		{
+			layer.addElement(createStroke(i % 20, i % 20, 50));
+		}
+
+		gint running = true;
+		bool ordered = true;
+		std::thread reader([&layer, &running, &ordered]()
+		{
+			while (g_atomic_int_get(&running))
+			{
+				vector<Element*> result = layer.getElementsInArea(30, 30, 5, 5);
+				for (size_t i = 1; i < result.size(); i++)
+				{
+					// Positions can only be compared if the element is still on the layer
+					int a = layer.indexOf(result[i - 1]);
+					int b = layer.indexOf(result[i]);
+					if (a != -1 && b != -1 && a > b)
+					{
+						ordered = false;
+					}
+				}
+			}
+		});
+
+		for (int i = 0; i < 2000; i++)
+		{
+			Stroke* s = createStroke(10, 10, 50);
+			layer.addElement(s);
+			layer.removeElement(s, true);
+		}
+
+		g_atomic_int_set(&running, false);
+		reader.join();
+
+		CPPUNIT_ASSERT(ordered);
+		CPPUNIT_ASSERT_EQUAL((size_t) 100, layer.getElements()->size());
+	}
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(LayerTest);
@@ -0,0 +1,297 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include "model/Layer.h"
+#include "model/PolygonShape.h"
+#include "model/Stroke.h"
+#include <config-test.h>
+
+#ifdef TEST_CHECK_SPEED
+#include "SpeedTest.cpp"
+#endif
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <cmath>
+#include <stdlib.h>
+
+/**
+ * The even-odd test walking all edges, like the lasso selection did before
+ */
+class PlainPolygon : public ShapeContainer
+{
+public:
+	PlainPolygon(const vector<Point>& points)
+	 : points(points)
+	{
+	}
+
+	virtual bool contains(double x, double y)
+	{
+		bool inside = false;
+		for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++)
+		{
+			const Point& a = points[i];
+			const Point& b = points[j];
+			if ((a.y <= y) != (b.y <= y) && x < a.x + (y - a.y) / (b.y - a.y) * (b.x - a.x))
+			{
+				inside = !inside;
+			}
+		}
+		return inside;
+	}
+
+private:
+	vector<Point> points;
+};
+
+class PolygonShapeTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE(PolygonShapeTest);
+
+#ifdef TEST_CHECK_SPEED
+	CPPUNIT_TEST(testSpeedLasso);
+#endif
+
+	CPPUNIT_TEST(testSquare);
+	CPPUNIT_TEST(testConcave);
+	CPPUNIT_TEST(testDegenerated);
+	CPPUNIT_TEST(testArea);
+	CPPUNIT_TEST(testRandomLasso);
+	CPPUNIT_TEST(testStrokeSelection);
+
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp()
+	{
+	}
+
+	void tearDown()
+	{
+	}
+
+	/**
+	 * A freehand like loop around (cx, cy), with a wobbly radius
+	 */
+	static void createLasso(PolygonShape& shape, double cx, double cy, double radius, int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			double angle = 2 * M_PI * i / count;
+			double r = radius * (0.8 + 0.2 * std::sin(angle * 7) + 0.05 * (rand() % 100) / 100.0);
+			shape.addPoint(cx + r * std::cos(angle), cy + r * std::sin(angle));
+		}
+	}
+
+	static Stroke* createStroke(double x, double y, double length)
+	{
+		Stroke* s = new Stroke();
+		s->setWidth(1);
+		s->addPoint(Point(x, y));
+		s->addPoint(Point(x + length / 2, y + length / 3));
+		s->addPoint(Point(x + length, y + length));
+		return s;
+	}
+
+#ifdef TEST_CHECK_SPEED
+	void testSpeedLasso()
+	{
+		const int STROKES = 50000;
+
+		Layer layer;
+		srand(42);
+		for (int i = 0; i < STROKES; i++)
+		{
+			Stroke* s = new Stroke();
+			s->setWidth(1);
+			double x = rand() % 600;
+			double y = rand() % 800;
+			for (int p = 0; p < 20; p++)
+			{
+				s->addPoint(Point(x + p, y + (rand() % 10)));
+			}
+			layer.addElement(s);
+		}
+
+		PolygonShape lasso;
+		createLasso(lasso, 300, 400, 280, 2000);
+		PlainPolygon plain(lasso.getPoints());
+
+		vector<Element*> candidates = layer.getElementsInArea(lasso.getX1(), lasso.getY1(),
+															  lasso.getX2() - lasso.getX1(), lasso.getY2() - lasso.getY1());
+
+		SpeedTest speed;
+		speed.startTest("lasso " + std::to_string(STROKES) + " strokes, testing all edges");
+		size_t plainSelected = 0;
+		for (Element* e : candidates)
+		{
+			if (e->isInSelection(&plain))
+			{
+				plainSelected++;
+			}
+		}
+		speed.endTest();
+
+		speed.startTest("lasso " + std::to_string(STROKES) + " strokes, compiled polygon");
+		size_t selected = 0;
+		for (Element* e : candidates)
+		{
+			if (e->isInSelection(&lasso))
+			{
+				selected++;
+			}
+		}
+		speed.endTest();
+
+		CPPUNIT_ASSERT_EQUAL(plainSelected, selected);
+		CPPUNIT_ASSERT(selected > 0);
+	}
+#endif
+
+	void testSquare()
+	{
+		PolygonShape shape;
+		shape.addPoint(0, 0);
+		shape.addPoint(100, 0);
+		shape.addPoint(100, 100);
+		shape.addPoint(0, 100);
+
+		CPPUNIT_ASSERT(shape.contains(50, 50));
+		CPPUNIT_ASSERT(shape.contains(1, 99));
+		CPPUNIT_ASSERT(!shape.contains(-1, 50));
+		CPPUNIT_ASSERT(!shape.contains(50, 101));
+		CPPUNIT_ASSERT(!shape.contains(1000, 1000));
+
+		CPPUNIT_ASSERT_EQUAL(0.0, shape.getX1());
+		CPPUNIT_ASSERT_EQUAL(100.0, shape.getY2());
+	}
+
+	void testConcave()
+	{
+		// A "U", open at the top
+		PolygonShape shape;
+		shape.addPoint(0, 0);
+		shape.addPoint(30, 0);
+		shape.addPoint(30, 70);
+		shape.addPoint(70, 70);
+		shape.addPoint(70, 0);
+		shape.addPoint(100, 0);
+		shape.addPoint(100, 100);
+		shape.addPoint(0, 100);
+
+		CPPUNIT_ASSERT(shape.contains(15, 50));
+		CPPUNIT_ASSERT(shape.contains(85, 50));
+		CPPUNIT_ASSERT(shape.contains(50, 85));
+		CPPUNIT_ASSERT(!shape.contains(50, 50));
+		CPPUNIT_ASSERT(!shape.contains(50, 1));
+
+		// Adding a point after a query compiles the polygon again: close the "U"
+		shape.addPoint(0, 0);
+		shape.addPoint(50, -10);
+		CPPUNIT_ASSERT(shape.contains(50, -1));
+	}
+
+	void testDegenerated()
+	{
+		PolygonShape shape;
+		CPPUNIT_ASSERT(!shape.contains(0, 0));
+		CPPUNIT_ASSERT_EQUAL(SHAPE_OUTSIDE, shape.containsArea(0, 0, 10, 10));
+
+		shape.addPoint(0, 0);
+		shape.addPoint(10, 10);
+		CPPUNIT_ASSERT(!shape.contains(5, 5));
+
+		// No area
+		shape.addPoint(20, 20);
+		CPPUNIT_ASSERT(!shape.contains(5, 5));
+		CPPUNIT_ASSERT_EQUAL(SHAPE_OUTSIDE, shape.containsArea(0, 0, 10, 10));
+	}
+
+	void testArea()
+	{
+		PolygonShape shape;
+		shape.addPoint(0, 0);
+		shape.addPoint(100, 0);
+		shape.addPoint(100, 100);
+
+		CPPUNIT_ASSERT_EQUAL(SHAPE_INSIDE, shape.containsArea(80, 10, 10, 10));
+		CPPUNIT_ASSERT_EQUAL(SHAPE_OUTSIDE, shape.containsArea(10, 80, 10, 10));
+		CPPUNIT_ASSERT_EQUAL(SHAPE_OUTSIDE, shape.containsArea(200, 200, 10, 10));
+		CPPUNIT_ASSERT_EQUAL(SHAPE_PARTIAL, shape.containsArea(40, 40, 20, 20));
+		CPPUNIT_ASSERT_EQUAL(SHAPE_PARTIAL, shape.containsArea(90, 10, 20, 10));
+	}
+
+	void testRandomLasso()
+	{
+		srand(7);
+		PolygonShape shape;
+		createLasso(shape, 200, 300, 150, 500);
+		PlainPolygon plain(shape.getPoints());
+
+		for (int i = 0; i < 100000; i++)
+		{
+			double x = 30 + (rand() % 340000) / 1000.0;
+			double y = 130 + (rand() % 340000) / 1000.0;
+			CPPUNIT_ASSERT_EQUAL(plain.contains(x, y), shape.contains(x, y));
+		}
+
+		// An area classified completely inside or outside has to agree with all points in it
+		for (int i = 0; i < 1000; i++)
+		{
+			double x = 30 + rand() % 340;
+			double y = 130 + rand() % 340;
+			double size = 1 + rand() % 30;
+
+			ShapeContainment area = shape.containsArea(x, y, size, size);
+			if (area == SHAPE_PARTIAL)
+			{
+				continue;
+			}
+
+			for (int p = 0; p < 100; p++)
+			{
+				double px = x + size * (rand() % 1001) / 1000.0;
+				double py = y + size * (rand() % 1001) / 1000.0;
+				CPPUNIT_ASSERT_EQUAL(area == SHAPE_INSIDE, plain.contains(px, py));
+			}
+		}
+	}
+
+	void testStrokeSelection()
+	{
+		srand(3);
+		PolygonShape shape;
+		createLasso(shape, 300, 400, 250, 1000);
+		PlainPolygon plain(shape.getPoints());
+
+		Layer layer;
+		for (int i = 0; i < 5000; i++)
+		{
+			layer.addElement(createStroke(rand() % 600, rand() % 800, rand() % 40));
+		}
+
+		int selected = 0;
+		for (Element* e : *layer.getElements())
+		{
+			bool inside = e->isInSelection(&shape);
+			CPPUNIT_ASSERT_EQUAL(e->isInSelection(&plain), inside);
+			if (inside)
+			{
+				selected++;
+			}
+		}
+		CPPUNIT_ASSERT(selected > 0);
+	}
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(PolygonShapeTest);
@@ -0,0 +1,229 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include "control/xojfile/LoadHandler.h"
+#include "model/Stroke.h"
+#include <config-test.h>
+#include <serializing/BinObjectEncoding.h>
+#include <serializing/ObjectInputStream.h>
+#include <serializing/ObjectOutputStream.h>
+#include <serializing/Serializeable.h>
+
+#ifdef TEST_CHECK_SPEED
+#include "SpeedTest.cpp"
+#include <malloc.h>
+#endif
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <cstring>
+#include <thread>
+
+class StrokeTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE(StrokeTest);
+
+#ifdef TEST_CHECK_SPEED
+	CPPUNIT_TEST(testMemoryPerPoint);
+#endif
+
+	CPPUNIT_TEST(testSerialize);
+	CPPUNIT_TEST(testOtherStreamVersion);
+	CPPUNIT_TEST(testClonePoints);
+	CPPUNIT_TEST(testCloneThreads);
+
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp()
+	{
+	}
+
+	void tearDown()
+	{
+	}
+
+	static string serialize(Stroke& stroke)
+	{
+		ObjectOutputStream out(new BinObjectEncoding());
+		stroke.serialize(out);
+
+		GString* data = out.getStr();
+		string str(data->str, data->len);
+		g_string_free(data, true);
+		return str;
+	}
+
+#ifdef TEST_CHECK_SPEED
+	/**
+	 * Heap bytes used per stroke point, including the allocation slack of the point arrays
+	 */
+	void testMemoryPerPoint()
+	{
+		cout << endl << "== Memory of stroke points ==" << endl;
+		cout << "sizeof(Point): " << sizeof(Point) << endl;
+
+		for (const char* file : { GET_TESTFILE("packaged_xopp/stroke/new.xopp"),
+		                          GET_TESTFILE("packaged_xopp/stroke/old.xopp"),
+		                          GET_TESTFILE("big-test.xoj") })
+		{
+			size_t before = mallinfo().uordblks;
+
+			LoadHandler handler;
+			Document* doc = handler.loadDocument(file);
+			if (doc == NULL)
+			{
+				continue;
+			}
+
+			size_t pointCount = 0;
+			size_t pointBytes = 0;
+			for (size_t i = 0; i < doc->getPageCount(); i++)
+			{
+				for (Layer* l : *doc->getPage(i)->getLayers())
+				{
+					for (Element* e : *l->getElements())
+					{
+						if (e->getType() == ELEMENT_STROKE)
+						{
+							Stroke* s = (Stroke*) e;
+							pointCount += s->getPointCount();
+							pointBytes += s->getPointAllocCount() * sizeof(Point);
+						}
+					}
+				}
+			}
+
+			size_t total = mallinfo().uordblks - before;
+			if (pointCount > 0)
+			{
+				cout << file << ": " << pointCount << " points, "
+				     << (double) pointBytes / pointCount << " bytes per point in the point arrays, "
+				     << (double) total / pointCount << " heap bytes per point for the whole document" << endl;
+			}
+		}
+	}
+#endif
+
+	static Stroke* createStroke()
+	{
+		Stroke* s = new Stroke();
+		s->setWidth(2.5);
+		for (int i = 0; i < 100; i++)
+		{
+			s->addPoint(Point(i * 0.5, 10 - i * 0.25, i % 3 == 0 ? Point::NO_PRESSURE : i * 0.01));
+		}
+		return s;
+	}
+
+	void testSerialize()
+	{
+		Stroke* stroke = createStroke();
+		string data = serialize(*stroke);
+
+		ObjectInputStream in;
+		CPPUNIT_ASSERT(in.read(data.data(), data.size()));
+
+		Stroke read;
+		read.readSerialized(in);
+
+		CPPUNIT_ASSERT_EQUAL(2.5, read.getWidth());
+		CPPUNIT_ASSERT_EQUAL(stroke->getPointCount(), read.getPointCount());
+		for (int i = 0; i < stroke->getPointCount(); i++)
+		{
+			CPPUNIT_ASSERT_EQUAL(stroke->getPoint(i).x, read.getPoint(i).x);
+			CPPUNIT_ASSERT_EQUAL(stroke->getPoint(i).y, read.getPoint(i).y);
+			CPPUNIT_ASSERT_EQUAL(stroke->getPoint(i).z, read.getPoint(i).z);
+		}
+
+		delete stroke;
+	}
+
+	/**
+	 * A stream of an older version (e.g. pasted from another running instance) has another point layout
+	 */
+	void testOtherStreamVersion()
+	{
+		Stroke* stroke = createStroke();
+		string data = serialize(*stroke);
+		delete stroke;
+
+		size_t pos = data.find(XML_VERSION_STR);
+		CPPUNIT_ASSERT(pos != string::npos);
+		data.replace(pos, strlen(XML_VERSION_STR), "XojStrm1:");
+
+		ObjectInputStream in;
+		CPPUNIT_ASSERT(!in.read(data.data(), data.size()));
+	}
+
+	/**
+	 * A clone shares the points until one of the strokes changes them
+	 */
+	void testClonePoints()
+	{
+		Stroke* stroke = createStroke();
+		Stroke* clone = stroke->cloneStroke();
+		CPPUNIT_ASSERT(stroke->getPoints() == clone->getPoints());
+
+		stroke->move(10, 0);
+		CPPUNIT_ASSERT(stroke->getPoints() != clone->getPoints());
+		CPPUNIT_ASSERT_EQUAL(10.0, stroke->getPoint(0).x);
+		CPPUNIT_ASSERT_EQUAL(0.0, clone->getPoint(0).x);
+
+		// The clone is the only one with these points, it changes them without a copy
+		const Point* points = clone->getPoints();
+		clone->setLastPressure(1);
+		CPPUNIT_ASSERT(points == clone->getPoints());
+
+		// Deleting one of the strokes keeps the points of the other one
+		Stroke* clone2 = clone->cloneStroke();
+		delete clone;
+		CPPUNIT_ASSERT_EQUAL(100, clone2->getPointCount());
+		CPPUNIT_ASSERT_EQUAL(1.0, clone2->getPoint(99).z);
+		clone2->addPoint(Point(1, 2));
+		CPPUNIT_ASSERT_EQUAL(101, clone2->getPointCount());
+
+		delete clone2;
+		delete stroke;
+	}
+
+	/**
+	 * A snapshot is read in another thread while the document is changed
+	 */
+	void testCloneThreads()
+	{
+		Stroke* stroke = createStroke();
+
+		for (int round = 0; round < 50; round++)
+		{
+			Stroke* clone = stroke->cloneStroke();
+			double x = clone->getPoint(0).x;
+
+			std::thread reader([clone, x]()
+			{
+				for (int i = 0; i < clone->getPointCount(); i++)
+				{
+					CPPUNIT_ASSERT_EQUAL(x + i * 0.5, clone->getPoint(i).x);
+				}
+				delete clone;
+			});
+
+			stroke->move(1, 0);
+			reader.join();
+		}
+
+		CPPUNIT_ASSERT_EQUAL(50.0, stroke->getPoint(0).x);
+		delete stroke;
+	}
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(StrokeTest);
@@ -0,0 +1,147 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include "control/jobs/ProgressListener.h"
+#include "control/xojfile/LoadHandler.h"
+#include "control/TestDocument.h"
+#include "pdf/base/XojPdfExportFactory.h"
+#include "pdf/base/XojPdfFile.h"
+#include <config-test.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <glib/gstdio.h>
+
+/**
+ * Records the progress since it was started the last time
+ */
+class StateListener : public ProgressListener
+{
+public:
+	virtual void setMaximumState(int max)
+	{
+		this->starts++;
+		this->max = max;
+		this->states.clear();
+	}
+
+	virtual void setCurrentState(int state)
+	{
+		this->states.push_back(state);
+	}
+
+	virtual ~StateListener() { };
+
+public:
+	int starts = 0;
+	int max = 0;
+	vector<int> states;
+};
+
+class XojPdfCopyExportTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE(XojPdfCopyExportTest);
+
+	CPPUNIT_TEST(testExportCopyPdf);
+	CPPUNIT_TEST(testFallbackProgress);
+
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp()
+	{
+	}
+
+	void tearDown()
+	{
+	}
+
+	void testExportCopyPdf()
+	{
+		// The background PDF is attached, so it is only in memory
+		LoadHandler handler;
+		Document* doc = handler.loadDocument(GET_TESTFILE("packaged_xopp/pdfBackground/new.xopp"));
+		CPPUNIT_ASSERT(doc != NULL);
+		CPPUNIT_ASSERT(doc->isPdfDocumentLoaded());
+
+		gchar* path = NULL;
+		int fd = g_file_open_tmp("xournalpp_export_XXXXXX.pdf", &path, NULL);
+		CPPUNIT_ASSERT(fd != -1);
+		g_close(fd, NULL);
+		string file = path;
+		g_free(path);
+
+		XojPdfExport* pdfe = XojPdfExportFactory::createExport(doc, NULL);
+		CPPUNIT_ASSERT(pdfe->createPdf(Path(file)));
+		delete pdfe;
+
+		string data = TestDocument::readFile(file);
+		g_unlink(file.c_str());
+
+		// The pages are copied with their fonts and images, the layers are added as form XObject
+		XojPdfFile pdf;
+		CPPUNIT_ASSERT(pdf.open(data.data(), data.size()));
+		CPPUNIT_ASSERT_EQUAL((size_t) 2, pdf.getPageCount());
+
+		for (size_t i = 0; i < pdf.getPageCount(); i++)
+		{
+			const XojPdfObject& page = pdf.getPage(i);
+			CPPUNIT_ASSERT(page.get("Resources") != NULL);
+
+			XojPdfObject resources = pdf.resolve(*page.get("Resources"));
+			CPPUNIT_ASSERT(resources.get("Font") != NULL);
+			CPPUNIT_ASSERT(resources.get("XObject") != NULL);
+
+			XojPdfObject xobjects = pdf.resolve(*resources.get("XObject"));
+			CPPUNIT_ASSERT(xobjects.get("Im4") != NULL);
+			CPPUNIT_ASSERT(xobjects.get("XojOverlay") != NULL);
+
+			XojPdfObject overlay = pdf.resolve(*xobjects.get("XojOverlay"));
+			CPPUNIT_ASSERT(overlay.isStream());
+			CPPUNIT_ASSERT(overlay.get("Subtype")->isName("Form"));
+		}
+	}
+
+	/**
+	 * The copy can not be written, the rendering export starts the progress again
+	 */
+	void testFallbackProgress()
+	{
+		LoadHandler handler;
+		Document* doc = handler.loadDocument(GET_TESTFILE("packaged_xopp/pdfBackground/new.xopp"));
+		CPPUNIT_ASSERT(doc != NULL);
+		CPPUNIT_ASSERT(doc->isPdfDocumentLoaded());
+
+		gchar* dir = g_dir_make_tmp("xournalpp_export_XXXXXX", NULL);
+		CPPUNIT_ASSERT(dir != NULL);
+		string file = string(dir) + G_DIR_SEPARATOR_S + "missing" + G_DIR_SEPARATOR_S + "export.pdf";
+
+		StateListener listener;
+		XojPdfExport* pdfe = XojPdfExportFactory::createExport(doc, &listener);
+		pdfe->createPdf(Path(file));
+		delete pdfe;
+
+		g_rmdir(dir);
+		g_free(dir);
+
+		// Started by the copy and by the fallback, each page is reported once after the last start
+		CPPUNIT_ASSERT_EQUAL(2, listener.starts);
+		CPPUNIT_ASSERT_EQUAL((int) doc->getPageCount(), listener.max);
+		CPPUNIT_ASSERT_EQUAL(doc->getPageCount(), listener.states.size());
+		for (size_t i = 0; i < listener.states.size(); i++)
+		{
+			CPPUNIT_ASSERT_EQUAL((int) i, listener.states[i]);
+		}
+	}
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(XojPdfCopyExportTest);
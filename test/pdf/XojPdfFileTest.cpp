@@ -0,0 +1,111 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include "pdf/base/XojPdfFile.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+
+class XojPdfFileTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE(XojPdfFileTest);
+
+	CPPUNIT_TEST(testDecodeStream);
+	CPPUNIT_TEST(testDecodeStreamLimit);
+
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp()
+	{
+	}
+
+	void tearDown()
+	{
+	}
+
+	/**
+	 * @return A FlateDecode stream of this count of zero bytes
+	 */
+	static XojPdfObject createZeroStream(size_t size)
+	{
+		z_stream zs;
+		memset(&zs, 0, sizeof(zs));
+		CPPUNIT_ASSERT_EQUAL(Z_OK, deflateInit(&zs, Z_BEST_SPEED));
+
+		XojPdfObject stream = XojPdfObject::dict();
+		stream.type = PDF_OBJECT_STREAM;
+		stream.set("Filter", XojPdfObject::name("FlateDecode"));
+
+		char zeros[64 * 1024] = { 0 };
+		char buffer[64 * 1024];
+		while (true)
+		{
+			size_t chunk = std::min(size, sizeof(zeros));
+			size -= chunk;
+
+			zs.next_in = (Bytef*) zeros;
+			zs.avail_in = chunk;
+
+			int ret = Z_OK;
+			do
+			{
+				zs.next_out = (Bytef*) buffer;
+				zs.avail_out = sizeof(buffer);
+				ret = deflate(&zs, size == 0 ? Z_FINISH : Z_NO_FLUSH);
+				stream.data.append(buffer, sizeof(buffer) - zs.avail_out);
+			}
+			while (zs.avail_out == 0);
+
+			if (ret == Z_STREAM_END)
+			{
+				break;
+			}
+		}
+
+		deflateEnd(&zs);
+		return stream;
+	}
+
+	void testDecodeStream()
+	{
+		XojPdfObject stream = createZeroStream(1000000);
+
+		XojPdfFile pdf;
+		string decoded;
+		CPPUNIT_ASSERT(pdf.decodeStream(stream, decoded));
+		CPPUNIT_ASSERT_EQUAL((size_t) 1000000, decoded.size());
+		CPPUNIT_ASSERT(decoded.find_first_not_of('\0') == string::npos);
+	}
+
+	/**
+	 * A small stream which decodes to more than the limit is not decoded
+	 */
+	void testDecodeStreamLimit()
+	{
+		size_t limit = XojPdfFile::MAX_DECODED_SIZE;
+		XojPdfObject stream = createZeroStream(limit + 1);
+		CPPUNIT_ASSERT(stream.data.size() < limit / 100);
+
+		XojPdfFile pdf;
+		string decoded;
+		CPPUNIT_ASSERT(!pdf.decodeStream(stream, decoded));
+		CPPUNIT_ASSERT(decoded.empty());
+		CPPUNIT_ASSERT(!pdf.getLastError().empty());
+	}
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(XojPdfFileTest);
@@ -0,0 +1,172 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include "model/Layer.h"
+#include "model/PageRef.h"
+#include "model/Stroke.h"
+#include "model/XojPage.h"
+#include "undo/DeleteUndoAction.h"
+#include "undo/UndoSpillFile.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <glib/gstdio.h>
+
+class UndoSpillTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE(UndoSpillTest);
+
+	CPPUNIT_TEST(testSpillDeleteAction);
+	CPPUNIT_TEST(testReuseReleasedRecord);
+	CPPUNIT_TEST(testTruncateReleasedRecords);
+
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp()
+	{
+	}
+
+	void tearDown()
+	{
+	}
+
+	static Stroke* createStroke(int points, double offset)
+	{
+		Stroke* s = new Stroke();
+		s->setWidth(1);
+		for (int i = 0; i < points; i++)
+		{
+			// Values which are not exact in decimal, to find any loss of precision
+			s->addPoint(Point(offset + i / 3.0, offset - i / 7.0, 0.1 + i / 11.0));
+		}
+		return s;
+	}
+
+	static gint64 fileSize(UndoSpillFile& file)
+	{
+		GStatBuf st;
+		CPPUNIT_ASSERT_EQUAL(0, g_stat(file.getFilename().c_str(), &st));
+		return st.st_size;
+	}
+
+	void testSpillDeleteAction()
+	{
+		PageRef page = new XojPage(600, 800);
+		Layer* layer = page->getSelectedLayer();
+
+		vector<Stroke*> strokes;
+		vector<vector<Point>> points;
+		for (int i = 0; i < 3; i++)
+		{
+			Stroke* s = createStroke(1000 + i, i * 10.5);
+			layer->addElement(s);
+			strokes.push_back(s);
+			points.push_back(vector<Point>(s->getPoints(), s->getPoints() + s->getPointCount()));
+		}
+
+		DeleteUndoAction action(page, true);
+		for (Stroke* s : strokes)
+		{
+			action.addElement(layer, s, layer->removeElement(s, false));
+		}
+
+		UndoSpillFile file;
+		size_t memory = action.getMemoryUsage();
+
+		CPPUNIT_ASSERT(action.spill(&file));
+		CPPUNIT_ASSERT(action.isSpilled());
+		CPPUNIT_ASSERT(action.getMemoryUsage() < memory);
+		CPPUNIT_ASSERT(file.getSize() > 0);
+
+		CPPUNIT_ASSERT(action.unspill());
+		CPPUNIT_ASSERT(!action.isSpilled());
+		CPPUNIT_ASSERT(action.undo(NULL));
+
+		for (size_t i = 0; i < strokes.size(); i++)
+		{
+			Stroke* s = strokes[i];
+			CPPUNIT_ASSERT(layer->indexOf(s) >= 0);
+			CPPUNIT_ASSERT_EQUAL((int) points[i].size(), s->getPointCount());
+			for (int j = 0; j < s->getPointCount(); j++)
+			{
+				Point p = s->getPoint(j);
+				CPPUNIT_ASSERT_EQUAL(points[i][j].x, p.x);
+				CPPUNIT_ASSERT_EQUAL(points[i][j].y, p.y);
+				CPPUNIT_ASSERT_EQUAL(points[i][j].z, p.z);
+			}
+		}
+
+		// The only record is released, so the file is empty again
+		CPPUNIT_ASSERT_EQUAL((gint64) 0, file.getSize());
+		CPPUNIT_ASSERT_EQUAL((gint64) 0, fileSize(file));
+	}
+
+	void testReuseReleasedRecord()
+	{
+		UndoSpillFile file;
+		string data(100, 'a');
+
+		UndoSpillRecord first = file.write(data.c_str(), data.size());
+		UndoSpillRecord second = file.write(data.c_str(), data.size());
+		CPPUNIT_ASSERT_EQUAL((gint64) 200, file.getSize());
+
+		// The space of the first record is reused, the file does not grow
+		file.release(first);
+		CPPUNIT_ASSERT(!first.isValid());
+		UndoSpillRecord third = file.write("b", 1);
+		CPPUNIT_ASSERT_EQUAL((gint64) 0, third.offset);
+		CPPUNIT_ASSERT_EQUAL((gint64) 200, file.getSize());
+
+		// Too large for the remaining space before the second record
+		UndoSpillRecord fourth = file.write(data.c_str(), data.size());
+		CPPUNIT_ASSERT_EQUAL((gint64) 200, fourth.offset);
+
+		string read;
+		CPPUNIT_ASSERT(file.read(second, read));
+		CPPUNIT_ASSERT_EQUAL(data, read);
+		CPPUNIT_ASSERT(file.read(third, read));
+		CPPUNIT_ASSERT_EQUAL(string("b"), read);
+		CPPUNIT_ASSERT(file.read(fourth, read));
+		CPPUNIT_ASSERT_EQUAL(data, read);
+	}
+
+	void testTruncateReleasedRecords()
+	{
+		UndoSpillFile file;
+		string data(100, 'a');
+
+		UndoSpillRecord first = file.write(data.c_str(), data.size());
+		UndoSpillRecord second = file.write(data.c_str(), data.size());
+		UndoSpillRecord third = file.write(data.c_str(), data.size());
+		CPPUNIT_ASSERT_EQUAL((gint64) 300, file.getSize());
+
+		// Releasing a record in the middle does not shrink the file
+		file.release(second);
+		CPPUNIT_ASSERT_EQUAL((gint64) 300, file.getSize());
+
+		// The file is truncated after the last used record, while the first is still used
+		file.release(third);
+		CPPUNIT_ASSERT_EQUAL((gint64) 100, file.getSize());
+		CPPUNIT_ASSERT_EQUAL((gint64) 100, fileSize(file));
+
+		string read;
+		CPPUNIT_ASSERT(file.read(first, read));
+		CPPUNIT_ASSERT_EQUAL(data, read);
+
+		file.release(first);
+		CPPUNIT_ASSERT_EQUAL((gint64) 0, file.getSize());
+		CPPUNIT_ASSERT_EQUAL((gint64) 0, fileSize(file));
+	}
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(UndoSpillTest);
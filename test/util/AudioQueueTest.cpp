@@ -0,0 +1,245 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <config-test.h>
+#include <audio/AudioQueue.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <thread>
+
+using namespace std;
+
+class AudioQueueTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE(AudioQueueTest);
+
+	CPPUNIT_TEST(testPushPop);
+	CPPUNIT_TEST(testWrapAround);
+	CPPUNIT_TEST(testWholeFrames);
+	CPPUNIT_TEST(testOverrun);
+	CPPUNIT_TEST(testUnderrun);
+	CPPUNIT_TEST(testEndOfStream);
+	CPPUNIT_TEST(testStress);
+
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp()
+	{
+	}
+
+	void tearDown()
+	{
+	}
+
+	void testPushPop()
+	{
+		AudioQueue<float> queue(8);
+		queue.setAudioAttributes(44100, 1);
+		CPPUNIT_ASSERT_EQUAL(8ul, queue.capacity());
+		CPPUNIT_ASSERT(queue.empty());
+
+		float in[] = { 1, 2, 3 };
+		CPPUNIT_ASSERT_EQUAL(3ul, queue.push(in, 3));
+		CPPUNIT_ASSERT_EQUAL(3ul, queue.size());
+		CPPUNIT_ASSERT_EQUAL(5ul, queue.freeSpace());
+
+		float out[8];
+		unsigned long length = 0;
+		queue.pop(out, length, 8);
+		CPPUNIT_ASSERT_EQUAL(3ul, length);
+		CPPUNIT_ASSERT_EQUAL(1.0f, out[0]);
+		CPPUNIT_ASSERT_EQUAL(2.0f, out[1]);
+		CPPUNIT_ASSERT_EQUAL(3.0f, out[2]);
+		CPPUNIT_ASSERT(queue.empty());
+	}
+
+	void testWrapAround()
+	{
+		AudioQueue<float> queue(8);
+		queue.setAudioAttributes(44100, 1);
+
+		float value = 0;
+		float expected = 0;
+		for (int i = 0; i < 20; i++)
+		{
+			float in[5];
+			for (float& f : in)
+			{
+				f = value++;
+			}
+			CPPUNIT_ASSERT_EQUAL(5ul, queue.push(in, 5));
+
+			float out[5];
+			unsigned long length = 0;
+			queue.pop(out, length, 5);
+			CPPUNIT_ASSERT_EQUAL(5ul, length);
+			for (float f : out)
+			{
+				CPPUNIT_ASSERT_EQUAL(expected++, f);
+			}
+		}
+		CPPUNIT_ASSERT_EQUAL(0ul, queue.getOverrunCount());
+	}
+
+	void testWholeFrames()
+	{
+		AudioQueue<float> queue(14);
+		queue.setAudioAttributes(44100, 2);
+		CPPUNIT_ASSERT_EQUAL(16ul, queue.capacity());
+
+		float in[] = { 1, 2, 3, 4, 5, 6, 7 };
+		queue.push(in, 6);
+		queue.push(in, 6);
+
+		// Only two whole stereo frames fit into the rest of the queue
+		CPPUNIT_ASSERT_EQUAL(4ul, queue.push(in, 7));
+		CPPUNIT_ASSERT_EQUAL(16ul, queue.size());
+
+		float out[8];
+		unsigned long length = 0;
+		queue.pop(out, length, 5);
+		CPPUNIT_ASSERT_EQUAL(4ul, length);
+	}
+
+	void testOverrun()
+	{
+		AudioQueue<float> queue(4);
+		queue.setAudioAttributes(44100, 1);
+
+		float in[] = { 1, 2, 3, 4, 5, 6 };
+		CPPUNIT_ASSERT_EQUAL(4ul, queue.push(in, 6));
+		CPPUNIT_ASSERT_EQUAL(0ul, queue.push(in, 6));
+		CPPUNIT_ASSERT_EQUAL(8ul, queue.getOverrunCount());
+
+		// The queued samples are not overwritten
+		float out[4];
+		unsigned long length = 0;
+		queue.pop(out, length, 4);
+		CPPUNIT_ASSERT_EQUAL(4ul, length);
+		CPPUNIT_ASSERT_EQUAL(4.0f, out[3]);
+
+		queue.reset();
+		CPPUNIT_ASSERT_EQUAL(0ul, queue.getOverrunCount());
+	}
+
+	void testUnderrun()
+	{
+		AudioQueue<float> queue(4);
+
+		float out[4];
+		unsigned long length = 1;
+
+		// No attributes yet
+		queue.pop(out, length, 4);
+		CPPUNIT_ASSERT_EQUAL(0ul, length);
+
+		queue.setAudioAttributes(44100, 2);
+		queue.pop(out, length, 4);
+		CPPUNIT_ASSERT_EQUAL(0ul, length);
+
+		float in[] = { 1, 2 };
+		queue.push(in, 2);
+		queue.pop(out, length, 4);
+		CPPUNIT_ASSERT_EQUAL(2ul, length);
+	}
+
+	void testEndOfStream()
+	{
+		AudioQueue<float> queue(4);
+		queue.setAudioAttributes(44100, 1);
+
+		thread producer([&queue]
+		{
+			this_thread::sleep_for(chrono::milliseconds(20));
+			queue.signalEndOfStream();
+		});
+
+		{
+			std::unique_lock<std::mutex> lock(queue.syncMutex());
+			queue.waitForProducer(lock);
+		}
+		CPPUNIT_ASSERT(queue.hasStreamEnded());
+		CPPUNIT_ASSERT(queue.empty());
+		producer.join();
+
+		queue.reset();
+		CPPUNIT_ASSERT(!queue.hasStreamEnded());
+	}
+
+	/**
+	 * A small queue with producer and consumer using different block sizes, so the
+	 * consumer often finds the queue empty and the producer finds it full. The producer
+	 * retries the dropped samples, so the consumer has to see every sample exactly once.
+	 */
+	void testStress()
+	{
+		const unsigned long SAMPLES = 1000000;
+		AudioQueue<float> queue(256);
+		queue.setAudioAttributes(44100, 1);
+
+		thread producer([&queue, SAMPLES]
+		{
+			float block[97];
+			unsigned long next = 0;
+			while (next < SAMPLES)
+			{
+				unsigned long count = std::min((unsigned long) 97, SAMPLES - next);
+				for (unsigned long i = 0; i < count; i++)
+				{
+					block[i] = (float) ((next + i) % 65536);
+				}
+				unsigned long pushed = queue.push(block, count);
+				if (pushed == 0)
+				{
+					this_thread::sleep_for(chrono::microseconds(50));
+				}
+				next += pushed;
+			}
+			queue.signalEndOfStream();
+		});
+
+		unsigned long received = 0;
+		unsigned long underruns = 0;
+		bool ordered = true;
+		float block[61];
+		while (!(queue.hasStreamEnded() && queue.empty()))
+		{
+			unsigned long length = 0;
+			queue.pop(block, length, 61);
+			if (length < 61)
+			{
+				underruns++;
+			}
+
+			for (unsigned long i = 0; i < length; i++)
+			{
+				ordered = ordered && block[i] == (float) ((received + i) % 65536);
+			}
+			received += length;
+
+			if (length == 0)
+			{
+				this_thread::sleep_for(chrono::microseconds(50));
+			}
+		}
+		producer.join();
+
+		CPPUNIT_ASSERT(ordered);
+		CPPUNIT_ASSERT_EQUAL(SAMPLES, received);
+		CPPUNIT_ASSERT(underruns > 0);
+		CPPUNIT_ASSERT(queue.getOverrunCount() > 0);
+	}
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(AudioQueueTest);
@@ -14,7 +14,9 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <ctime>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 using namespace std;
 
@@ -28,6 +30,8 @@ class StringUtilsTest : public CppUnit::TestFixture
 	CPPUNIT_TEST(testSplitOne);
 	CPPUNIT_TEST(testEndsWith);
 	CPPUNIT_TEST(testCompare);
+	CPPUNIT_TEST(testParseDouble);
+	CPPUNIT_TEST(testParseDoubleRandom);
 
 	CPPUNIT_TEST_SUITE_END();
 
@@ -90,6 +94,48 @@ public:
 		CPPUNIT_ASSERT_EQUAL(true, StringUtils::iequals("ööaa", "Ööaa"));
 		CPPUNIT_ASSERT_EQUAL(false, StringUtils::iequals("ööaa", "ööaaa"));
 	}
+
+	/**
+	 * parseDouble() has to return the same value and end position as g_ascii_strtod()
+	 */
+	void assertParseDouble(const char* str)
+	{
+		char* expectedEnd = NULL;
+		double expected = g_ascii_strtod(str, &expectedEnd);
+
+		char* end = NULL;
+		double value = StringUtils::parseDouble(str, &end);
+
+		CPPUNIT_ASSERT_EQUAL_MESSAGE(str, (long) (expectedEnd - str), (long) (end - str));
+		CPPUNIT_ASSERT_MESSAGE(str, memcmp(&expected, &value, sizeof(double)) == 0);
+	}
+
+	void testParseDouble()
+	{
+		for (const char* str : { "0", "-0", "+0", "1", "-1", "1.5", "595.28", "841.89", " 12.34 56.78",
+		                         "\n1.25", "1.", ".5", "-.5", "0.1", "0.3", "123456789.123456",
+		                         "9007199254740993", "0.1234567890123456789", "1e10", "1.5E-3", "0x1A",
+		                         "inf", "nan", "", ".", "-", "abc", "12abc", "1.2.3" })
+		{
+			assertParseDouble(str);
+		}
+
+		char* end = NULL;
+		CPPUNIT_ASSERT_EQUAL(841.89, StringUtils::parseDouble("841.89 12", &end));
+		CPPUNIT_ASSERT_EQUAL(string(" 12"), string(end));
+	}
+
+	void testParseDoubleRandom()
+	{
+		srand(42);
+		for (int i = 0; i < 100000; i++)
+		{
+			char str[64];
+			double v = (rand() - RAND_MAX / 2) / (double) (rand() % 100000 + 1);
+			snprintf(str, sizeof(str), "%.*f", i % 18, v);
+			assertParseDouble(str);
+		}
+	}
 };
 
 // Registers the fixture into the 'registry'
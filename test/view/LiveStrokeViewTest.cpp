@@ -0,0 +1,311 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include "model/Stroke.h"
+#include "view/DocumentView.h"
+#include "view/LiveStrokeView.h"
+#include <config-test.h>
+
+#ifdef TEST_CHECK_SPEED
+#include "SpeedTest.cpp"
+#endif
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+class LiveStrokeViewTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE(LiveStrokeViewTest);
+
+#ifdef TEST_CHECK_SPEED
+	CPPUNIT_TEST(testSpeedPenTrace);
+#endif
+
+	CPPUNIT_TEST(testFill);
+	CPPUNIT_TEST(testFillVisitedPoints);
+	CPPUNIT_TEST(testDashOffset);
+	CPPUNIT_TEST(testDamagedArea);
+
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp()
+	{
+	}
+
+	void tearDown()
+	{
+	}
+
+	static Stroke* createStroke(int fill, bool dashed)
+	{
+		Stroke* s = new Stroke();
+		s->setWidth(2);
+		s->setFill(fill);
+
+		if (dashed)
+		{
+			LineStyle style;
+			const double dashes[] = { 6, 4 };
+			style.setDashes(dashes, 2);
+			s->setLineStyle(style);
+		}
+
+		return s;
+	}
+
+	/**
+	 * @return The largest difference of two A8 surfaces of the same size, only at the pixels which
+	 * are not at an edge of b
+	 */
+	static int maxDifferenceInside(cairo_surface_t* a, cairo_surface_t* b)
+	{
+		cairo_surface_flush(a);
+		cairo_surface_flush(b);
+
+		int width = cairo_image_surface_get_width(a);
+		int height = cairo_image_surface_get_height(a);
+		int strideA = cairo_image_surface_get_stride(a);
+		int strideB = cairo_image_surface_get_stride(b);
+		unsigned char* dataA = cairo_image_surface_get_data(a);
+		unsigned char* dataB = cairo_image_surface_get_data(b);
+
+		int diff = 0;
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				int pixelB = dataB[y * strideB + x];
+				if (pixelB > 5 && pixelB < 250)
+				{
+					continue;
+				}
+				diff = std::max(diff, std::abs(dataA[y * strideA + x] - pixelB));
+			}
+		}
+		return diff;
+	}
+
+	void testFill()
+	{
+		// A loop which intersects itself, the fill is the same as the fill of the finished stroke
+		Stroke* s = createStroke(128, false);
+		LiveStrokeView view(s, 300, 300, 1.5);
+
+		s->addPoint(Point(100, 100));
+		for (int i = 1; i <= 60; i++)
+		{
+			double a = i * 0.2;
+			s->addPoint(Point(100 + i + 40 * std::sin(a), 100 + 40 * std::cos(a) - 40));
+			view.drawLastSegment();
+		}
+
+		cairo_surface_t* expected = cairo_image_surface_create(CAIRO_FORMAT_A8, 300, 300);
+		cairo_t* cr = cairo_create(expected);
+		cairo_scale(cr, 1.5, 1.5);
+		for (int i = 0; i < s->getPointCount(); i++)
+		{
+			Point p = s->getPoint(i);
+			cairo_line_to(cr, p.x, p.y);
+		}
+		cairo_fill(cr);
+		cairo_destroy(cr);
+
+		// The fill is not antialiased while drawing, only its edge pixels differ
+		CPPUNIT_ASSERT(view.getFillMask() != NULL);
+		CPPUNIT_ASSERT(maxDifferenceInside(view.getFillMask(), expected) == 0);
+
+		cairo_surface_destroy(expected);
+		delete s;
+	}
+
+	/**
+	 * A new point of a filled stroke reads only the first, the previous and the new point
+	 */
+	void testFillVisitedPoints()
+	{
+		Stroke* s = createStroke(128, false);
+		LiveStrokeView view(s, 300, 300, 1);
+
+		s->addPoint(Point(100, 100));
+		for (int i = 1; i <= 500; i++)
+		{
+			double a = i * 0.05;
+			s->addPoint(Point(100 + 80 * std::sin(a), 100 + 80 * std::cos(a * 1.3)));
+			view.drawLastSegment();
+
+			CPPUNIT_ASSERT_EQUAL(3, view.getVisitedPoints());
+		}
+
+		delete s;
+	}
+
+	void testDashOffset()
+	{
+		// Segments shorter than the dashes, the dashes continue over the segments
+		Stroke* s = createStroke(-1, true);
+		LiveStrokeView view(s, 220, 20, 1);
+
+		s->addPoint(Point(10, 10));
+		for (int i = 1; i <= 200; i++)
+		{
+			s->addPoint(Point(10 + i, 10));
+			view.drawLastSegment();
+		}
+
+		cairo_surface_t* mask = view.getMask();
+		cairo_surface_flush(mask);
+		unsigned char* row = cairo_image_surface_get_data(mask) + 10 * cairo_image_surface_get_stride(mask);
+
+		// Checks the middle of the dashes and gaps, the line starts with a dash of 6 and a gap of 4
+		for (int x = 10; x < 205; x += 10)
+		{
+			CPPUNIT_ASSERT(row[x + 3] > 200);
+			CPPUNIT_ASSERT(row[x + 8] < 50);
+		}
+
+		delete s;
+	}
+
+	void testDamagedArea()
+	{
+		Stroke* s = createStroke(-1, false);
+		LiveStrokeView view(s, 600, 600, 1);
+
+		s->addPoint(Point(10, 10));
+		for (int i = 1; i <= 50; i++)
+		{
+			s->addPoint(Point(10 + i * 10, 10 + i * 10));
+			Range range = view.drawLastSegment();
+
+			// Only the new segment, not the whole stroke
+			CPPUNIT_ASSERT(range.getX() >= i * 10 - 2);
+			CPPUNIT_ASSERT(range.getX2() <= 20 + i * 10 + 2);
+		}
+
+		delete s;
+
+		// The fill changes up to the first point
+		s = createStroke(128, false);
+		LiveStrokeView fillView(s, 600, 600, 1);
+		s->addPoint(Point(10, 10));
+		s->addPoint(Point(100, 10));
+		s->addPoint(Point(100, 100));
+		fillView.drawLastSegment();
+		s->addPoint(Point(10, 100));
+		Range range = fillView.drawLastSegment();
+
+		CPPUNIT_ASSERT(range.getX() <= 10);
+		CPPUNIT_ASSERT(range.getY() <= 10);
+
+		delete s;
+	}
+
+#ifdef TEST_CHECK_SPEED
+	/**
+	 * A pen trace of cursive loops written in 6 lines across an A4 page, with pressure,
+	 * one event per 5 ms. The jitter of the pen is random, but the same on each run.
+	 */
+	static std::vector<Point> createPenTrace()
+	{
+		srand(7);
+		auto jitter = [](double max) { return (rand() / (double) RAND_MAX * 2 - 1) * max; };
+
+		std::vector<Point> trace;
+		for (int row = 0; row < 6; row++)
+		{
+			double y0 = 120 + row * 110;
+			for (int i = 0; i < 900; i++)
+			{
+				double a = i * 0.08;
+				double x = 60 + i * 0.53 + 18 * cos(a + M_PI);
+				double y = y0 - 26 * sin(a) + 6 * sin(a * 0.37);
+				double pressure = 0.55 + 0.3 * pow(sin(a * 0.5), 2) + jitter(0.03);
+				trace.push_back(Point(x + jitter(0.15), y + jitter(0.15), pressure));
+			}
+		}
+		return trace;
+	}
+
+	/**
+	 * Replays the pen trace, the latency of the last points of a long stroke should be the
+	 * same as of the first points
+	 */
+	void testSpeedPenTrace()
+	{
+		std::vector<Point> trace = createPenTrace();
+		// A4 with zoom 1.5 on a HiDPI screen
+		const double scale = 3;
+		const int width = (int) (595 * scale);
+		const int height = (int) (842 * scale);
+
+		for (int mode = 0; mode < 3; mode++)
+		{
+			const char* names[] = { "plain", "dashed", "filled" };
+			Stroke* s = createStroke(mode == 2 ? 128 : -1, mode == 1);
+			LiveStrokeView view(s, width, height, scale);
+
+			// The widget paints the damaged area from the masks
+			cairo_surface_t* widget = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+			cairo_t* cr = cairo_create(widget);
+
+			SpeedTest speed;
+			speed.startTest(string("replay the pen trace, ") + names[mode] + " stroke");
+
+			std::vector<double> latency;
+			s->addPoint(trace[0]);
+			for (size_t i = 1; i < trace.size(); i++)
+			{
+				auto begin = std::chrono::steady_clock::now();
+
+				Point p = trace[i];
+				s->setLastPressure(p.z * s->getWidth());
+				s->addPoint(Point(p.x, p.y));
+				Range range = view.drawLastSegment();
+
+				cairo_save(cr);
+				cairo_rectangle(cr, range.getX() * scale, range.getY() * scale, range.getWidth() * scale,
+				                range.getHeight() * scale);
+				cairo_clip(cr);
+				view.paint(cr);
+				cairo_restore(cr);
+				cairo_surface_flush(widget);
+
+				std::chrono::duration<double, std::micro> time = std::chrono::steady_clock::now() - begin;
+				latency.push_back(time.count());
+			}
+
+			speed.endTest();
+
+			size_t quarter = latency.size() / 4;
+			for (size_t part = 0; part < 4; part++)
+			{
+				std::vector<double> l(latency.begin() + part * quarter, latency.begin() + (part + 1) * quarter);
+				std::sort(l.begin(), l.end());
+				cout << "Points " << part * quarter << " to " << (part + 1) * quarter << ": median "
+				     << l[l.size() / 2] << " us, 99th percentile " << l[l.size() * 99 / 100] << " us" << endl;
+			}
+
+			cairo_destroy(cr);
+			cairo_surface_destroy(widget);
+			delete s;
+		}
+	}
+#endif
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(LiveStrokeViewTest);